@@ -0,0 +1,302 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Adversarial corpus generator for csource. Where corpus.c writes code
+ * that looks like what people write, this writes the inputs that make
+ * scanners slow: enormous lines, long chains of continued lines, comments
+ * and strings that never end, and deeply nested braces. Every module must
+ * get through each of them in time linear in its size, which the bench
+ * harness checks with its --minimum option.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The help message is split into lines so that no single string
+ * literal is longer than ANSI C guarantees. */
+static const char *help_message[] = {
+    "adversarial --output DIR [ options ]",
+    "Generate inputs that are pathological for the csource scanners",
+    "",
+    "Options",
+    "    --output DIR     directory to write the cases to (must exist)",
+    "    --size SIZE      size of the cases made of one long construct, with an",
+    "                     optional K, M or G suffix (default 100M)",
+    "    --lines N        number of lines in the cases made of many lines",
+    "                     (default 1000000)",
+    "    --depth N        depth of the nested braces (default 10000)",
+    NULL
+};
+
+#define MINIMUM_SIZE    1024L
+#define MAXIMUM_SIZE    (1024L * 1024L * 1024L)
+
+/*
+ * @docgen: structure
+ * @brief: how large to make the cases
+ * @name: AdversarialShape
+ *
+ * @field size: size of the cases made of one long construct, in bytes
+ * @type: long
+ *
+ * @field lines: number of lines in the cases made of many lines
+ * @type: long
+ *
+ * @field depth: depth of the nested braces
+ * @type: long
+*/
+struct AdversarialShape {
+    long size;
+    long lines;
+    long depth;
+};
+
+/*
+ * @docgen: function
+ * @brief: write a string over and over until a size is reached
+ * @name: write_repeated
+ *
+ * @param file: the file to write to
+ * @type: FILE *
+ *
+ * @param string: the string to repeat
+ * @type: const char *
+ *
+ * @param size: the number of bytes to write
+ * @type: long
+*/
+static void write_repeated(FILE *file, const char *string, long size) {
+    long written = 0;
+    long length = strlen(string);
+
+    while(written + length <= size) {
+        fputs(string, file);
+        written += length;
+    }
+
+    fwrite(string, 1, size - written, file);
+}
+
+/*
+ * @docgen: function
+ * @brief: write a string a number of times
+ * @name: write_times
+ *
+ * @param file: the file to write to
+ * @type: FILE *
+ *
+ * @param string: the string to write
+ * @type: const char *
+ *
+ * @param times: the number of times to write it
+ * @type: long
+*/
+static void write_times(FILE *file, const char *string, long times) {
+    long index = 0;
+
+    for(index = 0; index < times; index++)
+        fputs(string, file);
+}
+
+/*
+ * @docgen: function
+ * @brief: open a case for writing
+ * @name: open_case
+ *
+ * @param output: the directory to write the case to
+ * @type: const char *
+ *
+ * @param name: the name of the case
+ * @type: const char *
+ *
+ * @return: the file of the case
+ * @type: FILE *
+*/
+static FILE *open_case(const char *output, const char *name) {
+    char path[4096 + 1];
+    FILE *file = NULL;
+
+    sprintf(path, "%.4000s/%.64s", output, name);
+
+    if((file = fopen(path, "wb")) == NULL) {
+        fprintf(stderr, "adversarial: could not open '%s' for writing\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    return file;
+}
+
+static long parse_size(const char *string) {
+    char *end = NULL;
+    long size = strtol(string, &end, 10);
+
+    switch(*end) {
+        case 'K': case 'k': return size * 1024L;
+        case 'M': case 'm': return size * 1024L * 1024L;
+        case 'G': case 'g': return size * 1024L * 1024L * 1024L;
+    }
+
+    return size;
+}
+
+int main(int argc, char **argv) {
+    int index = 0;
+    const char *output = NULL;
+    FILE *file = NULL;
+    struct AdversarialShape shape;
+
+    shape.size = 100L * 1024L * 1024L;
+    shape.lines = 1000000L;
+    shape.depth = 10000L;
+
+    for(index = 1; index + 1 < argc; index += 2) {
+        const char *value = argv[index + 1];
+
+        if(strcmp(argv[index], "--output") == 0)
+            output = value;
+        else if(strcmp(argv[index], "--size") == 0)
+            shape.size = parse_size(value);
+        else if(strcmp(argv[index], "--lines") == 0)
+            shape.lines = atol(value);
+        else if(strcmp(argv[index], "--depth") == 0)
+            shape.depth = atol(value);
+        else
+            break;
+    }
+
+    if(output == NULL || index != argc || shape.lines <= 0 || shape.depth <= 0) {
+        for(index = 0; help_message[index] != NULL; index++)
+            fprintf(stderr, "%s\n", help_message[index]);
+
+        exit(EXIT_FAILURE);
+    }
+
+    if(shape.size < MINIMUM_SIZE || shape.size > MAXIMUM_SIZE) {
+        fprintf(stderr, "adversarial: size must be between 1K and 1G\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* One line of code with no new line, statement end or brace in it */
+    file = open_case(output, "long-line.c");
+    write_repeated(file, "value = value + other * (count - 1) ", shape.size);
+    fclose(file);
+
+    /* A file of nothing but new lines */
+    file = open_case(output, "new-lines.c");
+    write_repeated(file, "\n", shape.size);
+    fclose(file);
+
+    /* Comments, strings and character strings that never end */
+    file = open_case(output, "unterminated-comment.c");
+    fputs("int main(void) {\n/*", file);
+    write_repeated(file, "still in the comment * / \n", shape.size);
+    fclose(file);
+
+    file = open_case(output, "unterminated-string.c");
+    fputs("const char *string = \"", file);
+    write_repeated(file, "still in the string \\\" /* // \n", shape.size);
+    fclose(file);
+
+    file = open_case(output, "unterminated-character.c");
+    fputs("char character = '", file);
+    write_repeated(file, "still in the character \\' /* // \n", shape.size);
+    fclose(file);
+
+    /* An inclusion whose path never ends */
+    file = open_case(output, "unterminated-include.c");
+    fputs("#include <", file);
+    write_repeated(file, "path/to/", shape.size);
+    fclose(file);
+
+    /* Directives and comments that go on and on through continuations,
+     * with both Unix and DOS line endings */
+    file = open_case(output, "continued-directive.c");
+    fputs("#define VALUE \\\n", file);
+    write_times(file, "    (1 + 2) \\\n", shape.lines);
+    fputs("int value = VALUE;\n", file);
+    fclose(file);
+
+    file = open_case(output, "continued-directive-crlf.c");
+    fputs("#define VALUE \\\r\n", file);
+    write_times(file, "    (1 + 2) \\\r\n", shape.lines);
+    fputs("int value = VALUE;\r\n", file);
+    fclose(file);
+
+    file = open_case(output, "continued-comment.c");
+    fputs("// a comment \\\n", file);
+    write_times(file, "still in the comment \\\n", shape.lines);
+    fputs("int value = 0;\n", file);
+    fclose(file);
+
+    /* Many small constructs, which grow the arrays they are kept in */
+    file = open_case(output, "many-includes.c");
+    write_times(file, "#include <stdio.h>\n", shape.lines);
+    fclose(file);
+
+    file = open_case(output, "many-declarations.c");
+    write_times(file, "int function(int argument);\n", shape.lines);
+    fclose(file);
+
+    /* Braces nested as deep as they go, around and inside a function */
+    file = open_case(output, "deep-braces.c");
+    fputs("int main(void) ", file);
+    write_times(file, "{\n", shape.depth);
+    write_times(file, "}\n", shape.depth);
+    write_times(file, "{", shape.depth);
+    write_times(file, "}", shape.depth);
+    fputs("\n", file);
+    fclose(file);
+
+    /* Conditionals nested as deep as they go, and one whose expression
+     * nests instead */
+    file = open_case(output, "deep-conditionals.c");
+    write_times(file, "#if defined(VALUE) || 1\n", shape.depth);
+    write_times(file, "#endif\n", shape.depth);
+    fclose(file);
+
+    file = open_case(output, "deep-expression.c");
+    fputs("#if ", file);
+    write_times(file, "(!", shape.depth);
+    fputs("VALUE", file);
+    write_times(file, ")", shape.depth);
+    fputs("\nint value = 0;\n#endif\n", file);
+    fclose(file);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,486 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * End-to-end benchmark runner for csource. Every command is run over
+ * every file of a corpus (see corpus.c), the same way a user would run
+ * it, and the throughput and memory use of each command is reported as
+ * JSON. The results can be saved as a baseline, and later results can
+ * be compared against it to catch regressions.
+ *
+ * The baseline format is the same JSON this program writes, and only
+ * the fields that are compared are read back from it.
+ *
+ * With --minimum, every command is instead run once over every file of
+ * an adversarial corpus (see adversarial.c) with a time bound derived
+ * from the size of the file, and any run that goes over its bound fails
+ * the benchmark. This is what catches a scanner going quadratic.
+*/
+
+#define _DEFAULT_SOURCE
+#define _BSD_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+
+#define MAXIMUM_FILES   65536
+
+static const char *help_message[] = {
+    "bench --csource PATH --corpus DIR [ options ]",
+    "Measure the throughput of every csource command over a corpus",
+    "",
+    "Options",
+    "    --csource PATH         the csource binary to measure",
+    "    --corpus DIR           the corpus to run over",
+    "    --runs N               best of N runs for each command (default 3)",
+    "    --baseline FILE        baseline to compare the results against",
+    "    --threshold PERCENT    allowed regression from the baseline (default 10)",
+    "    --save FILE            write the results as a new baseline",
+    "    --minimum MBPS         instead check that every command gets through",
+    "                           every file at MBPS or faster, give or take a",
+    "                           second of slack",
+    NULL
+};
+
+static const char *commands[] = {
+    "include", "functions", "strip-comments", "strip-directives", "prune",
+    "conditionals", "stats", "prototypes", "grep", "symbols", "tags", "types",
+    "globals", NULL
+};
+
+/*
+ * @docgen: structure
+ * @brief: the measurements of one command over a corpus
+ * @name: BenchResult
+ *
+ * @field bytes: the number of bytes processed
+ * @type: double
+ *
+ * @field files: the number of files processed
+ * @type: int
+ *
+ * @field seconds: wall time of the fastest run
+ * @type: double
+ *
+ * @field peak_rss: largest resident set size of a run, in kilobytes
+ * @type: long
+*/
+struct BenchResult {
+    double bytes;
+    int files;
+    double seconds;
+    long peak_rss;
+};
+
+static double now(void) {
+    struct timeval time;
+
+    gettimeofday(&time, NULL);
+
+    return (double) time.tv_sec + (double) time.tv_usec / 1e6;
+}
+
+/*
+ * @docgen: function
+ * @brief: run csource once, and record its peak memory usage
+ * @name: run_command
+ *
+ * @param csource: the csource binary
+ * @type: const char *
+ *
+ * @param command: the command to run
+ * @type: const char *
+ *
+ * @param path: the file to run it on
+ * @type: const char *
+ *
+ * @param result: the result to update the peak memory usage of
+ * @type: struct BenchResult *
+ *
+ * @param bound: seconds csource may run before it is killed, or 0
+ * @type: unsigned int
+ *
+ * @return: the exit status of csource
+ * @type: int
+*/
+static int run_command(const char *csource, const char *command, const char *path,
+                       struct BenchResult *result, unsigned int bound) {
+    int status = 0;
+    pid_t child = fork();
+    struct rusage usage;
+
+    if(child == 0) {
+        int null = open("/dev/null", O_WRONLY);
+
+        dup2(null, STDOUT_FILENO);
+
+        /* The alarm survives the exec, and its signal kills csource */
+        if(bound > 0)
+            alarm(bound);
+
+        /* grep looks for a name the corpus uses everywhere, in code,
+         * comments and strings alike */
+        if(strcmp(command, "grep") == 0)
+            execl(csource, csource, command, "cursor", path, (char *) NULL);
+        else
+            execl(csource, csource, command, path, (char *) NULL);
+
+        _exit(127);
+    }
+
+    if(child == -1 || wait4(child, &status, 0, &usage) == -1) {
+        perror("bench: could not run csource");
+        exit(EXIT_FAILURE);
+    }
+
+    if(usage.ru_maxrss > result->peak_rss)
+        result->peak_rss = usage.ru_maxrss;
+
+    return status;
+}
+
+/*
+ * @docgen: function
+ * @brief: find a number in the baseline
+ * @name: baseline_number
+ *
+ * @description
+ * @Find the value of a field inside of the object of a command in the
+ * @baseline JSON.
+ * @description
+ *
+ * @param baseline: the contents of the baseline
+ * @type: const char *
+ *
+ * @param command: the command to look for
+ * @type: const char *
+ *
+ * @param field: the field to read
+ * @type: const char *
+ *
+ * @return: the value, or -1 if it is not in the baseline
+ * @type: double
+*/
+static double baseline_number(const char *baseline, const char *command, const char *field) {
+    char key[64 + 1];
+    const char *object = NULL;
+    const char *value = NULL;
+
+    sprintf(key, "\"%.60s\"", command);
+
+    if((object = strstr(baseline, key)) == NULL)
+        return -1;
+
+    sprintf(key, "\"%.60s\"", field);
+
+    /* The field must belong to this command's object */
+    if((value = strstr(object, key)) == NULL || strchr(object, '}') < value)
+        return -1;
+
+    value = strchr(value, ':');
+
+    return strtod(value + 1, NULL);
+}
+
+/*
+ * @docgen: function
+ * @brief: run every command over every file, each within a time bound
+ * @name: run_bounded
+ *
+ * @description
+ * @Run each command once over each file, allowing it the time it would
+ * @take at the minimum throughput plus a second of slack for start up.
+ * @The results are written as JSON to stdout.
+ * @description
+ *
+ * @param csource: the csource binary
+ * @type: const char *
+ *
+ * @param paths: the files to run over
+ * @type: char (*)[4096 + 1]
+ *
+ * @param sizes: the size of each file, in bytes
+ * @type: const double *
+ *
+ * @param files: the number of files
+ * @type: int
+ *
+ * @param minimum: the minimum throughput, in megabytes per second
+ * @type: double
+ *
+ * @return: the number of runs that failed or went over their bound
+ * @type: int
+*/
+static int run_bounded(const char *csource, char (*paths)[4096 + 1], const double *sizes,
+                       int files, double minimum) {
+    int file = 0;
+    int failures = 0;
+
+    printf("{\n    \"cases\": [\n");
+
+    for(file = 0; file < files; file++) {
+        int index = 0;
+        unsigned int bound = (unsigned int) (sizes[file] / (1024.0 * 1024.0) / minimum) + 2;
+
+        for(index = 0; commands[index] != NULL; index++) {
+            int status = 0;
+            const char *verdict = "ok";
+            double start = now();
+            struct BenchResult result;
+
+            memset(&result, 0, sizeof(result));
+            status = run_command(csource, commands[index], paths[file], &result, bound);
+
+            if(WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM)
+                verdict = "timeout";
+            else if(status != 0)
+                verdict = "failed";
+
+            printf("        {\"file\": \"%s\", \"command\": \"%s\", \"bytes\": %.0f, "
+                   "\"seconds\": %.6f, \"bound\": %u, \"peak_rss_kb\": %li, "
+                   "\"result\": \"%s\"}%s\n", paths[file], commands[index], sizes[file],
+                   now() - start, bound, result.peak_rss, verdict,
+                   file + 1 < files || commands[index + 1] != NULL ? "," : "");
+
+            if(strcmp(verdict, "ok") == 0)
+                continue;
+
+            fprintf(stderr, "bench: '%s %s %s' %s (bound %us)\n", csource, commands[index],
+                    paths[file], strcmp(verdict, "timeout") == 0 ? "went over its bound"
+                    : "failed", bound);
+            failures++;
+        }
+    }
+
+    printf("    ]\n}\n");
+
+    return failures;
+}
+
+static char *load_file(const char *path) {
+    long length = 0;
+    char *contents = NULL;
+    FILE *file = fopen(path, "rb");
+
+    if(file == NULL)
+        return NULL;
+
+    fseek(file, 0, SEEK_END);
+    length = ftell(file);
+    rewind(file);
+
+    contents = malloc(length + 1);
+    contents[fread(contents, 1, length, file)] = '\0';
+    fclose(file);
+
+    return contents;
+}
+
+int main(int argc, char **argv) {
+    int index = 0;
+    int runs = 3;
+    int files = 0;
+    int regressions = 0;
+    double threshold = 10;
+    double minimum = 0;
+    double corpus_bytes = 0;
+    char *baseline = NULL;
+    const char *csource = NULL;
+    const char *corpus = NULL;
+    const char *save = NULL;
+    const char *baseline_path = NULL;
+    static char paths[MAXIMUM_FILES][4096 + 1];
+    static double sizes[MAXIMUM_FILES];
+    struct BenchResult results[sizeof(commands) / sizeof(*commands) - 1];
+    DIR *directory = NULL;
+    struct dirent *entry = NULL;
+    FILE *output = NULL;
+
+    for(index = 1; index + 1 < argc; index += 2) {
+        if(strcmp(argv[index], "--csource") == 0)
+            csource = argv[index + 1];
+        else if(strcmp(argv[index], "--corpus") == 0)
+            corpus = argv[index + 1];
+        else if(strcmp(argv[index], "--runs") == 0)
+            runs = atoi(argv[index + 1]);
+        else if(strcmp(argv[index], "--baseline") == 0)
+            baseline_path = argv[index + 1];
+        else if(strcmp(argv[index], "--threshold") == 0)
+            threshold = atof(argv[index + 1]);
+        else if(strcmp(argv[index], "--save") == 0)
+            save = argv[index + 1];
+        else if(strcmp(argv[index], "--minimum") == 0)
+            minimum = atof(argv[index + 1]);
+        else
+            break;
+    }
+
+    if(csource == NULL || corpus == NULL || index != argc || runs <= 0) {
+        for(index = 0; help_message[index] != NULL; index++)
+            fprintf(stderr, "%s\n", help_message[index]);
+
+        exit(EXIT_FAILURE);
+    }
+
+    if((directory = opendir(corpus)) == NULL) {
+        fprintf(stderr, "bench: could not open corpus '%s'\n", corpus);
+        exit(EXIT_FAILURE);
+    }
+
+    /* Collect the corpus up front so listing it is not measured */
+    while((entry = readdir(directory)) != NULL && files < MAXIMUM_FILES) {
+        struct stat status;
+
+        sprintf(paths[files], "%.2048s/%.2000s", corpus, entry->d_name);
+
+        if(stat(paths[files], &status) == -1 || S_ISREG(status.st_mode) == 0)
+            continue;
+
+        sizes[files] = (double) status.st_size;
+        corpus_bytes += (double) status.st_size;
+        files++;
+    }
+
+    closedir(directory);
+
+    if(minimum > 0) {
+        if(run_bounded(csource, paths, sizes, files, minimum) > 0)
+            return EXIT_FAILURE;
+
+        return EXIT_SUCCESS;
+    }
+
+    for(index = 0; commands[index] != NULL; index++) {
+        int run = 0;
+        struct BenchResult *result = results + index;
+
+        memset(result, 0, sizeof(*result));
+        result->bytes = corpus_bytes;
+        result->files = files;
+
+        for(run = 0; run < runs; run++) {
+            int file = 0;
+            double start = now();
+            double elapsed = 0;
+
+            for(file = 0; file < files; file++) {
+                if(run_command(csource, commands[index], paths[file], result, 0) == 0)
+                    continue;
+
+                fprintf(stderr, "bench: '%s %s %s' failed\n", csource, commands[index],
+                        paths[file]);
+                exit(EXIT_FAILURE);
+            }
+
+            elapsed = now() - start;
+
+            if(run == 0 || elapsed < result->seconds)
+                result->seconds = elapsed;
+        }
+    }
+
+    if(baseline_path != NULL && (baseline = load_file(baseline_path)) == NULL) {
+        fprintf(stderr, "bench: could not read baseline '%s'\n", baseline_path);
+        exit(EXIT_FAILURE);
+    }
+
+    /* Write the results as JSON, and compare them as we go */
+    output = stdout;
+
+    if(save != NULL && (output = fopen(save, "w")) == NULL) {
+        fprintf(stderr, "bench: could not write baseline '%s'\n", save);
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(output, "{\n    \"commands\": {\n");
+
+    for(index = 0; commands[index] != NULL; index++) {
+        struct BenchResult result = results[index];
+        double megabytes = result.bytes / (1024.0 * 1024.0) / result.seconds;
+        double files_per_second = result.files / result.seconds;
+
+        fprintf(output, "        \"%s\": {\"bytes\": %.0f, \"files\": %i, \"seconds\": %.6f, "
+                "\"mb_per_second\": %.3f, \"files_per_second\": %.3f, \"peak_rss_kb\": %li}%s\n",
+                commands[index], result.bytes, result.files, result.seconds, megabytes,
+                files_per_second, result.peak_rss, commands[index + 1] != NULL ? "," : "");
+
+        fprintf(stderr, "%-18s %10.3f MB/s %10.3f files/s %8li KB peak RSS\n", commands[index],
+                megabytes, files_per_second, result.peak_rss);
+
+        if(baseline == NULL)
+            continue;
+
+        if(megabytes < baseline_number(baseline, commands[index], "mb_per_second")
+                       * (1 - threshold / 100)) {
+            fprintf(stderr, "bench: %s regressed: %.3f MB/s, baseline %.3f MB/s\n", commands[index],
+                    megabytes, baseline_number(baseline, commands[index], "mb_per_second"));
+            regressions++;
+        }
+
+        if(baseline_number(baseline, commands[index], "peak_rss_kb") > 0 &&
+           result.peak_rss > baseline_number(baseline, commands[index], "peak_rss_kb")
+                             * (1 + threshold / 100)) {
+            fprintf(stderr, "bench: %s regressed: %li KB peak RSS, baseline %.0f KB\n",
+                    commands[index], result.peak_rss,
+                    baseline_number(baseline, commands[index], "peak_rss_kb"));
+            regressions++;
+        }
+    }
+
+    fprintf(output, "    }\n}\n");
+
+    if(output != stdout)
+        fclose(output);
+
+    free(baseline);
+
+    if(regressions > 0)
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,347 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Synthetic corpus generator for the csource benchmarks. This writes a
+ * directory of C-like source files whose shape can be tuned, so each
+ * module can be measured against the kind of input it is slow on.
+ *
+ * The generated code does not need to compile; it only has to look
+ * like C to the scanners. Every knob is a percentage or a count, and
+ * the same seed always produces the same corpus.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The help message is split into lines so that no single string
+ * literal is longer than ANSI C guarantees. */
+static const char *help_message[] = {
+    "corpus --output DIR [ options ]",
+    "Generate a synthetic C corpus for benchmarking csource",
+    "",
+    "Options",
+    "    --output DIR           directory to write the corpus to (must exist)",
+    "    --size SIZE            total size of the corpus, with an optional K, M or G",
+    "                           suffix (default 1M, between 1K and 1G)",
+    "    --files N              number of files to split the corpus into (default 16)",
+    "    --comments PERCENT     chance of a line being a comment (default 20)",
+    "    --directives PERCENT   chance of a line being a directive (default 10)",
+    "    --depth N              maximum nesting depth of blocks (default 3)",
+    "    --line-length N        target length of a line of code (default 60)",
+    "    --strings PERCENT      chance of a statement having a string (default 20)",
+    "    --seed N               seed of the generator (default 1)",
+    NULL
+};
+
+#define MINIMUM_SIZE    1024L
+#define MAXIMUM_SIZE    (1024L * 1024L * 1024L)
+
+/*
+ * @docgen: structure
+ * @brief: the shape of the corpus to generate
+ * @name: CorpusShape
+ *
+ * @field size: the total size of the corpus in bytes
+ * @type: long
+ *
+ * @field files: the number of files to split the corpus into
+ * @type: int
+ *
+ * @field comments: the chance of a line being a comment
+ * @type: int
+ *
+ * @field directives: the chance of a line being a directive
+ * @type: int
+ *
+ * @field depth: the maximum nesting depth of blocks
+ * @type: int
+ *
+ * @field line_length: the target length of a line of code
+ * @type: int
+ *
+ * @field strings: the chance of a statement having a string
+ * @type: int
+*/
+struct CorpusShape {
+    long size;
+    int files;
+    int comments;
+    int directives;
+    int depth;
+    int line_length;
+    int strings;
+};
+
+/* The generator has its own random number generator so that a seed
+ * produces the same corpus with every C library. */
+static unsigned long random_state = 1;
+
+static int random_below(int bound) {
+    random_state = (random_state * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+
+    return (int) ((random_state >> 8) % (unsigned long) bound);
+}
+
+static int chance(int percent) {
+    return random_below(100) < percent;
+}
+
+static const char *identifiers[] = {
+    "buffer", "length", "cursor", "index", "value", "result", "node", "count",
+    "offset", "state", "flags", "table", "entry", "limit", "handle", "context"
+};
+
+#define IDENTIFIER() identifiers[random_below(sizeof(identifiers) / sizeof(*identifiers))]
+
+/*
+ * @docgen: function
+ * @brief: write a string literal that looks dangerous to a scanner
+ * @name: write_string
+ *
+ * @description
+ * @Write a string literal containing escaped quotes, backslashes, and text
+ * @that looks like the start of a comment, to exercise the string handling
+ * @of each module.
+ * @description
+ *
+ * @param file: the file to write to
+ * @type: FILE *
+ *
+ * @return: the number of bytes written
+ * @type: int
+*/
+static int write_string(FILE *file) {
+    switch(random_below(4)) {
+        case 0:  return fprintf(file, "\"%s: %%i\\n\"", IDENTIFIER());
+        case 1:  return fprintf(file, "\"/* %s */ // \\\"quoted\\\"\"", IDENTIFIER());
+        case 2:  return fprintf(file, "'\\''");
+        default: return fprintf(file, "\"C:\\\\%s\\\\\"", IDENTIFIER());
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: write a single line of code, comment or directive
+ * @name: write_line
+ *
+ * @param file: the file to write to
+ * @type: FILE *
+ *
+ * @param shape: the shape of the corpus
+ * @type: struct CorpusShape
+ *
+ * @param depth: the current nesting depth
+ * @type: int
+ *
+ * @return: the number of bytes written
+ * @type: int
+*/
+static int write_line(FILE *file, struct CorpusShape shape, int depth) {
+    int written = 0;
+
+    if(chance(shape.directives)) {
+        switch(random_below(4)) {
+            case 0:  return fprintf(file, "#include <%s.h>\n", IDENTIFIER());
+            case 1:  return fprintf(file, "#define %s_MAXIMUM(a, b) \\\n    ((a) > (b) ? (a) : (b))\n",
+                                    IDENTIFIER());
+            case 2:  return fprintf(file, "  #  if defined(%s)\n", IDENTIFIER());
+            default: return fprintf(file, "#endif\n");
+        }
+    }
+
+    if(chance(shape.comments)) {
+        if(random_below(2) == 0)
+            return fprintf(file, "%*s// %s is \"checked\" here\n", depth * 4, "", IDENTIFIER());
+
+        return fprintf(file, "%*s/* %s\n%*s * is updated ** here */\n", depth * 4, "", IDENTIFIER(),
+                       depth * 4, "");
+    }
+
+    written += fprintf(file, "%*s%s = %s", depth * 4, "", IDENTIFIER(), IDENTIFIER());
+
+    while(written < shape.line_length)
+        written += fprintf(file, " + %s[%i]", IDENTIFIER(), random_below(64));
+
+    if(chance(shape.strings)) {
+        written += fprintf(file, " + strlen(");
+        written += write_string(file);
+        written += fprintf(file, ")");
+    }
+
+    return written + fprintf(file, ";\n");
+}
+
+/*
+ * @docgen: function
+ * @brief: write a function whose body nests blocks
+ * @name: write_function
+ *
+ * @param file: the file to write to
+ * @type: FILE *
+ *
+ * @param shape: the shape of the corpus
+ * @type: struct CorpusShape
+ *
+ * @return: the number of bytes written
+ * @type: int
+*/
+static int write_function(FILE *file, struct CorpusShape shape) {
+    int depth = 1;
+    int lines = 0;
+    int written = 0;
+    int body_lines = 8 + random_below(24);
+
+    written += fprintf(file, "static int %s_%i(struct Context *%s, int %s) {\n", IDENTIFIER(),
+                       random_below(100000), IDENTIFIER(), IDENTIFIER());
+
+    for(lines = 0; lines < body_lines; lines++) {
+        /* Open a new block, or close the innermost one */
+        if(depth < shape.depth && random_below(4) == 0) {
+            written += fprintf(file, "%*sif(%s != 0) {\n", depth * 4, "", IDENTIFIER());
+            depth++;
+
+            continue;
+        }
+
+        if(depth > 1 && random_below(6) == 0) {
+            depth--;
+            written += fprintf(file, "%*s}\n", depth * 4, "");
+
+            continue;
+        }
+
+        written += write_line(file, shape, depth);
+    }
+
+    while(depth > 1) {
+        depth--;
+        written += fprintf(file, "%*s}\n", depth * 4, "");
+    }
+
+    return written + fprintf(file, "    return 0;\n}\n\n");
+}
+
+static long parse_size(const char *string) {
+    char *end = NULL;
+    long size = strtol(string, &end, 10);
+
+    switch(*end) {
+        case 'k': case 'K': return size * 1024L;
+        case 'm': case 'M': return size * 1024L * 1024L;
+        case 'g': case 'G': return size * 1024L * 1024L * 1024L;
+    }
+
+    return size;
+}
+
+int main(int argc, char **argv) {
+    int index = 0;
+    const char *output = NULL;
+    struct CorpusShape shape;
+
+    shape.size = 1024L * 1024L;
+    shape.files = 16;
+    shape.comments = 20;
+    shape.directives = 10;
+    shape.depth = 3;
+    shape.line_length = 60;
+    shape.strings = 20;
+
+    for(index = 1; index + 1 < argc; index += 2) {
+        const char *value = argv[index + 1];
+
+        if(strcmp(argv[index], "--output") == 0)
+            output = value;
+        else if(strcmp(argv[index], "--size") == 0)
+            shape.size = parse_size(value);
+        else if(strcmp(argv[index], "--files") == 0)
+            shape.files = atoi(value);
+        else if(strcmp(argv[index], "--comments") == 0)
+            shape.comments = atoi(value);
+        else if(strcmp(argv[index], "--directives") == 0)
+            shape.directives = atoi(value);
+        else if(strcmp(argv[index], "--depth") == 0)
+            shape.depth = atoi(value);
+        else if(strcmp(argv[index], "--line-length") == 0)
+            shape.line_length = atoi(value);
+        else if(strcmp(argv[index], "--strings") == 0)
+            shape.strings = atoi(value);
+        else if(strcmp(argv[index], "--seed") == 0)
+            random_state = strtoul(value, NULL, 10);
+        else
+            break;
+    }
+
+    if(output == NULL || index != argc || shape.files <= 0 || shape.depth <= 0) {
+        for(index = 0; help_message[index] != NULL; index++)
+            fprintf(stderr, "%s\n", help_message[index]);
+
+        exit(EXIT_FAILURE);
+    }
+
+    if(shape.size < MINIMUM_SIZE || shape.size > MAXIMUM_SIZE) {
+        fprintf(stderr, "corpus: size must be between 1K and 1G\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for(index = 0; index < shape.files; index++) {
+        long written = 0;
+        char path[4096 + 1];
+        FILE *file = NULL;
+
+        sprintf(path, "%.4000s/corpus_%04i.c", output, index);
+
+        if((file = fopen(path, "w")) == NULL) {
+            fprintf(stderr, "corpus: could not open '%s' for writing\n", path);
+            exit(EXIT_FAILURE);
+        }
+
+        /* Every file gets its share of the corpus */
+        while(written < shape.size / shape.files) {
+            if(random_below(8) == 0)
+                written += write_line(file, shape, 0);
+            else
+                written += write_function(file, shape);
+        }
+
+        fclose(file);
+    }
+
+    return EXIT_SUCCESS;
+}
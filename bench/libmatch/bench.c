@@ -0,0 +1,250 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Microbenchmarks for the libmatch primitives that every module is built
+ * from. Each primitive is run over the same input shapes in isolation,
+ * and the time it takes per byte of input is written as one JSON object
+ * per line, in a fixed order, so the output of two commits can be diffed
+ * directly.
+*/
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../src/libmatch/libmatch.h"
+
+#define DEFAULT_BUFFER_SIZE (4L * 1024L * 1024L)
+#define MINIMUM_SECONDS     0.25
+
+static const char *help_message[] = {
+    "bench-libmatch [ --size BYTES ] [ --label LABEL ]",
+    "Measure the time libmatch primitives take per byte of input",
+    "",
+    "Options",
+    "    --size BYTES           size of each input (default 4194304)",
+    "    --label LABEL          label to attach to every result",
+    NULL
+};
+
+/* Every benchmark scans a whole input, and returns a checksum that depends
+ * on the scan so that the work cannot be optimized away. The checksum is
+ * also written out, so a change in behavior shows up in a diff. */
+typedef long (*Benchmark)(char *buffer, int length);
+
+static long bench_getch(char *buffer, int length) {
+    long sum = 0;
+    int character = -1;
+    struct LibmatchCursor cursor = libmatch_cursor_init(buffer, length);
+
+    while((character = libmatch_cursor_getch(&cursor)) != LIBMATCH_EOF)
+        sum += character;
+
+    return sum;
+}
+
+static long bench_until(char *buffer, int length) {
+    long sum = 0;
+    struct LibmatchCursor cursor = libmatch_cursor_init(buffer, length);
+
+    /* Without pushback, the new line that stops it is consumed too */
+    while(cursor.cursor < cursor.length)
+        sum += libmatch_until(&cursor, "\n");
+
+    return sum;
+}
+
+static long bench_read_alloc_until(char *buffer, int length) {
+    long sum = 0;
+    struct LibmatchCursor cursor = libmatch_cursor_init(buffer, length);
+
+    while(cursor.cursor < cursor.length) {
+        char *line = libmatch_read_alloc_until(&cursor, "\n");
+
+        sum += line[0];
+        libmatch_free_hook(line);
+    }
+
+    return sum;
+}
+
+static long bench_cond_before(char *buffer, int length) {
+    long sum = 0;
+    struct LibmatchCursor cursor = libmatch_cursor_init(buffer, length);
+
+    /* Ask the question the include extractor asks at every line */
+    while(cursor.cursor < cursor.length) {
+        sum += libmatch_cond_before(&cursor, '#', "\n");
+
+        while(cursor.cursor < cursor.length && buffer[cursor.cursor++] != '\n')
+            continue;
+    }
+
+    return sum;
+}
+
+static long bench_string_expect(char *buffer, int length) {
+    long sum = 0;
+    struct LibmatchCursor cursor = libmatch_cursor_init(buffer, length);
+
+    libmatch_cursor_enable_pushback(&cursor);
+
+    /* Ask the question the comment filter asks at every byte */
+    while(cursor.cursor < cursor.length) {
+        struct LibmatchCursor copy = cursor;
+
+        sum += libmatch_string_expect(&copy, "/*");
+        cursor.cursor++;
+    }
+
+    return sum;
+}
+
+static long bench_next_line(char *buffer, int length) {
+    long sum = 0;
+    struct LibmatchCursor cursor = libmatch_cursor_init(buffer, length);
+
+    while(cursor.cursor < cursor.length)
+        sum += libmatch_next_line(&cursor);
+
+    return sum;
+}
+
+static const char *benchmark_names[] = {
+    "libmatch_cursor_getch", "libmatch_until", "libmatch_read_alloc_until",
+    "libmatch_cond_before", "libmatch_string_expect", "libmatch_next_line", NULL
+};
+
+static Benchmark benchmarks[] = {
+    bench_getch, bench_until, bench_read_alloc_until,
+    bench_cond_before, bench_string_expect, bench_next_line
+};
+
+/*
+ * @docgen: function
+ * @brief: fill a buffer with an input shape
+ * @name: fill_shape
+ *
+ * @param buffer: the buffer to fill
+ * @type: char *
+ *
+ * @param length: the length of the buffer
+ * @type: long
+ *
+ * @param shape: the name of the shape
+ * @type: const char *
+*/
+static void fill_shape(char *buffer, long length, const char *shape) {
+    long index = 0;
+    unsigned long state = 1;
+    const char *punctuation = "{}()[];,.<>=+-*/%&|^!~?:#\"'\\";
+
+    for(index = 0; index < length; index++) {
+        state = (state * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+
+        if(strcmp(shape, "short-lines") == 0)
+            buffer[index] = (index % 24 == 23) ? '\n' : (char) ('a' + (state >> 8) % 26);
+        else if(strcmp(shape, "long-lines") == 0)
+            buffer[index] = (index % 10240 == 10239) ? '\n' : (char) ('a' + (state >> 8) % 26);
+        else if(strcmp(shape, "whitespace") == 0)
+            buffer[index] = (index % 80 == 79) ? '\n' : " \t"[(state >> 8) % 2];
+        else
+            buffer[index] = (index % 80 == 79) ? '\n' :
+                            punctuation[(state >> 8) % strlen(punctuation)];
+    }
+}
+
+static const char *shapes[] = {
+    "short-lines", "long-lines", "whitespace", "punctuation", NULL
+};
+
+int main(int argc, char **argv) {
+    int index = 0;
+    int shape = 0;
+    long size = DEFAULT_BUFFER_SIZE;
+    const char *label = "";
+    char *buffer = NULL;
+
+    for(index = 1; index + 1 < argc; index += 2) {
+        if(strcmp(argv[index], "--size") == 0)
+            size = atol(argv[index + 1]);
+        else if(strcmp(argv[index], "--label") == 0)
+            label = argv[index + 1];
+        else
+            break;
+    }
+
+    if(index != argc || size <= 0) {
+        for(index = 0; help_message[index] != NULL; index++)
+            fprintf(stderr, "%s\n", help_message[index]);
+
+        exit(EXIT_FAILURE);
+    }
+
+    buffer = malloc(size);
+
+    for(shape = 0; shapes[shape] != NULL; shape++) {
+        fill_shape(buffer, size, shapes[shape]);
+
+        for(index = 0; benchmark_names[index] != NULL; index++) {
+            long sum = 0;
+            long iterations = 0;
+            double seconds = 0;
+            clock_t start = clock();
+
+            /* Repeat the scan until the clock has measured enough time
+             * for the result to be stable. */
+            do {
+                sum = benchmarks[index](buffer, (int) size);
+                iterations++;
+                seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+            } while(seconds < MINIMUM_SECONDS);
+
+            printf("{\"label\":\"%s\",\"function\":\"%s\",\"shape\":\"%s\",\"bytes\":%li,"
+                   "\"iterations\":%li,\"ns_per_byte\":%.4f,\"checksum\":%li}\n", label,
+                   benchmark_names[index], shapes[shape], size, iterations,
+                   seconds * 1e9 / ((double) size * (double) iterations), sum);
+            fflush(stdout);
+        }
+    }
+
+    free(buffer);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,260 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Standalone driver for the differential fuzzing harness, for when no
+ * fuzzer toolchain is around. Given files, it checks each of them once,
+ * which is also how AFL runs it (`afl-fuzz ... -- fuzz/driver @@`).
+ * Otherwise, it generates random inputs from fragments of C that the
+ * scanners care about, and checks those.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fuzz.h"
+
+/* The help message is split into lines so that no single string
+ * literal is longer than ANSI C guarantees. */
+static const char *help_message[] = {
+    "driver [ options ] [ FILE ... ]",
+    "Check every csource module against its reference model",
+    "",
+    "Options",
+    "    --runs N       number of random inputs to check (default 10000)",
+    "    --seed N       seed of the generator (default 1)",
+    "    --size N       maximum number of fragments in an input (default 64)",
+    "    --save PATH    where to save an input that fails (default fuzz-failure.c)",
+    NULL
+};
+
+/* The generator has its own random number generator so that a seed
+ * produces the same inputs with every C library. */
+static unsigned long random_state = 1;
+
+static int random_below(int bound) {
+    random_state = (random_state * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+
+    return (int) ((random_state >> 8) % (unsigned long) bound);
+}
+
+/* Fragments that change the state of at least one of the scanners */
+static const char *fragments[] = {
+    "/*", "*/", "//", "/", "*", "\"", "'", "\\", "\\\\", "\\\n", "\n", "\r\n",
+    "\r", " ", "\t", "#", "#include ", "# include", "#define X ", "#if 0\n",
+    "#endif\n", "<stdio.h>", "\"local.h\"", "<", ">", "{", "}", "(", ")", ";",
+    "=", "[", "]", ",", "int ", "static ", "typedef ", "struct s ", "main",
+    "x", "0", "'\"'", "\"/*\"", "'\\''", "\"\\\"\"", "char *s = \"", " * @docgen: ",
+    "@name: ", "@param x: ", "@description", "@", ":", "#if X && (1 ? 2 : 0)\n",
+    "#ifdef X\n", "#elif defined(X) || 0x10 >> 1\n", "#else\n", "#undef X\n", NULL
+};
+
+/*
+ * @docgen: function
+ * @brief: generate a random input
+ * @name: generate
+ *
+ * @param buffer: the buffer to generate into
+ * @type: char *
+ *
+ * @param fragments_count: the number of fragments to generate
+ * @type: int
+ *
+ * @return: the length of the input
+ * @type: int
+*/
+static int generate(char *buffer, int fragments_count) {
+    int index = 0;
+    int length = 0;
+    int total = 0;
+
+    while(fragments[total] != NULL)
+        total++;
+
+    for(index = 0; index < fragments_count; index++) {
+        const char *fragment = fragments[random_below(total)];
+
+        /* Mix in the odd raw byte, so nothing relies on only ever
+         * seeing the fragments above */
+        if(random_below(16) == 0) {
+            buffer[length++] = (char) (1 + random_below(255));
+
+            continue;
+        }
+
+        strcpy(buffer + length, fragment);
+        length += strlen(fragment);
+    }
+
+    return length;
+}
+
+/*
+ * @docgen: function
+ * @brief: save an input that failed
+ * @name: save_failure
+ *
+ * @param path: the path to save the input to
+ * @type: const char *
+ *
+ * @param data: the input
+ * @type: const char *
+ *
+ * @param size: the size of the input
+ * @type: int
+*/
+static void save_failure(const char *path, const char *data, int size) {
+    FILE *file = fopen(path, "wb");
+
+    if(file == NULL) {
+        fprintf(stderr, "driver: could not save the failing input to '%s'\n", path);
+
+        return;
+    }
+
+    fwrite(data, 1, size, file);
+    fclose(file);
+
+    fprintf(stderr, "driver: failing input saved to '%s'\n", path);
+}
+
+/*
+ * @docgen: function
+ * @brief: check every file given to the driver
+ * @name: check_files
+ *
+ * @param paths: the paths of the files
+ * @type: char **
+ *
+ * @param count: the number of files
+ * @type: int
+ *
+ * @return: the number of files that failed
+ * @type: int
+*/
+static int check_files(char **paths, int count) {
+    int index = 0;
+    int failures = 0;
+
+    for(index = 0; index < count; index++) {
+        long size = 0;
+        char *data = NULL;
+        FILE *file = fopen(paths[index], "rb");
+
+        if(file == NULL) {
+            fprintf(stderr, "driver: could not open '%s'\n", paths[index]);
+            exit(EXIT_FAILURE);
+        }
+
+        fseek(file, 0, SEEK_END);
+        size = ftell(file);
+        rewind(file);
+
+        data = malloc(size + 1);
+        size = (long) fread(data, 1, size, file);
+        fclose(file);
+
+        if(csource_fuzz_compare(data, (int) size) != 0) {
+            fprintf(stderr, "driver: '%s' failed\n", paths[index]);
+            failures++;
+        }
+
+        free(data);
+    }
+
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    int index = 0;
+    int run = 0;
+    int runs = 10000;
+    int size = 64;
+    char *buffer = NULL;
+    const char *save = "fuzz-failure.c";
+
+    for(index = 1; index + 1 < argc && strncmp(argv[index], "--", 2) == 0; index += 2) {
+        const char *value = argv[index + 1];
+
+        if(strcmp(argv[index], "--runs") == 0)
+            runs = atoi(value);
+        else if(strcmp(argv[index], "--seed") == 0)
+            random_state = strtoul(value, NULL, 10);
+        else if(strcmp(argv[index], "--size") == 0)
+            size = atoi(value);
+        else if(strcmp(argv[index], "--save") == 0)
+            save = value;
+        else
+            break;
+    }
+
+    if((index < argc && strncmp(argv[index], "--", 2) == 0) || runs < 0 || size <= 0) {
+        for(index = 0; help_message[index] != NULL; index++)
+            fprintf(stderr, "%s\n", help_message[index]);
+
+        exit(EXIT_FAILURE);
+    }
+
+    /* Replay the given inputs instead of generating any */
+    if(index < argc) {
+        if(check_files(argv + index, argc - index) != 0)
+            exit(EXIT_FAILURE);
+
+        return EXIT_SUCCESS;
+    }
+
+    /* No fragment is longer than 16 bytes */
+    buffer = malloc(size * 16 + 1);
+
+    for(run = 0; run < runs; run++) {
+        int length = generate(buffer, 1 + random_below(size));
+
+        if(csource_fuzz_compare(buffer, length) == 0)
+            continue;
+
+        save_failure(save, buffer, length);
+        free(buffer);
+
+        exit(EXIT_FAILURE);
+    }
+
+    printf("driver: %i inputs matched the reference\n", runs);
+    free(buffer);
+
+    return EXIT_SUCCESS;
+}
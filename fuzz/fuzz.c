@@ -0,0 +1,428 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Differential fuzzing harness for csource. Every module is run twice
+ * on the same input: once as the reference model, which is the plain
+ * per-character scanner reading the input through a stream, and once as
+ * the implementation csource actually uses, reading the input straight
+ * from memory. The output of both must be byte-identical in every
+ * output format, so faster engines can replace the implementation while
+ * the reference keeps them honest. The command is then run once more
+ * through libcsource, which must agree with the implementation.
+ *
+ * This file provides LLVMFuzzerTestOneInput for libFuzzer, and is also
+ * linked into the standalone driver in driver.c, which AFL can use.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/csource.h"
+#include "../src/output/output.h"
+#include "../src/extractors/include/include.h"
+#include "../src/extractors/docgen/docgen.h"
+#include "../src/extractors/conditionals/conditionals.h"
+#include "../src/extractors/counts/counts.h"
+#include "../src/extractors/defines/defines.h"
+#include "../src/extractors/functions/functions.h"
+#include "../src/extractors/prototypes/prototypes.h"
+#include "../src/extractors/grep/grep.h"
+#include "../src/extractors/symbols/symbols.h"
+#include "../src/extractors/tags/tags.h"
+#include "../src/extractors/types/types.h"
+#include "../src/extractors/globals/globals.h"
+#include "../src/filters/comments/comments.h"
+#include "../src/filters/directives/directives.h"
+#include "../src/filters/prune/prune.h"
+#include "../src/library/libcsource.h"
+
+#include "fuzz.h"
+
+/*
+ * @docgen: structure
+ * @brief: a module and the model it is checked against
+ * @name: FuzzModule
+ *
+ * @field name: the name of the module
+ * @type: const char *
+ *
+ * @field reference: the reference model of the module
+ * @type: void (*)(struct ModuleSetup)
+ *
+ * @field implementation: the implementation used by csource
+ * @type: void (*)(struct ModuleSetup)
+*/
+struct FuzzModule {
+    const char *name;
+    void (*reference)(struct ModuleSetup setup);
+    void (*implementation)(struct ModuleSetup setup);
+};
+
+/* Until a module has an accelerated engine, its implementation is its
+ * own reference, which still checks it against stream ingest. */
+static struct FuzzModule modules[] = {
+    {"include", csource_write_inclusions, csource_write_inclusions},
+    {"functions", csource_extract_functions, csource_extract_functions},
+    {"strip-comments", csource_filter_comments_reference, csource_filter_comments},
+    {"strip-directives", csource_filter_directives_reference, csource_filter_directives},
+    {"docgen", csource_extract_docgen, csource_extract_docgen},
+    {"defines", csource_extract_defines, csource_extract_defines},
+    {"prune", csource_filter_prune, csource_filter_prune},
+    {"conditionals", csource_extract_conditionals, csource_extract_conditionals},
+    {"stats", csource_extract_counts, csource_extract_counts},
+    {"prototypes", csource_extract_prototypes, csource_extract_prototypes},
+    {"grep", csource_extract_grep_reference, csource_extract_grep},
+    {"symbols", csource_extract_symbols, csource_extract_symbols},
+    {"tags", csource_extract_tags, csource_extract_tags},
+    {"types", csource_extract_types, csource_extract_types},
+    {"globals", csource_extract_globals, csource_extract_globals},
+    {NULL, NULL, NULL}
+};
+
+static const int formats[] = {
+    CSOURCE_FORMAT_TEXT, CSOURCE_FORMAT_JSONL, CSOURCE_FORMAT_BINARY, -1
+};
+
+static const char *format_names[] = {
+    "text", "jsonl", "binary"
+};
+
+/* The identifiers grep looks for, which are all in the fragments of
+ * the driver */
+static const char *identifiers[] = {
+    "main", "x", "X", "s", NULL
+};
+
+/*
+ * @docgen: structure
+ * @brief: a sink that collects output in memory
+ * @name: FuzzBuffer
+ *
+ * @field contents: the output so far
+ * @type: char *
+ *
+ * @field length: the length of the output
+ * @type: long
+ *
+ * @field capacity: the capacity of the contents
+ * @type: long
+*/
+struct FuzzBuffer {
+    char *contents;
+    long length;
+    long capacity;
+};
+
+/*
+ * @docgen: function
+ * @brief: collect output into a buffer
+ * @name: collect_output
+ *
+ * @param sink: the sink of the buffer
+ * @type: struct CSourceSink *
+ *
+ * @param bytes: the output
+ * @type: const char *
+ *
+ * @param length: the length of the output
+ * @type: int
+ *
+ * @return: 0, since memory is all it needs
+ * @type: int
+*/
+static int collect_output(struct CSourceSink *sink, const char *bytes, int length) {
+    struct FuzzBuffer *buffer = sink->data;
+
+    while(buffer->length + length > buffer->capacity) {
+        buffer->capacity = buffer->capacity * 2 + length;
+        buffer->contents = realloc(buffer->contents, buffer->capacity);
+    }
+
+    memcpy(buffer->contents + buffer->length, bytes, length);
+    buffer->length += length;
+
+    return 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: run a module and collect its output
+ * @name: run_module
+ *
+ * @param module: the module to run
+ * @type: void (*)(struct ModuleSetup)
+ *
+ * @param input: the input to run the module on
+ * @type: struct LibmatchCursor
+ *
+ * @param format: the output format to write in
+ * @type: int
+ *
+ * @param length: where to store the length of the output
+ * @type: long *
+ *
+ * @return: the output of the module, which must be freed
+ * @type: char *
+*/
+static char *run_module(void (*module)(struct ModuleSetup), struct LibmatchCursor input,
+                        int format, long *length) {
+    struct ModuleSetup setup;
+    struct CSourceOutput output;
+    struct CSourceSink sink;
+    struct FuzzBuffer buffer;
+
+    INIT_VARIABLE(setup);
+    INIT_VARIABLE(buffer);
+
+    sink.write = collect_output;
+    sink.data = &buffer;
+    buffer.contents = malloc(1);
+    buffer.capacity = 1;
+
+    output = csource_output_init_sink(&sink, format, "fuzz.c");
+    setup.input = input;
+    setup.source = "fuzz.c";
+    setup.command = "fuzz";
+    setup.identifiers = identifiers;
+    setup.output = &output;
+
+    /* Each scope and format of tags gets its share of the inputs */
+    setup.scope = input.length % 3;
+    setup.tags = input.length % 2;
+
+    module(setup);
+
+    csource_output_flush(&output);
+    csource_output_free(&output);
+
+    *length = buffer.length;
+
+    return buffer.contents;
+}
+
+/*
+ * @docgen: function
+ * @brief: run a command through libcsource and collect its output
+ * @name: run_library
+ *
+ * @param command: the command to run
+ * @type: const char *
+ *
+ * @param data: the input to run the command on
+ * @type: const char *
+ *
+ * @param size: the size of the input
+ * @type: int
+ *
+ * @param format: the output format to write in
+ * @type: int
+ *
+ * @param length: where to store the length of the output
+ * @type: long *
+ *
+ * @return: the output of the command, which must be freed
+ * @type: char *
+*/
+static char *run_library(const char *command, const char *data, int size, int format,
+                         long *length) {
+    int error = 0;
+    struct CSourceSink sink;
+    struct FuzzBuffer buffer;
+    struct CSourceContext context = csource_context_init();
+
+    INIT_VARIABLE(buffer);
+
+    sink.write = collect_output;
+    sink.data = &buffer;
+    buffer.contents = malloc(1);
+    buffer.capacity = 1;
+    context.format = format;
+    context.identifiers = identifiers;
+    context.scope = size % 3;
+    context.tags = size % 2;
+
+    if((error = csource_context_run(&context, command, "fuzz.c", data, size, &sink)) != 0) {
+        fprintf(stderr, "fuzz: libcsource could not run %s (%s)\n", command,
+                csource_error_message(error));
+        abort();
+    }
+
+    csource_context_free(&context);
+    *length = buffer.length;
+
+    return buffer.contents;
+}
+
+/*
+ * @docgen: function
+ * @brief: read an input the way the reference model does
+ * @name: reference_input
+ *
+ * @description
+ * @Make a cursor over the input by writing it to a stream and reading
+ * @it back with libmatch_cursor_from_stream.
+ * @description
+ *
+ * @param data: the input
+ * @type: const char *
+ *
+ * @param size: the size of the input
+ * @type: int
+ *
+ * @return: a cursor over the input
+ * @type: struct LibmatchCursor
+*/
+static struct LibmatchCursor reference_input(const char *data, int size) {
+    FILE *stream = tmpfile();
+    struct LibmatchCursor cursor;
+
+    if(stream == NULL) {
+        fprintf(stderr, "fuzz: could not create a temporary file\n");
+        abort();
+    }
+
+    fwrite(data, 1, size, stream);
+    rewind(stream);
+
+    cursor = libmatch_cursor_from_stream(stream);
+    fclose(stream);
+
+    return cursor;
+}
+
+/*
+ * @docgen: function
+ * @brief: report the first difference between two outputs
+ * @name: report_difference
+ *
+ * @param module: the module that differed
+ * @type: const char *
+ *
+ * @param format: the format the outputs are in
+ * @type: const char *
+ *
+ * @param expected: the output of the reference
+ * @type: const char *
+ *
+ * @param expected_length: the length of the output of the reference
+ * @type: long
+ *
+ * @param actual: the output of the implementation
+ * @type: const char *
+ *
+ * @param actual_length: the length of the output of the implementation
+ * @type: long
+*/
+static void report_difference(const char *module, const char *format,
+                              const char *expected, long expected_length,
+                              const char *actual, long actual_length) {
+    long offset = 0;
+
+    while(offset < expected_length && offset < actual_length &&
+          expected[offset] == actual[offset]) {
+        offset++;
+    }
+
+    fprintf(stderr, "fuzz: %s (%s) differs from the reference at byte %li "
+                    "(reference wrote %li bytes, implementation wrote %li)\n",
+            module, format, offset, expected_length, actual_length);
+}
+
+int csource_fuzz_compare(const char *data, int size) {
+    int index = 0;
+    int failed = 0;
+
+    /* Sources are text, so the scanners are free to treat a NUL byte
+     * as the end of a line or string. */
+    if(memchr(data, '\0', size) != NULL)
+        return 0;
+
+    for(index = 0; modules[index].name != NULL; index++) {
+        int format_index = 0;
+
+        for(format_index = 0; formats[format_index] != -1; format_index++) {
+            long expected_length = 0;
+            long actual_length = 0;
+            long library_length = 0;
+            char *expected = NULL;
+            char *actual = NULL;
+            char *library = NULL;
+            struct LibmatchCursor reference = reference_input(data, size);
+
+            /* Modules only ever read their input, so the implementation
+             * is given the input as it is */
+            expected = run_module(modules[index].reference, reference,
+                                  formats[format_index], &expected_length);
+            actual = run_module(modules[index].implementation,
+                                libmatch_cursor_init((char *) data, size),
+                                formats[format_index], &actual_length);
+            library = run_library(modules[index].name, data, size, formats[format_index],
+                                  &library_length);
+
+            if(expected_length != actual_length ||
+               memcmp(expected, actual, expected_length) != 0) {
+                report_difference(modules[index].name, format_names[format_index],
+                                  expected, expected_length, actual, actual_length);
+                failed = 1;
+            }
+
+            /* The library runs the same modules, just with a context */
+            if(library_length != actual_length ||
+               memcmp(library, actual, actual_length) != 0) {
+                report_difference(modules[index].name, "libcsource", actual, actual_length,
+                                  library, library_length);
+                failed = 1;
+            }
+
+            libmatch_cursor_free(&reference);
+            free(expected);
+            free(actual);
+            free(library);
+        }
+    }
+
+    return failed;
+}
+
+int LLVMFuzzerTestOneInput(const unsigned char *data, size_t size) {
+    if(csource_fuzz_compare((const char *) data, (int) size) != 0)
+        abort();
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * The entry points of the differential fuzzing harness.
+*/
+
+#ifndef CWARE_CSOURCE_FUZZ_H
+#define CWARE_CSOURCE_FUZZ_H
+
+#include <stddef.h>
+
+/*
+ * @docgen: function
+ * @brief: check every module against its reference on an input
+ * @name: csource_fuzz_compare
+ *
+ * @description
+ * @Run every module through its reference model and its implementation
+ * @in every output format, and compare the outputs. Each difference
+ * @is reported to stderr. Inputs containing a NUL byte are skipped.
+ * @description
+ *
+ * @param data: the input to check
+ * @type: const char *
+ *
+ * @param size: the size of the input
+ * @type: int
+ *
+ * @return: 1 if any output differed, 0 otherwise
+ * @type: int
+*/
+int csource_fuzz_compare(const char *data, int size);
+
+/*
+ * @docgen: function
+ * @brief: the libFuzzer entry point
+ * @name: LLVMFuzzerTestOneInput
+ *
+ * @description
+ * @Check an input with csource_fuzz_compare, aborting if any output
+ * @differed so the fuzzer keeps the input.
+ * @description
+ *
+ * @param data: the input to check
+ * @type: const unsigned char *
+ *
+ * @param size: the size of the input
+ * @type: size_t
+ *
+ * @return: always 0
+ * @type: int
+*/
+int LLVMFuzzerTestOneInput(const unsigned char *data, size_t size);
+
+#endif
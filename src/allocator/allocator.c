@@ -0,0 +1,108 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file implements switching the allocator of csource and the
+ * libraries it uses.
+*/
+
+#include <stdlib.h>
+
+#include "../csource.h"
+
+#include "allocator.h"
+
+struct CSourceAllocatorStatistics csource_allocator_statistics;
+
+#if defined(CSOURCE_NO_STATISTICS)
+struct CSourceAllocator csource_allocator = {malloc, realloc, free};
+#else
+
+/* The allocator the counting allocator hands every request to */
+static struct CSourceAllocator counted_allocator = {malloc, realloc, free};
+
+static void *count_allocate(size_t size) {
+    csource_allocator_statistics.allocations++;
+    csource_allocator_statistics.bytes_allocated += (unsigned long) size;
+
+    return counted_allocator.allocate(size);
+}
+
+static void *count_reallocate(void *pointer, size_t size) {
+    csource_allocator_statistics.reallocations++;
+    csource_allocator_statistics.bytes_allocated += (unsigned long) size;
+
+    return counted_allocator.reallocate(pointer, size);
+}
+
+static void count_release(void *pointer) {
+    counted_allocator.release(pointer);
+}
+
+struct CSourceAllocator csource_allocator = {count_allocate, count_reallocate, count_release};
+#endif
+
+void csource_use_allocator(struct CSourceAllocator allocator) {
+    liberror_is_null(csource_use_allocator, allocator.allocate);
+    liberror_is_null(csource_use_allocator, allocator.reallocate);
+    liberror_is_null(csource_use_allocator, allocator.release);
+
+#if defined(CSOURCE_NO_STATISTICS)
+    csource_allocator = allocator;
+#else
+    counted_allocator = allocator;
+#endif
+
+    libmatch_malloc_hook = allocator.allocate;
+    libmatch_realloc_hook = allocator.reallocate;
+    libmatch_free_hook = allocator.release;
+
+    cstring_malloc_hook = allocator.allocate;
+    cstring_realloc_hook = allocator.reallocate;
+    cstring_free_hook = allocator.release;
+
+    /* Only the command line program has paths and arguments to handle */
+#if !defined(CSOURCE_LIBRARY)
+    libpath_malloc_hook = allocator.allocate;
+    libpath_realloc_hook = allocator.reallocate;
+    libpath_free_hook = allocator.release;
+
+    argparse_malloc_hook = allocator.allocate;
+    argparse_realloc_hook = allocator.reallocate;
+    argparse_free_hook = allocator.release;
+#endif
+}
@@ -0,0 +1,124 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * The allocator used throughout csource. Every vendored library keeps
+ * its own allocator hooks, so this ties them together to make swapping
+ * the allocator a single call.
+*/
+
+#ifndef CWARE_CSOURCE_ALLOCATOR_H
+#define CWARE_CSOURCE_ALLOCATOR_H
+
+#include <stddef.h>
+
+/*
+ * @docgen: structure
+ * @brief: the functions used to allocate and release memory
+ * @name: CSourceAllocator
+ *
+ * @field allocate: allocate a block of memory, like malloc
+ * @type: void *(*)(size_t)
+ *
+ * @field reallocate: resize a block of memory, like realloc
+ * @type: void *(*)(void *, size_t)
+ *
+ * @field release: release a block of memory, like free
+ * @type: void (*)(void *)
+*/
+struct CSourceAllocator {
+    void *(*allocate)(size_t size);
+    void *(*reallocate)(void *pointer, size_t size);
+    void (*release)(void *pointer);
+};
+
+/*
+ * @docgen: structure
+ * @brief: counters of the memory allocated through csource_allocator
+ * @name: CSourceAllocatorStatistics
+ *
+ * @field allocations: the number of allocations
+ * @type: unsigned long
+ *
+ * @field reallocations: the number of reallocations
+ * @type: unsigned long
+ *
+ * @field bytes_allocated: the number of bytes requested
+ * @type: unsigned long
+*/
+struct CSourceAllocatorStatistics {
+    unsigned long allocations;
+    unsigned long reallocations;
+    unsigned long bytes_allocated;
+};
+
+/* The allocator in use by csource itself. This is the standard
+ * allocator until csource_use_allocator is called. Unless
+ * CSOURCE_NO_STATISTICS is defined, it counts every request into
+ * csource_allocator_statistics before passing it on. */
+extern struct CSourceAllocator csource_allocator;
+
+extern struct CSourceAllocatorStatistics csource_allocator_statistics;
+
+/*
+ * @docgen: function
+ * @brief: use an allocator for csource and every library it uses
+ * @name: csource_use_allocator
+ *
+ * @description
+ * @Make csource, libmatch, cstring, carray, libpath and argparse all
+ * @allocate through the same allocator. Memory allocated by one of
+ * @them is sometimes released by another, so they must always share
+ * @one allocator.
+ * @description
+ *
+ * @notes
+ * @This must be called before anything has been allocated, since
+ * @memory from the previous allocator would otherwise be released
+ * @into the new one.
+ * @notes
+ *
+ * @error: allocator.allocate is NULL
+ * @error: allocator.reallocate is NULL
+ * @error: allocator.release is NULL
+ *
+ * @param allocator: the allocator to use
+ * @type: struct CSourceAllocator
+*/
+void csource_use_allocator(struct CSourceAllocator allocator);
+
+#endif
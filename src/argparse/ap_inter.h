@@ -77,6 +77,11 @@
 #define OPTION_TYPE_REGULAR 0
 #define OPTION_TYPE_REPEAT 1
 
+/* Route the allocations of carray through the argparse allocator */
+#define CARRAY_MALLOC(size)             argparse_malloc_hook((size))
+#define CARRAY_REALLOC(pointer, size)   argparse_realloc_hook((pointer), (size))
+#define CARRAY_FREE(pointer)            argparse_free_hook((pointer))
+
 /* Internal libraries-- change if resolving duplicate dependencies */
 #include "carray/carray.h"
 #include "liberror/liberror.h"
@@ -46,6 +46,10 @@
 #include "argparse.h"
 #include "ap_inter.h"
 
+void *(*argparse_malloc_hook)(size_t size) = malloc;
+void *(*argparse_realloc_hook)(void *pointer, size_t size) = realloc;
+void (*argparse_free_hook)(void *pointer) = free;
+
 #define error_if_same_option(option, name, func)                             \
 do {                                                                         \
     if((option) == NULL)                                                     \
@@ -76,6 +76,15 @@
 
 #define CWARE_ARGPARSE_VERSION  "1.0.1"
 
+#include <stddef.h>
+
+/* The allocator used by argparse for everything it allocates. These point at
+ * the standard allocator by default, and should only be replaced before
+ * argparse has allocated anything. */
+extern void *(*argparse_malloc_hook)(size_t size);
+extern void *(*argparse_realloc_hook)(void *pointer, size_t size);
+extern void (*argparse_free_hook)(void *pointer);
+
 /* Possibilities for variable option parameters */
 #define ARGPARSE_FLAG           0
 #define ARGPARSE_NOT_FOUND      -1
@@ -121,9 +130,9 @@
  * @param index: the index variable
 */
 #define argparse_repeatable_option_iter(parser, option, index)         \
-    for(index = argparse_repeatable_option_start(parser, "-i");        \
+    for(index = argparse_repeatable_option_start(parser, option);      \
         index != ARGPARSE_NOT_FOUND;                                   \
-        index = argparse_repeatable_option_next(parser, "-i", index))
+        index = argparse_repeatable_option_next(parser, option, index))
 
 /* Utility macros */
 #define argparse_get_index(parser, index) \
@@ -74,12 +74,13 @@ char *argparse_get_argument(struct ArgparseParser parser, const char *argument)
         /* Skip past this option! (We can assume that the number of
          * indices skipped is correct because error checking should have
          * been done before hand. */
-        if(argparse_is_option(parser, argument) == 1) {
-            int parameters = argparse_option_parser_parameters(parser, argument);
+        if(argparse_is_option(parser, parser.argv[argv_index]) == 1) {
+            const char *option = parser.argv[argv_index];
+            int parameters = argparse_option_parser_parameters(parser, option);
 
             /* Skip past a variable number */
             if(parameters == ARGPARSE_VARIABLE || parameters == ARGPARSE_VARIABLE_ONE) {
-                argv_index += argparse_option_argv_parameters(parser, argument);
+                argv_index += argparse_option_argv_parameters(parser, option);
 
                 continue;
             }
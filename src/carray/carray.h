@@ -55,27 +55,70 @@
     ((size) + 5)
 #endif
 
+/* The allocator used for arrays and their contents. These can be
+ * defined to route carray through another allocator. */
+#ifndef CARRAY_MALLOC
+#define CARRAY_MALLOC(size) \
+    malloc((size))
+#endif
+
+#ifndef CARRAY_REALLOC
+#define CARRAY_REALLOC(pointer, size) \
+    realloc((pointer), (size))
+#endif
+
+#ifndef CARRAY_FREE
+#define CARRAY_FREE(pointer) \
+    free((pointer))
+#endif
+
 #ifndef CARRAY_COUNTER_TYPE 
 #define CARRAY_COUNTER_TYPE int
 #endif
 
+/* Instrumentation. carray does not keep any counters itself, but
+ * CARRAY_COUNT can be defined to count allocations into a structure
+ * like CArrayStatistics. By default, nothing is counted. */
+#ifndef CARRAY_COUNT
+#define CARRAY_COUNT(counter, amount)
+#endif
+
+struct CArrayStatistics {
+    unsigned long allocations;
+    unsigned long reallocations;
+    unsigned long bytes_allocated;
+};
+
+/* What is done with an error. By default it is printed and the process
+ * is aborted, but these can be defined to handle errors another way. */
+#ifndef CARRAY_REPORT
+#define CARRAY_REPORT(arguments) \
+    fprintf arguments
+#endif
+
+#ifndef CARRAY_ABORT
+#define CARRAY_ABORT() \
+    abort()
+#endif
+
 /* Error handlers */
 #define __carray_assert_natural(macro_name, argument, value)          \
 do {                                                                  \
     if((value) <= 0) {                                                \
-        fprintf(stderr, "%s: %s cannot be less than or equal to zero" \
-                        "(%s:%i)\n", macro_name, argument, __FILE__,  \
-                        __LINE__);                                    \
-        abort();                                                      \
+        CARRAY_REPORT((stderr, "%s: %s cannot be less than or equal " \
+                               "to zero(%s:%i)\n", macro_name,        \
+                               argument, __FILE__, __LINE__));        \
+        CARRAY_ABORT();                                               \
     }                                                                 \
 } while(0)
 
 #define __carray_assert_nonnull(macro_name, argument, value)           \
 do {                                                                   \
     if((value) == NULL) {                                              \
-        fprintf(stderr, "%s: %s cannot be NULL (%s:%i)\n", macro_name, \
-                        argument, __FILE__, __LINE__);                 \
-        abort();                                                       \
+        CARRAY_REPORT((stderr, "%s: %s cannot be NULL (%s:%i)\n",      \
+                               macro_name, argument, __FILE__,         \
+                               __LINE__));                             \
+        CARRAY_ABORT();                                                \
     }                                                                  \
 } while(0)
 
@@ -84,11 +127,15 @@ do {                                                                   \
 #define carray_init(array, namespace)                          \
     (array);                                                   \
                                                                \
-    (array) = malloc(sizeof(*(array)));                        \
+    (array) = CARRAY_MALLOC(sizeof(*(array)));                 \
     (array)->length = 0;                                       \
     (array)->capacity = CARRAY_INITIAL_SIZE;                   \
-    (array)->contents = malloc(CARRAY_INITIAL_SIZE             \
+    (array)->contents = CARRAY_MALLOC(CARRAY_INITIAL_SIZE      \
                                 * sizeof(namespace ## _TYPE)); \
+    CARRAY_COUNT(allocations, 2);                              \
+    CARRAY_COUNT(bytes_allocated, sizeof(*(array)) +           \
+                 CARRAY_INITIAL_SIZE                           \
+                 * sizeof(namespace ## _TYPE));                \
     memset((array)->contents, 0, CARRAY_INITIAL_SIZE *         \
                                  sizeof(namespace ## _TYPE))
 
@@ -112,22 +159,25 @@ do {                                                                   \
         if(namespace ## _HEAP == 1) {                                         \
             (array)->capacity = (CARRAY_COUNTER_TYPE)                         \
                                 CARRAY_RESIZE((array)->capacity);             \
-            (array)->contents = realloc((array)->contents,                    \
+            (array)->contents = CARRAY_REALLOC((array)->contents,             \
                                         sizeof(*(array)->contents)            \
                                         * (size_t) (array)->capacity);        \
+            CARRAY_COUNT(reallocations, 1);                                   \
+            CARRAY_COUNT(bytes_allocated, sizeof(*(array)->contents)          \
+                                          * (size_t) (array)->capacity);      \
         } else {                                                              \
-            fprintf(stderr, "carray_insert: attempt to insert value '%s' "    \
-                            "into full array (%s:%i)\n", #value, __FILE__,    \
-                                                                 __LINE__);   \
-            abort();                                                          \
+            CARRAY_REPORT((stderr, "carray_insert: attempt to insert "        \
+                                   "value '%s' into full array (%s:%i)\n",    \
+                                   #value, __FILE__, __LINE__));              \
+            CARRAY_ABORT();                                                   \
         }                                                                     \
     }                                                                         \
                                                                               \
     if(index < 0 || index > (array)->length) {                                \
-        fprintf(stderr, "carray_insert: attempt to insert at index %i, out "  \
-                        "of bounds of array (%s:%i)\n", index, __FILE__,      \
-                                                               __LINE__);     \
-        abort();                                                              \
+        CARRAY_REPORT((stderr, "carray_insert: attempt to insert at index "   \
+                               "%i, out of bounds of array (%s:%i)\n",        \
+                               index, __FILE__, __LINE__));                   \
+        CARRAY_ABORT();                                                       \
     }                                                                         \
                                                                               \
     memmove((array)->contents + index + 1,                                    \
@@ -144,9 +194,10 @@ do {                                                                   \
                                             (array)->contents);               \
                                                                               \
     if(index < 0 || index >= (array)->length) {                               \
-        fprintf(stderr, "carray_pop: attempt to pop index %i, out of bounds " \
-                        "of array (%s:%i)\n", index, __FILE__, __LINE__);     \
-        abort();                                                              \
+        CARRAY_REPORT((stderr, "carray_pop: attempt to pop index %i, out "    \
+                               "of bounds of array (%s:%i)\n", index,         \
+                               __FILE__, __LINE__));                          \
+        CARRAY_ABORT();                                                       \
     }                                                                         \
                                                                               \
     (array)->length--;                                                        \
@@ -182,10 +233,10 @@ do {                                                                          \
     }                                                                         \
                                                                               \
     if(__CARRAY_ITER_INDEX != -1) {                                           \
-        fprintf(stderr, "carray_remove: attempt to remove value '%s' that is" \
-                        " not in array. (%s:%i)\n", #value, __FILE__,         \
-                        __LINE__);                                            \
-        abort();                                                              \
+        CARRAY_REPORT((stderr, "carray_remove: attempt to remove value '%s' " \
+                               "that is not in array. (%s:%i)\n", #value,     \
+                               __FILE__, __LINE__));                          \
+        CARRAY_ABORT();                                                       \
     }                                                                         \
 } while(0)
 
@@ -227,8 +278,8 @@ do {                                                                          \
     }                                                                         \
                                                                               \
     if(namespace ## _HEAP == 1) {                                             \
-        free((array)->contents);                                              \
-        free((array));                                                        \
+        CARRAY_FREE((array)->contents);                                       \
+        CARRAY_FREE((array));                                                 \
     }                                                                         \
 } while(0)
 
@@ -239,14 +290,17 @@ do {                                                                          \
     if((array)->length == (array)->capacity) {                                \
         if(namespace ## _HEAP == 1) {                                         \
             (array)->capacity = CARRAY_RESIZE((array)->capacity);             \
-            (array)->contents = realloc((array)->contents,                    \
+            (array)->contents = CARRAY_REALLOC((array)->contents,             \
                                         sizeof(*(array)->contents)            \
                                         * (size_t) (array)->capacity);        \
+            CARRAY_COUNT(reallocations, 1);                                   \
+            CARRAY_COUNT(bytes_allocated, sizeof(*(array)->contents)          \
+                                          * (size_t) (array)->capacity);      \
         } else {                                                              \
-            fprintf(stderr, "carray_append: array is full. maximum capacity " \
-                            "of %i (%s:%i)\n", (array)->capacity,             \
-                            __FILE__, __LINE__);                              \
-            abort();                                                          \
+            CARRAY_REPORT((stderr, "carray_append: array is full. maximum "   \
+                                   "capacity of %i (%s:%i)\n",                \
+                                   (array)->capacity, __FILE__, __LINE__));   \
+            CARRAY_ABORT();                                                   \
         }                                                                     \
     }                                                                         \
                                                                               \
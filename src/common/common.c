@@ -0,0 +1,116 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file has the helpers that modules which have nothing else to do
+ * with each other share, like telling identifiers apart, hashing names,
+ * and reading and writing the integers of indexes and binary records.
+*/
+
+#include <stdio.h>
+
+#include "../csource.h"
+
+#include "common.h"
+
+int csource_is_identifier(const char *name) {
+    liberror_is_null(csource_is_identifier, name);
+
+    if(csource_is_identifier_start(*name) == 0)
+        return 0;
+
+    for(name++; *name != '\0'; name++) {
+        if(csource_is_identifier_character(*name) == 0)
+            return 0;
+    }
+
+    return 1;
+}
+
+unsigned long csource_hash_name(const char *name, int length) {
+    int index = 0;
+    unsigned long hash = 2166136261UL;
+
+    for(index = 0; index < length; index++) {
+        hash ^= (unsigned char) name[index];
+        hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+    }
+
+    return hash;
+}
+
+unsigned long csource_read_unsigned(const char *bytes, int size) {
+    unsigned long value = 0;
+
+    while(size-- > 0)
+        value = (value << 8) | (unsigned char) bytes[size];
+
+    return value;
+}
+
+void csource_encode_unsigned(char *bytes, unsigned long value, int size) {
+    int index = 0;
+
+    for(index = 0; index < size; index++) {
+        bytes[index] = (char) (value & 0xFF);
+
+        /* Shifting by the width of the type is undefined */
+        value = (value >> 4) >> 4;
+    }
+}
+
+void csource_write_unsigned(FILE *stream, unsigned long value, int size) {
+    char bytes[8];
+
+    csource_encode_unsigned(bytes, value, size);
+    fwrite(bytes, 1, size, stream);
+}
+
+int csource_read_number(FILE *stream, unsigned long *value) {
+    char bytes[4];
+    size_t length = fread(bytes, 1, sizeof(bytes), stream);
+
+    if(length == 0 && feof(stream) != 0)
+        return 1;
+
+    if(length != sizeof(bytes))
+        return -1;
+
+    *value = csource_read_unsigned(bytes, 4);
+
+    return 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_CSOURCE_COMMON_H
+#define CWARE_CSOURCE_COMMON_H
+
+#include <stdio.h>
+
+/* Whether a character can start an identifier, or be part of one. Only
+ * the characters of the basic character set are taken. */
+#define csource_is_identifier_start(character)                          \
+    (((character) >= 'a' && (character) <= 'z') ||                      \
+     ((character) >= 'A' && (character) <= 'Z') || (character) == '_')
+
+#define csource_is_identifier_character(character) \
+    (csource_is_identifier_start(character) || ((character) >= '0' && (character) <= '9'))
+
+/*
+ * @docgen: function
+ * @brief: determine whether a string is an identifier
+ * @name: csource_is_identifier
+ *
+ * @error: name is NULL
+ *
+ * @param name: the string to check
+ * @type: const char *
+ *
+ * @return: 1 if the string is an identifier, 0 if it is not
+ * @type: int
+*/
+int csource_is_identifier(const char *name);
+
+/*
+ * @docgen: function
+ * @brief: hash a name for a table of names
+ * @name: csource_hash_name
+ *
+ * @description
+ * @Hash a name with 32 bit FNV-1a, which is the same wherever it is
+ * @computed, so the hashes can be kept in files.
+ * @description
+ *
+ * @param name: the name
+ * @type: const char *
+ *
+ * @param length: the length of the name
+ * @type: int
+ *
+ * @return: the hash, which is below 2^32
+ * @type: unsigned long
+*/
+unsigned long csource_hash_name(const char *name, int length);
+
+/*
+ * @docgen: function
+ * @brief: read a little endian unsigned integer
+ * @name: csource_read_unsigned
+ *
+ * @description
+ * @Read an unsigned integer stored least significant byte first. Bytes
+ * @past the width of an unsigned long are dropped, which only happens
+ * @for values that were never wider than it.
+ * @description
+ *
+ * @param bytes: the bytes of the integer
+ * @type: const char *
+ *
+ * @param size: the number of bytes
+ * @type: int
+ *
+ * @return: the integer
+ * @type: unsigned long
+*/
+unsigned long csource_read_unsigned(const char *bytes, int size);
+
+/*
+ * @docgen: function
+ * @brief: turn an unsigned integer into little endian bytes
+ * @name: csource_encode_unsigned
+ *
+ * @description
+ * @Turn the low bytes of a value into bytes, least significant first. If
+ * @the value is narrower than the number of bytes, the rest are zeroes.
+ * @description
+ *
+ * @param bytes: where to put the bytes
+ * @type: char *
+ *
+ * @param value: the integer
+ * @type: unsigned long
+ *
+ * @param size: the number of bytes
+ * @type: int
+*/
+void csource_encode_unsigned(char *bytes, unsigned long value, int size);
+
+/*
+ * @docgen: function
+ * @brief: write a little endian unsigned integer to a stream
+ * @name: csource_write_unsigned
+ *
+ * @param stream: the stream to write to
+ * @type: FILE *
+ *
+ * @param value: the integer
+ * @type: unsigned long
+ *
+ * @param size: the number of bytes, which is 8 at most
+ * @type: int
+*/
+void csource_write_unsigned(FILE *stream, unsigned long value, int size);
+
+/*
+ * @docgen: function
+ * @brief: read a 32 bit little endian unsigned integer from a stream
+ * @name: csource_read_number
+ *
+ * @param stream: the stream to read from
+ * @type: FILE *
+ *
+ * @param value: where to put the integer
+ * @type: unsigned long *
+ *
+ * @return: 0 if it was read, 1 at the end of the stream, or -1 if cut short
+ * @type: int
+*/
+int csource_read_number(FILE *stream, unsigned long *value);
+
+#endif
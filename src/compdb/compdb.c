@@ -0,0 +1,1141 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file reads compilation databases, which are laid out in compdb.h.
+ * The JSON is read a block at a time from the stream, and only the
+ * keys of an entry csource needs are kept, until the entry ends and its
+ * unit is made. Everything else is read past without being kept.
+*/
+
+/* The working directory is POSIX, not ANSI */
+#if defined(__unix__) || defined(__CW_UNIXWARE__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200112L
+#define CSOURCE_COMPDB_POSIX
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(CSOURCE_COMPDB_POSIX)
+#include <unistd.h>
+#endif
+
+#include "../csource.h"
+
+#include "compdb.h"
+
+/* How much of the database is read from the stream at once */
+#define COMPDB_BUFFER   65536
+
+#define is_blank(character) \
+    ((character) == ' ' || (character) == '\t' || (character) == '\n' || (character) == '\r')
+
+/*
+ * @docgen: structure
+ * @brief: text that is being put together, which can hold any byte
+ * @name: CompdbText
+ *
+ * @field contents: the text
+ * @type: char *
+ *
+ * @field length: the length of the text
+ * @type: int
+ *
+ * @field capacity: the number of bytes there is room for
+ * @type: int
+*/
+struct CompdbText {
+    char *contents;
+    int length;
+    int capacity;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the keys of an entry of a database that are kept
+ * @name: CompdbEntry
+ *
+ * @field key: the key that is being read
+ * @type: struct CompdbText
+ *
+ * @field directory: the directory the command is run in
+ * @type: struct CompdbText
+ *
+ * @field file: the file that is compiled
+ * @type: struct CompdbText
+ *
+ * @field command: the command, as one string
+ * @type: struct CompdbText
+ *
+ * @field arguments: the arguments of the command, each ending with a NUL
+ * @type: struct CompdbText
+ *
+ * @field listed: whether the entry had a list of arguments
+ * @type: int
+*/
+struct CompdbEntry {
+    struct CompdbText key;
+    struct CompdbText directory;
+    struct CompdbText file;
+    struct CompdbText command;
+    struct CompdbText arguments;
+    int listed;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the state of reading a database
+ * @name: CompdbReader
+ *
+ * @field stream: the stream the database is read from
+ * @type: FILE *
+ *
+ * @field line: the line the reader is on
+ * @type: int
+ *
+ * @field cursor: the index of the next character in the buffer
+ * @type: int
+ *
+ * @field length: the number of characters in the buffer
+ * @type: int
+ *
+ * @field buffer: what was last read from the stream
+ * @type: char *
+*/
+struct CompdbReader {
+    FILE *stream;
+    int line;
+    int cursor;
+    int length;
+    char *buffer;
+};
+
+/*
+ * @docgen: function
+ * @brief: add bytes to text
+ * @name: add_text
+ *
+ * @param text: the text to add to
+ * @type: struct CompdbText *
+ *
+ * @param bytes: the bytes to add
+ * @type: const char *
+ *
+ * @param length: the number of bytes
+ * @type: int
+*/
+static void add_text(struct CompdbText *text, const char *bytes, int length) {
+    if(text->length + length > text->capacity) {
+        while(text->length + length > text->capacity)
+            text->capacity = text->capacity * 2 + 256;
+
+        text->contents = csource_allocator.reallocate(text->contents, text->capacity);
+    }
+
+    memcpy(text->contents + text->length, bytes, length);
+    text->length += length;
+}
+
+/*
+ * @docgen: function
+ * @brief: add a byte to text
+ * @name: add_byte
+ *
+ * @param text: the text to add to, or NULL to leave the byte out
+ * @type: struct CompdbText *
+ *
+ * @param byte: the byte to add
+ * @type: int
+*/
+static void add_byte(struct CompdbText *text, int byte) {
+    char character = (char) byte;
+
+    if(text != NULL)
+        add_text(text, &character, 1);
+}
+
+/*
+ * @docgen: function
+ * @brief: release text
+ * @name: free_text
+ *
+ * @param text: the text to release
+ * @type: struct CompdbText *
+*/
+static void free_text(struct CompdbText *text) {
+    if(text->contents != NULL)
+        csource_allocator.release(text->contents);
+}
+
+/*
+ * @docgen: function
+ * @brief: read the next character of a database
+ * @name: next_character
+ *
+ * @param reader: the reader of the database
+ * @type: struct CompdbReader *
+ *
+ * @return: the character, or EOF
+ * @type: int
+*/
+static int next_character(struct CompdbReader *reader) {
+    int character = 0;
+
+    if(reader->cursor == reader->length) {
+        reader->length = fread(reader->buffer, 1, COMPDB_BUFFER, reader->stream);
+        reader->cursor = 0;
+
+        if(reader->length == 0)
+            return EOF;
+    }
+
+    character = (unsigned char) reader->buffer[reader->cursor++];
+
+    if(character == '\n')
+        reader->line++;
+
+    return character;
+}
+
+/*
+ * @docgen: function
+ * @brief: read the next character of a database that is not a blank
+ * @name: next_token
+ *
+ * @param reader: the reader of the database
+ * @type: struct CompdbReader *
+ *
+ * @return: the character, or EOF
+ * @type: int
+*/
+static int next_token(struct CompdbReader *reader) {
+    int character = next_character(reader);
+
+    while(is_blank(character))
+        character = next_character(reader);
+
+    return character;
+}
+
+/*
+ * @docgen: function
+ * @brief: read the four hexadecimal digits of a \u escape
+ * @name: read_hex
+ *
+ * @param reader: the reader of the database
+ * @type: struct CompdbReader *
+ *
+ * @return: the value of the digits, or -1 if they are not digits
+ * @type: long
+*/
+static long read_hex(struct CompdbReader *reader) {
+    int index = 0;
+    long value = 0;
+
+    for(index = 0; index < 4; index++) {
+        int character = next_character(reader);
+
+        value *= 16;
+
+        if(character >= '0' && character <= '9')
+            value += character - '0';
+        else if(character >= 'a' && character <= 'f')
+            value += character - 'a' + 10;
+        else if(character >= 'A' && character <= 'F')
+            value += character - 'A' + 10;
+        else
+            return -1;
+    }
+
+    return value;
+}
+
+/*
+ * @docgen: function
+ * @brief: add a code point to text as UTF-8
+ * @name: add_code_point
+ *
+ * @param text: the text to add to, or NULL to leave it out
+ * @type: struct CompdbText *
+ *
+ * @param code: the code point, which is never 0
+ * @type: long
+*/
+static void add_code_point(struct CompdbText *text, long code) {
+    if(code < 0x80) {
+        add_byte(text, (int) code);
+    } else if(code < 0x800) {
+        add_byte(text, (int) (0xC0 | (code >> 6)));
+        add_byte(text, (int) (0x80 | (code & 0x3F)));
+    } else if(code < 0x10000) {
+        add_byte(text, (int) (0xE0 | (code >> 12)));
+        add_byte(text, (int) (0x80 | ((code >> 6) & 0x3F)));
+        add_byte(text, (int) (0x80 | (code & 0x3F)));
+    } else {
+        add_byte(text, (int) (0xF0 | (code >> 18)));
+        add_byte(text, (int) (0x80 | ((code >> 12) & 0x3F)));
+        add_byte(text, (int) (0x80 | ((code >> 6) & 0x3F)));
+        add_byte(text, (int) (0x80 | (code & 0x3F)));
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: read a string of a database
+ * @name: read_string
+ *
+ * @description
+ * @Read a string, just past its opening quote, and add what it is to text
+ * @with its escapes taken out. A \u escape of a surrogate pair is one code
+ * @point, and a \u0000 is left out, since the flags of a unit end with
+ * @NULs.
+ * @description
+ *
+ * @param reader: the reader of the database
+ * @type: struct CompdbReader *
+ *
+ * @param text: the text to add the string to, or NULL to read past it
+ * @type: struct CompdbText *
+ *
+ * @return: 0 if the string was read, or -1 if it is malformed
+ * @type: int
+*/
+static int read_string(struct CompdbReader *reader, struct CompdbText *text) {
+    while(1) {
+        long code = 0;
+        int character = 0;
+        int start = reader->cursor;
+
+        /* Most of a string is nothing but characters, which are added at once */
+        while(reader->cursor < reader->length) {
+            character = reader->buffer[reader->cursor];
+
+            if(character == '"' || character == '\\' || character == '\n')
+                break;
+
+            reader->cursor++;
+        }
+
+        if(text != NULL && reader->cursor > start)
+            add_text(text, reader->buffer + start, reader->cursor - start);
+
+        character = next_character(reader);
+
+        if(character == EOF || character == '\n')
+            return -1;
+
+        if(character == '"')
+            return 0;
+
+        if(character != '\\') {
+            add_byte(text, character);
+
+            continue;
+        }
+
+        switch((character = next_character(reader))) {
+            case '"': case '\\': case '/':
+                add_byte(text, character);
+                break;
+
+            case 'b':
+                add_byte(text, '\b');
+                break;
+
+            case 'f':
+                add_byte(text, '\f');
+                break;
+
+            case 'n':
+                add_byte(text, '\n');
+                break;
+
+            case 'r':
+                add_byte(text, '\r');
+                break;
+
+            case 't':
+                add_byte(text, '\t');
+                break;
+
+            case 'u':
+                if((code = read_hex(reader)) == -1)
+                    return -1;
+
+                /* The second half of a surrogate pair is its own escape */
+                if(code >= 0xD800 && code <= 0xDBFF) {
+                    long low = 0;
+
+                    if(next_character(reader) != '\\' || next_character(reader) != 'u' ||
+                       (low = read_hex(reader)) < 0xDC00 || low > 0xDFFF)
+                        return -1;
+
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+
+                if(code != 0)
+                    add_code_point(text, code);
+
+                break;
+
+            default:
+                return -1;
+        }
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: read past a value of a database
+ * @name: skip_value
+ *
+ * @description
+ * @Read past a value that is not needed, whose first character was just
+ * @read. Objects and arrays are read past by counting how deep in them
+ * @the reader is, rather than by reading what is in them.
+ * @description
+ *
+ * @param reader: the reader of the database
+ * @type: struct CompdbReader *
+ *
+ * @param character: the first character of the value
+ * @type: int
+ *
+ * @return: 0 if the value was read past, or -1 if it is malformed
+ * @type: int
+*/
+static int skip_value(struct CompdbReader *reader, int character) {
+    long depth = 0;
+
+    if(character == '"')
+        return read_string(reader, NULL);
+
+    /* Numbers, true, false and null end where the next token starts */
+    if(character != '{' && character != '[') {
+        while(character != EOF && character != ',' && character != '}' && character != ']' &&
+              is_blank(character) == 0)
+            character = next_character(reader);
+
+        if(character == EOF)
+            return -1;
+
+        /* The character is still in the buffer, since it was just read */
+        if(is_blank(character) == 0)
+            reader->cursor--;
+
+        return 0;
+    }
+
+    for(depth = 1; depth > 0; ) {
+        character = next_character(reader);
+
+        if(character == EOF)
+            return -1;
+
+        if(character == '{' || character == '[')
+            depth++;
+        else if(character == '}' || character == ']')
+            depth--;
+        else if(character == '"' && read_string(reader, NULL) == -1)
+            return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: read the arguments of an entry
+ * @name: read_arguments
+ *
+ * @param reader: the reader of the database, just past the [
+ * @type: struct CompdbReader *
+ *
+ * @param arguments: the text to add each argument to, ending with a NUL
+ * @type: struct CompdbText *
+ *
+ * @return: 0 if the arguments were read, or -1 if they are malformed
+ * @type: int
+*/
+static int read_arguments(struct CompdbReader *reader, struct CompdbText *arguments) {
+    int character = next_token(reader);
+
+    if(character == ']')
+        return 0;
+
+    while(1) {
+        if(character != '"' || read_string(reader, arguments) == -1)
+            return -1;
+
+        add_byte(arguments, '\0');
+
+        if((character = next_token(reader)) == ']')
+            return 0;
+
+        if(character != ',')
+            return -1;
+
+        character = next_token(reader);
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: read a string that is the value of a key
+ * @name: read_value
+ *
+ * @param reader: the reader of the database, just past the :
+ * @type: struct CompdbReader *
+ *
+ * @param text: the text to keep the string in
+ * @type: struct CompdbText *
+ *
+ * @return: 0 if the string was read, or -1 if it is malformed
+ * @type: int
+*/
+static int read_value(struct CompdbReader *reader, struct CompdbText *text) {
+    text->length = 0;
+
+    if(next_token(reader) != '"')
+        return -1;
+
+    return read_string(reader, text);
+}
+
+/*
+ * @docgen: function
+ * @brief: read an entry of a database
+ * @name: read_entry
+ *
+ * @param reader: the reader of the database, just past the {
+ * @type: struct CompdbReader *
+ *
+ * @param entry: the entry to keep the keys in
+ * @type: struct CompdbEntry *
+ *
+ * @return: 0 if the entry was read, or -1 if it is malformed
+ * @type: int
+*/
+static int read_entry(struct CompdbReader *reader, struct CompdbEntry *entry) {
+    int status = 0;
+    int character = next_token(reader);
+
+    entry->directory.length = 0;
+    entry->file.length = 0;
+    entry->command.length = 0;
+    entry->arguments.length = 0;
+    entry->listed = 0;
+
+    if(character == '}')
+        return 0;
+
+    while(1) {
+        entry->key.length = 0;
+
+        if(character != '"' || read_string(reader, &entry->key) == -1)
+            return -1;
+
+        if(next_token(reader) != ':')
+            return -1;
+
+        add_byte(&entry->key, '\0');
+
+        if(strcmp(entry->key.contents, "directory") == 0) {
+            status = read_value(reader, &entry->directory);
+        } else if(strcmp(entry->key.contents, "file") == 0) {
+            status = read_value(reader, &entry->file);
+        } else if(strcmp(entry->key.contents, "command") == 0) {
+            status = read_value(reader, &entry->command);
+        } else if(strcmp(entry->key.contents, "arguments") == 0) {
+            entry->listed = 1;
+            entry->arguments.length = 0;
+            status = next_token(reader) == '[' ? read_arguments(reader, &entry->arguments) : -1;
+        } else {
+            status = skip_value(reader, next_token(reader));
+        }
+
+        if(status == -1)
+            return -1;
+
+        if((character = next_token(reader)) == '}')
+            return 0;
+
+        if(character != ',')
+            return -1;
+
+        character = next_token(reader);
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: split a command into its arguments
+ * @name: split_command
+ *
+ * @description
+ * @Split a command the way a shell would, at blanks outside of quotes.
+ * @Nothing is special in single quotes, and in double quotes only a
+ * @backslash before a double quote, a backslash, a $ or a ` is. Outside of
+ * @quotes, a backslash makes whatever comes after it part of the argument.
+ * @description
+ *
+ * @param command: the command
+ * @type: const struct CompdbText *
+ *
+ * @param arguments: the text to add each argument to, ending with a NUL
+ * @type: struct CompdbText *
+*/
+static void split_command(const struct CompdbText *command, struct CompdbText *arguments) {
+    int index = 0;
+    int started = 0;
+    int quote = 0;
+
+    for(index = 0; index < command->length; index++) {
+        int character = command->contents[index];
+
+        if(quote == 0 && is_blank(character)) {
+            if(started == 1)
+                add_byte(arguments, '\0');
+
+            started = 0;
+
+            continue;
+        }
+
+        started = 1;
+
+        if(quote == 0 && (character == '\'' || character == '"')) {
+            quote = character;
+        } else if(quote != 0 && character == quote) {
+            quote = 0;
+        } else if(character == '\\' && quote != '\'' && index + 1 < command->length &&
+                  (quote == 0 || strchr("\"\\$`", command->contents[index + 1]) != NULL)) {
+            add_byte(arguments, command->contents[++index]);
+        } else {
+            add_byte(arguments, character);
+        }
+    }
+
+    if(started == 1)
+        add_byte(arguments, '\0');
+}
+
+/*
+ * @docgen: function
+ * @brief: take . and .. out of an absolute path
+ * @name: normalize_path
+ *
+ * @description
+ * @Take the . and .. components and doubled slashes out of a path, in
+ * @place, by its text alone. A .. at the root stays at the root. A path
+ * @that is not absolute is left as it is.
+ * @description
+ *
+ * @param path: the path
+ * @type: char *
+*/
+static void normalize_path(char *path) {
+    int read = 0;
+    int write = 0;
+
+    if(path[0] != '/')
+        return;
+
+    while(path[read] != '\0') {
+        int length = 0;
+
+        while(path[read] == '/')
+            read++;
+
+        while(path[read + length] != '/' && path[read + length] != '\0')
+            length++;
+
+        if(length == 0 || (length == 1 && path[read] == '.')) {
+            read += length;
+
+            continue;
+        }
+
+        /* A .. takes the last component back out */
+        if(length == 2 && path[read] == '.' && path[read + 1] == '.') {
+            while(write > 0 && path[write - 1] != '/')
+                write--;
+
+            if(write > 0)
+                write--;
+
+            read += length;
+
+            continue;
+        }
+
+        path[write++] = '/';
+        memmove(path + write, path + read, length);
+        write += length;
+        read += length;
+    }
+
+    if(write == 0)
+        path[write++] = '/';
+
+    path[write] = '\0';
+}
+
+/*
+ * @docgen: function
+ * @brief: make a path absolute
+ * @name: absolute_path
+ *
+ * @description
+ * @Join a path to a directory, unless it is absolute already, and join
+ * @the working directory to what that gives if it is still relative. The
+ * @working directory is only known where there is POSIX; elsewhere such a
+ * @path stays relative.
+ * @description
+ *
+ * @param directory: the directory the path is relative to, or NULL
+ * @type: const char *
+ *
+ * @param path: the path
+ * @type: const char *
+ *
+ * @return: the absolute path, which is allocated
+ * @type: char *
+*/
+static char *absolute_path(const char *directory, const char *path) {
+    struct CompdbText text;
+
+    INIT_VARIABLE(text);
+
+    if(path[0] != '/' && directory != NULL && directory[0] != '\0') {
+        add_text(&text, directory, strlen(directory));
+        add_byte(&text, '/');
+    }
+
+#if defined(CSOURCE_COMPDB_POSIX)
+    if(path[0] != '/' && (text.length == 0 || text.contents[0] != '/')) {
+        char working[4096 + 1];
+
+        if(getcwd(working, sizeof(working)) != NULL) {
+            struct CompdbText joined;
+
+            INIT_VARIABLE(joined);
+            add_text(&joined, working, strlen(working));
+            add_byte(&joined, '/');
+
+            if(text.length > 0)
+                add_text(&joined, text.contents, text.length);
+
+            free_text(&text);
+            text = joined;
+        }
+    }
+#endif
+
+    add_text(&text, path, strlen(path) + 1);
+    normalize_path(text.contents);
+
+    return text.contents;
+}
+
+/*
+ * @docgen: function
+ * @brief: determine whether a path is a source or under it
+ * @name: is_under
+ *
+ * @param source: the source, which is absolute
+ * @type: const char *
+ *
+ * @param path: the path, which is absolute
+ * @type: const char *
+ *
+ * @return: 1 if the path is the source or is under it, or 0 if not
+ * @type: int
+*/
+static int is_under(const char *source, const char *path) {
+    int length = strlen(source);
+
+    if(strncmp(source, path, length) != 0)
+        return 0;
+
+    return path[length] == '\0' || path[length] == '/' || (length > 0 && source[length - 1] == '/');
+}
+
+/*
+ * @docgen: function
+ * @brief: add a flag to the flags of a unit
+ * @name: add_flag
+ *
+ * @param flags: the flags to add to
+ * @type: struct CompdbText *
+ *
+ * @param letter: I, D or U
+ * @type: int
+ *
+ * @param value: the value of the flag
+ * @type: const char *
+*/
+static void add_flag(struct CompdbText *flags, int letter, const char *value) {
+    add_byte(flags, letter);
+    add_text(flags, value, strlen(value) + 1);
+}
+
+/*
+ * @docgen: function
+ * @brief: find the flags of an entry that csource can use
+ * @name: find_flags
+ *
+ * @description
+ * @Find every -I, -isystem, -iquote and -idirafter, which are all kept as
+ * @directories to search, and every -D and -U, with their values joined
+ * @to them or as the next argument. Directories are made absolute. The
+ * @flags end with a second NUL.
+ * @description
+ *
+ * @param entry: the entry to find the flags of
+ * @type: struct CompdbEntry *
+ *
+ * @param flags: the text to keep the flags in
+ * @type: struct CompdbText *
+*/
+static void find_flags(struct CompdbEntry *entry, struct CompdbText *flags) {
+    static const char *directories[] = {"-I", "-isystem", "-iquote", "-idirafter", NULL};
+    const char *arguments = entry->arguments.contents;
+    const char *end = arguments + entry->arguments.length;
+
+    flags->length = 0;
+
+    while(arguments != NULL && arguments < end) {
+        int index = 0;
+        int letter = 0;
+        const char *value = NULL;
+        const char *argument = arguments;
+
+        arguments += strlen(arguments) + 1;
+
+        for(index = 0; directories[index] != NULL; index++) {
+            int length = strlen(directories[index]);
+
+            if(strncmp(argument, directories[index], length) == 0) {
+                letter = 'I';
+                value = argument + length;
+
+                break;
+            }
+        }
+
+        if(letter == 0 && argument[0] == '-' && (argument[1] == 'D' || argument[1] == 'U')) {
+            letter = argument[1];
+            value = argument + 2;
+        }
+
+        if(letter == 0)
+            continue;
+
+        /* The value is the next argument when it is not joined to the flag */
+        if(*value == '\0') {
+            if(arguments >= end)
+                break;
+
+            value = arguments;
+            arguments += strlen(arguments) + 1;
+        }
+
+        if(letter == 'I') {
+            char *directory = absolute_path(entry->directory.contents, value);
+
+            add_flag(flags, letter, directory);
+            csource_allocator.release(directory);
+        } else {
+            add_flag(flags, letter, value);
+        }
+    }
+
+    add_byte(flags, '\0');
+}
+
+/*
+ * @docgen: function
+ * @brief: find the length of the flags of a unit
+ * @name: flags_length
+ *
+ * @param flags: the flags
+ * @type: const char *
+ *
+ * @return: the length of the flags, with the NUL that ends them
+ * @type: int
+*/
+static int flags_length(const char *flags) {
+    const char *cursor = flags;
+
+    while(*cursor != '\0')
+        cursor += strlen(cursor) + 1;
+
+    return cursor - flags + 1;
+}
+
+/*
+ * @docgen: function
+ * @brief: make the unit of an entry, if its file is under the root
+ * @name: add_unit
+ *
+ * @param units: the units to add the unit to
+ * @type: struct CSourceUnits *
+ *
+ * @param entry: the entry
+ * @type: struct CompdbEntry *
+ *
+ * @param root: the absolute path of the source to keep the units of
+ * @type: const char *
+ *
+ * @param flags: text to find the flags of the entry in
+ * @type: struct CompdbText *
+ *
+ * @return: 0 if the entry was used, or -1 if it has no file or command
+ * @type: int
+*/
+static int add_unit(struct CSourceUnits *units, struct CompdbEntry *entry, const char *root,
+                    struct CompdbText *flags) {
+    struct CSourceUnit unit;
+    struct CSourceUnit *last = NULL;
+
+    add_byte(&entry->directory, '\0');
+    add_byte(&entry->file, '\0');
+
+    if(entry->file.length == 1 || (entry->listed == 0 && entry->command.length == 0))
+        return -1;
+
+    unit.path = absolute_path(entry->directory.contents, entry->file.contents);
+    unit.shared = 0;
+
+    if(is_under(root, unit.path) == 0) {
+        csource_allocator.release(unit.path);
+
+        return 0;
+    }
+
+    if(entry->listed == 0)
+        split_command(&entry->command, &entry->arguments);
+
+    find_flags(entry, flags);
+
+    if(units->length > 0)
+        last = units->contents + units->length - 1;
+
+    /* Most units are compiled like the one before them */
+    if(last != NULL && flags_length(last->flags) == flags->length &&
+       memcmp(last->flags, flags->contents, flags->length) == 0) {
+        unit.flags = last->flags;
+        unit.shared = 1;
+    } else {
+        unit.flags = csource_allocator.allocate(flags->length);
+        memcpy(unit.flags, flags->contents, flags->length);
+    }
+
+    carray_append(units, unit, COMPDB_UNIT);
+
+    return 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: read the entries of a database
+ * @name: read_entries
+ *
+ * @param reader: the reader of the database
+ * @type: struct CompdbReader *
+ *
+ * @param units: the units to add the units of the entries to
+ * @type: struct CSourceUnits *
+ *
+ * @param root: the absolute path of the source to keep the units of
+ * @type: const char *
+ *
+ * @return: 0 if the entries were read, or -1 if they are malformed
+ * @type: int
+*/
+static int read_entries(struct CompdbReader *reader, struct CSourceUnits *units,
+                        const char *root) {
+    int status = 0;
+    int character = 0;
+    struct CompdbText flags;
+    struct CompdbEntry entry;
+
+    INIT_VARIABLE(flags);
+    INIT_VARIABLE(entry);
+
+    if(next_token(reader) != '[')
+        return -1;
+
+    if((character = next_token(reader)) == ']')
+        return 0;
+
+    while(1) {
+        if(character != '{' || read_entry(reader, &entry) == -1 ||
+           add_unit(units, &entry, root, &flags) == -1) {
+            status = -1;
+
+            break;
+        }
+
+        if((character = next_token(reader)) == ']')
+            break;
+
+        if(character != ',') {
+            status = -1;
+
+            break;
+        }
+
+        character = next_token(reader);
+    }
+
+    free_text(&flags);
+    free_text(&entry.key);
+    free_text(&entry.directory);
+    free_text(&entry.file);
+    free_text(&entry.command);
+    free_text(&entry.arguments);
+
+    return status;
+}
+
+struct CSourceUnits *csource_compdb_read(FILE *stream, const char *source, int *line) {
+    char *root = NULL;
+    struct CompdbReader reader;
+    struct CSourceUnits *units = NULL;
+
+    liberror_is_null(csource_compdb_read, stream);
+    liberror_is_null(csource_compdb_read, source);
+
+    reader.stream = stream;
+    reader.line = 1;
+    reader.cursor = 0;
+    reader.length = 0;
+    reader.buffer = csource_allocator.allocate(COMPDB_BUFFER);
+
+    root = absolute_path(NULL, source);
+    units = carray_init(units, COMPDB_UNIT);
+
+    if(read_entries(&reader, units, root) == -1) {
+        *line = reader.line;
+        csource_compdb_free(units);
+        units = NULL;
+    }
+
+    csource_allocator.release(reader.buffer);
+    csource_allocator.release(root);
+
+    return units;
+}
+
+void csource_compdb_free(struct CSourceUnits *units) {
+    int index = 0;
+
+    liberror_is_null(csource_compdb_free, units);
+
+    for(index = 0; index < units->length; index++) {
+        csource_allocator.release(units->contents[index].path);
+
+        if(units->contents[index].shared == 0)
+            csource_allocator.release(units->contents[index].flags);
+    }
+
+    carray_free(units, COMPDB_UNIT);
+}
+
+void csource_compdb_directives(const struct CSourceUnit *unit, struct CString *directives) {
+    const char *flag = NULL;
+
+    liberror_is_null(csource_compdb_directives, unit);
+    liberror_is_null(csource_compdb_directives, directives);
+
+    for(flag = unit->flags; *flag != '\0'; flag += strlen(flag) + 1) {
+        char *macro = NULL;
+        char *value = NULL;
+
+        if(flag[0] == 'U') {
+            cstring_concats(directives, "#undef ");
+            cstring_concats(directives, flag + 1);
+            cstring_concats(directives, "\n");
+
+            continue;
+        }
+
+        if(flag[0] != 'D')
+            continue;
+
+        /* A macro without a value is 1, the same as with a compiler */
+        macro = csource_allocator.allocate(strlen(flag));
+        strcpy(macro, flag + 1);
+
+        if((value = strchr(macro, '=')) != NULL)
+            *value = ' ';
+
+        cstring_concats(directives, "#define ");
+        cstring_concats(directives, macro);
+        cstring_concats(directives, value == NULL ? " 1\n" : "\n");
+
+        csource_allocator.release(macro);
+    }
+}
+
+const char **csource_compdb_includes(const struct CSourceUnit *unit) {
+    int count = 0;
+    const char *flag = NULL;
+    const char **includes = NULL;
+
+    liberror_is_null(csource_compdb_includes, unit);
+
+    for(flag = unit->flags; *flag != '\0'; flag += strlen(flag) + 1) {
+        if(flag[0] == 'I')
+            count++;
+    }
+
+    includes = csource_allocator.allocate(sizeof(char *) * (count + 1));
+    count = 0;
+
+    for(flag = unit->flags; *flag != '\0'; flag += strlen(flag) + 1) {
+        if(flag[0] == 'I')
+            includes[count++] = flag + 1;
+    }
+
+    includes[count] = NULL;
+
+    return includes;
+}
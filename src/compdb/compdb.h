@@ -0,0 +1,183 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * A compilation database is the compile_commands.json that build systems
+ * write, with the command each translation unit of a project is compiled
+ * with. Only what csource can use of a command is kept for each unit: its
+ * file, and its -I, -isystem, -iquote, -D and -U flags, in the order they
+ * were given. The database is read as a stream, one entry at a time, so
+ * only the units and never the whole of the database are in memory.
+*/
+
+#ifndef CWARE_CSOURCE_COMPDB_H
+#define CWARE_CSOURCE_COMPDB_H
+
+#include <stdio.h>
+
+/* Data structure properties */
+#define COMPDB_UNIT_TYPE    struct CSourceUnit
+#define COMPDB_UNIT_HEAP    1
+#define COMPDB_UNIT_FREE(value)
+
+struct CString;
+
+/*
+ * @docgen: structure
+ * @brief: a translation unit of a compilation database
+ * @name: CSourceUnit
+ *
+ * @field path: the file, joined to the directory of its entry
+ * @type: char *
+ *
+ * @field flags: each flag as I, D or U and its value, ending with NULs
+ * @type: char *
+ *
+ * @field shared: whether the flags are the same as those of the unit before
+ * @type: int
+*/
+struct CSourceUnit {
+    char *path;
+    char *flags;
+    int shared;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the translation units of a compilation database, in order
+ * @name: CSourceUnits
+ *
+ * @field length: the number of units
+ * @type: int
+ *
+ * @field capacity: the number of units there is room for
+ * @type: int
+ *
+ * @field contents: the units
+ * @type: struct CSourceUnit *
+*/
+struct CSourceUnits {
+    int length;
+    int capacity;
+    struct CSourceUnit *contents;
+};
+
+/*
+ * @docgen: function
+ * @brief: read the translation units of a compilation database
+ * @name: csource_compdb_read
+ *
+ * @description
+ * @Read a compilation database from a stream, keeping the units whose file
+ * @is the source, or is under it. Each entry takes its flags from its
+ * @arguments, or if it has none, from its command, which is split the way
+ * @a shell would. Relative files and directories of flags are joined to
+ * @the directory of the entry, and every path is made absolute, with . and
+ * @.. taken out, so that it can be compared to the source. The units are
+ * @kept in the order of the database, and a file compiled twice is kept
+ * @twice. Units with the same flags as the one before them share them,
+ * @since most units of a project are compiled the same way. The flags of
+ * @a unit are a list of strings, each ending with a NUL and the last
+ * @followed by another, which are a letter, I, D or U, and the value.
+ * @description
+ *
+ * @error: stream is NULL
+ * @error: source is NULL
+ *
+ * @param stream: the stream to read the database from
+ * @type: FILE *
+ *
+ * @param source: the file or directory to keep the units of
+ * @type: const char *
+ *
+ * @param line: the line the database is malformed on
+ * @type: int *
+ *
+ * @return: the units, or NULL if the database is malformed
+ * @type: struct CSourceUnits *
+*/
+struct CSourceUnits *csource_compdb_read(FILE *stream, const char *source, int *line);
+
+/*
+ * @docgen: function
+ * @brief: release the units of a compilation database
+ * @name: csource_compdb_free
+ *
+ * @error: units is NULL
+ *
+ * @param units: the units to release
+ * @type: struct CSourceUnits *
+*/
+void csource_compdb_free(struct CSourceUnits *units);
+
+/*
+ * @docgen: function
+ * @brief: write the -D and -U flags of a unit as directives
+ * @name: csource_compdb_directives
+ *
+ * @description
+ * @Write a #define for every -D of a unit and an #undef for every -U, in
+ * @the order they were given, the same way the options of csource are.
+ * @description
+ *
+ * @error: unit is NULL
+ * @error: directives is NULL
+ *
+ * @param unit: the unit to write the flags of
+ * @type: const struct CSourceUnit *
+ *
+ * @param directives: the string to write the directives to
+ * @type: struct CString *
+*/
+void csource_compdb_directives(const struct CSourceUnit *unit, struct CString *directives);
+
+/*
+ * @docgen: function
+ * @brief: find the directories a unit searches for inclusions
+ * @name: csource_compdb_includes
+ *
+ * @error: unit is NULL
+ *
+ * @param unit: the unit to find the directories of
+ * @type: const struct CSourceUnit *
+ *
+ * @return: the directories, which point into the unit, ending with NULL
+ * @type: const char **
+*/
+const char **csource_compdb_includes(const struct CSourceUnit *unit);
+
+#endif
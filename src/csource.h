@@ -38,6 +38,27 @@
 #ifndef CWARE_CSOURCE_H
 #define CWARE_CSOURCE_H
 
+/* Grow arrays by doubling them, so appending to them stays linear */
+#define CARRAY_RESIZE(size) \
+    ((size) * 2)
+
+/* Allocate arrays through the allocator of csource, which also counts
+ * them for --stats. Define CSOURCE_NO_STATISTICS to compile the counters
+ * out, as libcsource does, since every thread shares them. */
+#include "allocator/allocator.h"
+
+#define CARRAY_MALLOC(size)             csource_allocator.allocate((size))
+#define CARRAY_REALLOC(pointer, size)   csource_allocator.reallocate((pointer), (size))
+#define CARRAY_FREE(pointer)            csource_allocator.release((pointer))
+
+/* libcsource hands the errors of carray to liberror_handle_error, like
+ * those of liberror, rather than print them and end the process */
+#if defined(LIBERROR_NO_ABORT)
+#define CARRAY_REPORT(arguments)
+#define CARRAY_ABORT() \
+    liberror_handle_error()
+#endif
+
 /* Project dependencies */
 #include "carray/carray.h"
 #include "libpath/libpath.h"
@@ -46,6 +67,10 @@
 #include "argparse/argparse.h"
 #include "libmatch/libmatch.h"
 
+struct CSourceOutput;
+struct CSourceDefines;
+struct CSourceStatistics;
+
 /* Helpful macros */
 #define INIT_VARIABLE(v) \
     memset(&(v), 0, sizeof((v)))
@@ -53,41 +78,87 @@
 /* Program configuration */
 #define HELP_MESSAGE_STREAM     stderr
 #define ERROR_MESSAGE_STREAM    stderr
-#define HELP_MESSAGE                                        \
-    "csource SOURCE TARGET [ --help | -h ]\n"               \
-    "Extract code from a C source file\n"                   \
-    "\n"                                                    \
-    "Arguments\n"                                           \
-    "    command            the type of token to extract\n" \
-    "    source             the file to use\n"              \
-    "\n"                                                    \
-    "Options\n"                                             \
-    "    --help, -h         display this message\n"
 
 /* Exit codes */
 #define EXIT_HELP_MESSAGE   1
 #define EXIT_UNKNOWN_FILE   2
 #define EXIT_INTERNAL_ERROR 3
 #define EXIT_UNKNOWN_MODULE 4
+#define EXIT_UNKNOWN_FORMAT 5
+#define EXIT_UNKNOWN_STATS  6
+#define EXIT_INVALID_JOBS   7
+#define EXIT_INVALID_LINE   8
+#define EXIT_BINARY_FILE    9
+#define EXIT_SKIPPED_FILES  10
+#define EXIT_UNKNOWN_SCOPE  11
+#define EXIT_INVALID_NAME   12
+#define EXIT_INVALID_INDEX  13
+#define EXIT_INVALID_PATTERN 14
+#define EXIT_INVALID_COMPDB 15
+#define EXIT_UNKNOWN_UNIT   16
 
 /*
  * @docgen: structure
  * @brief: parameters to configure a module's function
  * @name: ModuleSetup
  *
- * @param file: the file to read from
- * @type: FILE *
+ * @field input: the contents of the source file, owned by the caller
+ * @type: struct LibmatchCursor
  *
  * @field source: the source file
  * @type: const char *
  *
  * @field command: the command to perform
  * @type: const char *
+ *
+ * @field lookup: the name to look up, or NULL (--lookup)
+ * @type: const char *
+ *
+ * @field line: the line to look up, or 0 (--line)
+ * @type: int
+ *
+ * @field statics: whether static functions are wanted too (--static)
+ * @type: int
+ *
+ * @field identifiers: the identifiers to look for, ending with NULL, or NULL
+ * @type: const char **
+ *
+ * @field scope: where to look for them (CSOURCE_SCOPE_*, --scope)
+ * @type: int
+ *
+ * @field search: how to search for the lookup (CSOURCE_SEARCH_*, --code, --regex)
+ * @type: int
+ *
+ * @field tags: the format to write tags in (CSOURCE_TAGS_*, --etags)
+ * @type: int
+ *
+ * @field macros: the macros given with -D and -U, or NULL
+ * @type: const struct CSourceDefines *
+ *
+ * @field includes: the directories to find inclusions in, ending with NULL, or NULL
+ * @type: const char **
+ *
+ * @field statistics: the statistics of the run, or NULL
+ * @type: struct CSourceStatistics *
+ *
+ * @field output: the record stream to write results to
+ * @type: struct CSourceOutput *
 */
 struct ModuleSetup {
-    FILE *file;
+    struct LibmatchCursor input;
     const char *source;
     const char *command;
+    const char *lookup;
+    int line;
+    int statics;
+    const char **identifiers;
+    int scope;
+    int search;
+    int tags;
+    const struct CSourceDefines *macros;
+    const char **includes;
+    struct CSourceStatistics *statistics;
+    struct CSourceOutput *output;
 };
 
 #endif
@@ -44,6 +44,21 @@
 
 #include "cstring.h"
 
+/* Errors end the process, unless liberror hands them to the program */
+#if defined(LIBERROR_NO_ABORT)
+#define _cstring_exit() \
+    liberror_handle_error()
+#else
+#define _cstring_exit() \
+    exit(EXIT_FAILURE)
+#endif
+
+struct CStringStatistics cstring_statistics;
+
+void *(*cstring_malloc_hook)(size_t size) = malloc;
+void *(*cstring_realloc_hook)(void *pointer, size_t size) = realloc;
+void (*cstring_free_hook)(void *pointer) = free;
+
 /* Memory focused operations */
 
 struct CString cstring_init(const char *body) {
@@ -55,7 +70,10 @@ struct CString cstring_init(const char *body) {
     body_length = strlen(body);
     cstring.length = body_length;
     cstring.capacity = body_length + 1;
-    cstring.contents = malloc(body_length + 1);
+    cstring.contents = cstring_malloc_hook(body_length + 1);
+
+    _cstring_count(allocations, 1);
+    _cstring_count(bytes_allocated, body_length + 1);
 
     cstring.contents[0] = '\0';
     strncat(cstring.contents, body, body_length);
@@ -67,7 +85,7 @@ struct CString cstring_init(const char *body) {
 void cstring_free(struct CString cstring) {
     liberror_is_null(cstring_free, cstring.contents);
 
-    free(cstring.contents);
+    cstring_free_hook(cstring.contents);
 }
 
 /* Addition based operations */
@@ -95,8 +113,12 @@ void cstring_concat(struct CString *cstring_a, struct CString cstring_b) {
      * This would be a factor in a situation where the string was
      * reset, and then we concatenate to the reset string. This is
      * essentially so we do not shrink the string. */
-    if(new_length > cstring_a->length)
-        cstring_a->contents = realloc(cstring_a->contents, new_length + 1);
+    if(new_length > cstring_a->length) {
+        cstring_a->contents = cstring_realloc_hook(cstring_a->contents, new_length + 1);
+
+        _cstring_count(reallocations, 1);
+        _cstring_count(bytes_allocated, new_length + 1);
+    }
 
     for(index = 0; index < cstring_b.length; index++) {
         cstring_a->contents[cstring_a->length + index] = cstring_b.contents[index];
@@ -307,7 +329,11 @@ struct CString cstring_loadf(FILE *file) {
     length = ftell(file);
 
     /* Prepare the buffer and cstring */
-    cstring.contents = malloc(sizeof(char) * (length + 1));
+    cstring.contents = cstring_malloc_hook(sizeof(char) * (length + 1));
+
+    _cstring_count(allocations, 1);
+    _cstring_count(bytes_allocated, length + 1);
+
     cstring.contents[length] = '\0';
     cstring.length = length;
     cstring.capacity = length + 1;
@@ -338,21 +364,21 @@ struct CString cstring_slice(struct CString cstring, int start, int stop) {
     liberror_is_negative(cstring_slice, stop);
 
     if(start > stop) {
-        fprintf(stderr, "cstring_slice: start (%i) cannot be larger than stop (%i)\n",
-                start, stop);
-        exit(EXIT_FAILURE);
+        _liberror_report((stderr, "cstring_slice: start (%i) cannot be larger than stop (%i)\n",
+                          start, stop));
+        _cstring_exit();
     }
 
     if(start > cstring.length) {
-        fprintf(stderr, "cstring_slice: start (%i) outside of the bounds of the cstring length (%i)\n",
-                start, cstring.length);
-        exit(EXIT_FAILURE);
+        _liberror_report((stderr, "cstring_slice: start (%i) outside of the bounds of the "
+                          "cstring length (%i)\n", start, cstring.length));
+        _cstring_exit();
     }
 
     if(stop > cstring.length) {
-        fprintf(stderr, "cstring_slice: stop (%i) outside of the bounds of the cstring length (%i)\n",
-                stop, cstring.length);
-        exit(EXIT_FAILURE);
+        _liberror_report((stderr, "cstring_slice: stop (%i) outside of the bounds of the "
+                          "cstring length (%i)\n", stop, cstring.length));
+        _cstring_exit();
     }
 
     /*
@@ -100,10 +100,50 @@
 #ifndef CWARE_CSTRING_H
 #define CWARE_CSTRING_H
 
+#include <stddef.h>
+
 #include "liberror/liberror.h"
 
 #define CSTRING_NOT_FOUND   -1
 
+/* Instrumentation. Define CSTRING_NO_STATISTICS when building cstring
+ * to compile the counters out entirely. */
+#if defined(CSTRING_NO_STATISTICS)
+#define _cstring_count(counter, amount)
+#else
+#define _cstring_count(counter, amount) \
+    (cstring_statistics.counter += (unsigned long) (amount))
+#endif
+
+/*
+ * @docgen: structure
+ * @brief: counters of the memory used by cstring
+ * @name: CStringStatistics
+ *
+ * @field allocations: the number of allocations
+ * @type: unsigned long
+ *
+ * @field reallocations: the number of reallocations
+ * @type: unsigned long
+ *
+ * @field bytes_allocated: the number of bytes requested
+ * @type: unsigned long
+*/
+struct CStringStatistics {
+    unsigned long allocations;
+    unsigned long reallocations;
+    unsigned long bytes_allocated;
+};
+
+extern struct CStringStatistics cstring_statistics;
+
+/* The allocator used by cstring for the contents of every string. These
+ * point at the standard allocator by default, and should only be replaced
+ * before any string is made. */
+extern void *(*cstring_malloc_hook)(size_t size);
+extern void *(*cstring_realloc_hook)(void *pointer, size_t size);
+extern void (*cstring_free_hook)(void *pointer);
+
 /*
  * @docgen: macro_function
  * @brief: get the string from the cstring
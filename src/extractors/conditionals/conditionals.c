@@ -0,0 +1,499 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file maps the conditional branches of a source file, and indexes
+ * them by line. The branches are found in one pass over the directives of
+ * the file. The innermost branch that is still open is the only state that
+ * pass needs, since the rest of the open branches are its parents.
+ *
+ * The index is built after that from the branches alone. They nest, so a
+ * sweep over them in the order they start, keeping the chain of branches
+ * around the current line, splits the lines into intervals that each have
+ * one innermost branch.
+*/
+
+#include <string.h>
+
+#include "../../csource.h"
+#include "../../output/output.h"
+#include "../../filters/directives/directives.h"
+
+#include "conditionals.h"
+
+/*
+ * @docgen: structure
+ * @brief: the state of mapping the branches of a file
+ * @name: ConditionalsBuilder
+ *
+ * @field buffer: the source file
+ * @type: const char *
+ *
+ * @field length: the length of the source file
+ * @type: int
+ *
+ * @field conditionals: the branches found so far
+ * @type: struct CSourceConditionals *
+ *
+ * @field current: the innermost branch that is open, or -1
+ * @type: int
+ *
+ * @field position: the index after the last directive
+ * @type: int
+ *
+ * @field position_line: the line after the last directive
+ * @type: int
+*/
+struct ConditionalsBuilder {
+    const char *buffer;
+    int length;
+    struct CSourceConditionals *conditionals;
+    int current;
+    int position;
+    int position_line;
+};
+
+static int count_newlines(const char *buffer, int start, int end) {
+    int count = 0;
+    const char *newline = NULL;
+
+    while(start < end && (newline = memchr(buffer + start, '\n', end - start)) != NULL) {
+        start = newline - buffer + 1;
+        count++;
+    }
+
+    return count;
+}
+
+static int is_name(const char *buffer, int name, int length, const char *expected) {
+    return length == (int) strlen(expected) && strncmp(buffer + name, expected, length) == 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: open a new branch
+ * @name: open_branch
+ *
+ * @param builder: the builder to open the branch in
+ * @type: struct ConditionalsBuilder *
+ *
+ * @param group: the first branch of the group, or -1 if this is it
+ * @type: int
+ *
+ * @param start: the index the directive of the branch starts at
+ * @type: int
+ *
+ * @param end: the index the directive of the branch ends at
+ * @type: int
+ *
+ * @param line: the line the directive of the branch starts on
+ * @type: int
+*/
+static void open_branch(struct ConditionalsBuilder *builder, int group, int start, int end,
+                        int line) {
+    struct CSourceConditional branch;
+    const char *hash = memchr(builder->buffer + start, '#', end - start);
+
+    INIT_VARIABLE(branch);
+
+    branch.parent = builder->current;
+    branch.group = group == -1 ? builder->conditionals->length : group;
+    branch.start_line = line;
+    branch.start_offset = start;
+    branch.text = hash;
+    branch.length = builder->buffer + end - hash;
+
+    if(builder->current != -1)
+        branch.depth = builder->conditionals->contents[builder->current].depth + 1;
+
+    /* The end of a DOS line is not part of the directive */
+    while(branch.length > 0 && (hash[branch.length - 1] == '\r' || hash[branch.length - 1] == ' ' ||
+                                hash[branch.length - 1] == '\t'))
+        branch.length--;
+
+    builder->current = builder->conditionals->length;
+    carray_append(builder->conditionals, branch, CONDITIONAL);
+}
+
+/*
+ * @docgen: function
+ * @brief: close the innermost open branch
+ * @name: close_branch
+ *
+ * @param builder: the builder with the branch
+ * @type: struct ConditionalsBuilder *
+ *
+ * @param end_line: the last line of the branch
+ * @type: int
+ *
+ * @param end_offset: the byte offset after the end of the branch
+ * @type: long
+*/
+static void close_branch(struct ConditionalsBuilder *builder, int end_line, long end_offset) {
+    struct CSourceConditional *branch = builder->conditionals->contents + builder->current;
+
+    branch->end_line = end_line;
+    branch->end_offset = end_offset;
+    builder->current = branch->parent;
+}
+
+/*
+ * @docgen: function
+ * @brief: open or close branches at a directive
+ * @name: visit_directive
+ *
+ * @param visitor: the visitor of the builder
+ * @type: struct CSourceDirectiveVisitor *
+ *
+ * @param start: the index the directive starts at
+ * @type: int
+ *
+ * @param end: the index the directive ends at
+ * @type: int
+ *
+ * @param line: the line the directive starts on
+ * @type: int
+*/
+static void visit_directive(struct CSourceDirectiveVisitor *visitor, int start, int end, int line) {
+    int length = 0;
+    struct ConditionalsBuilder *builder = visitor->data;
+    const char *buffer = builder->buffer;
+    int name = csource_directive_name(buffer, start, end, &length);
+    int last_line = line + count_newlines(buffer, start, end);
+
+    builder->position = end + 1;
+    builder->position_line = last_line + 1;
+
+    if(is_name(buffer, name, length, "if") == 1 || is_name(buffer, name, length, "ifdef") == 1 ||
+       is_name(buffer, name, length, "ifndef") == 1) {
+        open_branch(builder, -1, start, end, line);
+
+        return;
+    }
+
+    if(builder->current == -1)
+        return;
+
+    if(is_name(buffer, name, length, "elif") == 1 || is_name(buffer, name, length, "elifdef") == 1 ||
+       is_name(buffer, name, length, "elifndef") == 1 || is_name(buffer, name, length, "else") == 1) {
+        int group = builder->conditionals->contents[builder->current].group;
+
+        close_branch(builder, line - 1, start);
+        open_branch(builder, group, start, end, line);
+
+        return;
+    }
+
+    if(is_name(buffer, name, length, "endif") == 1)
+        close_branch(builder, last_line, end < builder->length ? end + 1 : end);
+}
+
+/*
+ * @docgen: function
+ * @brief: add an interval to the index, if it has any lines
+ * @name: add_interval
+ *
+ * @param conditionals: the branches to add the interval to
+ * @type: struct CSourceConditionals *
+ *
+ * @param start_line: the first line of the interval
+ * @type: int
+ *
+ * @param end_line: the last line of the interval
+ * @type: int
+ *
+ * @param start_offset: the byte offset the interval starts at
+ * @type: long
+ *
+ * @param branch: the innermost branch of the interval
+ * @type: int
+*/
+static void add_interval(struct CSourceConditionals *conditionals, int start_line, int end_line,
+                         long start_offset, int branch) {
+    struct CSourceInterval interval;
+
+    if(start_line > end_line)
+        return;
+
+    interval.start_line = start_line;
+    interval.end_line = end_line;
+    interval.start_offset = start_offset;
+    interval.branch = branch;
+
+    carray_append(conditionals->intervals, interval, INTERVAL);
+}
+
+/*
+ * @docgen: function
+ * @brief: build the index of the lines of the branches
+ * @name: build_intervals
+ *
+ * @param conditionals: the branches to index
+ * @type: struct CSourceConditionals *
+*/
+static void build_intervals(struct CSourceConditionals *conditionals) {
+    int index = 0;
+    int top = -1;
+    int line = 0;
+    long offset = 0;
+    const struct CSourceConditional *branches = conditionals->contents;
+
+    for(index = 0; index <= conditionals->length; index++) {
+        /* Every branch that ends before this one starts has no more lines
+         * after this, which leaves the parent of this branch on top. Past
+         * the last branch, every branch ends. */
+        while(top != -1 && (index == conditionals->length ||
+                            branches[top].end_line < branches[index].start_line)) {
+            add_interval(conditionals, line, branches[top].end_line, offset, top);
+
+            if(line <= branches[top].end_line) {
+                line = branches[top].end_line + 1;
+                offset = branches[top].end_offset;
+            }
+
+            top = branches[top].parent;
+        }
+
+        if(index == conditionals->length)
+            break;
+
+        if(top != -1)
+            add_interval(conditionals, line, branches[index].start_line - 1, offset, top);
+
+        top = index;
+        line = branches[index].start_line;
+        offset = branches[index].start_offset;
+    }
+}
+
+struct CSourceConditionals *csource_conditionals_init(const char *buffer, int length) {
+    struct ConditionalsBuilder builder;
+    struct CSourceDirectiveVisitor visitor;
+    struct CSourceConditionals *conditionals = NULL;
+
+    liberror_is_null(csource_conditionals_init, buffer);
+
+    conditionals = carray_init(conditionals, CONDITIONAL);
+    conditionals->intervals = carray_init(conditionals->intervals, INTERVAL);
+
+    builder.buffer = buffer;
+    builder.length = length;
+    builder.conditionals = conditionals;
+    builder.current = -1;
+    builder.position = 0;
+    builder.position_line = 1;
+
+    visitor.code = NULL;
+    visitor.directive = visit_directive;
+    visitor.data = &builder;
+
+    csource_scan_directives(buffer, length, &visitor);
+
+    /* Groups that are still open end with the file. Only what is after the
+     * last directive is counted to find its last line. */
+    if(builder.current != -1) {
+        int last_line = builder.position_line - 1;
+
+        if(builder.position < length) {
+            last_line += count_newlines(buffer, builder.position, length);
+
+            if(buffer[length - 1] != '\n')
+                last_line++;
+        }
+
+        while(builder.current != -1)
+            close_branch(&builder, last_line, length);
+    }
+
+    build_intervals(conditionals);
+
+    return conditionals;
+}
+
+void csource_conditionals_free(struct CSourceConditionals *conditionals) {
+    liberror_is_null(csource_conditionals_free, conditionals);
+
+    carray_free(conditionals->intervals, INTERVAL);
+    carray_free(conditionals, CONDITIONAL);
+}
+
+int csource_conditionals_find(const struct CSourceConditionals *conditionals, int line) {
+    int low = 0;
+    int high = 0;
+    const struct CSourceInterval *intervals = NULL;
+
+    liberror_is_null(csource_conditionals_find, conditionals);
+
+    intervals = conditionals->intervals->contents;
+    high = conditionals->intervals->length - 1;
+
+    /* Find the last interval that starts on or before the line */
+    while(low <= high) {
+        int middle = low + (high - low) / 2;
+
+        if(intervals[middle].start_line <= line)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+
+    if(high < 0 || intervals[high].end_line < line)
+        return -1;
+
+    return intervals[high].branch;
+}
+
+/*
+ * @docgen: structure
+ * @brief: the state of writing branches
+ * @name: ConditionalsWriter
+ *
+ * @field output: the output to write to
+ * @type: struct CSourceOutput *
+ *
+ * @field payload: the payload of the record being written
+ * @type: char *
+ *
+ * @field capacity: the capacity of the payload
+ * @type: int
+*/
+struct ConditionalsWriter {
+    struct CSourceOutput *output;
+    char *payload;
+    int capacity;
+};
+
+/*
+ * @docgen: function
+ * @brief: write a branch as a record
+ * @name: write_branch
+ *
+ * @param writer: the writer to write with
+ * @type: struct ConditionalsWriter *
+ *
+ * @param conditionals: the branches
+ * @type: const struct CSourceConditionals *
+ *
+ * @param index: the index of the branch to write
+ * @type: int
+*/
+static void write_branch(struct ConditionalsWriter *writer,
+                         const struct CSourceConditionals *conditionals, int index) {
+    char numbers[8 * 24 + 1];
+    int length = 0;
+    struct CSourceRecord record;
+    struct CSourceConditional branch = conditionals->contents[index];
+
+    sprintf(numbers, "%i %i %i %i %i %i %li %li ", index, branch.parent, branch.group,
+            branch.depth, branch.start_line, branch.end_line, branch.start_offset,
+            branch.end_offset);
+    length = strlen(numbers);
+
+    if(length + branch.length > writer->capacity) {
+        writer->capacity = length + branch.length;
+        writer->payload = csource_allocator.reallocate(writer->payload, writer->capacity);
+    }
+
+    memcpy(writer->payload, numbers, length);
+    memcpy(writer->payload + length, branch.text, branch.length);
+
+    record.kind = CSOURCE_RECORD_CONDITIONAL;
+    record.line = branch.start_line;
+    record.offset = branch.start_offset;
+    record.payload = writer->payload;
+    record.length = length + branch.length;
+
+    csource_output_record(writer->output, record);
+}
+
+void csource_extract_conditionals(struct ModuleSetup setup) {
+    int index = 0;
+    int depth = 0;
+    int *chain = NULL;
+    struct ConditionalsWriter writer;
+    struct CSourceConditionals *conditionals = NULL;
+
+    conditionals = csource_conditionals_init(setup.input.buffer, setup.input.length);
+
+    writer.output = setup.output;
+    writer.payload = NULL;
+    writer.capacity = 0;
+
+    if(setup.line > 0) {
+        /* The chain goes from the innermost branch out, so it is gathered
+         * first to be written from the outermost in */
+        if((index = csource_conditionals_find(conditionals, setup.line)) != -1) {
+            chain = csource_allocator.allocate(sizeof(int) *
+                                               (conditionals->contents[index].depth + 1));
+
+            for(; index != -1; index = conditionals->contents[index].parent)
+                chain[depth++] = index;
+
+            while(depth > 0)
+                write_branch(&writer, conditionals, chain[--depth]);
+
+            csource_allocator.release(chain);
+        }
+
+        csource_allocator.release(writer.payload);
+        csource_conditionals_free(conditionals);
+
+        return;
+    }
+
+    for(index = 0; index < conditionals->length; index++)
+        write_branch(&writer, conditionals, index);
+
+    for(index = 0; index < conditionals->intervals->length; index++) {
+        char payload[3 * 24 + 1];
+        struct CSourceRecord record;
+        struct CSourceInterval interval = conditionals->intervals->contents[index];
+
+        sprintf(payload, "%i %i %i", interval.start_line, interval.end_line, interval.branch);
+
+        record.kind = CSOURCE_RECORD_INTERVAL;
+        record.line = interval.start_line;
+        record.offset = interval.start_offset;
+        record.payload = payload;
+        record.length = strlen(payload);
+
+        csource_output_record(setup.output, record);
+    }
+
+    csource_allocator.release(writer.payload);
+    csource_conditionals_free(conditionals);
+}
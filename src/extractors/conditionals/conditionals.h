@@ -0,0 +1,264 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_CSOURCE_EXTRACT_CONDITIONALS_H
+#define CWARE_CSOURCE_EXTRACT_CONDITIONALS_H
+
+/* Data structure properties */
+#define CONDITIONAL_TYPE    struct CSourceConditional
+#define CONDITIONAL_HEAP    1
+#define CONDITIONAL_FREE(value)
+
+#define INTERVAL_TYPE       struct CSourceInterval
+#define INTERVAL_HEAP       1
+#define INTERVAL_FREE(value)
+
+struct ModuleSetup;
+
+/*
+ * @docgen: structure
+ * @brief: a branch of a conditional group
+ * @name: CSourceConditional
+ *
+ * @description
+ * @One branch of an #if, #ifdef or #ifndef group, from the directive that
+ * @starts it up to the #elif, #else or #endif that follows. The last
+ * @branch of a group takes in its #endif. Branches are numbered in the
+ * @order they start, which is also the order of the tree from the outside
+ * @in, so a branch always comes after its parent.
+ * @description
+ *
+ * @field parent: the branch this one is inside of, or -1
+ * @type: int
+ *
+ * @field group: the first branch of the group this one is in
+ * @type: int
+ *
+ * @field depth: how many branches this one is inside of
+ * @type: int
+ *
+ * @field start_line: the first line of the branch
+ * @type: int
+ *
+ * @field end_line: the last line of the branch
+ * @type: int
+ *
+ * @field start_offset: the byte offset the branch starts at
+ * @type: long
+ *
+ * @field end_offset: the byte offset after the end of the branch
+ * @type: long
+ *
+ * @field text: the directive that starts the branch, from its #
+ * @type: const char *
+ *
+ * @field length: the length of the directive
+ * @type: int
+*/
+struct CSourceConditional {
+    int parent;
+    int group;
+    int depth;
+    int start_line;
+    int end_line;
+    long start_offset;
+    long end_offset;
+    const char *text;
+    int length;
+};
+
+/*
+ * @docgen: structure
+ * @brief: a range of lines which all have the same innermost branch
+ * @name: CSourceInterval
+ *
+ * @field start_line: the first line of the range
+ * @type: int
+ *
+ * @field end_line: the last line of the range
+ * @type: int
+ *
+ * @field start_offset: the byte offset the range starts at
+ * @type: long
+ *
+ * @field branch: the innermost branch of every line in the range
+ * @type: int
+*/
+struct CSourceInterval {
+    int start_line;
+    int end_line;
+    long start_offset;
+    int branch;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the intervals of a file, sorted by line
+ * @name: CSourceIntervals
+ *
+ * @field length: the number of intervals
+ * @type: int
+ *
+ * @field capacity: the capacity of the intervals
+ * @type: int
+ *
+ * @field contents: the intervals
+ * @type: struct CSourceInterval *
+*/
+struct CSourceIntervals {
+    int length;
+    int capacity;
+    struct CSourceInterval *contents;
+};
+
+/*
+ * @docgen: structure
+ * @brief: every conditional branch of a file, with an index by line
+ * @name: CSourceConditionals
+ *
+ * @description
+ * @The branches of a file form a tree, so every line that is in a branch
+ * @at all has one innermost branch. The index splits the lines that are
+ * @in branches into intervals, sorted and apart from each other, which
+ * @each have a single innermost branch. There are never more than twice
+ * @as many intervals as branches, and finding the interval of a line is
+ * @a binary search.
+ * @description
+ *
+ * @field length: the number of branches
+ * @type: int
+ *
+ * @field capacity: the capacity of the branches
+ * @type: int
+ *
+ * @field contents: the branches, in the order they start
+ * @type: struct CSourceConditional *
+ *
+ * @field intervals: the index of the innermost branch of each line
+ * @type: struct CSourceIntervals *
+*/
+struct CSourceConditionals {
+    int length;
+    int capacity;
+    struct CSourceConditional *contents;
+
+    struct CSourceIntervals *intervals;
+};
+
+/*
+ * @docgen: function
+ * @brief: map the conditional branches of a source file
+ * @name: csource_conditionals_init
+ *
+ * @description
+ * @Find every conditional branch of a source file in a single pass over
+ * @its directives, then build the index of its lines from the branches.
+ * @A group that is never closed ends at the end of the file, and an #elif,
+ * @#else or #endif outside of any group is left out.
+ * @description
+ *
+ * @error: buffer is NULL
+ *
+ * @param buffer: the source file
+ * @type: const char *
+ *
+ * @param length: the length of the source file
+ * @type: int
+ *
+ * @return: the branches of the file
+ * @type: struct CSourceConditionals *
+*/
+struct CSourceConditionals *csource_conditionals_init(const char *buffer, int length);
+
+/*
+ * @docgen: function
+ * @brief: release the branches of a file from memory
+ * @name: csource_conditionals_free
+ *
+ * @error: conditionals is NULL
+ *
+ * @param conditionals: the branches to release
+ * @type: struct CSourceConditionals *
+*/
+void csource_conditionals_free(struct CSourceConditionals *conditionals);
+
+/*
+ * @docgen: function
+ * @brief: find the innermost branch a line is in
+ * @name: csource_conditionals_find
+ *
+ * @description
+ * @Find the innermost branch a line is in with a binary search of the
+ * @intervals. The rest of the branches the line is in are the parents of
+ * @that branch.
+ * @description
+ *
+ * @error: conditionals is NULL
+ *
+ * @param conditionals: the branches to search
+ * @type: const struct CSourceConditionals *
+ *
+ * @param line: the line to find
+ * @type: int
+ *
+ * @return: the index of the branch, or -1 if the line is in none
+ * @type: int
+*/
+int csource_conditionals_find(const struct CSourceConditionals *conditionals, int line);
+
+/*
+ * @docgen: function
+ * @brief: extract the conditional branches of a source file
+ * @name: csource_extract_conditionals
+ *
+ * @description
+ * @Write a conditional record for every branch, then an interval record
+ * @for every interval of the index. The payload of a branch is its index,
+ * @parent, group, depth, first and last line, and start and end offset,
+ * @separated by spaces, followed by its directive. The payload of an
+ * @interval is its first line, last line, and innermost branch.
+ * @
+ * @With a line to look up, only the branches that line is in are written,
+ * @from the outermost in.
+ * @description
+ *
+ * @param setup: the setup of the module
+ * @type: struct ModuleSetup
+*/
+void csource_extract_conditionals(struct ModuleSetup setup);
+
+#endif
@@ -0,0 +1,310 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file counts what source files are made of, the way cloc and
+ * sloccount do. Lines are sorted out in the pass over the comments that
+ * strip-comments makes, which already knows where strings are, so a
+ * comment marker in a string does not make a comment line. Inclusions are
+ * counted in the same pass, as the directives named include.
+*/
+
+#include <string.h>
+
+#include "../../csource.h"
+#include "../../output/output.h"
+#include "../../statistics/statistics.h"
+#include "../../filters/comments/comments.h"
+#include "../../filters/directives/directives.h"
+#include "../../filters/blank/blank.h"
+#include "../functions/functions.h"
+
+#include "counts.h"
+
+/*
+ * @docgen: structure
+ * @brief: the state of sorting the lines of a file
+ * @name: LineCounter
+ *
+ * @field buffer: the source file
+ * @type: const char *
+ *
+ * @field counts: the counts to add the lines to
+ * @type: struct CSourceCounts *
+ *
+ * @field code: whether the line has code on it
+ * @type: int
+ *
+ * @field comment: whether the line has a comment on it
+ * @type: int
+ *
+ * @field directive: whether the line is part of a directive
+ * @type: int
+ *
+ * @field continued: whether the line ends with a continuation
+ * @type: int
+*/
+struct LineCounter {
+    const char *buffer;
+    struct CSourceCounts *counts;
+    int code;
+    int comment;
+    int directive;
+    int continued;
+};
+
+/*
+ * @docgen: function
+ * @brief: count the line that just ended
+ * @name: end_line
+ *
+ * @param counter: the counter with the line
+ * @type: struct LineCounter *
+*/
+static void end_line(struct LineCounter *counter) {
+    if(counter->directive == 1)
+        counter->counts->directive++;
+    else if(counter->code == 1)
+        counter->counts->code++;
+    else if(counter->comment == 1)
+        counter->counts->comment++;
+    else
+        counter->counts->blank++;
+
+    /* A directive goes on for as long as it is continued */
+    counter->directive = counter->directive == 1 && counter->continued == 1;
+    counter->code = 0;
+    counter->comment = 0;
+    counter->continued = 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: sort the lines of a run of code
+ * @name: count_code
+ *
+ * @param visitor: the visitor of the counter
+ * @type: struct CSourceCommentVisitor *
+ *
+ * @param start: the index the run starts at
+ * @type: int
+ *
+ * @param end: the index the run ends at
+ * @type: int
+*/
+static void count_code(struct CSourceCommentVisitor *visitor, int start, int end) {
+    int index = 0;
+    struct LineCounter *counter = visitor->data;
+    const char *buffer = counter->buffer;
+
+    for(index = start; index < end; index++) {
+        char character = buffer[index];
+
+        if(character == '\n') {
+            end_line(counter);
+
+            continue;
+        }
+
+        if(character == ' ' || character == '\t' || character == '\r' || character == '\f' ||
+           character == '\v')
+            continue;
+
+        /* Comments are whitespace to the preprocessor, so a # after one
+         * still starts a directive */
+        if(character == '#' && counter->code == 0 && counter->directive == 0) {
+            int length = 0;
+            int name = csource_directive_name(buffer, index, end, &length);
+
+            counter->directive = 1;
+            counter->counts->includes += length == 7 && strncmp(buffer + name, "include", 7) == 0;
+        }
+
+        counter->code = 1;
+        counter->continued = character == '\\' &&
+                             ((index + 1 < end && buffer[index + 1] == '\n') ||
+                              (index + 2 < end && buffer[index + 1] == '\r' &&
+                               buffer[index + 2] == '\n'));
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: sort the lines of a comment
+ * @name: count_comment
+ *
+ * @param visitor: the visitor of the counter
+ * @type: struct CSourceCommentVisitor *
+ *
+ * @param start: the index the comment starts at
+ * @type: int
+ *
+ * @param end: the index the comment ends at
+ * @type: int
+*/
+static void count_comment(struct CSourceCommentVisitor *visitor, int start, int end) {
+    const char *newline = NULL;
+    struct LineCounter *counter = visitor->data;
+    const char *buffer = counter->buffer;
+
+    counter->comment = 1;
+    counter->continued = 0;
+
+    while((newline = memchr(buffer + start, '\n', end - start)) != NULL) {
+        end_line(counter);
+        counter->comment = 1;
+        start = newline - buffer + 1;
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: count a function if it is a definition
+ * @name: count_function
+ *
+ * @param visitor: the visitor with the counts
+ * @type: struct CSourceFunctionVisitor *
+ *
+ * @param record: the record of the function
+ * @type: struct CSourceRecord
+ *
+ * @param definition: whether the function has a body
+ * @type: int
+*/
+static void count_function(struct CSourceFunctionVisitor *visitor, struct CSourceRecord record,
+                           int definition) {
+    struct CSourceCounts *counts = visitor->data;
+
+    counts->functions += definition;
+}
+
+void csource_count_lines(const char *buffer, int length, struct CSourceCounts *counts) {
+    struct LineCounter counter;
+    struct CSourceCommentVisitor visitor;
+
+    liberror_is_null(csource_count_lines, buffer);
+    liberror_is_null(csource_count_lines, counts);
+
+    INIT_VARIABLE(counter);
+
+    counter.buffer = buffer;
+    counter.counts = counts;
+
+    visitor.code = count_code;
+    visitor.comment = count_comment;
+    visitor.data = &counter;
+
+    csource_scan_comments(buffer, length, &visitor);
+
+    if(length > 0 && buffer[length - 1] != '\n')
+        end_line(&counter);
+}
+
+void csource_extract_counts(struct ModuleSetup setup) {
+    char payload[6 * 32 + 1];
+    char *code = NULL;
+    struct CSourceCounts counts;
+    struct CSourceRecord record;
+    struct CSourceFunctionVisitor visitor;
+
+    INIT_VARIABLE(counts);
+
+    csource_count_lines(setup.input.buffer, setup.input.length, &counts);
+
+    visitor.function = count_function;
+    visitor.data = &counts;
+    code = csource_blank(setup.input.buffer, setup.input.length);
+    csource_scan_functions(libmatch_cursor_init(code, setup.input.length), &visitor);
+    csource_allocator.release(code);
+
+    sprintf(payload, "code %lu comment %lu blank %lu directive %lu functions %lu includes %lu",
+            counts.code, counts.comment, counts.blank, counts.directive, counts.functions,
+            counts.includes);
+
+    record.kind = CSOURCE_RECORD_COUNTS;
+    record.line = 1;
+    record.offset = 0;
+    record.payload = payload;
+    record.length = strlen(payload);
+
+    csource_output_record(setup.output, record);
+
+    if(setup.statistics == NULL)
+        return;
+
+    setup.statistics->counts.code += counts.code;
+    setup.statistics->counts.comment += counts.comment;
+    setup.statistics->counts.blank += counts.blank;
+    setup.statistics->counts.directive += counts.directive;
+    setup.statistics->counts.functions += counts.functions;
+    setup.statistics->counts.includes += counts.includes;
+}
+
+void csource_counts_write(struct CSourceOutput *output, struct CSourceStatistics statistics) {
+    char payload[8 * 40 + 1];
+    struct CSourceRecord record;
+
+    liberror_is_null(csource_counts_write, output);
+
+    if(output->format == CSOURCE_FORMAT_TEXT) {
+        sprintf(payload, "{\"files\":%lu,\"lines\":%lu,\"code\":%lu,\"comment\":%lu,",
+                statistics.files, statistics.lines, statistics.counts.code,
+                statistics.counts.comment);
+        csource_output_span(output, payload, strlen(payload), 0, 0);
+
+        sprintf(payload, "\"blank\":%lu,\"directive\":%lu,\"functions\":%lu,\"includes\":%lu}\n",
+                statistics.counts.blank, statistics.counts.directive,
+                statistics.counts.functions, statistics.counts.includes);
+        csource_output_span(output, payload, strlen(payload), 0, 0);
+
+        return;
+    }
+
+    sprintf(payload, "files %lu lines %lu code %lu comment %lu blank %lu directive %lu "
+            "functions %lu includes %lu", statistics.files, statistics.lines,
+            statistics.counts.code, statistics.counts.comment, statistics.counts.blank,
+            statistics.counts.directive, statistics.counts.functions,
+            statistics.counts.includes);
+
+    record.kind = CSOURCE_RECORD_TOTALS;
+    record.line = 0;
+    record.offset = 0;
+    record.payload = payload;
+    record.length = strlen(payload);
+
+    csource_output_record(output, record);
+}
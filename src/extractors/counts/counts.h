@@ -0,0 +1,111 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_CSOURCE_EXTRACT_COUNTS_H
+#define CWARE_CSOURCE_EXTRACT_COUNTS_H
+
+#include <stdio.h>
+
+struct ModuleSetup;
+struct CSourceCounts;
+struct CSourceOutput;
+struct CSourceStatistics;
+
+/*
+ * @docgen: function
+ * @brief: count the code, comment, blank and directive lines of a file
+ * @name: csource_count_lines
+ *
+ * @description
+ * @Sort every line of a file into code, comment, blank or directive in a
+ * @single pass over its comments, and add them to a set of counts, along
+ * @with the inclusions. The last line of a file counts even if it has no
+ * @new line.
+ * @description
+ *
+ * @error: buffer is NULL
+ * @error: counts is NULL
+ *
+ * @param buffer: the source file
+ * @type: const char *
+ *
+ * @param length: the length of the source file
+ * @type: int
+ *
+ * @param counts: the counts to add to
+ * @type: struct CSourceCounts *
+*/
+void csource_count_lines(const char *buffer, int length, struct CSourceCounts *counts);
+
+/*
+ * @docgen: function
+ * @brief: count what a source file is made of
+ * @name: csource_extract_counts
+ *
+ * @description
+ * @Count the lines, function definitions and inclusions of a file, and
+ * @write them as a single counts record, of the form
+ * @"code N comment N blank N directive N functions N includes N". The
+ * @counts are also added to the statistics of the setup, if it has any.
+ * @description
+ *
+ * @param setup: the setup of the module
+ * @type: struct ModuleSetup
+*/
+void csource_extract_counts(struct ModuleSetup setup);
+
+/*
+ * @docgen: function
+ * @brief: write the counts of a whole run
+ * @name: csource_counts_write
+ *
+ * @description
+ * @Write the counts of every file of a run after their records. In the
+ * @text format, they are written as a line of JSON. In the other formats,
+ * @they are a single totals record, of the form "files N lines N code N
+ * @comment N blank N directive N functions N includes N".
+ * @description
+ *
+ * @param output: the record stream to write to
+ * @type: struct CSourceOutput *
+ *
+ * @param statistics: the statistics of the run
+ * @type: struct CSourceStatistics
+*/
+void csource_counts_write(struct CSourceOutput *output, struct CSourceStatistics statistics);
+
+#endif
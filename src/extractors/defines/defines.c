@@ -0,0 +1,431 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This is the component of csource which extracts macro definitions. The
+ * directives come from the same pass strip-directives uses, so definitions
+ * continued over many lines are read whole. Definitions can be kept in a
+ * hash table by name, which is how --lookup finds the definitions of one
+ * macro, and how prune knows what a macro is defined as.
+*/
+
+#include <string.h>
+
+#include "../../csource.h"
+#include "../../common/common.h"
+#include "../../output/output.h"
+#include "../../filters/directives/directives.h"
+
+#include "defines.h"
+
+/*
+ * @docgen: function
+ * @brief: skip the whitespace and continuations in a directive
+ * @name: skip_blanks
+ *
+ * @param buffer: the buffer the directive is in
+ * @type: const char *
+ *
+ * @param index: the index to start skipping at
+ * @type: int
+ *
+ * @param end: the index the directive ends at
+ * @type: int
+ *
+ * @return: the index of the next character that is not blank
+ * @type: int
+*/
+static int skip_blanks(const char *buffer, int index, int end) {
+    while(index < end) {
+        char character = buffer[index];
+
+        if(character == ' ' || character == '\t' || character == '\r' || character == '\f' ||
+           character == '\v' || character == '\n') {
+            index++;
+
+            continue;
+        }
+
+        /* A continuation is the same as whitespace here */
+        if(character == '\\' && index + 1 < end &&
+           (buffer[index + 1] == '\n' || buffer[index + 1] == '\r')) {
+            index++;
+
+            continue;
+        }
+
+        break;
+    }
+
+    return index;
+}
+
+/*
+ * @docgen: function
+ * @brief: skip an identifier
+ * @name: skip_identifier
+ *
+ * @param buffer: the buffer the identifier is in
+ * @type: const char *
+ *
+ * @param index: the index the identifier starts at
+ * @type: int
+ *
+ * @param end: the index the directive ends at
+ * @type: int
+ *
+ * @return: the index after the identifier, which is the index given if
+ * there is no identifier there
+ * @type: int
+*/
+static int skip_identifier(const char *buffer, int index, int end) {
+    if(index >= end || csource_is_identifier_start(buffer[index]) == 0)
+        return index;
+
+    while(index < end && csource_is_identifier_character(buffer[index]))
+        index++;
+
+    return index;
+}
+
+/*
+ * @docgen: function
+ * @brief: chain every definition into the buckets of a table again
+ * @name: rehash
+ *
+ * @param defines: the table to rehash
+ * @type: struct CSourceDefines *
+ *
+ * @param bucket_count: the new number of buckets, a power of two
+ * @type: int
+*/
+static void rehash(struct CSourceDefines *defines, int bucket_count) {
+    int index = 0;
+
+    csource_allocator.release(defines->buckets);
+    defines->buckets = csource_allocator.allocate(sizeof(int) * bucket_count);
+    defines->bucket_count = bucket_count;
+
+    for(index = 0; index < bucket_count; index++)
+        defines->buckets[index] = -1;
+
+    /* Adding them in order keeps the latest of each bucket first */
+    for(index = 0; index < defines->length; index++) {
+        struct CSourceDefine *define = defines->contents + index;
+        int bucket = csource_hash_name(define->name, define->name_length) & (bucket_count - 1);
+
+        define->next = defines->buckets[bucket];
+        defines->buckets[bucket] = index;
+    }
+}
+
+int csource_define_parse(const char *buffer, int start, int end, struct CSourceDefine *define) {
+    int index = start;
+    int keyword = 0;
+
+    liberror_is_null(csource_define_parse, buffer);
+    liberror_is_null(csource_define_parse, define);
+
+    INIT_VARIABLE(*define);
+
+    /* Get to the # the same way the directive was found */
+    while(index < end && buffer[index] != '#')
+        index++;
+
+    define->offset = index;
+    define->text = buffer + index;
+    index = skip_blanks(buffer, index + 1, end);
+    keyword = index;
+    index = skip_identifier(buffer, index, end);
+
+    if(index - keyword == 6 && strncmp(buffer + keyword, "define", 6) == 0)
+        define->kind = CSOURCE_DEFINE_OBJECT;
+    else if(index - keyword == 5 && strncmp(buffer + keyword, "undef", 5) == 0)
+        define->kind = CSOURCE_DEFINE_UNDEFINE;
+    else
+        return 0;
+
+    /* There must be something between the keyword and the name */
+    if(index == skip_blanks(buffer, index, end))
+        return 0;
+
+    define->name = buffer + (index = skip_blanks(buffer, index, end));
+    define->name_length = skip_identifier(buffer, index, end) - index;
+    index += define->name_length;
+
+    if(define->name_length == 0)
+        return 0;
+
+    /* Only a parenthesis right after the name makes a function-like
+     * macro. With a space first, it is the start of the body. */
+    if(define->kind == CSOURCE_DEFINE_OBJECT && index < end && buffer[index] == '(') {
+        const char *close = memchr(buffer + index, ')', end - index);
+
+        if(close == NULL)
+            return 0;
+
+        define->kind = CSOURCE_DEFINE_FUNCTION;
+        define->parameters = buffer + index + 1;
+        define->parameters_length = close - define->parameters;
+        index = close - buffer + 1;
+    }
+
+    index = skip_blanks(buffer, index, end);
+
+    /* The end of a DOS line is not part of the body */
+    while(end > index && (buffer[end - 1] == '\r' || buffer[end - 1] == ' ' ||
+                          buffer[end - 1] == '\t'))
+        end--;
+
+    define->body = buffer + index;
+    define->body_length = end - index;
+    define->length = end - define->offset;
+    define->next = -1;
+
+    return 1;
+}
+
+struct CSourceDefines *csource_defines_init(void) {
+    struct CSourceDefines *defines = carray_init(defines, DEFINE);
+
+    defines->buckets = NULL;
+    rehash(defines, CSOURCE_DEFINES_BUCKETS);
+
+    return defines;
+}
+
+void csource_defines_free(struct CSourceDefines *defines) {
+    liberror_is_null(csource_defines_free, defines);
+
+    csource_allocator.release(defines->buckets);
+    carray_free(defines, DEFINE);
+}
+
+void csource_defines_add(struct CSourceDefines *defines, struct CSourceDefine define) {
+    int bucket = 0;
+
+    liberror_is_null(csource_defines_add, defines);
+
+    carray_append(defines, define, DEFINE);
+
+    /* Keep the chains short by keeping a bucket per definition */
+    if(defines->length > defines->bucket_count) {
+        rehash(defines, defines->bucket_count * 2);
+
+        return;
+    }
+
+    bucket = csource_hash_name(define.name, define.name_length) & (defines->bucket_count - 1);
+    defines->contents[defines->length - 1].next = defines->buckets[bucket];
+    defines->buckets[bucket] = defines->length - 1;
+}
+
+/*
+ * @docgen: function
+ * @brief: find a definition of a name in a chain
+ * @name: find_in_chain
+ *
+ * @param defines: the table to search
+ * @type: const struct CSourceDefines *
+ *
+ * @param index: the definition to start searching at, or -1
+ * @type: int
+ *
+ * @param name: the name to find
+ * @type: const char *
+ *
+ * @param length: the length of the name
+ * @type: int
+ *
+ * @return: the index of the definition, or -1 if there is none
+ * @type: int
+*/
+static int find_in_chain(const struct CSourceDefines *defines, int index, const char *name,
+                         int length) {
+    for(; index != -1; index = defines->contents[index].next) {
+        const struct CSourceDefine *define = defines->contents + index;
+
+        if(define->name_length == length && memcmp(define->name, name, length) == 0)
+            return index;
+    }
+
+    return -1;
+}
+
+int csource_defines_lookup(const struct CSourceDefines *defines, const char *name, int length) {
+    int bucket = 0;
+
+    liberror_is_null(csource_defines_lookup, defines);
+    liberror_is_null(csource_defines_lookup, name);
+
+    bucket = csource_hash_name(name, length) & (defines->bucket_count - 1);
+
+    return find_in_chain(defines, defines->buckets[bucket], name, length);
+}
+
+int csource_defines_previous(const struct CSourceDefines *defines, int index) {
+    const struct CSourceDefine *define = NULL;
+
+    liberror_is_null(csource_defines_previous, defines);
+
+    define = defines->contents + index;
+
+    return find_in_chain(defines, define->next, define->name, define->name_length);
+}
+
+/*
+ * @docgen: function
+ * @brief: write a definition as a record
+ * @name: write_define
+ *
+ * @param output: the output to write to
+ * @type: struct CSourceOutput *
+ *
+ * @param define: the definition to write
+ * @type: struct CSourceDefine
+*/
+static void write_define(struct CSourceOutput *output, struct CSourceDefine define) {
+    struct CSourceRecord record;
+
+    record.kind = CSOURCE_RECORD_DEFINE;
+    record.line = define.line;
+    record.offset = define.offset;
+    record.payload = define.text;
+    record.length = define.length;
+
+    csource_output_record(output, record);
+}
+
+/*
+ * @docgen: structure
+ * @brief: the state of extracting definitions
+ * @name: DefinesExtractor
+ *
+ * @field setup: the setup of the module
+ * @type: struct ModuleSetup *
+ *
+ * @field defines: the table to add definitions to, or NULL to write them
+ * @type: struct CSourceDefines *
+*/
+struct DefinesExtractor {
+    struct ModuleSetup *setup;
+    struct CSourceDefines *defines;
+};
+
+/*
+ * @docgen: function
+ * @brief: write or keep a directive if it is a definition
+ * @name: extract_define
+ *
+ * @param visitor: the visitor of the defines extractor
+ * @type: struct CSourceDirectiveVisitor *
+ *
+ * @param start: the index the directive starts at
+ * @type: int
+ *
+ * @param end: the index the directive ends at
+ * @type: int
+ *
+ * @param line: the line the directive starts on
+ * @type: int
+*/
+static void extract_define(struct CSourceDirectiveVisitor *visitor, int start, int end, int line) {
+    struct CSourceDefine define;
+    struct DefinesExtractor *extractor = visitor->data;
+
+    if(csource_define_parse(extractor->setup->input.buffer, start, end, &define) == 0)
+        return;
+
+    if(define.kind == CSOURCE_DEFINE_UNDEFINE)
+        return;
+
+    define.line = line;
+
+    if(extractor->defines == NULL) {
+        write_define(extractor->setup->output, define);
+
+        return;
+    }
+
+    csource_defines_add(extractor->defines, define);
+}
+
+void csource_extract_defines(struct ModuleSetup setup) {
+    int index = 0;
+    int count = 0;
+    int total = 0;
+    int *found = NULL;
+    struct DefinesExtractor extractor;
+    struct CSourceDirectiveVisitor visitor;
+
+    extractor.setup = &setup;
+    extractor.defines = NULL;
+
+    visitor.code = NULL;
+    visitor.directive = extract_define;
+    visitor.data = &extractor;
+
+    /* Without a name to look up, every definition is written as it is
+     * found, and there is no need to keep them */
+    if(setup.lookup == NULL) {
+        csource_scan_directives(setup.input.buffer, setup.input.length, &visitor);
+
+        return;
+    }
+
+    extractor.defines = csource_defines_init();
+    csource_scan_directives(setup.input.buffer, setup.input.length, &visitor);
+
+    /* The chain goes from the latest definition back, so the definitions
+     * are gathered first to be written in the order of the file */
+    for(index = csource_defines_lookup(extractor.defines, setup.lookup, strlen(setup.lookup));
+        index != -1; index = csource_defines_previous(extractor.defines, index))
+        count++;
+
+    found = csource_allocator.allocate(sizeof(int) * (count + 1));
+    total = count;
+
+    for(index = csource_defines_lookup(extractor.defines, setup.lookup, strlen(setup.lookup));
+        index != -1; index = csource_defines_previous(extractor.defines, index))
+        found[--count] = index;
+
+    for(index = 0; index < total; index++)
+        write_define(setup.output, extractor.defines->contents[found[index]]);
+
+    csource_allocator.release(found);
+    csource_defines_free(extractor.defines);
+}
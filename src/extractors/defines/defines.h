@@ -0,0 +1,281 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_CSOURCE_EXTRACT_DEFINES_H
+#define CWARE_CSOURCE_EXTRACT_DEFINES_H
+
+/* Kinds of macro definitions */
+#define CSOURCE_DEFINE_OBJECT       0
+#define CSOURCE_DEFINE_FUNCTION     1
+#define CSOURCE_DEFINE_UNDEFINE     2
+#define CSOURCE_DEFINE_UNKNOWN      3
+
+/* Number of buckets a table starts with. This must be a power of two. */
+#define CSOURCE_DEFINES_BUCKETS     64
+
+/* Data structure properties */
+#define DEFINE_TYPE     struct CSourceDefine
+#define DEFINE_HEAP     1
+#define DEFINE_FREE(value)
+
+struct ModuleSetup;
+
+/*
+ * @docgen: structure
+ * @brief: a #define or #undef of a macro
+ * @name: CSourceDefine
+ *
+ * @description
+ * @A definition of a macro. Every string in it points into the source it
+ * @was read from, and is not NUL terminated.
+ * @description
+ *
+ * @field kind: the kind of definition (CSOURCE_DEFINE_*)
+ * @type: int
+ *
+ * @field line: the line the directive starts on
+ * @type: int
+ *
+ * @field offset: the byte offset of the # of the directive
+ * @type: long
+ *
+ * @field text: the whole directive, from its #
+ * @type: const char *
+ *
+ * @field length: the length of the directive
+ * @type: int
+ *
+ * @field name: the name of the macro
+ * @type: const char *
+ *
+ * @field name_length: the length of the name
+ * @type: int
+ *
+ * @field parameters: the parameters of a function-like macro, or NULL
+ * @type: const char *
+ *
+ * @field parameters_length: the length of the parameters
+ * @type: int
+ *
+ * @field body: the replacement of the macro, with continuations left in
+ * @type: const char *
+ *
+ * @field body_length: the length of the body
+ * @type: int
+ *
+ * @field next: the next definition in the same bucket, or -1
+ * @type: int
+*/
+struct CSourceDefine {
+    int kind;
+    int line;
+    long offset;
+    const char *text;
+    int length;
+
+    const char *name;
+    int name_length;
+    const char *parameters;
+    int parameters_length;
+    const char *body;
+    int body_length;
+
+    int next;
+};
+
+/*
+ * @docgen: structure
+ * @brief: every definition of a source file, indexed by name
+ * @name: CSourceDefines
+ *
+ * @description
+ * @The definitions are kept in the order they were added. Each is also
+ * @chained into a bucket by the hash of its name, with the latest first,
+ * @so finding the definitions of a name only looks at those in its bucket.
+ * @description
+ *
+ * @field length: the number of definitions
+ * @type: int
+ *
+ * @field capacity: the capacity of the definitions
+ * @type: int
+ *
+ * @field contents: the definitions, in the order they were added
+ * @type: struct CSourceDefine *
+ *
+ * @field buckets: the latest definition in each bucket, or -1
+ * @type: int *
+ *
+ * @field bucket_count: the number of buckets
+ * @type: int
+*/
+struct CSourceDefines {
+    int length;
+    int capacity;
+    struct CSourceDefine *contents;
+
+    int *buckets;
+    int bucket_count;
+};
+
+/*
+ * @docgen: function
+ * @brief: read a #define or #undef directive
+ * @name: csource_define_parse
+ *
+ * @description
+ * @Read the name, parameters and body out of a directive, as found by
+ * @csource_scan_directives. Continuations are treated as whitespace
+ * @between the parts of the directive.
+ * @description
+ *
+ * @error: buffer is NULL
+ * @error: define is NULL
+ *
+ * @param buffer: the buffer the directive is in
+ * @type: const char *
+ *
+ * @param start: the index the directive starts at
+ * @type: int
+ *
+ * @param end: the index the directive ends at
+ * @type: int
+ *
+ * @param define: the definition to fill in
+ * @type: struct CSourceDefine *
+ *
+ * @return: 1 if the directive is a #define or #undef, 0 if it is not
+ * @type: int
+*/
+int csource_define_parse(const char *buffer, int start, int end, struct CSourceDefine *define);
+
+/*
+ * @docgen: function
+ * @brief: create a new table of definitions
+ * @name: csource_defines_init
+ *
+ * @return: an empty table
+ * @type: struct CSourceDefines *
+*/
+struct CSourceDefines *csource_defines_init(void);
+
+/*
+ * @docgen: function
+ * @brief: release a table of definitions from memory
+ * @name: csource_defines_free
+ *
+ * @error: defines is NULL
+ *
+ * @param defines: the table to release
+ * @type: struct CSourceDefines *
+*/
+void csource_defines_free(struct CSourceDefines *defines);
+
+/*
+ * @docgen: function
+ * @brief: add a definition to a table
+ * @name: csource_defines_add
+ *
+ * @error: defines is NULL
+ *
+ * @param defines: the table to add to
+ * @type: struct CSourceDefines *
+ *
+ * @param define: the definition to add
+ * @type: struct CSourceDefine
+*/
+void csource_defines_add(struct CSourceDefines *defines, struct CSourceDefine define);
+
+/*
+ * @docgen: function
+ * @brief: find the latest definition of a name
+ * @name: csource_defines_lookup
+ *
+ * @error: defines is NULL
+ * @error: name is NULL
+ *
+ * @param defines: the table to search
+ * @type: const struct CSourceDefines *
+ *
+ * @param name: the name to find
+ * @type: const char *
+ *
+ * @param length: the length of the name
+ * @type: int
+ *
+ * @return: the index of the definition, or -1 if the name is not defined
+ * @type: int
+*/
+int csource_defines_lookup(const struct CSourceDefines *defines, const char *name, int length);
+
+/*
+ * @docgen: function
+ * @brief: find the definition of a name before another
+ * @name: csource_defines_previous
+ *
+ * @error: defines is NULL
+ *
+ * @param defines: the table to search
+ * @type: const struct CSourceDefines *
+ *
+ * @param index: the index of a definition
+ * @type: int
+ *
+ * @return: the index of the definition before it, or -1 if there is none
+ * @type: int
+*/
+int csource_defines_previous(const struct CSourceDefines *defines, int index);
+
+/*
+ * @docgen: function
+ * @brief: extract the macro definitions of a source file
+ * @name: csource_extract_defines
+ *
+ * @description
+ * @Write a define record for every #define in the source file, with the
+ * @whole directive (continuations included) as its payload, so the byte
+ * @range of a definition is its offset and the length of its payload. If
+ * @the setup has a name to look up, only the definitions of that name are
+ * @written.
+ * @description
+ *
+ * @param setup: the module setup to extract from and write to
+ * @type: struct ModuleSetup
+*/
+void csource_extract_defines(struct ModuleSetup setup);
+
+#endif
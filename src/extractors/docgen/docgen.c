@@ -0,0 +1,336 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This is the component of csource which extracts the docgen blocks that
+ * C-Ware projects document themselves with. The comments come from the
+ * same pass strip-comments uses, so only the comments that are actually
+ * comments (and not inside of strings) are looked at, and everything else
+ * is skipped over a word at a time.
+*/
+
+#include <string.h>
+
+#include "../../csource.h"
+#include "../../output/output.h"
+#include "../../filters/comments/comments.h"
+
+#include "docgen.h"
+
+/* The tag every docgen block has */
+#define DOCGEN_TAG  "@docgen:"
+
+/* The tags which span many lines, and end with themselves */
+static const char *sections[] = {
+    "description", "notes", "example", NULL
+};
+
+/*
+ * @docgen: structure
+ * @brief: the state of extracting docgen blocks
+ * @name: DocgenExtractor
+ *
+ * @field output: the output to write to
+ * @type: struct CSourceOutput *
+ *
+ * @field buffer: the buffer the source is in
+ * @type: const char *
+ *
+ * @field counted: the index lines have been counted up to
+ * @type: int
+ *
+ * @field line: the line of the index lines have been counted up to
+ * @type: int
+ *
+ * @field payload: the payload of the block being written
+ * @type: char *
+ *
+ * @field capacity: the capacity of the payload
+ * @type: int
+*/
+struct DocgenExtractor {
+    struct CSourceOutput *output;
+    const char *buffer;
+    int counted;
+    int line;
+
+    char *payload;
+    int capacity;
+};
+
+/*
+ * @docgen: function
+ * @brief: determine if a range of a buffer contains a string
+ * @name: contains
+ *
+ * @param buffer: the buffer to search
+ * @type: const char *
+ *
+ * @param start: the index to start searching at
+ * @type: int
+ *
+ * @param end: the index to stop searching at
+ * @type: int
+ *
+ * @param string: the string to search for
+ * @type: const char *
+ *
+ * @return: 1 if the string is in the range, 0 if it is not
+ * @type: int
+*/
+static int contains(const char *buffer, int start, int end, const char *string) {
+    const char *found = NULL;
+    int length = strlen(string);
+
+    while((found = memchr(buffer + start, string[0], end - start)) != NULL) {
+        start = found - buffer;
+
+        if(end - start >= length && memcmp(found, string, length) == 0)
+            return 1;
+
+        start++;
+    }
+
+    return 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: find the multi line section a tag opens or closes
+ * @name: find_section
+ *
+ * @param tag: the tag, without its @
+ * @type: const char *
+ *
+ * @param length: the length of the tag
+ * @type: int
+ *
+ * @return: the section, or NULL if the tag is not a section
+ * @type: const char *
+*/
+static const char *find_section(const char *tag, int length) {
+    int index = 0;
+
+    for(index = 0; sections[index] != NULL; index++) {
+        if((int) strlen(sections[index]) != length)
+            continue;
+
+        if(memcmp(sections[index], tag, length) == 0)
+            return sections[index];
+    }
+
+    return NULL;
+}
+
+/*
+ * @docgen: function
+ * @brief: add a line to the payload of a block
+ * @name: append_line
+ *
+ * @param extractor: the extractor with the payload
+ * @type: struct DocgenExtractor *
+ *
+ * @param length: the length of the payload so far
+ * @type: int *
+ *
+ * @param prefix: what to write before the line
+ * @type: const char *
+ *
+ * @param line: the line to add
+ * @type: const char *
+ *
+ * @param line_length: the length of the line
+ * @type: int
+*/
+static void append_line(struct DocgenExtractor *extractor, int *length, const char *prefix,
+                        const char *line, int line_length) {
+    int prefix_length = strlen(prefix);
+
+    memcpy(extractor->payload + *length, prefix, prefix_length);
+    memcpy(extractor->payload + *length + prefix_length, line, line_length);
+    *length += prefix_length + line_length;
+    extractor->payload[(*length)++] = '\n';
+}
+
+/*
+ * @docgen: function
+ * @brief: write a comment as a docgen record, if it is one
+ * @name: extract_block
+ *
+ * @description
+ * @Take the decoration off of each line of a comment, and write what is
+ * @left as a record. Each line loses the whitespace and * it starts with.
+ * @Lines inside of a multi line section are kept, with their @ taken off.
+ * @Outside of sections, only tags are kept.
+ * @description
+ *
+ * @param visitor: the visitor of the docgen extractor
+ * @type: struct CSourceCommentVisitor *
+ *
+ * @param start: the index the comment starts at
+ * @type: int
+ *
+ * @param end: the index after the end of the comment
+ * @type: int
+*/
+static void extract_block(struct CSourceCommentVisitor *visitor, int start, int end) {
+    int length = 0;
+    int index = start + 2;
+    const char *section = NULL;
+    const char *newline = NULL;
+    struct CSourceRecord record;
+    struct DocgenExtractor *extractor = visitor->data;
+    const char *buffer = extractor->buffer;
+
+    if(buffer[start + 1] != '*' || contains(buffer, start, end, DOCGEN_TAG) == 0)
+        return;
+
+    /* Leave the end delimiter out of the last line */
+    if(end - start >= 4 && buffer[end - 2] == '*' && buffer[end - 1] == '/')
+        end -= 2;
+
+    /* The payload is never more than a byte longer per line than the
+     * comment was, and a comment has at most one line per byte. */
+    if(extractor->capacity < (end - start) * 2 + 1) {
+        extractor->capacity = (end - start) * 2 + 1;
+        extractor->payload = csource_allocator.reallocate(extractor->payload,
+                                                          extractor->capacity);
+    }
+
+    while(index < end) {
+        int line_end = end;
+        const char *line = NULL;
+        int line_length = 0;
+
+        if((newline = memchr(buffer + index, '\n', end - index)) != NULL)
+            line_end = newline - buffer;
+
+        line = buffer + index;
+        line_length = line_end - index;
+        index = line_end + 1;
+
+        /* Strip the decoration at the start, and the end of DOS lines */
+        while(line_length > 0 && (*line == ' ' || *line == '\t')) {
+            line++;
+            line_length--;
+        }
+
+        if(line_length > 0 && *line == '*') {
+            line++;
+            line_length--;
+        }
+
+        while(line_length > 0 && (*line == ' ' || *line == '\t')) {
+            line++;
+            line_length--;
+        }
+
+        if(line_length > 0 && line[line_length - 1] == '\r')
+            line_length--;
+
+        if(line_length == 0)
+            continue;
+
+        if(*line != '@') {
+            if(section != NULL)
+                append_line(extractor, &length, "\t", line, line_length);
+
+            continue;
+        }
+
+        line++;
+        line_length--;
+
+        /* Inside of a section, every line is text until the section's
+         * own tag closes it */
+        if(section != NULL) {
+            if(find_section(line, line_length) == section)
+                section = NULL;
+            else
+                append_line(extractor, &length, "\t", line, line_length);
+
+            continue;
+        }
+
+        if((section = find_section(line, line_length)) != NULL) {
+            append_line(extractor, &length, "", line, line_length);
+            extractor->payload[length - 1] = ':';
+            extractor->payload[length++] = '\n';
+
+            continue;
+        }
+
+        if(memchr(line, ':', line_length) != NULL)
+            append_line(extractor, &length, "", line, line_length);
+    }
+
+    /* Lines are only counted up to the comments that are blocks */
+    while((newline = memchr(buffer + extractor->counted, '\n',
+                            start - extractor->counted)) != NULL) {
+        extractor->counted = newline - buffer + 1;
+        extractor->line++;
+    }
+
+    extractor->counted = start;
+
+    record.kind = CSOURCE_RECORD_DOCGEN;
+    record.line = extractor->line;
+    record.offset = start;
+    record.payload = extractor->payload;
+    record.length = length > 0 ? length - 1 : 0;
+
+    csource_output_record(extractor->output, record);
+}
+
+void csource_extract_docgen(struct ModuleSetup setup) {
+    struct DocgenExtractor extractor;
+    struct CSourceCommentVisitor visitor;
+
+    extractor.output = setup.output;
+    extractor.buffer = setup.input.buffer;
+    extractor.counted = 0;
+    extractor.line = 1;
+    extractor.payload = NULL;
+    extractor.capacity = 0;
+
+    visitor.code = NULL;
+    visitor.comment = extract_block;
+    visitor.data = &extractor;
+
+    csource_scan_comments(setup.input.buffer, setup.input.length, &visitor);
+    csource_allocator.release(extractor.payload);
+}
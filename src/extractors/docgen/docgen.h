@@ -0,0 +1,71 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_CSOURCE_EXTRACT_DOCGEN_H
+#define CWARE_CSOURCE_EXTRACT_DOCGEN_H
+
+struct ModuleSetup;
+
+/*
+ * @docgen: function
+ * @brief: extract the docgen blocks of a source file
+ * @name: csource_extract_docgen
+ *
+ * @description
+ * @Write a docgen record for every comment in the source file with a
+ * @docgen tag in it. The payload of the record is the block with the
+ * @comment decoration taken off: one 'tag: value' line per tag, and the
+ * @multi line sections (description, notes and example) as their name
+ * @followed by each of their lines indented with a tab.
+ * @description
+ *
+ * @example
+ * @docgen: function
+ * @brief: write a record to a record stream
+ * @name: csource_output_record
+ * @description:
+ * @	Write a single record to the stream.
+ * @param output: the stream to write to
+ * @type: struct CSourceOutput *
+ * @example
+ *
+ * @param setup: the module setup to extract from and write to
+ * @type: struct ModuleSetup
+*/
+void csource_extract_docgen(struct ModuleSetup setup);
+
+#endif
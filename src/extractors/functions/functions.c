@@ -39,19 +39,132 @@
  * This file contains logic for extracting functions from a C source file.
 */
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "../../csource.h"
+#include "../../common/common.h"
+#include "../../output/output.h"
+#include "../../filters/blank/blank.h"
 
-static void ignore_string(struct LibmatchCursor *cursor) {
+#include "functions.h"
 
+/*
+ * @docgen: function
+ * @brief: skip past a string or character constant
+ * @name: ignore_string
+ *
+ * @param cursor: the cursor just past the opening quote
+ * @type: struct LibmatchCursor *
+ *
+ * @param quote: the quote that closes the string
+ * @type: int
+*/
+static void ignore_string(struct LibmatchCursor *cursor, int quote) {
+    int character = -1;
+
+    while((character = libmatch_cursor_getch(cursor)) != LIBMATCH_EOF) {
+        /* Whatever is escaped cannot close the string */
+        if(character == '\\') {
+            libmatch_cursor_getch(cursor);
+
+            continue;
+        }
+
+        if(character == quote)
+            return;
+    }
 }
 
-void csource_extract_functions(struct ModuleSetup setup) {
+/*
+ * @docgen: function
+ * @brief: determine whether a declaration starts an old style definition
+ * @name: is_old_style
+ *
+ * @description
+ * @Determine whether a statement ending in a ; is the start of an old
+ * @style definition, like int f(a, b) int a, which has a list of names
+ * @for parameters, followed by the declaration of one of them.
+ * @description
+ *
+ * @param line: the statement, without its ;
+ * @type: const char *
+ *
+ * @return: 1 if it is the start of an old style definition, 0 if not
+ * @type: int
+*/
+static int is_old_style(const char *line) {
+    const char *cursor = strchr(line, '(');
+
+    if(cursor == NULL)
+        return 0;
+
+    do {
+        const char *name = NULL;
+
+        for(cursor++; *cursor != '\0' && strchr(LIBMATCH_WHITESPACE, *cursor) != NULL; cursor++)
+            continue;
+
+        if(csource_is_identifier_start(*cursor) == 0)
+            return 0;
+
+        for(name = cursor; csource_is_identifier_character(*cursor); cursor++)
+            continue;
+
+        /* (void) is the list of a prototype */
+        if(cursor - name == 4 && strncmp(name, "void", 4) == 0)
+            return 0;
+
+        while(*cursor != '\0' && strchr(LIBMATCH_WHITESPACE, *cursor) != NULL)
+            cursor++;
+    } while(*cursor == ',');
+
+    if(*cursor != ')')
+        return 0;
+
+    for(cursor++; *cursor != '\0' && strchr(LIBMATCH_WHITESPACE, *cursor) != NULL; cursor++)
+        continue;
+
+    return csource_is_identifier_start(*cursor);
+}
+
+/*
+ * @docgen: function
+ * @brief: find the body of an old style definition
+ * @name: find_body
+ *
+ * @description
+ * @Find the { that ends the declarations of the parameters of an old
+ * @style definition. An initializer or a } found first means the names
+ * @were not parameters after all.
+ * @description
+ *
+ * @param cursor: the cursor just past the first declaration
+ * @type: struct LibmatchCursor
+ *
+ * @return: the index of the {, or -1 if there is none
+ * @type: int
+*/
+static int find_body(struct LibmatchCursor cursor) {
+    int index = 0;
+
+    for(index = cursor.cursor; index < cursor.length; index++) {
+        if(cursor.buffer[index] == '{')
+            return index;
+
+        if(cursor.buffer[index] == '=' || cursor.buffer[index] == '}')
+            return -1;
+    }
+
+    return -1;
+}
+
+void csource_scan_functions(struct LibmatchCursor input, struct CSourceFunctionVisitor *visitor) {
     int depth = 0;
-    FILE *source_file = setup.file;
     struct LibmatchCursor sub_cursor;
-    struct LibmatchCursor cursor = libmatch_cursor_from_stream(source_file);
+    struct LibmatchCursor cursor = input;
+
+    liberror_is_null(csource_scan_functions, visitor);
 
     INIT_VARIABLE(sub_cursor);
 
@@ -59,12 +172,16 @@ void csource_extract_functions(struct ModuleSetup setup) {
      * is exhausted. */
     while(cursor.cursor < cursor.length) {
         char *line = NULL;
+        const char *payload = NULL;
         int character = -1;
+        int length = 0;
+        int body = -1;
+        struct CSourceRecord record;
 
         character = libmatch_cursor_getch(&cursor);
 
-        if(character == '"') {
-            ignore_string(&cursor);
+        if(character == '"' || character == '\'') {
+            ignore_string(&cursor, character);
 
             continue;
         }
@@ -86,9 +203,10 @@ void csource_extract_functions(struct ModuleSetup setup) {
         if(depth != 0)
             continue;
 
-        /* Remove those nasty preprocessor directives */
-        if(character == '#')
-            continue;
+        /* The character just read can be the first of the declaration,
+         * when nothing comes before it on its line */
+        if(character != '\0' && strchr(LIBMATCH_ALPHA "_", character) != NULL)
+            libmatch_cursor_ungetch(&cursor);
 
         /* Read until a '{' or ';', and then go back a character
          * so we can examine whether or not its a declaration or body, so
@@ -96,44 +214,121 @@ void csource_extract_functions(struct ModuleSetup setup) {
         libmatch_cursor_enable_pushback(&cursor);
         libmatch_until(&cursor, LIBMATCH_ALPHA "_");
 
+        INIT_VARIABLE(record);
+
+        record.kind = CSOURCE_RECORD_FUNCTION;
+        record.line = cursor.line + 1;
+        record.offset = cursor.cursor;
+
         line = libmatch_read_alloc_until(&cursor, ";{");
         character = libmatch_cursor_getch(&cursor);
         sub_cursor = libmatch_cursor_init(line, strlen(line));
 
         libmatch_cursor_disable_pushback(&cursor);
 
+        /* The parameters of an old style definition are declared between
+         * their names and the body, which all belong to the definition */
+        if(character == ';' && is_old_style(line) == 1 && (body = find_body(cursor)) != -1) {
+            while(cursor.cursor < body)
+                libmatch_cursor_getch(&cursor);
+
+            character = libmatch_cursor_getch(&cursor);
+        }
+
+        /* Whatever the statement turns out to be, its brace opens a scope
+         * which has to close before file scope is back, like the body of
+         * a structure, or the initializer of an array. */
+        if(character == '{')
+            depth++;
+
         /* If the line has an equals sign (this is a possibility, because
          * 'static int x = (1 + (2 + 3));' will still be matched by this
          * algorithm so far), then we dispose of this line. */
-        if(strchr(line, '=') != NULL)
+        if(strchr(line, '=') != NULL) {
+            libmatch_free_hook(line);
+
             continue;
+        }
 
         /* Next, let's rip other non-function declarations out. */
-        if(strchr(line, '(') == NULL)
+        if(strchr(line, '(') == NULL) {
+            libmatch_free_hook(line);
+
             continue;
+        }
 
         /* By this point, typedefs can also get caught in our net, so
          * we must be rid of them. */
-        if(libmatch_string_expect(&sub_cursor, "typedef") == 1)
+        if(libmatch_string_expect(&sub_cursor, "typedef") == 1) {
+            libmatch_free_hook(line);
+
             continue;
+        }
 
         /* Get rid of arrays declared in the global scope, like:
          * int x[123 + (53 + 1)]; */
-        if(strchr(line, '[') != NULL && libmatch_cond_before(&sub_cursor, '(', "[") == 0)
+        if(strchr(line, '[') != NULL && libmatch_cond_before(&sub_cursor, '(', "[") == 0) {
+            libmatch_free_hook(line);
+
             continue;
+        }
 
-        /* We only need to increase the depth if we are about to enter a
-         * function body next. We still may consider this a */
-        if(character == '{')
-            depth++;
+        /* The declaration is followed by whitespace before the body */
+        payload = line;
+        length = strlen(line);
+
+        if(body != -1) {
+            payload = cursor.buffer + record.offset;
+            length = body - record.offset;
+        }
 
-        printf("Line: %i\n", cursor.line + 1);
-        printf("Line: '%s'\n", line);
+        while(length > 0 && strchr(LIBMATCH_WHITESPACE, payload[length - 1]) != NULL)
+            length--;
+
+        record.payload = payload;
+        record.length = length;
+
+        visitor->function(visitor, record, character == '{');
+        libmatch_free_hook(line);
     }
+}
+
+/*
+ * @docgen: function
+ * @brief: write a function as a record
+ * @name: write_function
+ *
+ * @param visitor: the visitor of the functions extractor
+ * @type: struct CSourceFunctionVisitor *
+ *
+ * @param record: the record of the function
+ * @type: struct CSourceRecord
+ *
+ * @param definition: whether the function has a body
+ * @type: int
+*/
+static void write_function(struct CSourceFunctionVisitor *visitor, struct CSourceRecord record,
+                           int definition) {
+    struct ModuleSetup *setup = visitor->data;
+
+    /* The blanked file keeps every offset, so the declaration is written
+     * as it is in the file */
+    record.payload = setup->input.buffer + record.offset;
+
+    csource_output_record(setup->output, record);
+}
+
+void csource_extract_functions(struct ModuleSetup setup) {
+    char *code = NULL;
+    struct CSourceFunctionVisitor visitor;
+
+    code = csource_blank(setup.input.buffer, setup.input.length);
 
+    visitor.function = write_function;
+    visitor.data = &setup;
 
-    fclose(source_file);
-    libmatch_cursor_free(&cursor);
+    csource_scan_functions(libmatch_cursor_init(code, setup.input.length), &visitor);
+    csource_allocator.release(code);
 }
 
 
@@ -38,8 +38,61 @@
 #ifndef CWARE_CSOURCE_EXTRACT_FUNCTIONS_H
 #define CWARE_CSOURCE_EXTRACT_FUNCTIONS_H
 
+#include "../../output/output.h"
+
 struct ModuleSetup;
 
+/*
+ * @docgen: structure
+ * @brief: what to do with the functions of a source file
+ * @name: CSourceFunctionVisitor
+ *
+ * @field function: called with each function, and whether it has a body
+ * @type: void (*)(struct CSourceFunctionVisitor *, struct CSourceRecord, int)
+ *
+ * @field data: whatever the callback needs
+ * @type: void *
+*/
+struct CSourceFunctionVisitor {
+    void (*function)(struct CSourceFunctionVisitor *visitor, struct CSourceRecord record,
+                     int definition);
+    void *data;
+};
+
+/*
+ * @docgen: function
+ * @brief: find the functions of a source file
+ * @name: csource_scan_functions
+ *
+ * @description
+ * @Walk a source file once, and give every function declared or defined
+ * @at file scope to a visitor, as the record the functions extractor
+ * @writes for it. The payload of the record is only valid during the
+ * @callback. The payload of an old style definition goes on to the
+ * @declarations of its parameters, up to its body.
+ * @
+ * @The file has to be blanked by csource_blank first, as comments and
+ * @directives are read as code otherwise.
+ * @description
+ *
+ * @error: visitor is NULL
+ *
+ * @param input: the blanked source file
+ * @type: struct LibmatchCursor
+ *
+ * @param visitor: the visitor to give the functions to
+ * @type: struct CSourceFunctionVisitor *
+*/
+void csource_scan_functions(struct LibmatchCursor input, struct CSourceFunctionVisitor *visitor);
+
+/*
+ * @docgen: function
+ * @brief: extract the functions of a source file
+ * @name: csource_extract_functions
+ *
+ * @param setup: the setup of the module
+ * @type: struct ModuleSetup
+*/
 void csource_extract_functions(struct ModuleSetup setup);
 
 #endif
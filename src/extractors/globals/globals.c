@@ -0,0 +1,160 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file writes the variables a source file declares at file scope,
+ * which the tags extractor finds in its walk over the declarations of the
+ * file. They are given to it in the order they are declared in, so their
+ * lines are counted as they come.
+*/
+
+#include <string.h>
+
+#include "../../csource.h"
+#include "../../output/output.h"
+#include "../tags/tags.h"
+
+#include "globals.h"
+
+/*
+ * @docgen: structure
+ * @brief: the state of writing the variables of a file
+ * @name: GlobalWriter
+ *
+ * @field setup: the setup of the module
+ * @type: struct ModuleSetup *
+ *
+ * @field line: the line the cursor is on
+ * @type: int
+ *
+ * @field cursor: the index the lines are counted up to
+ * @type: int
+*/
+struct GlobalWriter {
+    struct ModuleSetup *setup;
+    int line;
+    int cursor;
+};
+
+static const char *storage_names[] = {
+    "none", "static", "extern"
+};
+
+const char *csource_storage_name(int storage) {
+    if(storage < CSOURCE_STORAGE_NONE || storage > CSOURCE_STORAGE_EXTERN)
+        return "unknown";
+
+    return storage_names[storage];
+}
+
+/*
+ * @docgen: function
+ * @brief: write a variable of the file
+ * @name: write_global
+ *
+ * @param visitor: the visitor of the variables
+ * @type: struct CSourceTagVisitor *
+ *
+ * @param variable: the variable
+ * @type: struct CSourceVariable *
+*/
+static void write_global(struct CSourceTagVisitor *visitor, struct CSourceVariable *variable) {
+    int length = 0;
+    char prefix[64 + 1];
+    char suffix[64 + 1];
+    struct CSourceRecord record;
+    struct GlobalWriter *writer = visitor->data;
+    struct ModuleSetup *setup = writer->setup;
+    const char *buffer = setup->input.buffer;
+
+    for(; writer->cursor < variable->start; writer->cursor++) {
+        if(buffer[writer->cursor] == '\n')
+            writer->line++;
+    }
+
+    sprintf(suffix, "\t%s\t%s\t%s", csource_storage_name(variable->storage),
+            variable->array == 1 ? "array" : "scalar",
+            variable->initialized == 1 ? "initialized" : "uninitialized");
+
+    if(setup->output->format != CSOURCE_FORMAT_TEXT) {
+        char *payload = NULL;
+
+        length = variable->end - variable->start;
+        payload = csource_allocator.allocate(length + strlen(suffix) + 1);
+
+        memcpy(payload, buffer + variable->start, length);
+        strcpy(payload + length, suffix);
+
+        INIT_VARIABLE(record);
+
+        record.kind = CSOURCE_RECORD_GLOBAL;
+        record.line = writer->line;
+        record.offset = variable->start;
+        record.payload = payload;
+        record.length = length + strlen(suffix);
+
+        csource_output_record(setup->output, record);
+        csource_allocator.release(payload);
+
+        return;
+    }
+
+    sprintf(prefix, "%i\t\t", writer->line);
+    strcat(suffix, "\n");
+
+    csource_output_span(setup->output, prefix, strlen(prefix), variable->start, writer->line);
+    csource_output_span(setup->output, buffer + variable->start, variable->end - variable->start,
+                        variable->start, writer->line);
+    csource_output_span(setup->output, suffix, strlen(suffix), variable->start, writer->line);
+}
+
+void csource_extract_globals(struct ModuleSetup setup) {
+    struct GlobalWriter writer;
+    struct CSourceTagVisitor visitor;
+
+    INIT_VARIABLE(writer);
+
+    writer.setup = &setup;
+    writer.line = 1;
+
+    visitor.tag = NULL;
+    visitor.type = NULL;
+    visitor.variable = write_global;
+    visitor.data = &writer;
+
+    csource_scan_tags(setup.input.buffer, setup.input.length, &visitor);
+}
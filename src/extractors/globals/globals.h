@@ -0,0 +1,74 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_CSOURCE_EXTRACT_GLOBALS_H
+#define CWARE_CSOURCE_EXTRACT_GLOBALS_H
+
+struct ModuleSetup;
+
+/*
+ * @docgen: function
+ * @brief: find the name of a storage class
+ * @name: csource_storage_name
+ *
+ * @param storage: the storage class (CSOURCE_STORAGE_*)
+ * @type: int
+ *
+ * @return: none, static, extern, or unknown
+ * @type: const char *
+*/
+const char *csource_storage_name(int storage);
+
+/*
+ * @docgen: function
+ * @brief: write the variables a source file declares at file scope
+ * @name: csource_extract_globals
+ *
+ * @description
+ * @Write every variable a source file declares or defines at file scope,
+ * @in the order they are declared in. Each one is written as its name, its
+ * @storage class, whether it is an array or a scalar, and whether it is
+ * @initialized, separated by tabs. The variables are found by
+ * @csource_scan_tags, in the same walk as tags.
+ * @description
+ *
+ * @param setup: the setup of the module
+ * @type: struct ModuleSetup
+*/
+void csource_extract_globals(struct ModuleSetup setup);
+
+#endif
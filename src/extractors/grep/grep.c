@@ -0,0 +1,586 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file implements the grep command, which finds where identifiers
+ * are used in the code of a file. Plain text searches find the places an
+ * identifier could be used in first, and the file is only lexed when
+ * there are some, so that most files of a large tree are never lexed.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../csource.h"
+#include "../../common/common.h"
+#include "../../output/output.h"
+#include "../../filters/blank/blank.h"
+#include "../../filters/directives/directives.h"
+
+#include "grep.h"
+
+#define is_blank(character)                                             \
+    ((character) == ' ' || (character) == '\t' || (character) == '\n' || \
+     (character) == '\r' || (character) == '\f' || (character) == '\v')
+
+/*
+ * @docgen: structure
+ * @brief: the state of a search through the code of a file
+ * @name: GrepSearch
+ *
+ * @field setup: the setup of the module
+ * @type: struct ModuleSetup *
+ *
+ * @field code: the file, with its comments and strings blanked
+ * @type: const char *
+ *
+ * @field candidates: the places the identifiers could be used in
+ * @type: struct CSourceCandidates *
+ *
+ * @field next: the next candidate to check
+ * @type: int
+ *
+ * @field depth: how many braces the search is inside of
+ * @type: int
+ *
+ * @field body: whether the outermost braces are the body of a function
+ * @type: int
+ *
+ * @field last: the last character of the runs so far that is not blank
+ * @type: int
+ *
+ * @field line: the line the search has counted up to
+ * @type: int
+ *
+ * @field line_start: the offset that line starts at
+ * @type: int
+ *
+ * @field counted: the offset the lines have been counted up to
+ * @type: int
+ *
+ * @field written: the last line that was written, or 0
+ * @type: int
+*/
+struct GrepSearch {
+    struct ModuleSetup *setup;
+    const char *code;
+    struct CSourceCandidates *candidates;
+    int next;
+    int depth;
+    int body;
+    int last;
+    int line;
+    int line_start;
+    int counted;
+    int written;
+};
+
+/*
+ * @docgen: function
+ * @brief: order candidates by their offset
+ * @name: compare_candidates
+ *
+ * @param first: the first candidate
+ * @type: const void *
+ *
+ * @param second: the second candidate
+ * @type: const void *
+ *
+ * @return: less than, equal to or greater than 0, like strcmp
+ * @type: int
+*/
+static int compare_candidates(const void *first, const void *second) {
+    const struct CSourceCandidate *left = first;
+    const struct CSourceCandidate *right = second;
+
+    return (left->offset > right->offset) - (left->offset < right->offset);
+}
+
+/*
+ * @docgen: function
+ * @brief: find every whole word of a file that is an identifier
+ * @name: find_candidates
+ *
+ * @description
+ * @Find the places in a file an identifier could be used in, without
+ * @knowing anything of C. Only the first character of the identifier is
+ * @looked for byte by byte, by memchr, which is much faster than lexing.
+ * @description
+ *
+ * @param buffer: the file to search
+ * @type: const char *
+ *
+ * @param length: the length of the file
+ * @type: int
+ *
+ * @param identifier: the identifier to look for
+ * @type: const char *
+ *
+ * @param candidates: the array to add the candidates to
+ * @type: struct CSourceCandidates *
+*/
+static void find_candidates(const char *buffer, int length, const char *identifier,
+                            struct CSourceCandidates *candidates) {
+    int size = strlen(identifier);
+    const char *cursor = buffer;
+    const char *end = buffer + length;
+
+    while(end - cursor >= size &&
+          (cursor = memchr(cursor, identifier[0], (end - cursor) - size + 1)) != NULL) {
+        struct CSourceCandidate candidate;
+
+        candidate.offset = cursor - buffer;
+        candidate.length = size;
+        cursor++;
+
+        if(memcmp(buffer + candidate.offset, identifier, size) != 0)
+            continue;
+
+        /* Only whole words are identifiers */
+        if(candidate.offset > 0 && csource_is_identifier_character(buffer[candidate.offset - 1]))
+            continue;
+
+        if(candidate.offset + size < length &&
+           csource_is_identifier_character(buffer[candidate.offset + size]))
+            continue;
+
+        carray_append(candidates, candidate, CANDIDATE);
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: find the last character of code before an index
+ * @name: last_character
+ *
+ * @param search: the search to look in
+ * @type: struct GrepSearch *
+ *
+ * @param run: the index the run of code the index is in starts at
+ * @type: int
+ *
+ * @param index: the index to look before
+ * @type: int
+ *
+ * @return: the last character that is not blank, or 0 if there is none
+ * @type: int
+*/
+static int last_character(struct GrepSearch *search, int run, int index) {
+    while(index > run) {
+        index--;
+
+        if(is_blank(search->code[index]) == 0)
+            return search->code[index];
+    }
+
+    /* Directives do not count, so this is from the runs before */
+    return search->last;
+}
+
+/*
+ * @docgen: function
+ * @brief: follow the braces of a run of code
+ * @name: count_braces
+ *
+ * @description
+ * @Keep track of how deep in braces the search is, and of whether the
+ * @outermost braces are the body of a function. Those are the only braces
+ * @at the top level which follow the ) of a parameter list. Without a
+ * @scope, none of this is needed.
+ * @description
+ *
+ * @param search: the search to keep track in
+ * @type: struct GrepSearch *
+ *
+ * @param run: the index the run of code starts at
+ * @type: int
+ *
+ * @param start: the index to start at
+ * @type: int
+ *
+ * @param end: the index to stop before
+ * @type: int
+*/
+static void count_braces(struct GrepSearch *search, int run, int start, int end) {
+    if(search->setup->scope == CSOURCE_SCOPE_ANY)
+        return;
+
+    /* The copy ends with a NUL, so strcspn never runs off of it */
+    for(; start < end; start++) {
+        start += strcspn(search->code + start, "{}");
+
+        if(start >= end)
+            break;
+
+        if(search->code[start] == '}') {
+            if(search->depth > 0)
+                search->depth--;
+
+            continue;
+        }
+
+        if(search->depth == 0)
+            search->body = last_character(search, run, start) == ')';
+
+        search->depth++;
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: write the line a use is on
+ * @name: write_match
+ *
+ * @param search: the search the use was found in
+ * @type: struct GrepSearch *
+ *
+ * @param offset: the offset of the use
+ * @type: int
+*/
+static void write_match(struct GrepSearch *search, int offset) {
+    int end = 0;
+    char number[64 + 1];
+    const char *newline = NULL;
+    struct CSourceRecord record;
+    const char *buffer = search->setup->input.buffer;
+    int length = search->setup->input.length;
+
+    /* Uses are found in order, so lines are counted from the last one,
+     * and nothing before it is counted again, however long its line */
+    while((newline = memchr(buffer + search->counted, '\n', offset - search->counted)) != NULL) {
+        search->line++;
+        search->line_start = newline - buffer + 1;
+        search->counted = search->line_start;
+    }
+
+    search->counted = offset;
+
+    /* A line is only written once, however many uses are on it */
+    if(search->line == search->written)
+        return;
+
+    search->written = search->line;
+
+    if((newline = memchr(buffer + offset, '\n', length - offset)) == NULL)
+        end = length;
+    else
+        end = newline - buffer;
+
+    if(end > search->line_start && buffer[end - 1] == '\r')
+        end--;
+
+    if(search->setup->output->format != CSOURCE_FORMAT_TEXT) {
+        INIT_VARIABLE(record);
+
+        record.kind = CSOURCE_RECORD_MATCH;
+        record.line = search->line;
+        record.offset = offset;
+        record.payload = buffer + search->line_start;
+        record.length = end - search->line_start;
+
+        csource_output_record(search->setup->output, record);
+
+        return;
+    }
+
+    sprintf(number, ":%i:", search->line);
+
+    csource_output_span(search->setup->output, search->setup->source,
+                        strlen(search->setup->source), offset, search->line);
+    csource_output_span(search->setup->output, number, strlen(number), offset, search->line);
+    csource_output_span(search->setup->output, buffer + search->line_start,
+                        end - search->line_start, offset, search->line);
+    csource_output_span(search->setup->output, "\n", 1, offset, search->line);
+}
+
+/*
+ * @docgen: function
+ * @brief: write a candidate if it is a use in the right scope
+ * @name: check_candidate
+ *
+ * @param search: the search the candidate was found in
+ * @type: struct GrepSearch *
+ *
+ * @param candidate: the candidate to check
+ * @type: struct CSourceCandidate
+*/
+static void check_candidate(struct GrepSearch *search, struct CSourceCandidate candidate) {
+    int inside = search->depth > 0 && search->body == 1;
+
+    /* Whatever was in a comment or a string has been blanked */
+    if(memcmp(search->code + candidate.offset, search->setup->input.buffer + candidate.offset,
+              candidate.length) != 0)
+        return;
+
+    if(search->setup->scope == CSOURCE_SCOPE_FUNCTION && inside == 0)
+        return;
+
+    if(search->setup->scope == CSOURCE_SCOPE_TOP && inside == 1)
+        return;
+
+    write_match(search, candidate.offset);
+}
+
+/*
+ * @docgen: function
+ * @brief: check the candidates in a run of code
+ * @name: search_code
+ *
+ * @param visitor: the visitor of the directives
+ * @type: struct CSourceDirectiveVisitor *
+ *
+ * @param start: the index the run starts at
+ * @type: int
+ *
+ * @param end: the index the run ends at
+ * @type: int
+ *
+ * @param line: the line the run starts on
+ * @type: int
+*/
+static void search_code(struct CSourceDirectiveVisitor *visitor, int start, int end, int line) {
+    int index = start;
+    struct GrepSearch *search = visitor->data;
+    struct CSourceCandidates *candidates = search->candidates;
+
+    for(; search->next < candidates->length; search->next++) {
+        struct CSourceCandidate candidate = candidates->contents[search->next];
+
+        if(candidate.offset >= end)
+            break;
+
+        count_braces(search, start, index, candidate.offset);
+        check_candidate(search, candidate);
+        index = candidate.offset;
+    }
+
+    count_braces(search, start, index, end);
+
+    if(search->setup->scope != CSOURCE_SCOPE_ANY)
+        search->last = last_character(search, start, end);
+}
+
+/*
+ * @docgen: function
+ * @brief: check the candidates in a directive
+ * @name: search_directive
+ *
+ * @description
+ * @Check the candidates in a directive, other than its name. Nothing in
+ * @an inclusion is code, and the braces in a directive are not counted,
+ * @since there is no telling where the macro they are in is used.
+ * @description
+ *
+ * @param visitor: the visitor of the directives
+ * @type: struct CSourceDirectiveVisitor *
+ *
+ * @param start: the index the directive starts at
+ * @type: int
+ *
+ * @param end: the index the directive ends at
+ * @type: int
+ *
+ * @param line: the line the directive starts on
+ * @type: int
+*/
+static void search_directive(struct CSourceDirectiveVisitor *visitor, int start, int end,
+                             int line) {
+    int length = 0;
+    int name = 0;
+    struct GrepSearch *search = visitor->data;
+    struct CSourceCandidates *candidates = search->candidates;
+
+    name = csource_directive_name(search->code, start, end, &length);
+
+    for(; search->next < candidates->length; search->next++) {
+        struct CSourceCandidate candidate = candidates->contents[search->next];
+
+        if(candidate.offset >= end)
+            break;
+
+        if(candidate.offset == name)
+            continue;
+
+        if(length == 7 && strncmp(search->code + name, "include", 7) == 0)
+            continue;
+
+        check_candidate(search, candidate);
+    }
+}
+
+int csource_grep_scope(const char *name) {
+    liberror_is_null(csource_grep_scope, name);
+
+    if(strcmp(name, "function") == 0)
+        return CSOURCE_SCOPE_FUNCTION;
+
+    if(strcmp(name, "top") == 0)
+        return CSOURCE_SCOPE_TOP;
+
+    return -1;
+}
+
+/*
+ * @docgen: function
+ * @brief: check the candidates of a file against its code
+ * @name: search_file
+ *
+ * @param setup: the setup of the module
+ * @type: struct ModuleSetup *
+ *
+ * @param code: the file up to the end of the last candidate, blanked
+ * @type: const char *
+ *
+ * @param end: the length of the code
+ * @type: int
+ *
+ * @param candidates: the candidates, in the order they appear
+ * @type: struct CSourceCandidates *
+*/
+static void search_file(struct ModuleSetup *setup, const char *code, int end,
+                        struct CSourceCandidates *candidates) {
+    struct GrepSearch search;
+    struct CSourceDirectiveVisitor visitor;
+
+    INIT_VARIABLE(search);
+
+    search.setup = setup;
+    search.code = code;
+    search.candidates = candidates;
+    search.line = 1;
+
+    visitor.code = search_code;
+    visitor.directive = search_directive;
+    visitor.data = &search;
+
+    csource_scan_directives(code, end, &visitor);
+}
+
+void csource_extract_grep(struct ModuleSetup setup) {
+    int index = 0;
+    int end = 0;
+    char *code = NULL;
+    struct CSourceCandidates *candidates = NULL;
+
+    if(setup.identifiers == NULL)
+        return;
+
+    candidates = carray_init(candidates, CANDIDATE);
+
+    for(index = 0; setup.identifiers[index] != NULL; index++) {
+        find_candidates(setup.input.buffer, setup.input.length, setup.identifiers[index],
+                        candidates);
+    }
+
+    /* Most files of a tree never get past here */
+    if(candidates->length == 0) {
+        carray_free(candidates, CANDIDATE);
+
+        return;
+    }
+
+    if(index > 1)
+        qsort(candidates->contents, candidates->length, sizeof(*candidates->contents),
+              compare_candidates);
+
+    /* Nothing after the last candidate needs to be lexed */
+    for(index = 0; index < candidates->length; index++) {
+        if(candidates->contents[index].offset + candidates->contents[index].length > end)
+            end = candidates->contents[index].offset + candidates->contents[index].length;
+    }
+
+    code = csource_allocator.allocate(end + 1);
+    memcpy(code, setup.input.buffer, end);
+    code[end] = '\0';
+
+    csource_blank_comments(code, end);
+    search_file(&setup, code, end, candidates);
+
+    csource_allocator.release(code);
+    carray_free(candidates, CANDIDATE);
+}
+
+void csource_extract_grep_reference(struct ModuleSetup setup) {
+    int index = 0;
+    char *code = NULL;
+    int length = setup.input.length;
+    struct CSourceCandidates *candidates = NULL;
+
+    if(setup.identifiers == NULL)
+        return;
+
+    code = csource_allocator.allocate(length + 1);
+    memcpy(code, setup.input.buffer, length);
+    code[length] = '\0';
+
+    csource_blank_comments(code, length);
+    candidates = carray_init(candidates, CANDIDATE);
+
+    /* Every identifier of the code is a candidate if it is looked for */
+    while(index < length) {
+        int name = 0;
+        struct CSourceCandidate candidate;
+
+        if(csource_is_identifier_character(code[index]) == 0) {
+            index++;
+
+            continue;
+        }
+
+        candidate.offset = index;
+
+        while(index < length && csource_is_identifier_character(code[index]))
+            index++;
+
+        candidate.length = index - candidate.offset;
+
+        for(name = 0; setup.identifiers[name] != NULL; name++) {
+            if((int) strlen(setup.identifiers[name]) != candidate.length ||
+               strncmp(code + candidate.offset, setup.identifiers[name], candidate.length) != 0)
+                continue;
+
+            carray_append(candidates, candidate, CANDIDATE);
+
+            break;
+        }
+    }
+
+    search_file(&setup, code, length, candidates);
+
+    csource_allocator.release(code);
+    carray_free(candidates, CANDIDATE);
+}
@@ -0,0 +1,150 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_CSOURCE_EXTRACT_GREP_H
+#define CWARE_CSOURCE_EXTRACT_GREP_H
+
+/* Data structure properties */
+#define CANDIDATE_TYPE  struct CSourceCandidate
+#define CANDIDATE_HEAP  1
+#define CANDIDATE_FREE(value)
+
+/* Where uses of an identifier are looked for */
+#define CSOURCE_SCOPE_ANY       0
+#define CSOURCE_SCOPE_FUNCTION  1
+#define CSOURCE_SCOPE_TOP       2
+
+struct ModuleSetup;
+
+/*
+ * @docgen: structure
+ * @brief: a place an identifier might be used in
+ * @name: CSourceCandidate
+ *
+ * @description
+ * @A whole word of a source file which is one of the identifiers being
+ * @looked for. It is only a use if it turns out to be in code, rather
+ * @than in a comment or a string.
+ * @description
+ *
+ * @field offset: the byte offset of the word
+ * @type: int
+ *
+ * @field length: the length of the word
+ * @type: int
+*/
+struct CSourceCandidate {
+    int offset;
+    int length;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the candidates of a source file, in the order they appear
+ * @name: CSourceCandidates
+ *
+ * @field length: the number of candidates
+ * @type: int
+ *
+ * @field capacity: the number of candidates there is room for
+ * @type: int
+ *
+ * @field contents: the candidates
+ * @type: struct CSourceCandidate *
+*/
+struct CSourceCandidates {
+    int length;
+    int capacity;
+    struct CSourceCandidate *contents;
+};
+
+/*
+ * @docgen: function
+ * @brief: find the scope a name given to --scope stands for
+ * @name: csource_grep_scope
+ *
+ * @error: name is NULL
+ *
+ * @param name: the name of the scope (function, top)
+ * @type: const char *
+ *
+ * @return: the scope (CSOURCE_SCOPE_*), or -1 if there is no such scope
+ * @type: int
+*/
+int csource_grep_scope(const char *name);
+
+/*
+ * @docgen: function
+ * @brief: write the lines that use some identifiers in their code
+ * @name: csource_extract_grep
+ *
+ * @description
+ * @Write every line that uses one of the identifiers of the setup as a
+ * @whole word, outside of comments, strings, character constants and
+ * @the paths of inclusions. The scope of the setup can keep to the uses
+ * @inside function bodies, or to the ones outside of them. In the text
+ * @format, a line is written the way grep -n writes it, after the path
+ * @of the file. Otherwise, it is a match record at the first use on it.
+ * @description
+ *
+ * @notes
+ * @The file is first searched for the identifiers as plain words, with
+ * @nothing but memchr and memcmp. A file with none of them in it is never
+ * @lexed, and one with some of them is only lexed up to the last one.
+ * @notes
+ *
+ * @param setup: the setup of the module
+ * @type: struct ModuleSetup
+*/
+void csource_extract_grep(struct ModuleSetup setup);
+
+/*
+ * @docgen: function
+ * @brief: the reference model of csource_extract_grep
+ * @name: csource_extract_grep_reference
+ *
+ * @description
+ * @Write the same lines as csource_extract_grep, by lexing the whole file
+ * @and checking every identifier in its code. Only the fuzzer uses this.
+ * @description
+ *
+ * @param setup: the setup of the module
+ * @type: struct ModuleSetup
+*/
+void csource_extract_grep_reference(struct ModuleSetup setup);
+
+#endif
@@ -41,6 +41,7 @@
 */
 
 #include "../../csource.h"
+#include "../../output/output.h"
 
 #include "include.h"
 
@@ -159,8 +160,7 @@ static int is_inclusion(struct LibmatchCursor cursor) {
 }
 
 struct CSourceInclusions *csource_extract_inclusions(struct ModuleSetup setup) {
-    FILE *source_file = setup.file;
-    struct LibmatchCursor cursor = libmatch_cursor_from_stream(source_file);
+    struct LibmatchCursor cursor = setup.input;
     struct CSourceInclusions *inclusions = carray_init(inclusions, INCLUSION);
 
     while(cursor.cursor < cursor.length) {
@@ -176,6 +176,8 @@ struct CSourceInclusions *csource_extract_inclusions(struct ModuleSetup setup) {
         INIT_VARIABLE(path);
         INIT_VARIABLE(inclusion);
 
+        inclusion.offset = cursor.cursor;
+
         /* Get the inclusion path. Detecting a < or " before
          * the end of the line can RELIABLY signal what type
          * of inclusion it is because there is no circumstances
@@ -193,7 +195,7 @@ struct CSourceInclusions *csource_extract_inclusions(struct ModuleSetup setup) {
         } else if(libmatch_cond_before(&cursor, '"', "\n") == 1) {
             libmatch_until(&cursor, "\"");
 
-            inclusion.type = INCLUSION_TYPE_SYSTEM;
+            inclusion.type = INCLUSION_TYPE_LOCAL;
 
             path.contents = libmatch_read_alloc_until(&cursor, "\"");
             path.capacity = strlen(path.contents) + 1;
@@ -207,8 +209,124 @@ struct CSourceInclusions *csource_extract_inclusions(struct ModuleSetup setup) {
         libmatch_next_line(&cursor);
     }
 
-    fclose(source_file);
-    libmatch_cursor_free(&cursor);
-
     return inclusions;
 }
+
+/*
+ * @docgen: function
+ * @brief: determine whether a file can be read
+ * @name: is_readable
+ *
+ * @description
+ * @Determine whether a file can be opened, which is all ANSI C can tell of
+ * @whether it is there, and all a compiler needs of it.
+ * @description
+ *
+ * @param path: the path of the file
+ * @type: const char *
+ *
+ * @return: 1 if the file can be read, or 0 if not
+ * @type: int
+*/
+static int is_readable(const char *path) {
+    FILE *file = fopen(path, "rb");
+
+    if(file == NULL)
+        return 0;
+
+    fclose(file);
+
+    return 1;
+}
+
+/*
+ * @docgen: function
+ * @brief: find the file an inclusion is of
+ * @name: find_inclusion
+ *
+ * @description
+ * @Find the file an inclusion is of the way a compiler would, in the
+ * @directory of the source file first if it is a local inclusion, and
+ * @then in each directory to find inclusions in, in order.
+ * @description
+ *
+ * @param setup: the module setup, with the directories to look in
+ * @type: struct ModuleSetup
+ *
+ * @param inclusion: the inclusion
+ * @type: struct CSourceInclusion
+ *
+ * @param found: the string to write the path of the file to
+ * @type: struct CString *
+ *
+ * @return: 1 if the file was found, or 0 if not
+ * @type: int
+*/
+static int find_inclusion(struct ModuleSetup setup, struct CSourceInclusion inclusion,
+                          struct CString *found) {
+    int index = 0;
+    const char *slash = strrchr(setup.source, '/');
+
+    if(inclusion.type == INCLUSION_TYPE_LOCAL && slash != NULL) {
+        struct CString whole = cstring_init(setup.source);
+        struct CString directory = cstring_slice(whole, 0, slash - setup.source + 1);
+
+        cstring_reset(found);
+        cstring_concat(found, directory);
+        cstring_concat(found, inclusion.path);
+        cstring_free(whole);
+
+        if(is_readable(found->contents) == 1)
+            return 1;
+    }
+
+    for(index = 0; setup.includes[index] != NULL; index++) {
+        cstring_reset(found);
+        cstring_concats(found, setup.includes[index]);
+        cstring_concats(found, "/");
+        cstring_concat(found, inclusion.path);
+
+        if(is_readable(found->contents) == 1)
+            return 1;
+    }
+
+    return 0;
+}
+
+void csource_write_inclusions(struct ModuleSetup setup) {
+    int index = 0;
+    struct CString found = cstring_init("");
+    struct CString payload = cstring_init("");
+    struct CSourceInclusions *inclusions = csource_extract_inclusions(setup);
+
+    for(index = 0; index < carray_length(inclusions); index++) {
+        struct CSourceRecord record;
+
+        INIT_VARIABLE(record);
+
+        record.kind = CSOURCE_RECORD_INCLUDE;
+        record.line = inclusions->contents[index].line;
+        record.offset = inclusions->contents[index].offset;
+        record.payload = inclusions->contents[index].path.contents;
+        record.length = inclusions->contents[index].path.length;
+
+        /* With directories to look in, the file is written after a tab */
+        if(setup.includes != NULL) {
+            cstring_reset(&payload);
+            cstring_concat(&payload, inclusions->contents[index].path);
+            cstring_concats(&payload, "\t");
+
+            if(find_inclusion(setup, inclusions->contents[index], &found) == 1)
+                cstring_concat(&payload, found);
+
+            record.payload = payload.contents;
+            record.length = payload.length;
+        }
+
+        csource_output_record(setup.output, record);
+    }
+
+    cstring_free(found);
+    cstring_free(payload);
+    carray_free(inclusions, INCLUSION);
+}
@@ -57,6 +57,9 @@ struct ModuleSetup;
  * @field line: the line the inclusion was on
  * @type: int
  *
+ * @field offset: the byte offset of the start of the inclusion's line
+ * @type: long
+ *
  * @field type: the type of inclusion
  * @type: int
  *
@@ -65,6 +68,7 @@ struct ModuleSetup;
 */
 struct CSourceInclusion {
     int line;
+    long offset;
     int type;
     struct CString path;
 };
@@ -91,6 +95,21 @@ struct CSourceInclusions {
 
 struct CSourceInclusions *csource_extract_inclusions(struct ModuleSetup setup);
 
+/*
+ * @docgen: function
+ * @brief: write the inclusions of a source file as records
+ * @name: csource_write_inclusions
+ *
+ * @description
+ * @Extract the inclusions of a source file, and write each one to the
+ * @output of the setup as an include record.
+ * @description
+ *
+ * @param setup: the module setup to extract from and write to
+ * @type: struct ModuleSetup
+*/
+void csource_write_inclusions(struct ModuleSetup setup);
+
 
 
 
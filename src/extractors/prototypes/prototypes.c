@@ -0,0 +1,687 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file turns the function definitions of a source file into a header
+ * of prototypes. The functions are found by the functions extractor, run
+ * over a copy of the source without its comments, directives and strings,
+ * so that none of those end up in a declaration.
+*/
+
+#include <string.h>
+
+#include "../../csource.h"
+#include "../../common/common.h"
+#include "../../output/output.h"
+#include "../../filters/blank/blank.h"
+#include "../functions/functions.h"
+
+#include "prototypes.h"
+
+/* The most parameters, and declarators of them, an old style definition
+ * has for its prototype to be put together. C89 only asks for 31. */
+#define PROTOTYPE_MAXIMUM_PARAMETERS    127
+
+/*
+ * @docgen: structure
+ * @brief: the state of writing the prototypes of a file
+ * @name: PrototypeWriter
+ *
+ * @field setup: the setup of the module
+ * @type: struct ModuleSetup *
+ *
+ * @field text: where each prototype is put together, as long as the file
+ * @type: char *
+*/
+struct PrototypeWriter {
+    struct ModuleSetup *setup;
+    char *text;
+};
+
+/*
+ * @docgen: structure
+ * @brief: a declarator of the parameters of an old style definition
+ * @name: PrototypeParameter
+ *
+ * @field name: the index the name starts at
+ * @type: int
+ *
+ * @field name_end: the index the name ends at
+ * @type: int
+ *
+ * @field specifiers: the index the specifiers of its declaration start at
+ * @type: int
+ *
+ * @field specifiers_end: the index the specifiers end at
+ * @type: int
+ *
+ * @field start: the index the declarator starts at
+ * @type: int
+ *
+ * @field end: the index the declarator ends at
+ * @type: int
+*/
+struct PrototypeParameter {
+    int name;
+    int name_end;
+    int specifiers;
+    int specifiers_end;
+    int start;
+    int end;
+};
+
+/*
+ * @docgen: function
+ * @brief: put a declaration on one line
+ * @name: collapse_declaration
+ *
+ * @description
+ * @Copy a declaration with every run of whitespace in it made into one
+ * @space, leaving out the spaces just inside of parentheses and before a
+ * @comma, which are mostly left behind by comments.
+ * @description
+ *
+ * @param text: the buffer to copy the declaration to
+ * @type: char *
+ *
+ * @param declaration: the declaration
+ * @type: const char *
+ *
+ * @param length: the length of the declaration
+ * @type: int
+ *
+ * @return: the length of the copy
+ * @type: int
+*/
+static int collapse_declaration(char *text, const char *declaration, int length) {
+    int index = 0;
+    int written = 0;
+    int space = 0;
+
+    for(index = 0; index < length; index++) {
+        char character = declaration[index];
+
+        if(strchr(LIBMATCH_WHITESPACE, character) != NULL) {
+            space = 1;
+
+            continue;
+        }
+
+        if(space == 1 && written > 0 && text[written - 1] != '(' && character != ')' &&
+           character != ',')
+            text[written++] = ' ';
+
+        text[written++] = character;
+        space = 0;
+    }
+
+    return written;
+}
+
+/*
+ * @docgen: function
+ * @brief: determine whether a declaration is of a static function
+ * @name: is_static
+ *
+ * @param text: the declaration
+ * @type: const char *
+ *
+ * @param length: the length of the declaration
+ * @type: int
+ *
+ * @return: 1 if static is one of its specifiers, 0 if not
+ * @type: int
+*/
+static int is_static(const char *text, int length) {
+    int index = 0;
+
+    /* Only what comes before the parameters can be a specifier */
+    while(index < length && text[index] != '(') {
+        int start = index;
+
+        if(csource_is_identifier_start(text[index]) == 0) {
+            index++;
+
+            continue;
+        }
+
+        while(index < length && csource_is_identifier_character(text[index]))
+            index++;
+
+        if(index - start == 6 && strncmp(text + start, "static", 6) == 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: find the name a declarator declares
+ * @name: declarator_name
+ *
+ * @description
+ * @Find the first identifier of a declarator that is not a qualifier,
+ * @which is the name it declares, like p in * const p or fn in (*fn)().
+ * @description
+ *
+ * @param text: the declaration the declarator is in
+ * @type: const char *
+ *
+ * @param parameter: the declarator, which the name is kept in
+ * @type: struct PrototypeParameter *
+*/
+static void declarator_name(const char *text, struct PrototypeParameter *parameter) {
+    int index = parameter->start;
+
+    parameter->name = parameter->end;
+    parameter->name_end = parameter->end;
+
+    while(index < parameter->end) {
+        int start = index;
+
+        if(csource_is_identifier_start(text[index]) == 0) {
+            index++;
+
+            continue;
+        }
+
+        while(index < parameter->end && csource_is_identifier_character(text[index]))
+            index++;
+
+        if((index - start == 5 && strncmp(text + start, "const", 5) == 0) ||
+           (index - start == 8 && strncmp(text + start, "volatile", 8) == 0))
+            continue;
+
+        parameter->name = start;
+        parameter->name_end = index;
+
+        return;
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: find the declarators of the parameters of an old style definition
+ * @name: read_parameters
+ *
+ * @description
+ * @Split the declarations between the list of names and the body of an old
+ * @style definition into their declarators. The specifiers of a declaration
+ * @are what comes before the first * or ( of its first declarator, or else
+ * @before its name, like unsigned long in unsigned long x.
+ * @description
+ *
+ * @param text: the definition, up to its body
+ * @type: const char *
+ *
+ * @param index: the index the declarations start at
+ * @type: int
+ *
+ * @param length: the length of the definition
+ * @type: int
+ *
+ * @param parameters: where to put the declarators
+ * @type: struct PrototypeParameter *
+ *
+ * @return: the number of declarators, or -1 if there are too many
+ * @type: int
+*/
+static int read_parameters(const char *text, int index, int length,
+                           struct PrototypeParameter *parameters) {
+    int count = 0;
+
+    while(index < length) {
+        int depth = 0;
+        int first = count;
+        struct PrototypeParameter parameter;
+
+        parameter.specifiers = index;
+        parameter.start = index;
+
+        /* Each declarator ends at a comma outside of brackets, and the
+         * declaration at its semicolon */
+        for(; index <= length; index++) {
+            int character = index < length ? text[index] : ';';
+
+            if(character == '(' || character == '[')
+                depth++;
+            else if(character == ')' || character == ']')
+                depth--;
+
+            if(character == '*' && count == first && parameter.start == parameter.specifiers)
+                parameter.start = index;
+
+            if(character == '(' && count == first && parameter.start == parameter.specifiers)
+                parameter.start = index;
+
+            if(character != ';' && (character != ',' || depth > 0))
+                continue;
+
+            if(count == PROTOTYPE_MAXIMUM_PARAMETERS)
+                return -1;
+
+            parameter.end = index;
+
+            /* Without a * or (, the declarator is only its name, which
+             * is the last identifier before any [ */
+            if(count == first && parameter.start == parameter.specifiers) {
+                int end = parameter.specifiers;
+
+                while(end < index && text[end] != '[')
+                    end++;
+
+                while(end > parameter.specifiers &&
+                      csource_is_identifier_character(text[end - 1]) == 0)
+                    end--;
+
+                while(end > parameter.specifiers &&
+                      csource_is_identifier_character(text[end - 1]))
+                    end--;
+
+                parameter.start = end;
+            }
+
+            if(count == first)
+                parameter.specifiers_end = parameter.start;
+            else
+                parameter.specifiers_end = parameters[first].start;
+
+            declarator_name(text, &parameter);
+            parameters[count++] = parameter;
+
+            parameter.start = index + 1;
+
+            if(character == ';')
+                break;
+        }
+
+        index++;
+    }
+
+    return count;
+}
+
+/*
+ * @docgen: function
+ * @brief: find the type an old style parameter is promoted to
+ * @name: promoted_type
+ *
+ * @description
+ * @Find the type a parameter of an old style definition is passed as,
+ * @which for a plain char, short or float is int or double, since those
+ * @are promoted when there is no prototype. A prototype has to use the
+ * @promoted type to agree with the definition. Types which are only
+ * @named by typedefs are taken as they are.
+ * @description
+ *
+ * @param text: the definition, up to its body
+ * @type: const char *
+ *
+ * @param parameter: the declarator of the parameter
+ * @type: struct PrototypeParameter
+ *
+ * @return: the promoted type, or NULL if it is not promoted
+ * @type: const char *
+*/
+static const char *promoted_type(const char *text, struct PrototypeParameter parameter) {
+    int index = 0;
+
+    for(index = parameter.start; index < parameter.end; index++) {
+        if(text[index] == '*' || text[index] == '(' || text[index] == '[')
+            return NULL;
+    }
+
+    for(index = parameter.specifiers; index < parameter.specifiers_end; index++) {
+        int start = index;
+
+        if(csource_is_identifier_start(text[index]) == 0)
+            continue;
+
+        while(index < parameter.specifiers_end && csource_is_identifier_character(text[index]))
+            index++;
+
+        if((index - start == 4 && strncmp(text + start, "char", 4) == 0) ||
+           (index - start == 5 && strncmp(text + start, "short", 5) == 0))
+            return "int";
+
+        if(index - start == 5 && strncmp(text + start, "float", 5) == 0)
+            return "double";
+    }
+
+    return NULL;
+}
+
+/*
+ * @docgen: function
+ * @brief: add text to a prototype being put together
+ * @name: put_text
+ *
+ * @param buffer: the prototype, or NULL if it is only being measured
+ * @type: char *
+ *
+ * @param written: the length of the prototype so far
+ * @type: int
+ *
+ * @param text: the text to add
+ * @type: const char *
+ *
+ * @param length: the length of the text
+ * @type: int
+ *
+ * @return: the length of the prototype with the text
+ * @type: int
+*/
+static int put_text(char *buffer, int written, const char *text, int length) {
+    if(buffer != NULL)
+        memcpy(buffer + written, text, length);
+
+    return written + length;
+}
+
+/*
+ * @docgen: function
+ * @brief: put the prototype of an old style definition together
+ * @name: old_style_prototype
+ *
+ * @description
+ * @Put together the prototype of an old style definition, like
+ * @int f(a, b) int a; char *b;, as int f(int a, char *b), with each name
+ * @of the list given the type it is declared with, promoted like it is
+ * @passed, or int if it is not declared. A definition with too many
+ * @parameters is given an empty list. Nothing is written if the buffer is
+ * @NULL, so that the prototype can be measured first.
+ * @description
+ *
+ * @param text: the definition, up to its body
+ * @type: const char *
+ *
+ * @param length: the length of the definition
+ * @type: int
+ *
+ * @param open: the index of the ( of the list of names
+ * @type: int
+ *
+ * @param close: the index of the ) of the list of names
+ * @type: int
+ *
+ * @param buffer: where to put the prototype, or NULL
+ * @type: char *
+ *
+ * @return: the length of the prototype
+ * @type: int
+*/
+static int old_style_prototype(const char *text, int length, int open, int close,
+                               char *buffer) {
+    int index = 0;
+    int count = 0;
+    int written = put_text(buffer, 0, text, open + 1);
+    struct PrototypeParameter parameters[PROTOTYPE_MAXIMUM_PARAMETERS];
+
+    if((count = read_parameters(text, close + 1, length, parameters)) == -1)
+        return put_text(buffer, written, ")", 1);
+
+    for(index = open + 1; index < close; index++) {
+        int start = index;
+        int parameter = 0;
+        const char *promoted = NULL;
+        struct PrototypeParameter declared;
+
+        if(csource_is_identifier_start(text[index]) == 0)
+            continue;
+
+        while(index < close && csource_is_identifier_character(text[index]))
+            index++;
+
+        for(parameter = 0; parameter < count; parameter++) {
+            declared = parameters[parameter];
+
+            if(declared.name_end - declared.name == index - start &&
+               strncmp(text + declared.name, text + start, index - start) == 0)
+                break;
+        }
+
+        if(written > open + 1)
+            written = put_text(buffer, written, ", ", 2);
+
+        /* A parameter that is not declared is an int */
+        if(parameter == count) {
+            written = put_text(buffer, written, "int ", 4);
+            written = put_text(buffer, written, text + start, index - start);
+        } else if((promoted = promoted_type(text, declared)) != NULL) {
+            written = put_text(buffer, written, promoted, strlen(promoted));
+            written = put_text(buffer, written, " ", 1);
+            written = put_text(buffer, written, text + start, index - start);
+        } else {
+            written = put_text(buffer, written, text + declared.specifiers,
+                               declared.specifiers_end - declared.specifiers);
+            written = put_text(buffer, written, " ", 1);
+            written = put_text(buffer, written, text + declared.start,
+                               declared.end - declared.start);
+        }
+    }
+
+    return put_text(buffer, written, ")", 1);
+}
+
+/*
+ * @docgen: function
+ * @brief: find the list of names of an old style definition
+ * @name: find_names
+ *
+ * @param text: the definition, up to its body
+ * @type: const char *
+ *
+ * @param length: the length of the definition
+ * @type: int
+ *
+ * @param open: where to put the index of the ( of the list
+ * @type: int *
+ *
+ * @param close: where to put the index of the ) of the list
+ * @type: int *
+ *
+ * @return: 1 if the definition is old style, 0 if not
+ * @type: int
+*/
+static int find_names(const char *text, int length, int *open, int *close) {
+    int index = 0;
+
+    while(index < length && text[index] != '(')
+        index++;
+
+    *open = index;
+
+    for(index++; index < length && text[index] != ')'; index++) {
+        if(csource_is_identifier_character(text[index]) == 0 && text[index] != ',' &&
+           strchr(LIBMATCH_WHITESPACE, text[index]) == NULL)
+            return 0;
+    }
+
+    *close = index;
+
+    /* Declarations of the parameters follow the list */
+    for(index++; index < length && strchr(LIBMATCH_WHITESPACE, text[index]) != NULL; index++)
+        continue;
+
+    return index < length && csource_is_identifier_start(text[index]);
+}
+
+/*
+ * @docgen: function
+ * @brief: write the prototype of a function definition
+ * @name: write_prototype
+ *
+ * @param visitor: the visitor of the functions extractor
+ * @type: struct CSourceFunctionVisitor *
+ *
+ * @param record: the record of the function
+ * @type: struct CSourceRecord
+ *
+ * @param definition: whether the function has a body
+ * @type: int
+*/
+static void write_prototype(struct CSourceFunctionVisitor *visitor, struct CSourceRecord record,
+                            int definition) {
+    int open = 0;
+    int close = 0;
+    int length = 0;
+    struct PrototypeWriter *writer = visitor->data;
+    char *text = writer->text;
+
+    /* A declaration already is a prototype, wherever it is */
+    if(definition == 0)
+        return;
+
+    /* The prototype of an old style definition can be longer than it */
+    if(find_names(record.payload, record.length, &open, &close) == 1) {
+        length = old_style_prototype(record.payload, record.length, open, close, NULL);
+        text = csource_allocator.allocate(length + 2);
+
+        old_style_prototype(record.payload, record.length, open, close, text);
+        length = collapse_declaration(text, text, length);
+    } else {
+        length = collapse_declaration(text, record.payload, record.length);
+    }
+
+    if(writer->setup->statics == 0 && is_static(text, length) == 1) {
+        if(text != writer->text)
+            csource_allocator.release(text);
+
+        return;
+    }
+
+    text[length++] = ';';
+
+    if(writer->setup->output->format != CSOURCE_FORMAT_TEXT) {
+        record.kind = CSOURCE_RECORD_PROTOTYPE;
+        record.payload = text;
+        record.length = length;
+
+        csource_output_record(writer->setup->output, record);
+    } else {
+        text[length++] = '\n';
+
+        csource_output_span(writer->setup->output, text, length, record.offset, record.line);
+    }
+
+    if(text != writer->text)
+        csource_allocator.release(text);
+}
+
+/*
+ * @docgen: function
+ * @brief: write the include guard of a header
+ * @name: write_guard
+ *
+ * @description
+ * @Write the start of an include guard, named after the source file the
+ * @way a header for it would be, so foo/bar.c gets BAR_H.
+ * @description
+ *
+ * @param setup: the setup of the module
+ * @type: struct ModuleSetup *
+ *
+ * @param text: the buffer to put the guard together in
+ * @type: char *
+*/
+static void write_guard(struct ModuleSetup *setup, char *text) {
+    int length = 0;
+    const char *name = setup->source;
+    const char *extension = NULL;
+    struct CString guard = cstring_init("#ifndef ");
+
+    if(strrchr(name, '/') != NULL)
+        name = strrchr(name, '/') + 1;
+
+    if(strcmp(name, "-") == 0)
+        name = "prototypes";
+
+    if((extension = strrchr(name, '.')) == NULL || extension == name)
+        extension = name + strlen(name);
+
+    /* A guard cannot start with a digit, even if a file can */
+    if(name[0] >= '0' && name[0] <= '9')
+        text[length++] = 'H';
+
+    for(; name < extension; name++) {
+        if(*name >= 'a' && *name <= 'z')
+            text[length++] = *name - 'a' + 'A';
+        else if(csource_is_identifier_character(*name))
+            text[length++] = *name;
+        else
+            text[length++] = '_';
+    }
+
+    text[length] = '\0';
+
+    cstring_concats(&guard, text);
+    cstring_concats(&guard, "_H\n#define ");
+    cstring_concats(&guard, text);
+    cstring_concats(&guard, "_H\n\n");
+
+    csource_output_span(setup->output, guard.contents, guard.length, 0, 1);
+    cstring_free(guard);
+}
+
+void csource_extract_prototypes(struct ModuleSetup setup) {
+    char *code = NULL;
+    struct PrototypeWriter writer;
+    struct CSourceFunctionVisitor visitor;
+    int length = setup.input.length;
+
+    code = csource_blank(setup.input.buffer, length);
+
+    /* Nothing written is ever longer than the file, and the name of the
+     * guard is never much longer than the path. */
+    writer.setup = &setup;
+    writer.text = csource_allocator.allocate(length + strlen(setup.source) + 16);
+
+    visitor.function = write_prototype;
+    visitor.data = &writer;
+
+    if(setup.output->format == CSOURCE_FORMAT_TEXT)
+        write_guard(&setup, writer.text);
+
+    csource_scan_functions(libmatch_cursor_init(code, length), &visitor);
+
+    if(setup.output->format == CSOURCE_FORMAT_TEXT)
+        csource_output_span(setup.output, "\n#endif\n", 8, length, 1);
+
+    csource_allocator.release(writer.text);
+    csource_allocator.release(code);
+}
@@ -0,0 +1,549 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file finds the symbols of a source file, which are the identifiers
+ * in its code, and tells apart the names it defines at file scope, and
+ * of the functions it declares, from every other use. The function
+ * extractor finds the functions and the tags extractor the other names,
+ * over a copy of the file with only its code left, and a second copy
+ * which keeps its directives is split into identifiers.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../csource.h"
+#include "../../common/common.h"
+#include "../../output/output.h"
+#include "../../filters/blank/blank.h"
+#include "../../filters/directives/directives.h"
+#include "../functions/functions.h"
+#include "../tags/tags.h"
+
+#include "symbols.h"
+
+/* Identifiers that are never symbols, which are the keywords, and the
+ * defined operator of conditionals */
+static const char *keywords[] = {
+    "auto", "break", "case", "char", "const", "continue", "default", "defined", "do",
+    "double", "else", "enum", "extern", "float", "for", "goto", "if", "inline", "int",
+    "long", "register", "restrict", "return", "short", "signed", "sizeof", "static",
+    "struct", "switch", "typedef", "union", "unsigned", "void", "volatile", "while", NULL
+};
+
+/* The names of each kind of symbol, indexed by kind. */
+static const char *kind_names[] = {
+    "definition", "prototype", "use"
+};
+
+/* The record each kind of symbol is written as, indexed by kind. */
+static const int kind_records[] = {
+    CSOURCE_RECORD_DEFINITION, CSOURCE_RECORD_PROTOTYPE, CSOURCE_RECORD_USE
+};
+
+/*
+ * @docgen: structure
+ * @brief: the state of a walk over the identifiers of a file
+ * @name: SymbolScan
+ *
+ * @field buffer: the source file
+ * @type: const char *
+ *
+ * @field code: the source file, with its comments and strings blanked
+ * @type: const char *
+ *
+ * @field declarations: the names the file declares or defines
+ * @type: struct CSourceDeclarations *
+ *
+ * @field next: the next declaration to look out for
+ * @type: int
+ *
+ * @field line: the line the scan has counted up to
+ * @type: int
+ *
+ * @field counted: the offset the scan has counted the lines up to
+ * @type: int
+ *
+ * @field visitor: the visitor to give the symbols to
+ * @type: struct CSourceSymbolVisitor *
+*/
+struct SymbolScan {
+    const char *buffer;
+    const char *code;
+    struct CSourceDeclarations *declarations;
+    int next;
+    int line;
+    int counted;
+    struct CSourceSymbolVisitor *visitor;
+};
+
+/*
+ * @docgen: function
+ * @brief: determine whether an identifier is a keyword
+ * @name: is_keyword
+ *
+ * @param text: the identifier
+ * @type: const char *
+ *
+ * @param length: the length of the identifier
+ * @type: int
+ *
+ * @return: 1 if the identifier is a keyword, 0 if it is not
+ * @type: int
+*/
+static int is_keyword(const char *text, int length) {
+    int index = 0;
+
+    for(index = 0; keywords[index] != NULL; index++) {
+        if(keywords[index][0] != text[0] || (int) strlen(keywords[index]) != length)
+            continue;
+
+        if(strncmp(keywords[index], text, length) == 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: keep the name of a function the file declares or defines
+ * @name: add_declaration
+ *
+ * @description
+ * @Find the name of a function in its declaration, which is the first
+ * @identifier that is not a keyword and comes right before a (.
+ * @description
+ *
+ * @param visitor: the visitor of the functions
+ * @type: struct CSourceFunctionVisitor *
+ *
+ * @param record: the record of the function
+ * @type: struct CSourceRecord
+ *
+ * @param definition: whether the function has a body
+ * @type: int
+*/
+static void add_declaration(struct CSourceFunctionVisitor *visitor, struct CSourceRecord record,
+                            int definition) {
+    int index = 0;
+    const char *payload = record.payload;
+    struct CSourceDeclarations *declarations = visitor->data;
+
+    while(index < record.length) {
+        int start = index;
+        int next = 0;
+        struct CSourceDeclaration declaration;
+
+        if(csource_is_identifier_character(payload[index]) == 0) {
+            index++;
+
+            continue;
+        }
+
+        while(index < record.length && csource_is_identifier_character(payload[index]))
+            index++;
+
+        if(csource_is_identifier_start(payload[start]) == 0 ||
+           is_keyword(payload + start, index - start))
+            continue;
+
+        next = index;
+
+        while(next < record.length && strchr(LIBMATCH_WHITESPACE, payload[next]) != NULL)
+            next++;
+
+        if(next == record.length || payload[next] != '(')
+            continue;
+
+        /* The payload is a slice of the file from the offset on */
+        declaration.offset = (int) record.offset + start;
+        declaration.kind = definition == 1 ? CSOURCE_SYMBOL_DEFINITION : CSOURCE_SYMBOL_PROTOTYPE;
+        carray_append(declarations, declaration, DECLARATION);
+
+        return;
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: keep a name the file defines at file scope
+ * @name: add_definition
+ *
+ * @description
+ * @Keep the typedefs, the tags of types, the constants of enumerations
+ * @and the variables the tags extractor finds. The functions are kept by
+ * @add_declaration, which tells their prototypes apart, and the macros
+ * @are found with the directives.
+ * @description
+ *
+ * @param visitor: the visitor of the tags
+ * @type: struct CSourceTagVisitor *
+ *
+ * @param start: the index the name starts at
+ * @type: int
+ *
+ * @param end: the index the name ends at
+ * @type: int
+ *
+ * @param kind: the kind of tag (CSOURCE_TAG_*)
+ * @type: int
+*/
+static void add_definition(struct CSourceTagVisitor *visitor, int start, int end, int kind) {
+    struct CSourceDeclaration declaration;
+    struct CSourceDeclarations *declarations = visitor->data;
+
+    if(kind == CSOURCE_TAG_FUNCTION || kind == CSOURCE_TAG_MACRO)
+        return;
+
+    declaration.offset = start;
+    declaration.kind = CSOURCE_SYMBOL_DEFINITION;
+    carray_append(declarations, declaration, DECLARATION);
+}
+
+/*
+ * @docgen: function
+ * @brief: order declarations by where they are
+ * @name: compare_declarations
+ *
+ * @param first: the first declaration
+ * @type: const void *
+ *
+ * @param second: the second declaration
+ * @type: const void *
+ *
+ * @return: less than, equal to, or greater than zero
+ * @type: int
+*/
+static int compare_declarations(const void *first, const void *second) {
+    const struct CSourceDeclaration *left = first;
+    const struct CSourceDeclaration *right = second;
+
+    return (left->offset > right->offset) - (left->offset < right->offset);
+}
+
+/*
+ * @docgen: function
+ * @brief: give a symbol to the visitor
+ * @name: visit_symbol
+ *
+ * @param scan: the scan the symbol was found in
+ * @type: struct SymbolScan *
+ *
+ * @param start: the index the symbol starts at
+ * @type: int
+ *
+ * @param end: the index the symbol ends at
+ * @type: int
+ *
+ * @param kind: the kind of symbol, unless it is a declaration
+ * @type: int
+*/
+static void visit_symbol(struct SymbolScan *scan, int start, int end, int kind) {
+    const char *newline = NULL;
+    struct CSourceDeclarations *declarations = scan->declarations;
+
+    /* Symbols are found in order, so lines are counted from the last one */
+    while((newline = memchr(scan->buffer + scan->counted, '\n', start - scan->counted)) != NULL) {
+        scan->line++;
+        scan->counted = newline - scan->buffer + 1;
+    }
+
+    /* Nothing before the symbol is counted again, however long its line */
+    scan->counted = start;
+
+    while(scan->next < declarations->length && declarations->contents[scan->next].offset < start)
+        scan->next++;
+
+    if(scan->next < declarations->length && declarations->contents[scan->next].offset == start)
+        kind = declarations->contents[scan->next].kind;
+
+    scan->visitor->symbol(scan->visitor, start, end, scan->line, kind);
+}
+
+/*
+ * @docgen: function
+ * @brief: give the identifiers of some code to the visitor
+ * @name: scan_identifiers
+ *
+ * @param scan: the scan to give them in
+ * @type: struct SymbolScan *
+ *
+ * @param start: the index to start at
+ * @type: int
+ *
+ * @param end: the index to stop before
+ * @type: int
+*/
+static void scan_identifiers(struct SymbolScan *scan, int start, int end) {
+    const char *code = scan->code;
+
+    while(start < end) {
+        int identifier = start;
+
+        if(csource_is_identifier_character(code[start]) == 0) {
+            start++;
+
+            continue;
+        }
+
+        while(start < end && csource_is_identifier_character(code[start]))
+            start++;
+
+        /* Numbers, like 10UL or 0x1F, are not identifiers */
+        if(csource_is_identifier_start(code[identifier]) == 0)
+            continue;
+
+        if(is_keyword(code + identifier, start - identifier) == 1)
+            continue;
+
+        visit_symbol(scan, identifier, start, CSOURCE_SYMBOL_USE);
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: give the identifiers of a run of code to the visitor
+ * @name: scan_code
+ *
+ * @param visitor: the visitor of the directives
+ * @type: struct CSourceDirectiveVisitor *
+ *
+ * @param start: the index the run starts at
+ * @type: int
+ *
+ * @param end: the index the run ends at
+ * @type: int
+ *
+ * @param line: the line the run starts on
+ * @type: int
+*/
+static void scan_code(struct CSourceDirectiveVisitor *visitor, int start, int end, int line) {
+    scan_identifiers(visitor->data, start, end);
+}
+
+/*
+ * @docgen: function
+ * @brief: give the identifiers of a directive to the visitor
+ * @name: scan_directive
+ *
+ * @description
+ * @Give the identifiers of the directives that are made of code to the
+ * @visitor, which are #define, #undef and the conditionals. The name of
+ * @a macro being defined is a definition, and its parameters are left
+ * @out, since they mean nothing outside of it.
+ * @description
+ *
+ * @param visitor: the visitor of the directives
+ * @type: struct CSourceDirectiveVisitor *
+ *
+ * @param start: the index the directive starts at
+ * @type: int
+ *
+ * @param end: the index the directive ends at
+ * @type: int
+ *
+ * @param line: the line the directive starts on
+ * @type: int
+*/
+static void scan_directive(struct CSourceDirectiveVisitor *visitor, int start, int end,
+                           int line) {
+    int length = 0;
+    int name = 0;
+    int macro = 0;
+    struct SymbolScan *scan = visitor->data;
+    const char *code = scan->code;
+
+    name = csource_directive_name(code, start, end, &length);
+    start = name + length;
+
+    if((length == 2 && strncmp(code + name, "if", 2) == 0) ||
+       (length == 4 && strncmp(code + name, "elif", 4) == 0) ||
+       (length == 5 && strncmp(code + name, "ifdef", 5) == 0) ||
+       (length == 6 && strncmp(code + name, "ifndef", 6) == 0) ||
+       (length == 5 && strncmp(code + name, "undef", 5) == 0)) {
+        scan_identifiers(scan, start, end);
+
+        return;
+    }
+
+    if(length != 6 || strncmp(code + name, "define", 6) != 0)
+        return;
+
+    while(start < end && csource_is_identifier_start(code[start]) == 0)
+        start++;
+
+    for(macro = start; start < end && csource_is_identifier_character(code[start]); start++)
+        continue;
+
+    if(macro == start)
+        return;
+
+    visit_symbol(scan, macro, start, CSOURCE_SYMBOL_DEFINITION);
+
+    /* A ( right after the name starts the parameters */
+    if(start < end && code[start] == '(') {
+        while(start < end && code[start] != ')')
+            start++;
+    }
+
+    scan_identifiers(scan, start, end);
+}
+
+void csource_scan_symbols(const char *buffer, int length, struct CSourceSymbolVisitor *visitor) {
+    char *code = NULL;
+    struct SymbolScan scan;
+    struct CSourceFunctionVisitor functions;
+    struct CSourceTagVisitor definitions;
+    struct CSourceDirectiveVisitor directives;
+    struct CSourceDeclarations *declarations = NULL;
+
+    liberror_is_null(csource_scan_symbols, buffer);
+    liberror_is_null(csource_scan_symbols, visitor);
+
+    declarations = carray_init(declarations, DECLARATION);
+
+    /* The function extractor is only ever run over code */
+    code = csource_blank(buffer, length);
+    functions.function = add_declaration;
+    functions.data = declarations;
+
+    csource_scan_functions(libmatch_cursor_init(code, length), &functions);
+
+    INIT_VARIABLE(definitions);
+
+    definitions.tag = add_definition;
+    definitions.data = declarations;
+
+    csource_scan_tags(buffer, length, &definitions);
+
+    /* The tags of a type are found after the types nested in it */
+    qsort(declarations->contents, declarations->length, sizeof(*declarations->contents),
+          compare_declarations);
+
+    /* The directives are put back, since some of them are code too */
+    memcpy(code, buffer, length);
+    csource_blank_comments(code, length);
+
+    INIT_VARIABLE(scan);
+
+    scan.buffer = buffer;
+    scan.code = code;
+    scan.declarations = declarations;
+    scan.line = 1;
+    scan.visitor = visitor;
+
+    directives.code = scan_code;
+    directives.directive = scan_directive;
+    directives.data = &scan;
+
+    csource_scan_directives(code, length, &directives);
+
+    csource_allocator.release(code);
+    carray_free(declarations, DECLARATION);
+}
+
+const char *csource_symbol_kind(int kind) {
+    if(kind < CSOURCE_SYMBOL_DEFINITION || kind > CSOURCE_SYMBOL_USE)
+        return "unknown";
+
+    return kind_names[kind];
+}
+
+int csource_symbol_record(int kind) {
+    if(kind < CSOURCE_SYMBOL_DEFINITION || kind > CSOURCE_SYMBOL_USE)
+        return CSOURCE_RECORD_USE;
+
+    return kind_records[kind];
+}
+
+/*
+ * @docgen: function
+ * @brief: write a symbol
+ * @name: write_symbol
+ *
+ * @param visitor: the visitor of the symbols extractor
+ * @type: struct CSourceSymbolVisitor *
+ *
+ * @param start: the index the symbol starts at
+ * @type: int
+ *
+ * @param end: the index the symbol ends at
+ * @type: int
+ *
+ * @param line: the line the symbol is on
+ * @type: int
+ *
+ * @param kind: the kind of symbol
+ * @type: int
+*/
+static void write_symbol(struct CSourceSymbolVisitor *visitor, int start, int end, int line,
+                         int kind) {
+    char prefix[64 + 1];
+    struct CSourceRecord record;
+    struct ModuleSetup *setup = visitor->data;
+
+    if(setup->output->format != CSOURCE_FORMAT_TEXT) {
+        INIT_VARIABLE(record);
+
+        record.kind = csource_symbol_record(kind);
+        record.line = line;
+        record.offset = start;
+        record.payload = setup->input.buffer + start;
+        record.length = end - start;
+
+        csource_output_record(setup->output, record);
+
+        return;
+    }
+
+    sprintf(prefix, "%i\t\t%s ", line, kind_names[kind]);
+
+    csource_output_span(setup->output, prefix, strlen(prefix), start, line);
+    csource_output_span(setup->output, setup->input.buffer + start, end - start, start, line);
+    csource_output_span(setup->output, "\n", 1, start, line);
+}
+
+void csource_extract_symbols(struct ModuleSetup setup) {
+    struct CSourceSymbolVisitor visitor;
+
+    visitor.symbol = write_symbol;
+    visitor.data = &setup;
+
+    csource_scan_symbols(setup.input.buffer, setup.input.length, &visitor);
+}
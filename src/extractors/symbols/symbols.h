@@ -0,0 +1,178 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_CSOURCE_EXTRACT_SYMBOLS_H
+#define CWARE_CSOURCE_EXTRACT_SYMBOLS_H
+
+/* Data structure properties */
+#define DECLARATION_TYPE    struct CSourceDeclaration
+#define DECLARATION_HEAP    1
+#define DECLARATION_FREE(value)
+
+/* Kinds of symbol. These values are kept in indexes, so existing values
+ * must never be renumbered. */
+#define CSOURCE_SYMBOL_DEFINITION   0
+#define CSOURCE_SYMBOL_PROTOTYPE    1
+#define CSOURCE_SYMBOL_USE          2
+
+struct ModuleSetup;
+
+/*
+ * @docgen: structure
+ * @brief: the name of something declared or defined by a file
+ * @name: CSourceDeclaration
+ *
+ * @field offset: the byte offset of the name
+ * @type: int
+ *
+ * @field kind: the kind of symbol the name is (CSOURCE_SYMBOL_*)
+ * @type: int
+*/
+struct CSourceDeclaration {
+    int offset;
+    int kind;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the declarations of a file, in the order they appear
+ * @name: CSourceDeclarations
+ *
+ * @field length: the number of declarations
+ * @type: int
+ *
+ * @field capacity: the number of declarations there is room for
+ * @type: int
+ *
+ * @field contents: the declarations
+ * @type: struct CSourceDeclaration *
+*/
+struct CSourceDeclarations {
+    int length;
+    int capacity;
+    struct CSourceDeclaration *contents;
+};
+
+/*
+ * @docgen: structure
+ * @brief: what to do with the symbols of a source file
+ * @name: CSourceSymbolVisitor
+ *
+ * @field symbol: called with the range and line of each symbol, and its kind
+ * @type: void (*)(struct CSourceSymbolVisitor *, int, int, int, int)
+ *
+ * @field data: whatever the callback needs
+ * @type: void *
+*/
+struct CSourceSymbolVisitor {
+    void (*symbol)(struct CSourceSymbolVisitor *visitor, int start, int end, int line,
+                   int kind);
+    void *data;
+};
+
+/*
+ * @docgen: function
+ * @brief: find the symbols of a source file
+ * @name: csource_scan_symbols
+ *
+ * @description
+ * @Walk a source file, and give every identifier in its code that is not
+ * @a keyword to a visitor, in the order they appear. The names it defines
+ * @at file scope are definitions, which are the functions with a body, the
+ * @macros, the typedefs, the tags of types with a body, the constants of
+ * @enumerations and the variables which are not extern. The names of the
+ * @functions it only declares are prototypes, and everything else is a
+ * @use. Comments, strings, the paths of inclusions and the parameters of
+ * @macros are left out.
+ * @description
+ *
+ * @error: buffer is NULL
+ * @error: visitor is NULL
+ *
+ * @param buffer: the source file
+ * @type: const char *
+ *
+ * @param length: the length of the source file
+ * @type: int
+ *
+ * @param visitor: the visitor to give the symbols to
+ * @type: struct CSourceSymbolVisitor *
+*/
+void csource_scan_symbols(const char *buffer, int length, struct CSourceSymbolVisitor *visitor);
+
+/*
+ * @docgen: function
+ * @brief: find the name of a kind of symbol
+ * @name: csource_symbol_kind
+ *
+ * @param kind: the kind of symbol (CSOURCE_SYMBOL_*)
+ * @type: int
+ *
+ * @return: definition, prototype or use
+ * @type: const char *
+*/
+const char *csource_symbol_kind(int kind);
+
+/*
+ * @docgen: function
+ * @brief: find the record a kind of symbol is written as
+ * @name: csource_symbol_record
+ *
+ * @param kind: the kind of symbol (CSOURCE_SYMBOL_*)
+ * @type: int
+ *
+ * @return: the kind of record (CSOURCE_RECORD_*)
+ * @type: int
+*/
+int csource_symbol_record(int kind);
+
+/*
+ * @docgen: function
+ * @brief: write the symbols of a source file
+ * @name: csource_extract_symbols
+ *
+ * @description
+ * @Write every symbol of a source file, as found by csource_scan_symbols.
+ * @The text format writes the kind of each one before its name.
+ * @description
+ *
+ * @param setup: the setup of the module
+ * @type: struct ModuleSetup
+*/
+void csource_extract_symbols(struct ModuleSetup setup);
+
+#endif
@@ -0,0 +1,1546 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file finds the tags of a source file, which are the names it
+ * defines at file scope, and writes them like ctags and etags do. The
+ * declarations are split into tokens over a copy of the file with only
+ * its code left, and the macros are found in its directives afterwards.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../csource.h"
+#include "../../common/common.h"
+#include "../../output/output.h"
+#include "../../filters/blank/blank.h"
+#include "../../filters/directives/directives.h"
+
+#include "tags.h"
+
+#define is_blank(character) \
+    ((character) == ' ' || (character) == '\t' || (character) == '\n' || \
+     (character) == '\r' || (character) == '\v' || (character) == '\f')
+
+/* Kinds of token. Any other token is a single character, which is its kind. */
+#define TOKEN_END           -1
+#define TOKEN_IDENTIFIER    'a'
+#define TOKEN_NUMBER        '0'
+
+/* The deepest structures nest in each other before their bodies are
+ * skipped, rather than read, so that nesting cannot run out of stack */
+#define TAGS_MAXIMUM_DEPTH  64
+
+/* The letters of each kind of tag, indexed by kind */
+static const char kind_letters[] = "fdtsugev";
+
+/* Identifiers that are never declared, which are the keywords */
+static const char *keywords[] = {
+    "auto", "break", "case", "char", "const", "continue", "default", "do", "double",
+    "else", "enum", "extern", "float", "for", "goto", "if", "inline", "int", "long",
+    "register", "restrict", "return", "short", "signed", "sizeof", "static", "struct",
+    "switch", "typedef", "union", "unsigned", "void", "volatile", "while", NULL
+};
+
+/* Extensions which take parentheses, and are never declared */
+static const char *attributes[] = {
+    "__attribute__", "__declspec", "__asm__", "__asm", "asm", NULL
+};
+
+/*
+ * @docgen: structure
+ * @brief: a token of code
+ * @name: TagToken
+ *
+ * @field kind: the kind of token (TOKEN_*), or the character it is
+ * @type: int
+ *
+ * @field start: the index the token starts at
+ * @type: int
+ *
+ * @field end: the index the token ends at
+ * @type: int
+*/
+struct TagToken {
+    int kind;
+    int start;
+    int end;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the state of a walk over the declarations of a file
+ * @name: TagScan
+ *
+ * @field code: the source file, with only its code left
+ * @type: const char *
+ *
+ * @field length: the length of the source file
+ * @type: int
+ *
+ * @field cursor: the index of the next token
+ * @type: int
+ *
+ * @field pending: whether a token was put back
+ * @type: int
+ *
+ * @field back: the token that was put back
+ * @type: struct TagToken
+ *
+ * @field closed: the index the last body that was read ends at
+ * @type: int
+ *
+ * @field typedefs: the names the typedef being read declares, or NULL
+ * @type: struct CSourceTypeMembers *
+ *
+ * @field visitor: the visitor to give the tags to
+ * @type: struct CSourceTagVisitor *
+*/
+struct TagScan {
+    const char *code;
+    int length;
+    int cursor;
+    int pending;
+    struct TagToken back;
+    int closed;
+    struct CSourceTypeMembers *typedefs;
+    struct CSourceTagVisitor *visitor;
+};
+
+/*
+ * @docgen: structure
+ * @brief: text that is being put together, which can hold any byte
+ * @name: TagText
+ *
+ * @field contents: the text
+ * @type: char *
+ *
+ * @field length: the length of the text
+ * @type: int
+ *
+ * @field capacity: the number of bytes there is room for
+ * @type: int
+*/
+struct TagText {
+    char *contents;
+    int length;
+    int capacity;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the state of writing the tags of a file
+ * @name: TagWriter
+ *
+ * @field setup: the setup of the module
+ * @type: struct ModuleSetup *
+ *
+ * @field tags: the tags of the file
+ * @type: struct CSourceTags *
+ *
+ * @field line: the line counted up to
+ * @type: int
+ *
+ * @field line_start: the index that line starts at
+ * @type: int
+ *
+ * @field counted: the index the lines have been counted up to
+ * @type: int
+*/
+struct TagWriter {
+    struct ModuleSetup *setup;
+    struct CSourceTags *tags;
+    int line;
+    int line_start;
+    int counted;
+};
+
+/*
+ * @docgen: structure
+ * @brief: a tag, in the order it is written in
+ * @name: TagOrder
+ *
+ * @field name: the name of the tag
+ * @type: const char *
+ *
+ * @field length: the length of the name
+ * @type: int
+ *
+ * @field tag: the tag
+ * @type: struct CSourceTag
+*/
+struct TagOrder {
+    const char *name;
+    int length;
+    struct CSourceTag tag;
+};
+
+/*
+ * @docgen: structure
+ * @brief: a line of a tags file
+ * @name: TagLine
+ *
+ * @field text: the line, without its new line
+ * @type: const char *
+ *
+ * @field length: the length of the line
+ * @type: int
+*/
+struct TagLine {
+    const char *text;
+    int length;
+};
+
+/*
+ * @docgen: function
+ * @brief: determine whether a token is one of some words
+ * @name: is_word
+ *
+ * @param scan: the scan the token was read in
+ * @type: struct TagScan *
+ *
+ * @param token: the token
+ * @type: struct TagToken
+ *
+ * @param words: the words, ending with NULL
+ * @type: const char **
+ *
+ * @return: 1 if the token is one of the words, 0 if it is not
+ * @type: int
+*/
+static int is_word(struct TagScan *scan, struct TagToken token, const char **words) {
+    int index = 0;
+    int length = token.end - token.start;
+    const char *text = scan->code + token.start;
+
+    if(token.kind != TOKEN_IDENTIFIER)
+        return 0;
+
+    for(index = 0; words[index] != NULL; index++) {
+        if(words[index][0] != text[0] || (int) strlen(words[index]) != length)
+            continue;
+
+        if(strncmp(words[index], text, length) == 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: determine whether a token is a particular word
+ * @name: is_token
+ *
+ * @param scan: the scan the token was read in
+ * @type: struct TagScan *
+ *
+ * @param token: the token
+ * @type: struct TagToken
+ *
+ * @param word: the word
+ * @type: const char *
+ *
+ * @return: 1 if the token is the word, 0 if it is not
+ * @type: int
+*/
+static int is_token(struct TagScan *scan, struct TagToken token, const char *word) {
+    int length = token.end - token.start;
+
+    return token.kind == TOKEN_IDENTIFIER && (int) strlen(word) == length &&
+           strncmp(scan->code + token.start, word, length) == 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: read the next token of code
+ * @name: next_token
+ *
+ * @param scan: the scan to read the token in
+ * @type: struct TagScan *
+ *
+ * @return: the token, which is TOKEN_END at the end of the file
+ * @type: struct TagToken
+*/
+static struct TagToken next_token(struct TagScan *scan) {
+    struct TagToken token;
+    const char *code = scan->code;
+
+    if(scan->pending == 1) {
+        scan->pending = 0;
+
+        return scan->back;
+    }
+
+    while(scan->cursor < scan->length && is_blank(code[scan->cursor]))
+        scan->cursor++;
+
+    token.start = scan->cursor;
+
+    if(scan->cursor == scan->length) {
+        token.kind = TOKEN_END;
+    } else if(csource_is_identifier_start(code[scan->cursor])) {
+        token.kind = TOKEN_IDENTIFIER;
+
+        while(scan->cursor < scan->length && csource_is_identifier_character(code[scan->cursor]))
+            scan->cursor++;
+    } else if(csource_is_identifier_character(code[scan->cursor])) {
+        token.kind = TOKEN_NUMBER;
+
+        /* A number can be 1.5e10 or 0x1FUL, but never starts a name */
+        while(scan->cursor < scan->length &&
+              (csource_is_identifier_character(code[scan->cursor]) || code[scan->cursor] == '.'))
+            scan->cursor++;
+    } else {
+        token.kind = (unsigned char) code[scan->cursor++];
+    }
+
+    token.end = scan->cursor;
+
+    return token;
+}
+
+/*
+ * @docgen: function
+ * @brief: put a token back, to be read again
+ * @name: put_back
+ *
+ * @param scan: the scan the token was read in
+ * @type: struct TagScan *
+ *
+ * @param token: the token
+ * @type: struct TagToken
+*/
+static void put_back(struct TagScan *scan, struct TagToken token) {
+    scan->back = token;
+    scan->pending = 1;
+}
+
+/*
+ * @docgen: function
+ * @brief: skip past the end of something in brackets
+ * @name: skip_brackets
+ *
+ * @description
+ * @Skip past the bracket that closes one which was just read. Any kind of
+ * @bracket closes any other, so code that does not balance them, which
+ * @conditionals can leave behind, is skipped the same way every time.
+ * @description
+ *
+ * @param scan: the scan to skip in
+ * @type: struct TagScan *
+*/
+static void skip_brackets(struct TagScan *scan) {
+    int depth = 1;
+
+    while(depth > 0) {
+        struct TagToken token = next_token(scan);
+
+        switch(token.kind) {
+            case TOKEN_END:
+                return;
+
+            case '(': case '[': case '{':
+                depth++;
+                break;
+
+            case ')': case ']': case '}':
+                depth--;
+                break;
+        }
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: skip an initializer or the value of a constant
+ * @name: skip_expression
+ *
+ * @description
+ * @Skip up to the comma, semicolon or closing bracket that ends an
+ * @expression, which is left to be read.
+ * @description
+ *
+ * @param scan: the scan to skip in
+ * @type: struct TagScan *
+*/
+static void skip_expression(struct TagScan *scan) {
+    while(1) {
+        struct TagToken token = next_token(scan);
+
+        switch(token.kind) {
+            case TOKEN_END:
+                return;
+
+            case '(': case '[': case '{':
+                skip_brackets(scan);
+                break;
+
+            case ',': case ';': case ')': case ']': case '}':
+                put_back(scan, token);
+
+                return;
+        }
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: skip the parentheses of an extension, if it has them
+ * @name: skip_attribute
+ *
+ * @param scan: the scan to skip in
+ * @type: struct TagScan *
+*/
+static void skip_attribute(struct TagScan *scan) {
+    struct TagToken token = next_token(scan);
+
+    if(token.kind == '(')
+        skip_brackets(scan);
+    else
+        put_back(scan, token);
+}
+
+/*
+ * @docgen: function
+ * @brief: find the kind of tag a keyword starts
+ * @name: type_kind
+ *
+ * @param scan: the scan the token was read in
+ * @type: struct TagScan *
+ *
+ * @param token: the token
+ * @type: struct TagToken
+ *
+ * @return: CSOURCE_TAG_STRUCT, CSOURCE_TAG_UNION, CSOURCE_TAG_ENUM, or -1
+ * @type: int
+*/
+static int type_kind(struct TagScan *scan, struct TagToken token) {
+    if(is_token(scan, token, "struct") == 1)
+        return CSOURCE_TAG_STRUCT;
+
+    if(is_token(scan, token, "union") == 1)
+        return CSOURCE_TAG_UNION;
+
+    if(is_token(scan, token, "enum") == 1)
+        return CSOURCE_TAG_ENUM;
+
+    return -1;
+}
+
+/*
+ * @docgen: function
+ * @brief: give a tag to the visitor
+ * @name: visit_tag
+ *
+ * @param scan: the scan the tag was found in
+ * @type: struct TagScan *
+ *
+ * @param token: the name of the tag
+ * @type: struct TagToken
+ *
+ * @param kind: the kind of tag
+ * @type: int
+*/
+static void visit_tag(struct TagScan *scan, struct TagToken token, int kind) {
+    if(scan->visitor->tag != NULL)
+        scan->visitor->tag(scan->visitor, token.start, token.end, kind);
+}
+
+/*
+ * @docgen: function
+ * @brief: keep the name of a member of a type
+ * @name: add_member
+ *
+ * @param members: the members of the type, or NULL if they are not wanted
+ * @type: struct CSourceTypeMembers *
+ *
+ * @param token: the name of the member
+ * @type: struct TagToken
+*/
+static void add_member(struct CSourceTypeMembers *members, struct TagToken token) {
+    struct CSourceTypeMember member;
+
+    if(members == NULL)
+        return;
+
+    member.start = token.start;
+    member.end = token.end;
+
+    carray_append(members, member, TYPE_MEMBER);
+}
+
+static int scan_declaration(struct TagScan *scan, struct CSourceTypeMembers *members, int depth);
+
+/*
+ * @docgen: function
+ * @brief: read the constants of an enumeration
+ * @name: scan_enumerators
+ *
+ * @param scan: the scan to read them in, just past the {
+ * @type: struct TagScan *
+ *
+ * @param members: where to keep the constants, or NULL
+ * @type: struct CSourceTypeMembers *
+*/
+static void scan_enumerators(struct TagScan *scan, struct CSourceTypeMembers *members) {
+    int expected = 1;
+
+    while(1) {
+        struct TagToken token = next_token(scan);
+
+        switch(token.kind) {
+            case TOKEN_END: case '}':
+                scan->closed = token.end;
+
+                return;
+
+            case TOKEN_IDENTIFIER:
+                if(expected == 1) {
+                    visit_tag(scan, token, CSOURCE_TAG_ENUMERATOR);
+                    add_member(members, token);
+                }
+
+                expected = 0;
+                break;
+
+            case ',':
+                expected = 1;
+                break;
+
+            case '=':
+                skip_expression(scan);
+                break;
+
+            case '(': case '[': case '{':
+                skip_brackets(scan);
+                break;
+        }
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: read a structure, union or enumeration type
+ * @name: scan_type
+ *
+ * @description
+ * @Read the name and body of a type, just past its keyword. A type with a
+ * @body is a tag, unless it has no name; one without a body only refers
+ * @to a type, so whatever comes after the name is left to be read. The
+ * @members of a structure or union are read as declarations of their own.
+ * @description
+ *
+ * @param scan: the scan to read the type in
+ * @type: struct TagScan *
+ *
+ * @param keyword: the keyword of the type
+ * @type: struct TagToken
+ *
+ * @param kind: the kind of type
+ * @type: int
+ *
+ * @param depth: how many types the type is nested in
+ * @type: int
+*/
+static void scan_type(struct TagScan *scan, struct TagToken keyword, int kind, int depth) {
+    struct TagToken name;
+    struct CSourceType type;
+    struct TagToken token = next_token(scan);
+
+    name.kind = TOKEN_END;
+    name.start = name.end = keyword.end;
+
+    while(is_word(scan, token, attributes) == 1) {
+        skip_attribute(scan);
+        token = next_token(scan);
+    }
+
+    if(token.kind == TOKEN_IDENTIFIER) {
+        name = token;
+        token = next_token(scan);
+    }
+
+    if(token.kind != '{') {
+        put_back(scan, token);
+
+        return;
+    }
+
+    if(name.kind == TOKEN_IDENTIFIER)
+        visit_tag(scan, name, kind);
+
+    if(depth >= TAGS_MAXIMUM_DEPTH) {
+        skip_brackets(scan);
+
+        return;
+    }
+
+    INIT_VARIABLE(type);
+
+    type.kind = kind;
+    type.name_start = name.start;
+    type.name_end = name.end;
+    type.start = keyword.start;
+
+    if(scan->visitor->type != NULL) {
+        type.members = carray_init(type.members, TYPE_MEMBER);
+    }
+
+    if(kind == CSOURCE_TAG_ENUM) {
+        scan_enumerators(scan, type.members);
+    } else {
+        while(scan_declaration(scan, type.members, depth + 1) == 0)
+            continue;
+    }
+
+    if(scan->visitor->type == NULL)
+        return;
+
+    type.end = scan->closed;
+    scan->visitor->type(scan->visitor, &type);
+
+    carray_free(type.members, TYPE_MEMBER);
+}
+
+/*
+ * @docgen: function
+ * @brief: give the name a declarator declares to the visitor
+ * @name: visit_declarator
+ *
+ * @description
+ * @Give the name of a declarator at file scope to the visitor, as a
+ * @typedef if the declaration is one, or as a variable unless it is
+ * @extern. Functions that are only declared are not tags. The names a
+ * @typedef declares are kept, to be given as types once its end is found.
+ * @Every variable is given as one too, extern or not. In the body of a
+ * @type, every name is a member.
+ * @description
+ *
+ * @param scan: the scan the declarator was read in
+ * @type: struct TagScan *
+ *
+ * @param name: the name, which is TOKEN_END if there is none
+ * @type: struct TagToken
+ *
+ * @param function: whether the name is of a function
+ * @type: int
+ *
+ * @param specifiers: typedef, extern, static, or TOKEN_END if none
+ * @type: int
+ *
+ * @param variable: whether the declarator is of an array, and initialized
+ * @type: struct CSourceVariable *
+ *
+ * @param members: the members of the type the declaration is in, or NULL
+ * @type: struct CSourceTypeMembers *
+ *
+ * @param depth: how many types the declaration is nested in
+ * @type: int
+*/
+static void visit_declarator(struct TagScan *scan, struct TagToken name, int function,
+                             int specifiers, struct CSourceVariable *variable,
+                             struct CSourceTypeMembers *members, int depth) {
+    if(name.kind != TOKEN_IDENTIFIER)
+        return;
+
+    if(depth > 0) {
+        add_member(members, name);
+
+        return;
+    }
+
+    if(specifiers == 't') {
+        visit_tag(scan, name, CSOURCE_TAG_TYPEDEF);
+
+        if(scan->visitor->type != NULL)
+            add_member(scan->typedefs, name);
+
+        return;
+    }
+
+    if(function == 1)
+        return;
+
+    if(specifiers != 'e')
+        visit_tag(scan, name, CSOURCE_TAG_VARIABLE);
+
+    if(scan->visitor->variable == NULL)
+        return;
+
+    variable->start = name.start;
+    variable->end = name.end;
+    variable->storage = CSOURCE_STORAGE_NONE;
+
+    if(specifiers == 's')
+        variable->storage = CSOURCE_STORAGE_STATIC;
+    else if(specifiers == 'e')
+        variable->storage = CSOURCE_STORAGE_EXTERN;
+
+    scan->visitor->variable(scan->visitor, variable);
+}
+
+/*
+ * @docgen: function
+ * @brief: give the names a typedef declares to the visitor as types
+ * @name: visit_typedefs
+ *
+ * @param scan: the scan the typedef was read in
+ * @type: struct TagScan *
+ *
+ * @param start: the index the typedef starts at
+ * @type: int
+ *
+ * @param end: the index the typedef ends at
+ * @type: int
+*/
+static void visit_typedefs(struct TagScan *scan, int start, int end) {
+    int index = 0;
+    struct CSourceType type;
+
+    if(scan->visitor->type == NULL)
+        return;
+
+    for(index = 0; index < scan->typedefs->length; index++) {
+        INIT_VARIABLE(type);
+
+        type.kind = CSOURCE_TAG_TYPEDEF;
+        type.name_start = scan->typedefs->contents[index].start;
+        type.name_end = scan->typedefs->contents[index].end;
+        type.start = start;
+        type.end = end;
+
+        scan->visitor->type(scan->visitor, &type);
+    }
+
+    scan->typedefs->length = 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: find the body of an old style definition
+ * @name: find_body
+ *
+ * @description
+ * @Find the { that ends the declarations of the parameters of an old
+ * @style definition, like int f(a) int a; {, and go on from past it. An
+ * @initializer or a } found first means it is not a definition after all,
+ * @and nothing is skipped.
+ * @description
+ *
+ * @param scan: the scan to skip in, just past the first declaration
+ * @type: struct TagScan *
+ *
+ * @return: 1 if the body was found, 0 if not
+ * @type: int
+*/
+static int find_body(struct TagScan *scan) {
+    int index = 0;
+
+    for(index = scan->cursor; index < scan->length; index++) {
+        if(scan->code[index] == '=' || scan->code[index] == '}')
+            return 0;
+
+        if(scan->code[index] == '{') {
+            scan->cursor = index + 1;
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: read a declaration
+ * @name: scan_declaration
+ *
+ * @description
+ * @Read a declaration up to its semicolon, or the body of a function
+ * @through to its end. The name of each declarator is the last identifier
+ * @in it before a parameter list, an array, or an initializer. A (
+ * @followed by a * groups a declarator, like (*handler)(int), and any
+ * @other ( starts a parameter list, which is of a function if it comes
+ * @right after the name, and a [ right after the name is of an array. A }
+ * @ends the body the declaration is in, and is kept as where that body is
+ * @closed. Names after the parameter list of a function are the
+ * @declarations of the parameters of an old style definition, which are
+ * @read as part of it.
+ * @description
+ *
+ * @param scan: the scan to read the declaration in
+ * @type: struct TagScan *
+ *
+ * @param members: the members of the type the declaration is in, or NULL
+ * @type: struct CSourceTypeMembers *
+ *
+ * @param depth: how many types the declaration is nested in
+ * @type: int
+ *
+ * @return: 1 if a } or the end of the file was found, or 0 if not
+ * @type: int
+*/
+static int scan_declaration(struct TagScan *scan, struct CSourceTypeMembers *members, int depth) {
+    int kind = 0;
+    int done = 0;
+    int start = -1;
+    int groups = 0;
+    int function = 0;
+    int old_style = 0;
+    int specifiers = TOKEN_END;
+    struct TagToken name;
+    struct TagToken last;
+    struct TagToken peek;
+    struct TagToken token;
+    struct CSourceVariable variable;
+
+    INIT_VARIABLE(variable);
+
+    name.kind = TOKEN_END;
+    last.kind = TOKEN_END;
+
+    if(depth == 0 && scan->typedefs != NULL)
+        scan->typedefs->length = 0;
+
+    for(;; last = token) {
+        token = next_token(scan);
+
+        if(start == -1)
+            start = token.start;
+
+        switch(token.kind) {
+            case TOKEN_END: case '}':
+                scan->closed = token.end;
+
+                return 1;
+
+            case ';':
+                if(old_style == 1 && depth == 0 && find_body(scan) == 1) {
+                    if(specifiers != 't')
+                        visit_tag(scan, name, CSOURCE_TAG_FUNCTION);
+
+                    skip_brackets(scan);
+
+                    return 0;
+                }
+
+                visit_declarator(scan, name, function, specifiers, &variable, members, depth);
+
+                if(specifiers == 't' && depth == 0)
+                    visit_typedefs(scan, start, token.end);
+
+                return 0;
+
+            case ',':
+                if(groups > 0)
+                    break;
+
+                visit_declarator(scan, name, function, specifiers, &variable, members, depth);
+                INIT_VARIABLE(variable);
+
+                name.kind = TOKEN_END;
+                function = 0;
+                done = 0;
+                break;
+
+            case '{':
+                /* The braces of extern "C" hold declarations of their own */
+                if(specifiers == 'e' && name.kind == TOKEN_END && depth == 0)
+                    return 0;
+
+                if(function == 1 && specifiers != 't' && depth == 0)
+                    visit_tag(scan, name, CSOURCE_TAG_FUNCTION);
+
+                skip_brackets(scan);
+
+                return 0;
+
+            case '(':
+                if(done == 1) {
+                    skip_brackets(scan);
+
+                    break;
+                }
+
+                peek = next_token(scan);
+                put_back(scan, peek);
+
+                if(peek.kind == '*' || peek.kind == '^') {
+                    groups++;
+
+                    break;
+                }
+
+                function = last.kind == TOKEN_IDENTIFIER && name.kind == TOKEN_IDENTIFIER &&
+                           last.start == name.start;
+                done = 1;
+                skip_brackets(scan);
+                break;
+
+            case ')':
+                if(groups > 0)
+                    groups--;
+
+                break;
+
+            case '[':
+                if(done == 0 && last.kind == TOKEN_IDENTIFIER && name.kind == TOKEN_IDENTIFIER &&
+                   last.start == name.start)
+                    variable.array = 1;
+
+                done = 1;
+                skip_brackets(scan);
+                break;
+
+            case '=':
+                variable.initialized = 1;
+                done = 1;
+                skip_expression(scan);
+                break;
+
+            case ':':
+                done = 1;
+                break;
+
+            case TOKEN_IDENTIFIER:
+                if(function == 1 && done == 1 && is_word(scan, token, attributes) == 0)
+                    old_style = 1;
+
+                if(is_token(scan, token, "typedef") == 1)
+                    specifiers = 't';
+                else if(is_token(scan, token, "extern") == 1 && specifiers != 't')
+                    specifiers = 'e';
+                else if(is_token(scan, token, "static") == 1 && specifiers != 't')
+                    specifiers = 's';
+                else if((kind = type_kind(scan, token)) != -1)
+                    scan_type(scan, token, kind, depth);
+                else if(is_word(scan, token, attributes) == 1)
+                    skip_attribute(scan);
+                else if(done == 0 && is_word(scan, token, keywords) == 0)
+                    name = token;
+
+                break;
+        }
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: give the name of a macro a directive defines to the visitor
+ * @name: scan_directive
+ *
+ * @param visitor: the visitor of the directives
+ * @type: struct CSourceDirectiveVisitor *
+ *
+ * @param start: the index the directive starts at
+ * @type: int
+ *
+ * @param end: the index the directive ends at
+ * @type: int
+ *
+ * @param line: the line the directive starts on
+ * @type: int
+*/
+static void scan_directive(struct CSourceDirectiveVisitor *visitor, int start, int end,
+                           int line) {
+    int length = 0;
+    int name = 0;
+    struct TagScan *scan = visitor->data;
+    const char *code = scan->code;
+
+    name = csource_directive_name(code, start, end, &length);
+
+    if(length != 6 || strncmp(code + name, "define", 6) != 0)
+        return;
+
+    /* The name can be continued onto the next line */
+    for(start = name + length; start < end && csource_is_identifier_start(code[start]) == 0;
+        start++) {
+        if(code[start] != '\\' && is_blank(code[start]) == 0)
+            return;
+    }
+
+    for(name = start; start < end && csource_is_identifier_character(code[start]); start++)
+        continue;
+
+    if(name < start)
+        scan->visitor->tag(scan->visitor, name, start, CSOURCE_TAG_MACRO);
+}
+
+/*
+ * @docgen: function
+ * @brief: skip a run of code
+ * @name: skip_code
+ *
+ * @param visitor: the visitor of the directives
+ * @type: struct CSourceDirectiveVisitor *
+ *
+ * @param start: the index the run starts at
+ * @type: int
+ *
+ * @param end: the index the run ends at
+ * @type: int
+ *
+ * @param line: the line the run starts on
+ * @type: int
+*/
+static void skip_code(struct CSourceDirectiveVisitor *visitor, int start, int end, int line) {
+    return;
+}
+
+void csource_scan_tags(const char *buffer, int length, struct CSourceTagVisitor *visitor) {
+    char *code = NULL;
+    struct TagScan scan;
+    struct CSourceDirectiveVisitor directives;
+
+    liberror_is_null(csource_scan_tags, buffer);
+    liberror_is_null(csource_scan_tags, visitor);
+
+    INIT_VARIABLE(scan);
+
+    code = csource_blank(buffer, length);
+
+    scan.code = code;
+    scan.length = length;
+    scan.visitor = visitor;
+
+    if(visitor->type != NULL) {
+        scan.typedefs = carray_init(scan.typedefs, TYPE_MEMBER);
+    }
+
+    while(scan.cursor < scan.length || scan.pending == 1)
+        scan_declaration(&scan, NULL, 0);
+
+    if(visitor->type != NULL) {
+        carray_free(scan.typedefs, TYPE_MEMBER);
+    }
+
+    if(visitor->tag == NULL) {
+        csource_allocator.release(code);
+
+        return;
+    }
+
+    /* The directives are put back to find the macros */
+    memcpy(code, buffer, length);
+    csource_blank_comments(code, length);
+
+    directives.code = skip_code;
+    directives.directive = scan_directive;
+    directives.data = &scan;
+
+    csource_scan_directives(code, length, &directives);
+
+    csource_allocator.release(code);
+}
+
+char csource_tag_letter(int kind) {
+    if(kind < CSOURCE_TAG_FUNCTION || kind > CSOURCE_TAG_VARIABLE)
+        return '?';
+
+    return kind_letters[kind];
+}
+
+/*
+ * @docgen: function
+ * @brief: add bytes to text
+ * @name: add_text
+ *
+ * @param text: the text to add to
+ * @type: struct TagText *
+ *
+ * @param bytes: the bytes to add
+ * @type: const char *
+ *
+ * @param length: the number of bytes
+ * @type: int
+*/
+static void add_text(struct TagText *text, const char *bytes, int length) {
+    if(text->length + length > text->capacity) {
+        while(text->length + length > text->capacity)
+            text->capacity = text->capacity * 2 + 256;
+
+        text->contents = csource_allocator.reallocate(text->contents, text->capacity);
+    }
+
+    memcpy(text->contents + text->length, bytes, length);
+    text->length += length;
+}
+
+/*
+ * @docgen: function
+ * @brief: keep a tag of the file
+ * @name: add_tag
+ *
+ * @param visitor: the visitor of the tags
+ * @type: struct CSourceTagVisitor *
+ *
+ * @param start: the index the name starts at
+ * @type: int
+ *
+ * @param end: the index the name ends at
+ * @type: int
+ *
+ * @param kind: the kind of tag
+ * @type: int
+*/
+static void add_tag(struct CSourceTagVisitor *visitor, int start, int end, int kind) {
+    struct CSourceTag tag;
+    const char *newline = NULL;
+    struct TagWriter *writer = visitor->data;
+    const char *buffer = writer->setup->input.buffer;
+
+    /* The macros come after the code, so the lines are counted again */
+    if(start < writer->counted) {
+        writer->line = 1;
+        writer->line_start = 0;
+        writer->counted = 0;
+    }
+
+    while((newline = memchr(buffer + writer->counted, '\n', start - writer->counted)) != NULL) {
+        writer->line++;
+        writer->line_start = newline - buffer + 1;
+        writer->counted = writer->line_start;
+    }
+
+    writer->counted = start;
+
+    tag.start = start;
+    tag.end = end;
+    tag.line = writer->line;
+    tag.line_start = writer->line_start;
+    tag.kind = kind;
+
+    carray_append(writer->tags, tag, TAG);
+}
+
+/*
+ * @docgen: function
+ * @brief: find how much of the line of a tag to keep
+ * @name: line_length
+ *
+ * @param writer: the writer of the tags
+ * @type: struct TagWriter *
+ *
+ * @param tag: the tag
+ * @type: struct CSourceTag
+ *
+ * @param truncated: where to store whether the line is longer than that
+ * @type: int *
+ *
+ * @return: the length of the line, up to CSOURCE_TAG_PATTERN_LIMIT
+ * @type: int
+*/
+static int line_length(struct TagWriter *writer, struct CSourceTag tag, int *truncated) {
+    int length = writer->setup->input.length - tag.line_start;
+    const char *line = writer->setup->input.buffer + tag.line_start;
+    const char *newline = NULL;
+
+    if(length > CSOURCE_TAG_PATTERN_LIMIT + 1)
+        length = CSOURCE_TAG_PATTERN_LIMIT + 1;
+
+    *truncated = 0;
+
+    if((newline = memchr(line, '\n', length)) != NULL)
+        length = newline - line;
+
+    if(length > CSOURCE_TAG_PATTERN_LIMIT) {
+        *truncated = 1;
+
+        return CSOURCE_TAG_PATTERN_LIMIT;
+    }
+
+    if(length > 0 && line[length - 1] == '\r')
+        length--;
+
+    return length;
+}
+
+/*
+ * @docgen: function
+ * @brief: order tags by their names, and then their lines
+ * @name: compare_tags
+ *
+ * @param first: the first tag
+ * @type: const void *
+ *
+ * @param second: the second tag
+ * @type: const void *
+ *
+ * @return: less than, equal to or greater than 0, like strcmp
+ * @type: int
+*/
+static int compare_tags(const void *first, const void *second) {
+    int order = 0;
+    const struct TagOrder *left = first;
+    const struct TagOrder *right = second;
+    int length = left->length < right->length ? left->length : right->length;
+
+    if((order = memcmp(left->name, right->name, length)) != 0)
+        return order;
+
+    if(left->length != right->length)
+        return (left->length > right->length) - (left->length < right->length);
+
+    return (left->tag.line > right->tag.line) - (left->tag.line < right->tag.line);
+}
+
+/*
+ * @docgen: function
+ * @brief: order tags by where they are
+ * @name: compare_offsets
+ *
+ * @param first: the first tag
+ * @type: const void *
+ *
+ * @param second: the second tag
+ * @type: const void *
+ *
+ * @return: less than, equal to or greater than 0, like strcmp
+ * @type: int
+*/
+static int compare_offsets(const void *first, const void *second) {
+    const struct CSourceTag *left = first;
+    const struct CSourceTag *right = second;
+
+    return (left->start > right->start) - (left->start < right->start);
+}
+
+/*
+ * @docgen: function
+ * @brief: write the tags of a file like ctags
+ * @name: write_ctags
+ *
+ * @description
+ * @Write a line for each tag, in order of the names: the name, the path,
+ * @a search pattern for the start of its line, the letter of its kind,
+ * @and its line. Other formats write the same line as a record.
+ * @description
+ *
+ * @param writer: the writer of the tags
+ * @type: struct TagWriter *
+*/
+static void write_ctags(struct TagWriter *writer) {
+    int index = 0;
+    struct TagText text;
+    struct ModuleSetup *setup = writer->setup;
+    struct CSourceTags *tags = writer->tags;
+    struct TagOrder *order = NULL;
+
+    INIT_VARIABLE(text);
+
+    order = csource_allocator.allocate(sizeof(*order) * (tags->length + 1));
+
+    for(index = 0; index < tags->length; index++) {
+        order[index].name = setup->input.buffer + tags->contents[index].start;
+        order[index].length = tags->contents[index].end - tags->contents[index].start;
+        order[index].tag = tags->contents[index];
+    }
+
+    qsort(order, tags->length, sizeof(*order), compare_tags);
+
+    for(index = 0; index < tags->length; index++) {
+        int cursor = 0;
+        int length = 0;
+        int truncated = 0;
+        char suffix[64 + 1];
+        struct CSourceRecord record;
+        struct CSourceTag tag = order[index].tag;
+        const char *line = setup->input.buffer + tag.line_start;
+
+        text.length = 0;
+        length = line_length(writer, tag, &truncated);
+
+        add_text(&text, order[index].name, order[index].length);
+        add_text(&text, "\t", 1);
+        add_text(&text, setup->source, strlen(setup->source));
+        add_text(&text, "\t/^", 3);
+
+        /* Only a backslash and a slash mean anything in the pattern */
+        for(cursor = 0; cursor < length; cursor++) {
+            if(line[cursor] == '\\' || line[cursor] == '/')
+                add_text(&text, "\\", 1);
+
+            add_text(&text, line + cursor, 1);
+        }
+
+        sprintf(suffix, "%s/;\"\t%c\tline:%i", truncated == 1 ? "" : "$",
+                csource_tag_letter(tag.kind), tag.line);
+        add_text(&text, suffix, strlen(suffix));
+
+        if(setup->output->format != CSOURCE_FORMAT_TEXT) {
+            INIT_VARIABLE(record);
+
+            record.kind = CSOURCE_RECORD_TAG;
+            record.line = tag.line;
+            record.offset = tag.start;
+            record.payload = text.contents;
+            record.length = text.length;
+
+            csource_output_record(setup->output, record);
+
+            continue;
+        }
+
+        add_text(&text, "\n", 1);
+        csource_output_span(setup->output, text.contents, text.length, tag.start, tag.line);
+    }
+
+    if(text.contents != NULL)
+        csource_allocator.release(text.contents);
+
+    csource_allocator.release(order);
+}
+
+/*
+ * @docgen: function
+ * @brief: write the tags of a file like etags
+ * @name: write_etags
+ *
+ * @description
+ * @Write the section of an etags file for the file, in the order of the
+ * @tags: a form feed, the path and the size of the section, and then for
+ * @each tag the start of its line up to the end of the name, the name,
+ * @its line, and the offset of the line. The section is put together
+ * @first, since its size comes before it.
+ * @description
+ *
+ * @param writer: the writer of the tags
+ * @type: struct TagWriter *
+*/
+static void write_etags(struct TagWriter *writer) {
+    int index = 0;
+    char number[64 + 1];
+    struct TagText text;
+    struct ModuleSetup *setup = writer->setup;
+    struct CSourceTags *tags = writer->tags;
+
+    INIT_VARIABLE(text);
+
+    /* The macros were found after everything else */
+    qsort(tags->contents, tags->length, sizeof(*tags->contents), compare_offsets);
+
+    for(index = 0; index < tags->length; index++) {
+        struct CSourceTag tag = tags->contents[index];
+        int length = tag.end - tag.line_start;
+
+        if(length > CSOURCE_TAG_PATTERN_LIMIT)
+            length = CSOURCE_TAG_PATTERN_LIMIT;
+
+        add_text(&text, setup->input.buffer + tag.line_start, length);
+        add_text(&text, "\177", 1);
+        add_text(&text, setup->input.buffer + tag.start, tag.end - tag.start);
+
+        sprintf(number, "\001%i,%i\n", tag.line, tag.line_start);
+        add_text(&text, number, strlen(number));
+    }
+
+    sprintf(number, ",%i\n", text.length);
+
+    csource_output_span(setup->output, "\f\n", 2, 0, 1);
+    csource_output_span(setup->output, setup->source, strlen(setup->source), 0, 1);
+    csource_output_span(setup->output, number, strlen(number), 0, 1);
+
+    if(text.contents != NULL) {
+        csource_output_span(setup->output, text.contents, text.length, 0, 1);
+        csource_allocator.release(text.contents);
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: order the lines of a tags file
+ * @name: compare_lines
+ *
+ * @param left: the first line
+ * @type: const struct TagLine *
+ *
+ * @param right: the second line
+ * @type: const struct TagLine *
+ *
+ * @return: less than, equal to or greater than 0, like strcmp
+ * @type: int
+*/
+static int compare_lines(const struct TagLine *left, const struct TagLine *right) {
+    int order = 0;
+    int length = left->length < right->length ? left->length : right->length;
+
+    if((order = memcmp(left->text, right->text, length)) != 0)
+        return order;
+
+    return (left->length > right->length) - (left->length < right->length);
+}
+
+/*
+ * @docgen: function
+ * @brief: merge two runs of lines that are in order
+ * @name: merge_lines
+ *
+ * @param lines: the lines
+ * @type: const struct TagLine *
+ *
+ * @param merged: where to put the lines of both runs, in order
+ * @type: struct TagLine *
+ *
+ * @param start: the index the first run starts at
+ * @type: int
+ *
+ * @param middle: the index the second run starts at
+ * @type: int
+ *
+ * @param end: the index the second run ends at
+ * @type: int
+*/
+static void merge_lines(const struct TagLine *lines, struct TagLine *merged, int start,
+                        int middle, int end) {
+    int left = start;
+    int right = middle;
+    int index = start;
+
+    while(left < middle && right < end) {
+        if(compare_lines(lines + right, lines + left) < 0)
+            merged[index++] = lines[right++];
+        else
+            merged[index++] = lines[left++];
+    }
+
+    while(left < middle)
+        merged[index++] = lines[left++];
+
+    while(right < end)
+        merged[index++] = lines[right++];
+}
+
+void csource_tags_write(FILE *stream, const char *buffer, int length) {
+    int index = 0;
+    int count = 0;
+    int runs = 0;
+    int *starts = NULL;
+    struct TagLine *lines = NULL;
+    struct TagLine *merged = NULL;
+    const char *cursor = buffer;
+    const char *end = buffer + length;
+
+    liberror_is_null(csource_tags_write, stream);
+    liberror_is_null(csource_tags_write, buffer);
+
+    fprintf(stream, "!_TAG_FILE_FORMAT\t2\t/extended format/\n");
+    fprintf(stream, "!_TAG_FILE_SORTED\t1\t/0=unsorted, 1=sorted, 2=foldcase/\n");
+    fprintf(stream, "!_TAG_PROGRAM_NAME\tcsource\t//\n");
+
+    for(index = 0; index < length; index++) {
+        if(buffer[index] == '\n')
+            count++;
+    }
+
+    lines = csource_allocator.allocate(sizeof(*lines) * (count + 1));
+    merged = csource_allocator.allocate(sizeof(*lines) * (count + 1));
+    starts = csource_allocator.allocate(sizeof(int) * (count + 2));
+
+    for(count = 0; cursor < end; count++) {
+        const char *newline = memchr(cursor, '\n', end - cursor);
+
+        if(newline == NULL)
+            newline = end;
+
+        lines[count].text = cursor;
+        lines[count].length = newline - cursor;
+        cursor = newline + 1;
+
+        /* A new run starts wherever the lines go out of order */
+        if(count == 0 || compare_lines(lines + count - 1, lines + count) > 0)
+            starts[runs++] = count;
+    }
+
+    starts[runs] = count;
+
+    /* Each pass merges every two runs into one */
+    while(runs > 1) {
+        int pairs = 0;
+        struct TagLine *swap = NULL;
+
+        for(index = 0; index < runs; index += 2) {
+            int stop = index + 2 <= runs ? starts[index + 2] : count;
+
+            merge_lines(lines, merged, starts[index], starts[index + 1], stop);
+            starts[pairs++] = starts[index];
+        }
+
+        starts[pairs] = count;
+        runs = pairs;
+
+        swap = lines;
+        lines = merged;
+        merged = swap;
+    }
+
+    for(index = 0; index < count; index++) {
+        fwrite(lines[index].text, 1, lines[index].length, stream);
+        fputc('\n', stream);
+    }
+
+    csource_allocator.release(lines);
+    csource_allocator.release(merged);
+    csource_allocator.release(starts);
+}
+
+void csource_extract_tags(struct ModuleSetup setup) {
+    struct TagWriter writer;
+    struct CSourceTagVisitor visitor;
+
+    INIT_VARIABLE(writer);
+
+    writer.setup = &setup;
+    writer.tags = carray_init(writer.tags, TAG);
+    writer.line = 1;
+
+    visitor.tag = add_tag;
+    visitor.type = NULL;
+    visitor.variable = NULL;
+    visitor.data = &writer;
+
+    csource_scan_tags(setup.input.buffer, setup.input.length, &visitor);
+
+    if(setup.tags == CSOURCE_TAGS_ETAGS && setup.output->format == CSOURCE_FORMAT_TEXT)
+        write_etags(&writer);
+    else
+        write_ctags(&writer);
+
+    carray_free(writer.tags, TAG);
+}
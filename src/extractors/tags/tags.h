@@ -0,0 +1,338 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_CSOURCE_EXTRACT_TAGS_H
+#define CWARE_CSOURCE_EXTRACT_TAGS_H
+
+#include <stdio.h>
+
+/* Data structure properties */
+#define TAG_TYPE    struct CSourceTag
+#define TAG_HEAP    1
+#define TAG_FREE(value)
+
+#define TYPE_MEMBER_TYPE    struct CSourceTypeMember
+#define TYPE_MEMBER_HEAP    1
+#define TYPE_MEMBER_FREE(value)
+
+/* Kinds of tag, which are the kinds of ctags for C */
+#define CSOURCE_TAG_FUNCTION    0
+#define CSOURCE_TAG_MACRO       1
+#define CSOURCE_TAG_TYPEDEF     2
+#define CSOURCE_TAG_STRUCT      3
+#define CSOURCE_TAG_UNION       4
+#define CSOURCE_TAG_ENUM        5
+#define CSOURCE_TAG_ENUMERATOR  6
+#define CSOURCE_TAG_VARIABLE    7
+
+/* Storage classes of variables at file scope */
+#define CSOURCE_STORAGE_NONE    0
+#define CSOURCE_STORAGE_STATIC  1
+#define CSOURCE_STORAGE_EXTERN  2
+
+/* Formats of tag files (--etags) */
+#define CSOURCE_TAGS_CTAGS  0
+#define CSOURCE_TAGS_ETAGS  1
+
+/* The most of a line a tag keeps to find it by, like ctags */
+#define CSOURCE_TAG_PATTERN_LIMIT   96
+
+struct ModuleSetup;
+
+/*
+ * @docgen: structure
+ * @brief: a name a source file defines at file scope
+ * @name: CSourceTag
+ *
+ * @field start: the index the name starts at
+ * @type: int
+ *
+ * @field end: the index the name ends at
+ * @type: int
+ *
+ * @field line: the line the name is on
+ * @type: int
+ *
+ * @field line_start: the index that line starts at
+ * @type: int
+ *
+ * @field kind: the kind of tag (CSOURCE_TAG_*)
+ * @type: int
+*/
+struct CSourceTag {
+    int start;
+    int end;
+    int line;
+    int line_start;
+    int kind;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the tags of a file
+ * @name: CSourceTags
+ *
+ * @field length: the number of tags
+ * @type: int
+ *
+ * @field capacity: the number of tags there is room for
+ * @type: int
+ *
+ * @field contents: the tags
+ * @type: struct CSourceTag *
+*/
+struct CSourceTags {
+    int length;
+    int capacity;
+    struct CSourceTag *contents;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the name of a member of a type
+ * @name: CSourceTypeMember
+ *
+ * @field start: the index the name starts at
+ * @type: int
+ *
+ * @field end: the index the name ends at
+ * @type: int
+*/
+struct CSourceTypeMember {
+    int start;
+    int end;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the members of a type
+ * @name: CSourceTypeMembers
+ *
+ * @field length: the number of members
+ * @type: int
+ *
+ * @field capacity: the number of members there is room for
+ * @type: int
+ *
+ * @field contents: the members
+ * @type: struct CSourceTypeMember *
+*/
+struct CSourceTypeMembers {
+    int length;
+    int capacity;
+    struct CSourceTypeMember *contents;
+};
+
+/*
+ * @docgen: structure
+ * @brief: a structure, union or enumeration with a body, or a typedef
+ * @name: CSourceType
+ *
+ * @field kind: the kind of type (CSOURCE_TAG_STRUCT, _UNION, _ENUM or _TYPEDEF)
+ * @type: int
+ *
+ * @field name_start: the index the name starts at
+ * @type: int
+ *
+ * @field name_end: the index the name ends at, which is name_start if it has none
+ * @type: int
+ *
+ * @field start: the index the definition starts at
+ * @type: int
+ *
+ * @field end: the index the definition ends at
+ * @type: int
+ *
+ * @field members: the members or constants, which is NULL for a typedef
+ * @type: struct CSourceTypeMembers *
+*/
+struct CSourceType {
+    int kind;
+    int name_start;
+    int name_end;
+    int start;
+    int end;
+    struct CSourceTypeMembers *members;
+};
+
+/*
+ * @docgen: structure
+ * @brief: a variable declared or defined at file scope
+ * @name: CSourceVariable
+ *
+ * @field start: the index the name starts at
+ * @type: int
+ *
+ * @field end: the index the name ends at
+ * @type: int
+ *
+ * @field storage: the storage class of the variable (CSOURCE_STORAGE_*)
+ * @type: int
+ *
+ * @field array: whether the variable is an array
+ * @type: int
+ *
+ * @field initialized: whether the variable has an initializer
+ * @type: int
+*/
+struct CSourceVariable {
+    int start;
+    int end;
+    int storage;
+    int array;
+    int initialized;
+};
+
+/*
+ * @docgen: structure
+ * @brief: what to do with the tags of a source file
+ * @name: CSourceTagVisitor
+ *
+ * @field tag: called with the range and kind of each tag, or NULL
+ * @type: void (*)(struct CSourceTagVisitor *, int, int, int)
+ *
+ * @field type: called with each type the file defines, or NULL
+ * @type: void (*)(struct CSourceTagVisitor *, struct CSourceType *)
+ *
+ * @field variable: called with each variable at file scope, or NULL
+ * @type: void (*)(struct CSourceTagVisitor *, struct CSourceVariable *)
+ *
+ * @field data: whatever the callbacks need
+ * @type: void *
+*/
+struct CSourceTagVisitor {
+    void (*tag)(struct CSourceTagVisitor *visitor, int start, int end, int kind);
+    void (*type)(struct CSourceTagVisitor *visitor, struct CSourceType *type);
+    void (*variable)(struct CSourceTagVisitor *visitor, struct CSourceVariable *variable);
+    void *data;
+};
+
+/*
+ * @docgen: function
+ * @brief: find the tags of a source file
+ * @name: csource_scan_tags
+ *
+ * @description
+ * @Walk a source file, and give every name it defines at file scope to a
+ * @visitor: the functions it defines, the macros, the typedefs, the tags
+ * @of structures, unions and enumerations which have a body, the
+ * @constants of enumerations, and the variables which are not extern. The
+ * @declarations are read over a copy of the file with only its code left,
+ * @so the code of macros is never taken for a declaration. The names are
+ * @given in the order their declarations end, which for the macros is
+ * @after everything else.
+ * @
+ * @The same walk gives the visitor every structure, union and enumeration
+ * @with a body, named or not and at any depth, with the names of its
+ * @members, and every name a typedef at file scope declares. A type is
+ * @given once its end is found, so a nested type comes before the one it
+ * @is in. The members are only kept for the length of the call.
+ * @
+ * @Every variable declared at file scope is given to the visitor too,
+ * @extern or not, in the order they are declared in.
+ * @description
+ *
+ * @error: buffer is NULL
+ * @error: visitor is NULL
+ *
+ * @param buffer: the source file
+ * @type: const char *
+ *
+ * @param length: the length of the source file
+ * @type: int
+ *
+ * @param visitor: the visitor to give the tags to
+ * @type: struct CSourceTagVisitor *
+*/
+void csource_scan_tags(const char *buffer, int length, struct CSourceTagVisitor *visitor);
+
+/*
+ * @docgen: function
+ * @brief: find the letter ctags writes for a kind of tag
+ * @name: csource_tag_letter
+ *
+ * @param kind: the kind of tag (CSOURCE_TAG_*)
+ * @type: int
+ *
+ * @return: the letter, or ? for an unknown kind
+ * @type: char
+*/
+char csource_tag_letter(int kind);
+
+/*
+ * @docgen: function
+ * @brief: write a ctags file
+ * @name: csource_tags_write
+ *
+ * @description
+ * @Write the header of a ctags file, and then the lines of tags in a
+ * @buffer, sorted. Each file's tags are already sorted by the tags
+ * @module, so the lines are sorted by merging the runs that are in
+ * @order, rather than from scratch.
+ * @description
+ *
+ * @error: stream is NULL
+ * @error: buffer is NULL
+ *
+ * @param stream: the stream to write to
+ * @type: FILE *
+ *
+ * @param buffer: the lines of tags, which each end with a new line
+ * @type: const char *
+ *
+ * @param length: the length of the buffer
+ * @type: int
+*/
+void csource_tags_write(FILE *stream, const char *buffer, int length);
+
+/*
+ * @docgen: function
+ * @brief: write the tags of a source file
+ * @name: csource_extract_tags
+ *
+ * @description
+ * @Write the tags of a source file as the lines of a ctags file, in order
+ * @of their names, or as the section of an etags file, in order of where
+ * @they are. Other formats write the line ctags would as a record.
+ * @description
+ *
+ * @param setup: the setup of the module
+ * @type: struct ModuleSetup
+*/
+void csource_extract_tags(struct ModuleSetup setup);
+
+#endif
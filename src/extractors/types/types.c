@@ -0,0 +1,363 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file writes the types a source file defines, which the tags
+ * extractor finds in its walk over the declarations of the file. Types
+ * are given to it as their ends are found, so they are kept, and written
+ * once the walk is over, in the order they start in.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../csource.h"
+#include "../../output/output.h"
+#include "../tags/tags.h"
+
+#include "types.h"
+
+/* Data structure properties */
+#define TYPE_RECORD_TYPE    struct TypeRecord
+#define TYPE_RECORD_HEAP    1
+#define TYPE_RECORD_FREE(value)
+
+/*
+ * @docgen: structure
+ * @brief: a type that was found, and where its members were kept
+ * @name: TypeRecord
+ *
+ * @field type: the type, without its members
+ * @type: struct CSourceType
+ *
+ * @field first: the index of its first member in the members of the file
+ * @type: int
+ *
+ * @field count: the number of members it has
+ * @type: int
+*/
+struct TypeRecord {
+    struct CSourceType type;
+    int first;
+    int count;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the types of a file
+ * @name: TypeRecords
+ *
+ * @field length: the number of types
+ * @type: int
+ *
+ * @field capacity: the number of types there is room for
+ * @type: int
+ *
+ * @field contents: the types
+ * @type: struct TypeRecord *
+*/
+struct TypeRecords {
+    int length;
+    int capacity;
+    struct TypeRecord *contents;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the types of a file that is being walked
+ * @name: TypeWalk
+ *
+ * @field records: the types that were found
+ * @type: struct TypeRecords *
+ *
+ * @field members: the members of every type, one after the other
+ * @type: struct CSourceTypeMembers *
+*/
+struct TypeWalk {
+    struct TypeRecords *records;
+    struct CSourceTypeMembers *members;
+};
+
+/*
+ * @docgen: structure
+ * @brief: text that is being put together
+ * @name: TypeText
+ *
+ * @field contents: the text
+ * @type: char *
+ *
+ * @field length: the length of the text
+ * @type: int
+ *
+ * @field capacity: the number of bytes there is room for
+ * @type: int
+*/
+struct TypeText {
+    char *contents;
+    int length;
+    int capacity;
+};
+
+static const char *kind_names[] = {
+    "unknown", "unknown", "typedef", "struct", "union", "enum"
+};
+
+const char *csource_type_kind(int kind) {
+    if(kind < CSOURCE_TAG_TYPEDEF || kind > CSOURCE_TAG_ENUM)
+        return "unknown";
+
+    return kind_names[kind];
+}
+
+/*
+ * @docgen: function
+ * @brief: keep a type of the file
+ * @name: add_type
+ *
+ * @param visitor: the visitor of the types
+ * @type: struct CSourceTagVisitor *
+ *
+ * @param type: the type
+ * @type: struct CSourceType *
+*/
+static void add_type(struct CSourceTagVisitor *visitor, struct CSourceType *type) {
+    int index = 0;
+    struct TypeRecord record;
+    struct TypeWalk *walk = visitor->data;
+
+    record.type = *type;
+    record.type.members = NULL;
+    record.first = walk->members->length;
+    record.count = 0;
+
+    if(type->members != NULL) {
+        for(index = 0; index < type->members->length; index++) {
+            carray_append(walk->members, type->members->contents[index], TYPE_MEMBER);
+        }
+
+        record.count = type->members->length;
+    }
+
+    carray_append(walk->records, record, TYPE_RECORD);
+}
+
+/*
+ * @docgen: function
+ * @brief: compare two types by where they start
+ * @name: compare_records
+ *
+ * @description
+ * @Order types by where they start, and then by where their names are,
+ * @since every name a typedef declares starts where the typedef does.
+ * @description
+ *
+ * @param first: the first type
+ * @type: const void *
+ *
+ * @param second: the second type
+ * @type: const void *
+ *
+ * @return: less than, equal to, or greater than zero
+ * @type: int
+*/
+static int compare_records(const void *first, const void *second) {
+    const struct TypeRecord *left = first;
+    const struct TypeRecord *right = second;
+
+    if(left->type.start != right->type.start)
+        return left->type.start < right->type.start ? -1 : 1;
+
+    if(left->type.name_start != right->type.name_start)
+        return left->type.name_start < right->type.name_start ? -1 : 1;
+
+    return 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: find the line an index is on
+ * @name: find_line
+ *
+ * @param newlines: the indexes of the new lines of the file, in order
+ * @type: const int *
+ *
+ * @param count: the number of new lines
+ * @type: int
+ *
+ * @param offset: the index
+ * @type: int
+ *
+ * @return: the line, starting from 1
+ * @type: int
+*/
+static int find_line(const int *newlines, int count, int offset) {
+    int low = 0;
+    int high = count;
+
+    /* The line is one more than the number of new lines before the index */
+    while(low < high) {
+        int middle = low + (high - low) / 2;
+
+        if(newlines[middle] < offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low + 1;
+}
+
+/*
+ * @docgen: function
+ * @brief: add bytes to text
+ * @name: add_text
+ *
+ * @param text: the text to add to
+ * @type: struct TypeText *
+ *
+ * @param bytes: the bytes to add
+ * @type: const char *
+ *
+ * @param length: the number of bytes
+ * @type: int
+*/
+static void add_text(struct TypeText *text, const char *bytes, int length) {
+    if(text->length + length > text->capacity) {
+        while(text->length + length > text->capacity)
+            text->capacity = text->capacity * 2 + 256;
+
+        text->contents = csource_allocator.reallocate(text->contents, text->capacity);
+    }
+
+    memcpy(text->contents + text->length, bytes, length);
+    text->length += length;
+}
+
+void csource_extract_types(struct ModuleSetup setup) {
+    int index = 0;
+    int count = 0;
+    int *newlines = NULL;
+    struct TypeText text;
+    struct TypeWalk walk;
+    struct CSourceTagVisitor visitor;
+    const char *buffer = setup.input.buffer;
+
+    INIT_VARIABLE(text);
+    INIT_VARIABLE(walk);
+
+    walk.records = carray_init(walk.records, TYPE_RECORD);
+    walk.members = carray_init(walk.members, TYPE_MEMBER);
+
+    visitor.tag = NULL;
+    visitor.type = add_type;
+    visitor.variable = NULL;
+    visitor.data = &walk;
+
+    csource_scan_tags(buffer, setup.input.length, &visitor);
+
+    qsort(walk.records->contents, walk.records->length, sizeof(struct TypeRecord),
+          compare_records);
+
+    for(index = 0; index < setup.input.length; index++) {
+        if(buffer[index] == '\n')
+            count++;
+    }
+
+    newlines = csource_allocator.allocate(sizeof(int) * (count + 1));
+
+    for(index = 0, count = 0; index < setup.input.length; index++) {
+        if(buffer[index] == '\n')
+            newlines[count++] = index;
+    }
+
+    for(index = 0; index < walk.records->length; index++) {
+        int member = 0;
+        char lines[64 + 1];
+        struct CSourceRecord record;
+        struct TypeRecord type = walk.records->contents[index];
+        const char *kind = csource_type_kind(type.type.kind);
+        int start = find_line(newlines, count, type.type.start);
+        int end = find_line(newlines, count, type.type.end - 1);
+
+        text.length = 0;
+
+        if(setup.output->format == CSOURCE_FORMAT_TEXT) {
+            sprintf(lines, "%i\t\t", start);
+            add_text(&text, lines, strlen(lines));
+        }
+
+        add_text(&text, kind, strlen(kind));
+        add_text(&text, "\t", 1);
+        add_text(&text, buffer + type.type.name_start, type.type.name_end - type.type.name_start);
+
+        sprintf(lines, "\t%i\t%i\t", start, end);
+        add_text(&text, lines, strlen(lines));
+
+        for(member = type.first; member < type.first + type.count; member++) {
+            struct CSourceTypeMember name = walk.members->contents[member];
+
+            if(member > type.first)
+                add_text(&text, ",", 1);
+
+            add_text(&text, buffer + name.start, name.end - name.start);
+        }
+
+        if(setup.output->format == CSOURCE_FORMAT_TEXT) {
+            add_text(&text, "\n", 1);
+            csource_output_span(setup.output, text.contents, text.length, type.type.start, start);
+
+            continue;
+        }
+
+        INIT_VARIABLE(record);
+
+        record.kind = CSOURCE_RECORD_TYPE;
+        record.line = start;
+        record.offset = type.type.start;
+        record.payload = text.contents;
+        record.length = text.length;
+
+        csource_output_record(setup.output, record);
+    }
+
+    if(text.contents != NULL)
+        csource_allocator.release(text.contents);
+
+    csource_allocator.release(newlines);
+    carray_free(walk.records, TYPE_RECORD);
+    carray_free(walk.members, TYPE_MEMBER);
+}
@@ -0,0 +1,205 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file makes a copy of a source file with only its code left in it.
+ * Everything else becomes spaces rather than being removed, so lines and
+ * offsets found in the copy can be reported as lines and offsets of the
+ * source itself.
+*/
+
+#include <string.h>
+
+#include "../../csource.h"
+#include "../comments/comments.h"
+#include "../directives/directives.h"
+
+#include "blank.h"
+
+/*
+ * @docgen: function
+ * @brief: replace part of a buffer with spaces
+ * @name: blank_range
+ *
+ * @param buffer: the buffer to blank
+ * @type: char *
+ *
+ * @param start: the index to start at
+ * @type: int
+ *
+ * @param end: the index to stop before
+ * @type: int
+*/
+static void blank_range(char *buffer, int start, int end) {
+    for(; start < end; start++) {
+        if(buffer[start] != '\n')
+            buffer[start] = ' ';
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: blank a comment
+ * @name: blank_comment
+ *
+ * @param visitor: the visitor of the comments
+ * @type: struct CSourceCommentVisitor *
+ *
+ * @param start: the index the comment starts at
+ * @type: int
+ *
+ * @param end: the index the comment ends at
+ * @type: int
+*/
+static void blank_comment(struct CSourceCommentVisitor *visitor, int start, int end) {
+    blank_range(visitor->data, start, end);
+}
+
+/*
+ * @docgen: function
+ * @brief: blank the strings in a run of code
+ * @name: blank_strings
+ *
+ * @description
+ * @Blank whatever is between the quotes of the strings and character
+ * @constants in a run of code. A run of code never ends inside a string,
+ * @since the pass over the comments skips strings the same way.
+ * @description
+ *
+ * @param visitor: the visitor of the comments
+ * @type: struct CSourceCommentVisitor *
+ *
+ * @param start: the index the run starts at
+ * @type: int
+ *
+ * @param end: the index the run ends at
+ * @type: int
+*/
+static void blank_strings(struct CSourceCommentVisitor *visitor, int start, int end) {
+    char *buffer = visitor->data;
+
+    while(start < end) {
+        int index = 0;
+        char quote = 0;
+
+        if(buffer[start] != '"' && buffer[start] != '\'') {
+            start++;
+
+            continue;
+        }
+
+        quote = buffer[start];
+
+        for(index = start + 1; index < end && buffer[index] != quote; index++) {
+            /* Whatever is escaped cannot close the string */
+            if(buffer[index] == '\\' && index + 1 < end)
+                index++;
+        }
+
+        blank_range(buffer, start + 1, index);
+        start = index + 1;
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: blank a directive
+ * @name: blank_directive
+ *
+ * @param visitor: the visitor of the directives
+ * @type: struct CSourceDirectiveVisitor *
+ *
+ * @param start: the index the directive starts at
+ * @type: int
+ *
+ * @param end: the index the directive ends at
+ * @type: int
+ *
+ * @param line: the line the directive starts on
+ * @type: int
+*/
+static void blank_directive(struct CSourceDirectiveVisitor *visitor, int start, int end,
+                            int line) {
+    blank_range(visitor->data, start, end);
+}
+
+void csource_blank_comments(char *buffer, int length) {
+    struct CSourceCommentVisitor comments;
+
+    liberror_is_null(csource_blank_comments, buffer);
+
+    comments.code = blank_strings;
+    comments.comment = blank_comment;
+    comments.data = buffer;
+
+    csource_scan_comments(buffer, length, &comments);
+}
+
+void csource_blank_only_comments(char *buffer, int length) {
+    struct CSourceCommentVisitor comments;
+
+    liberror_is_null(csource_blank_only_comments, buffer);
+
+    comments.code = NULL;
+    comments.comment = blank_comment;
+    comments.data = buffer;
+
+    csource_scan_comments(buffer, length, &comments);
+}
+
+char *csource_blank(const char *buffer, int length) {
+    char *copy = NULL;
+    struct CSourceDirectiveVisitor directives;
+
+    liberror_is_null(csource_blank, buffer);
+
+    copy = csource_allocator.allocate(length + 1);
+    memcpy(copy, buffer, length);
+    copy[length] = '\0';
+
+    csource_blank_comments(copy, length);
+
+    /* Once the comments are gone, a directive after a comment starts its
+     * line like any other, and nothing in a comment looks like one. */
+    directives.code = NULL;
+    directives.directive = blank_directive;
+    directives.data = copy;
+
+    csource_scan_directives(copy, length, &directives);
+
+    return copy;
+}
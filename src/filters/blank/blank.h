@@ -0,0 +1,109 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_CSOURCE_FILTER_BLANK_H
+#define CWARE_CSOURCE_FILTER_BLANK_H
+
+/*
+ * @docgen: function
+ * @brief: blank the comments and strings of a source file
+ * @name: csource_blank_comments
+ *
+ * @description
+ * @Replace the comments of a source file, and the contents of its strings
+ * @and character constants, by spaces, in place. Directives are left as
+ * @they are. New lines are kept, like in csource_blank.
+ * @description
+ *
+ * @error: buffer is NULL
+ *
+ * @param buffer: the source file
+ * @type: char *
+ *
+ * @param length: the length of the source file
+ * @type: int
+*/
+void csource_blank_comments(char *buffer, int length);
+
+/*
+ * @docgen: function
+ * @brief: blank only the comments of a source file
+ * @name: csource_blank_only_comments
+ *
+ * @description
+ * @Replace the comments of a source file by spaces, in place, and leave
+ * @everything else, strings included, as it is. New lines are kept, like
+ * @in csource_blank.
+ * @description
+ *
+ * @error: buffer is NULL
+ *
+ * @param buffer: the source file
+ * @type: char *
+ *
+ * @param length: the length of the source file
+ * @type: int
+*/
+void csource_blank_only_comments(char *buffer, int length);
+
+/*
+ * @docgen: function
+ * @brief: make a copy of a source file with only its code left
+ * @name: csource_blank
+ *
+ * @description
+ * @Copy a source file with its comments, its preprocessor directives, and
+ * @the contents of its strings and character constants replaced by spaces.
+ * @New lines are kept, so every line and offset in the copy is the same as
+ * @in the source, and a scanner which only understands code can be run
+ * @over the copy without being misled by anything else.
+ * @description
+ *
+ * @error: buffer is NULL
+ *
+ * @param buffer: the source file
+ * @type: const char *
+ *
+ * @param length: the length of the source file
+ * @type: int
+ *
+ * @return: the copy, which is released with csource_allocator
+ * @type: char *
+*/
+char *csource_blank(const char *buffer, int length);
+
+#endif
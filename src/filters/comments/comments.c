@@ -39,12 +39,52 @@
  * This file deals with filtering out comments from C source code. It
  * should filter out both multi-line ANSI comments, as well as C++
  * style single line comments.
+ *
+ * There are two implementations. The reference walks the source one
+ * character at a time through libmatch, and is kept as the model the
+ * fuzzing harness checks against. The one csource uses jumps between
+ * the only bytes that can change its state (slashes and quotes), and
+ * writes everything in between as a single span. That pass is exposed as
+ * csource_scan_comments, so other modules which care about comments (like
+ * docgen) get them from the same lexer.
 */
 
+#include <string.h>
+
 #include "../../csource.h"
+#include "../../output/output.h"
 
 #include "comments.h"
 
+/*
+ * @docgen: function
+ * @brief: write the character the cursor just read
+ * @name: write_previous
+ *
+ * @description
+ * @This function will write the character behind the cursor to the
+ * @output as a span of code. Since the spans of neighbouring characters
+ * @are joined by the output, this does not produce a record for every
+ * @character.
+ * @description
+ *
+ * @param cursor: the cursor that read the character
+ * @type: struct LibmatchCursor *
+ *
+ * @param output: the output to write to
+ * @type: struct CSourceOutput *
+*/
+static void write_previous(struct LibmatchCursor *cursor, struct CSourceOutput *output) {
+    int line = cursor->line + 1;
+    const char *character = cursor->buffer + cursor->cursor - 1;
+
+    /* Reading a new line moves the cursor onto the next line */
+    if(*character == '\n')
+        line--;
+
+    csource_output_span(output, character, 1, cursor->cursor - 1, line);
+}
+
 /*
  * @docgen: function
  * @brief: determine if the cursor is on a multi line comment
@@ -135,6 +175,39 @@ static int is_singleline(struct LibmatchCursor cursor) {
     return 1;
 }
 
+/*
+ * @docgen: function
+ * @brief: determine if the cursor is on a line continuation
+ * @name: is_continuation
+ *
+ * @description
+ * @This function will determine if the cursor is positioned on a
+ * @backslash that is immediately followed by the end of the line, with
+ * @either a Unix or a DOS line ending.
+ * @description
+ *
+ * @notes
+ * @This function does not advance the cursor of the caller.
+ * @notes
+ *
+ * @param cursor: the cursor to check
+ * @type: struct LibmatchCursor
+ *
+ * @return: 1 if it is on a line continuation, 0 if it is not
+ * @type: int
+*/
+static int is_continuation(struct LibmatchCursor cursor) {
+    struct LibmatchCursor dos_cursor = cursor;
+
+    if(libmatch_string_expect(&cursor, "\\\n") == 1)
+        return 1;
+
+    if(libmatch_string_expect(&dos_cursor, "\\\r\n") == 1)
+        return 1;
+
+    return 0;
+}
+
 /*
  * @docgen: function
  * @brief: move the cursor until after the end of a multi line comment
@@ -157,10 +230,16 @@ static int is_singleline(struct LibmatchCursor cursor) {
  * @type: struct LibmatchCursor *
 */
 static void filter_multiline(struct LibmatchCursor *cursor) {
-    liberror_is_null(filter_singleline, cursor);
-    
-    /* Keep traversing forward until a * / is found */
-    while(is_multiline_end(*cursor) == 0)
+    liberror_is_null(filter_multiline, cursor);
+
+    /* Skip the start delimiter, so the * in it cannot also be taken
+     * as the start of the end delimiter */
+    libmatch_cursor_getch(cursor);
+    libmatch_cursor_getch(cursor);
+
+    /* Keep traversing forward until a * / is found, or the file ends
+     * without the comment being closed */
+    while(cursor->cursor < cursor->length && is_multiline_end(*cursor) == 0)
         libmatch_cursor_getch(cursor);
 
     /* We only stop when we are ON the end delimiter--
@@ -178,7 +257,8 @@ static void filter_multiline(struct LibmatchCursor *cursor) {
  * @This function will displace the cursor given to it until it is no
  * @longer on a single line comment. This function will respect backslashes
  * @at the end of a single line comment, as well, and will exhaust them up
- * @until and including the line after the last backslash.
+ * @until and including the line after the last backslash. A backslash
+ * @anywhere else in the comment does not continue it.
  * @description
  *
  * @notes
@@ -194,18 +274,14 @@ static void filter_multiline(struct LibmatchCursor *cursor) {
 static void filter_singleline(struct LibmatchCursor *cursor) {
     liberror_is_null(filter_singleline, cursor);
 
-    /* Go to the end of the line for the comment. If a \ is found,
-     * then that means we need to check the new line. Recursion is
-     * nice here. Should be on the next line incase some idiot has
-     * an extra space after their backslash or whatever, before
-     * recursion starts. */
+    /* Go to the end of the line for the comment. A \ right before the
+     * new line splices the next line onto this one, so the comment
+     * carries on over it. */
     while(cursor->cursor < cursor->length) {
-        if(cursor->buffer[cursor->cursor] == '\\') {
+        if(is_continuation(*cursor) == 1) {
             libmatch_next_line(cursor);
-            
-            filter_singleline(cursor);
 
-            return;
+            continue;
         }
 
         /* Single line comments stop at new lines */
@@ -239,30 +315,28 @@ static void filter_singleline(struct LibmatchCursor *cursor) {
  *
  * @param cursor: the cursor to displace
  * @type: struct LibmatchCursor *
+ *
+ * @param output: the output to write the string to
+ * @type: struct CSourceOutput *
 */
-static void filter_string(struct LibmatchCursor *cursor) {
+static void filter_string(struct LibmatchCursor *cursor, struct CSourceOutput *output) {
     int character = -1;
     int escaped = 0;
  
-    printf("%c", '"');
     libmatch_cursor_getch(cursor);
+    write_previous(cursor, output);
 
     while((character = libmatch_cursor_getch(cursor)) != LIBMATCH_EOF) {
-        if(character == '\\') {
-            escaped = 1;
+        write_previous(cursor, output);
 
-            printf("%c", '\\');
+        if(character == '\\' && escaped == 0) {
+            escaped = 1;
 
             continue;
         }
 
-        if(character == '"' && escaped == 0) {
-            printf("%c", '"');
-
+        if(character == '"' && escaped == 0)
             break;
-        }
-
-        printf("%c", character);
 
         escaped = 0;
     }
@@ -289,37 +363,35 @@ static void filter_string(struct LibmatchCursor *cursor) {
  *
  * @param cursor: the cursor to displace
  * @type: struct LibmatchCursor *
+ *
+ * @param output: the output to write the character string to
+ * @type: struct CSourceOutput *
 */
-static void filter_character_string(struct LibmatchCursor *cursor) {
+static void filter_character_string(struct LibmatchCursor *cursor, struct CSourceOutput *output) {
     int character = -1;
     int escaped = 0;
  
-    printf("%c", '\'');
     libmatch_cursor_getch(cursor);
+    write_previous(cursor, output);
 
     while((character = libmatch_cursor_getch(cursor)) != LIBMATCH_EOF) {
-        if(character == '\\') {
-            escaped = 1;
+        write_previous(cursor, output);
 
-            printf("%c", '\\');
+        if(character == '\\' && escaped == 0) {
+            escaped = 1;
 
             continue;
         }
 
-        if(character == '\'' && escaped == 0) {
-            printf("%c", '\'');
-
+        if(character == '\'' && escaped == 0)
             break;
-        }
-
-        printf("%c", character);
 
         escaped = 0;
     }
 }
 
-void csource_filter_comments(struct ModuleSetup setup) {
-    struct LibmatchCursor cursor = libmatch_cursor_from_stream(setup.file);
+void csource_filter_comments_reference(struct ModuleSetup setup) {
+    struct LibmatchCursor cursor = setup.input;
 
     /* Enable pushback so we do not end up ignoring characters
      * because they failed a match. a / and * will mean a comment,
@@ -340,18 +412,308 @@ void csource_filter_comments(struct ModuleSetup setup) {
 
             continue;
         } else if(cursor.buffer[cursor.cursor] == '"') {
-            filter_string(&cursor);
+            filter_string(&cursor, setup.output);
 
             continue;
         } else if(cursor.buffer[cursor.cursor] == '\'') {
-            filter_character_string(&cursor);
+            filter_character_string(&cursor, setup.output);
 
             continue;
         }
 
-        printf("%c", cursor.buffer[cursor.cursor]);
         libmatch_cursor_getch(&cursor);
+        write_previous(&cursor, setup.output);
+    }
+}
+
+/* Word-at-a-time scanning. A word of ONES has a 1 in every byte, and
+ * has_zero_byte is non-zero exactly when some byte of the word is 0,
+ * so a byte can be searched for by XORing it into every lane first. */
+#define ONES    ((unsigned long) -1 / 0xFF)
+#define HIGHS   (ONES * 0x80)
+
+#define has_zero_byte(word) \
+    (((word) - ONES) & ~(word) & HIGHS)
+
+#define has_byte(word, byte) \
+    has_zero_byte((word) ^ (ONES * (unsigned char) (byte)))
+
+/*
+ * @docgen: function
+ * @brief: find the next byte that can start a comment or a string
+ * @name: find_special
+ *
+ * @description
+ * @Find the next slash, double quote or single quote in a buffer. Whole
+ * @words of the buffer are checked at once, so long runs of ordinary
+ * @code are skipped without looking at each byte.
+ * @description
+ *
+ * @param buffer: the buffer to search
+ * @type: const char *
+ *
+ * @param index: the index to start searching at
+ * @type: int
+ *
+ * @param length: the length of the buffer
+ * @type: int
+ *
+ * @return: the index of the byte, or the length if there is none
+ * @type: int
+*/
+static int find_special(const char *buffer, int index, int length) {
+    while(index + (int) sizeof(unsigned long) <= length) {
+        unsigned long word = 0;
+
+        memcpy(&word, buffer + index, sizeof(word));
+
+        if((has_byte(word, '/') | has_byte(word, '"') | has_byte(word, '\'')) != 0)
+            break;
+
+        index += sizeof(word);
+    }
+
+    for(; index < length; index++) {
+        if(buffer[index] == '/' || buffer[index] == '"' || buffer[index] == '\'')
+            break;
+    }
+
+    return index;
+}
+
+/*
+ * @docgen: function
+ * @brief: find the end of a string or character string
+ * @name: skip_quoted
+ *
+ * @param buffer: the buffer the string is in
+ * @type: const char *
+ *
+ * @param index: the index of the opening quote
+ * @type: int
+ *
+ * @param length: the length of the buffer
+ * @type: int
+ *
+ * @return: the index after the closing quote, or the length if unclosed
+ * @type: int
+*/
+static int skip_quoted(const char *buffer, int index, int length) {
+    char quote = buffer[index];
+
+    for(index++; index < length; index++) {
+        /* Whatever is escaped cannot close the string */
+        if(buffer[index] == '\\') {
+            index++;
+
+            continue;
+        }
+
+        if(buffer[index] == quote)
+            return index + 1;
     }
 
-    libmatch_cursor_free(&cursor);
+    return length;
+}
+
+/*
+ * @docgen: function
+ * @brief: find the end of a multi line comment
+ * @name: skip_multiline
+ *
+ * @param buffer: the buffer the comment is in
+ * @type: const char *
+ *
+ * @param index: the index of the / that starts the comment
+ * @type: int
+ *
+ * @param length: the length of the buffer
+ * @type: int
+ *
+ * @return: the index after the comment, or the length if unclosed
+ * @type: int
+*/
+static int skip_multiline(const char *buffer, int index, int length) {
+    const char *star = NULL;
+
+    index += 2;
+
+    while((star = memchr(buffer + index, '*', length - index)) != NULL) {
+        index = star - buffer + 1;
+
+        if(index < length && buffer[index] == '/')
+            return index + 1;
+    }
+
+    return length;
+}
+
+/*
+ * @docgen: function
+ * @brief: find the end of a single line comment
+ * @name: skip_singleline
+ *
+ * @description
+ * @Find the new line that ends a single line comment. A backslash right
+ * @before a new line continues the comment onto the next line.
+ * @description
+ *
+ * @param buffer: the buffer the comment is in
+ * @type: const char *
+ *
+ * @param index: the index of the / that starts the comment
+ * @type: int
+ *
+ * @param length: the length of the buffer
+ * @type: int
+ *
+ * @return: the index of the new line that ends the comment, or the length
+ * @type: int
+*/
+static int skip_singleline(const char *buffer, int index, int length) {
+    int start = index + 2;
+    const char *newline = NULL;
+
+    index = start;
+
+    while((newline = memchr(buffer + index, '\n', length - index)) != NULL) {
+        int end = newline - buffer;
+
+        if(end - 1 >= start && buffer[end - 1] == '\\') {
+            index = end + 1;
+
+            continue;
+        }
+
+        if(end - 2 >= start && buffer[end - 1] == '\r' && buffer[end - 2] == '\\') {
+            index = end + 1;
+
+            continue;
+        }
+
+        return end;
+    }
+
+    return length;
+}
+
+/*
+ * @docgen: structure
+ * @brief: where strip-comments is in writing the code it keeps
+ * @name: CommentFilter
+ *
+ * @field output: the output to write to
+ * @type: struct CSourceOutput *
+ *
+ * @field buffer: the buffer the code is in
+ * @type: const char *
+ *
+ * @field counted: the index lines have been counted up to
+ * @type: int
+ *
+ * @field line: the line of the index lines have been counted up to
+ * @type: int
+*/
+struct CommentFilter {
+    struct CSourceOutput *output;
+    const char *buffer;
+    int counted;
+    int line;
+};
+
+/*
+ * @docgen: function
+ * @brief: write a run of code as a span
+ * @name: write_run
+ *
+ * @description
+ * @Write the code between two indexes as one span. Only formats with
+ * @records need the line the span starts on, so the lines are only
+ * @counted for those, and only from where the last count stopped.
+ * @description
+ *
+ * @param visitor: the visitor of strip-comments
+ * @type: struct CSourceCommentVisitor *
+ *
+ * @param start: the index the run starts at
+ * @type: int
+ *
+ * @param end: the index the run ends at
+ * @type: int
+*/
+static void write_run(struct CSourceCommentVisitor *visitor, int start, int end) {
+    const char *newline = NULL;
+    struct CommentFilter *filter = visitor->data;
+
+    if(filter->output->format != CSOURCE_FORMAT_TEXT) {
+        while((newline = memchr(filter->buffer + filter->counted, '\n',
+                                start - filter->counted)) != NULL) {
+            filter->counted = newline - filter->buffer + 1;
+            filter->line++;
+        }
+
+        filter->counted = start;
+    }
+
+    csource_output_span(filter->output, filter->buffer + start, end - start, start, filter->line);
+}
+
+void csource_scan_comments(const char *buffer, int length, struct CSourceCommentVisitor *visitor) {
+    int index = 0;
+    int run = 0;
+
+    liberror_is_null(csource_scan_comments, buffer);
+    liberror_is_null(csource_scan_comments, visitor);
+
+    /* Everything is part of the run of code until a comment starts,
+     * including strings, which only need skipping so that nothing in
+     * them is taken as a comment. */
+    while((index = find_special(buffer, index, length)) < length) {
+        int end = index;
+
+        if(buffer[index] == '"' || buffer[index] == '\'') {
+            index = skip_quoted(buffer, index, length);
+
+            continue;
+        }
+
+        if(index + 1 < length && buffer[index + 1] == '*')
+            end = skip_multiline(buffer, index, length);
+        else if(index + 1 < length && buffer[index + 1] == '/')
+            end = skip_singleline(buffer, index, length);
+
+        /* A lone slash is just code */
+        if(end == index) {
+            index++;
+
+            continue;
+        }
+
+        if(visitor->code != NULL && run < index)
+            visitor->code(visitor, run, index);
+
+        if(visitor->comment != NULL)
+            visitor->comment(visitor, index, end);
+
+        run = index = end;
+    }
+
+    if(visitor->code != NULL && run < length)
+        visitor->code(visitor, run, length);
+}
+
+void csource_filter_comments(struct ModuleSetup setup) {
+    struct CommentFilter filter;
+    struct CSourceCommentVisitor visitor;
+
+    filter.output = setup.output;
+    filter.buffer = setup.input.buffer;
+    filter.counted = 0;
+    filter.line = 1;
+
+    visitor.code = write_run;
+    visitor.comment = NULL;
+    visitor.data = &filter;
+
+    csource_scan_comments(setup.input.buffer, setup.input.length, &visitor);
 }
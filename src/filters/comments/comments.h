@@ -40,6 +40,87 @@
 
 struct ModuleSetup;
 
+/*
+ * @docgen: structure
+ * @brief: what to do with the code and comments of a source file
+ * @name: CSourceCommentVisitor
+ *
+ * @description
+ * @The callbacks of a pass over the comments of a source file. Either
+ * @callback can be NULL if that part of the source is not wanted. The
+ * @indexes given to them are a half open range of the buffer.
+ * @description
+ *
+ * @field code: called with each run of code between comments
+ * @type: void (*)(struct CSourceCommentVisitor *, int, int)
+ *
+ * @field comment: called with each comment, including its delimiters
+ * @type: void (*)(struct CSourceCommentVisitor *, int, int)
+ *
+ * @field data: whatever the callbacks need
+ * @type: void *
+*/
+struct CSourceCommentVisitor {
+    void (*code)(struct CSourceCommentVisitor *visitor, int start, int end);
+    void (*comment)(struct CSourceCommentVisitor *visitor, int start, int end);
+    void *data;
+};
+
+/*
+ * @docgen: function
+ * @brief: split a source file into its code and its comments
+ * @name: csource_scan_comments
+ *
+ * @description
+ * @Walk a source file once, and give every run of code and every comment
+ * @to a visitor in the order they appear. Strings and character strings
+ * @are part of the code, so nothing inside of them starts a comment. A
+ * @comment which is never closed runs to the end of the buffer.
+ * @description
+ *
+ * @error: buffer is NULL
+ * @error: visitor is NULL
+ *
+ * @param buffer: the source to scan
+ * @type: const char *
+ *
+ * @param length: the length of the source
+ * @type: int
+ *
+ * @param visitor: the visitor to give the code and comments to
+ * @type: struct CSourceCommentVisitor *
+*/
+void csource_scan_comments(const char *buffer, int length, struct CSourceCommentVisitor *visitor);
+
+/*
+ * @docgen: function
+ * @brief: write a source file without its comments
+ * @name: csource_filter_comments
+ *
+ * @description
+ * @Write everything in the source file except its comments to the
+ * @output, as spans of code.
+ * @description
+ *
+ * @param setup: the module setup to filter from and write to
+ * @type: struct ModuleSetup
+*/
 void csource_filter_comments(struct ModuleSetup setup);
 
+/*
+ * @docgen: function
+ * @brief: the reference model of csource_filter_comments
+ * @name: csource_filter_comments_reference
+ *
+ * @description
+ * @Filter comments out one character at a time. This produces the same
+ * @output as csource_filter_comments, and is what the fuzzing harness
+ * @checks it against.
+ * @description
+ *
+ * @param setup: the module setup to filter from and write to
+ * @type: struct ModuleSetup
+*/
+void csource_filter_comments_reference(struct ModuleSetup setup);
+
 #endif
@@ -51,9 +51,19 @@
  * We literally detect whether or not its the first printable character by
  * using libmatch_cond_before with a string of every printable without the
  * pound sign. High quality code for sure.
+ *
+ * That is still how the reference implementation works, which the fuzzing
+ * harness checks against. The one csource uses never copies a line: it
+ * finds the end of each line with memchr, and writes the lines between
+ * two directives as a single span. That pass is exposed on its own as
+ * csource_scan_directives, for the modules that care about the directives
+ * rather than the code around them.
 */
 
+#include <string.h>
+
 #include "../../csource.h"
+#include "../../output/output.h"
 
 #include "directives.h"
 
@@ -88,76 +98,259 @@ static int is_directive(struct LibmatchCursor cursor) {
 
 /*
  * @docgen: function
- * @brief: print the contents of a line until a character
- * @name: print_line_until
+ * @brief: determine if a line is continued onto the next line
+ * @name: is_continued
  *
  * @description
- * @This function will a line until a character sign is met, and when it
- * @is met, filter the rest of the line out. Either way, no matter what,
- * @it will always stop at the end of the line.
+ * @This function will determine whether or not a line ends with a
+ * @backslash, which splices the next line onto it. The line may still
+ * @have the carriage return of a DOS line ending on it.
  * @description
  *
- * @error: cursor is NULL
- * @error: character is less than 0
+ * @param line: the line to check, without its new line
+ * @type: const char *
  *
- * @param stop_at: the character to print until
+ * @param length: the length of the line
  * @type: int
  *
- * @param cursor: the cursor to print from
- * @type: struct LibmatchCursor *
+ * @return: 1 if the line is continued, 0 if it is not
+ * @type: int
 */
-static void print_line_until(struct LibmatchCursor *cursor, int stop_at) {
-    int character = -1;
-
-    liberror_is_null(print_line_until, cursor);
-    liberror_is_negative(print_line_until, stop_at);
+static int is_continued(const char *line, int length) {
+    if(length > 0 && line[length - 1] == '\\')
+        return 1;
 
-    while((character = libmatch_cursor_getch(cursor)) != LIBMATCH_EOF) {
-        if(character == stop_at) {
-            libmatch_next_line(cursor);
-
-            break;
-        }
+    if(length > 1 && line[length - 1] == '\r' && line[length - 2] == '\\')
+        return 1;
 
-        if(character == '\n')
-            break;
-        
-        printf("%c", character);
-    }
+    return 0;
 }
 
-void csource_filter_directives(struct ModuleSetup setup) {
-    struct LibmatchCursor cursor = libmatch_cursor_from_stream(setup.file);
+void csource_filter_directives_reference(struct ModuleSetup setup) {
+    struct LibmatchCursor cursor = setup.input;
 
     while(cursor.cursor < cursor.length) {
-        int cancel_next_line = 0;
+        int start = cursor.cursor;
+        int line_number = cursor.line + 1;
         struct LibmatchCursor sub_cursor;
         char *line = libmatch_read_alloc_until(&cursor, "\n");
+        int length = strlen(line);
 
-        sub_cursor = libmatch_cursor_init(line, strlen(line) + 1);
+        sub_cursor = libmatch_cursor_init(line, length + 1);
 
         if(is_directive(sub_cursor) == 0) {
-            printf("%s\n", line);
+            /* The last line of the file may not have a new line, but
+             * one is always written after it. */
+            if(start + length < cursor.length) {
+                csource_output_span(setup.output, cursor.buffer + start, length + 1, start, line_number);
+            } else {
+                csource_output_span(setup.output, cursor.buffer + start, length, start, line_number);
+                csource_output_span(setup.output, "\n", 1, start + length, line_number);
+            }
 
-            free(line);
+            libmatch_free_hook(line);
             
             continue;
         }
 
         /* Keep reading lines until line has no more \ on it */
-        while(cursor.cursor < cursor.length) {
-            if(line[strlen(line) - 1] != '\\') {
-                free(line);
-
-                break;
-            }
-            
-            free(line);
+        while(cursor.cursor < cursor.length && is_continued(line, length) == 1) {
+            libmatch_free_hook(line);
 
             line = libmatch_read_alloc_until(&cursor, "\n");
+            length = strlen(line);
+        }
+
+        libmatch_free_hook(line);
+    }
+}
+
+/* The printable characters are exactly the graphic ASCII characters,
+ * so checking the range is the same as looking the byte up in
+ * PRINTABLES_WITHOUT_POUND, with the pound sign on top. */
+#define is_printable(character) \
+    ((character) > ' ' && (character) < 0x7F)
+
+/*
+ * @docgen: function
+ * @brief: determine if a line of a buffer is a directive
+ * @name: is_directive_line
+ *
+ * @param buffer: the buffer the line is in
+ * @type: const char *
+ *
+ * @param start: the index the line starts at
+ * @type: int
+ *
+ * @param end: the index the line ends at, which is its new line
+ * @type: int
+ *
+ * @return: 1 if the first printable character is a #, 0 otherwise
+ * @type: int
+*/
+static int is_directive_line(const char *buffer, int start, int end) {
+    for(; start < end; start++) {
+        int character = (unsigned char) buffer[start];
+
+        if(is_printable(character) == 0)
+            continue;
+
+        return character == '#';
+    }
+
+    return 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: find the end of the line an index is on
+ * @name: line_end
+ *
+ * @param buffer: the buffer to search
+ * @type: const char *
+ *
+ * @param index: the index to search from
+ * @type: int
+ *
+ * @param length: the length of the buffer
+ * @type: int
+ *
+ * @return: the index of the next new line, or the length if there is none
+ * @type: int
+*/
+static int line_end(const char *buffer, int index, int length) {
+    const char *newline = memchr(buffer + index, '\n', length - index);
+
+    if(newline == NULL)
+        return length;
+
+    return newline - buffer;
+}
+
+void csource_scan_directives(const char *buffer, int length,
+                             struct CSourceDirectiveVisitor *visitor) {
+    int index = 0;
+    int line = 1;
+    int run = 0;
+    int run_line = 1;
+
+    liberror_is_null(csource_scan_directives, buffer);
+    liberror_is_null(csource_scan_directives, visitor);
+
+    while(index < length) {
+        int start = index;
+        int start_line = line;
+        int end = line_end(buffer, index, length);
+
+        /* Lines that are not directives join the run of code */
+        if(is_directive_line(buffer, index, end) == 0) {
+            index = end + 1;
+            line++;
+
+            continue;
         }
+
+        if(visitor->code != NULL && run < start)
+            visitor->code(visitor, run, start, run_line);
+
+        /* Take in the lines the directive is continued onto */
+        while(end + 1 < length && is_continued(buffer + index, end - index) == 1) {
+            index = end + 1;
+            end = line_end(buffer, index, length);
+            line++;
+        }
+
+        if(visitor->directive != NULL)
+            visitor->directive(visitor, start, end, start_line);
+
+        index = end + 1;
+        line++;
+        run = index;
+        run_line = line;
+    }
+
+    if(visitor->code != NULL && run < length)
+        visitor->code(visitor, run, length, run_line);
+}
+
+int csource_directive_name(const char *buffer, int start, int end, int *length) {
+    int name = start;
+
+    liberror_is_null(csource_directive_name, buffer);
+    liberror_is_null(csource_directive_name, length);
+
+    while(name < end && buffer[name] != '#')
+        name++;
+
+    /* A continuation is the same as whitespace here */
+    for(name++; name < end; name++) {
+        if(buffer[name] == '\\' && name + 1 < end &&
+           (buffer[name + 1] == '\n' || buffer[name + 1] == '\r'))
+            continue;
+
+        if(buffer[name] != ' ' && buffer[name] != '\t' && buffer[name] != '\r' &&
+           buffer[name] != '\n' && buffer[name] != '\f' && buffer[name] != '\v')
+            break;
+    }
+
+    for(*length = 0; name + *length < end; (*length)++) {
+        char character = buffer[name + *length];
+
+        if((character < 'a' || character > 'z') && (character < 'A' || character > 'Z') &&
+           (character < '0' || character > '9') && character != '_')
+            break;
     }
-    
 
-    libmatch_cursor_free(&cursor);
+    return name;
+}
+
+/*
+ * @docgen: function
+ * @brief: write a run of code as a span
+ * @name: write_run
+ *
+ * @description
+ * @Write a run of lines that are not directives. The last line of the file
+ * @may not have a new line, but one is always written after it.
+ * @description
+ *
+ * @param visitor: the visitor of strip-directives
+ * @type: struct CSourceDirectiveVisitor *
+ *
+ * @param start: the index the run starts at
+ * @type: int
+ *
+ * @param end: the index after the end of the run
+ * @type: int
+ *
+ * @param line: the line the run starts on
+ * @type: int
+*/
+static void write_run(struct CSourceDirectiveVisitor *visitor, int start, int end, int line) {
+    const char *newline = NULL;
+    struct ModuleSetup *setup = visitor->data;
+    const char *buffer = setup->input.buffer;
+
+    csource_output_span(setup->output, buffer + start, end - start, start, line);
+
+    if(end < setup->input.length || buffer[end - 1] == '\n')
+        return;
+
+    /* The new line is a span of its own, so it needs the line it is on */
+    while((newline = memchr(buffer + start, '\n', end - start)) != NULL) {
+        start = newline - buffer + 1;
+        line++;
+    }
+
+    csource_output_span(setup->output, "\n", 1, end, line);
+}
+
+void csource_filter_directives(struct ModuleSetup setup) {
+    struct CSourceDirectiveVisitor visitor;
+
+    visitor.code = write_run;
+    visitor.directive = NULL;
+    visitor.data = &setup;
+
+    csource_scan_directives(setup.input.buffer, setup.input.length, &visitor);
 }
@@ -43,6 +43,123 @@ struct ModuleSetup;
 #define PRINTABLES_WITHOUT_POUND      \
     "QWERTYUIOPASDFGHJKLZXCVBNMqwertyuiopasdfghjklzxcvbnm[];',./{}:\"<>?1234567890!@$%^&*()-=_+`~\\|"
 
+/*
+ * @docgen: structure
+ * @brief: what to do with the code and directives of a source file
+ * @name: CSourceDirectiveVisitor
+ *
+ * @description
+ * @The callbacks of a pass over the directives of a source file. Either
+ * @callback can be NULL if that part of the source is not wanted. Both
+ * @are given a half open range of the buffer, and the line it starts on.
+ * @description
+ *
+ * @field code: called with each run of lines between directives
+ * @type: void (*)(struct CSourceDirectiveVisitor *, int, int, int)
+ *
+ * @field directive: called with each directive, up to its last new line
+ * @type: void (*)(struct CSourceDirectiveVisitor *, int, int, int)
+ *
+ * @field data: whatever the callbacks need
+ * @type: void *
+*/
+struct CSourceDirectiveVisitor {
+    void (*code)(struct CSourceDirectiveVisitor *visitor, int start, int end, int line);
+    void (*directive)(struct CSourceDirectiveVisitor *visitor, int start, int end, int line);
+    void *data;
+};
+
+/*
+ * @docgen: function
+ * @brief: split a source file into its code and its directives
+ * @name: csource_scan_directives
+ *
+ * @description
+ * @Walk a source file once, and give every run of code and every directive
+ * @to a visitor in the order they appear. A directive is a line whose first
+ * @printable character is a #, along with every line it is continued onto
+ * @by a backslash right before the new line. The range of a directive
+ * @starts at the start of its first line, and ends before the new line of
+ * @its last line.
+ * @description
+ *
+ * @error: buffer is NULL
+ * @error: visitor is NULL
+ *
+ * @param buffer: the source to scan
+ * @type: const char *
+ *
+ * @param length: the length of the source
+ * @type: int
+ *
+ * @param visitor: the visitor to give the code and directives to
+ * @type: struct CSourceDirectiveVisitor *
+*/
+void csource_scan_directives(const char *buffer, int length,
+                             struct CSourceDirectiveVisitor *visitor);
+
+/*
+ * @docgen: function
+ * @brief: find the name of a directive
+ * @name: csource_directive_name
+ *
+ * @description
+ * @Find the name of a directive found by csource_scan_directives, which is
+ * @the identifier after its #, like include or ifdef. Blanks and
+ * @continuations may come between the # and the name.
+ * @description
+ *
+ * @error: buffer is NULL
+ * @error: length is NULL
+ *
+ * @param buffer: the buffer the directive is in
+ * @type: const char *
+ *
+ * @param start: the index the directive starts at
+ * @type: int
+ *
+ * @param end: the index the directive ends at
+ * @type: int
+ *
+ * @param length: where to store the length of the name, which is 0 if
+ * the directive has none
+ * @type: int *
+ *
+ * @return: the index of the name
+ * @type: int
+*/
+int csource_directive_name(const char *buffer, int start, int end, int *length);
+
+/*
+ * @docgen: function
+ * @brief: write a source file without its preprocessor directives
+ * @name: csource_filter_directives
+ *
+ * @description
+ * @Write every line of the source file that is not part of a directive
+ * @to the output, as spans of code. A directive continues onto the next
+ * @line when it ends with a backslash.
+ * @description
+ *
+ * @param setup: the module setup to filter from and write to
+ * @type: struct ModuleSetup
+*/
 void csource_filter_directives(struct ModuleSetup setup);
 
+/*
+ * @docgen: function
+ * @brief: the reference model of csource_filter_directives
+ * @name: csource_filter_directives_reference
+ *
+ * @description
+ * @Filter directives out by copying each line and checking it on its
+ * @own. This produces the same output as csource_filter_directives, and
+ * @is what the fuzzing harness checks it against.
+ * @description
+ *
+ * @param setup: the module setup to filter from and write to
+ * @type: struct ModuleSetup
+*/
+void csource_filter_directives_reference(struct ModuleSetup setup);
+
 #endif
@@ -0,0 +1,879 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * The expressions of #if and #elif. This is a small recursive descent
+ * parser over the text of the directive, which evaluates as it parses.
+ * Every value carries whether it is known, so a macro prune has not been
+ * told about poisons only what depends on it, and the conditional it is in
+ * can be left intact.
+*/
+
+#include <limits.h>
+#include <string.h>
+
+#include "../../csource.h"
+#include "../../common/common.h"
+#include "../../extractors/defines/defines.h"
+
+#include "expression.h"
+
+/* Kinds of tokens */
+#define TOKEN_END           0
+#define TOKEN_NUMBER        1
+#define TOKEN_IDENTIFIER    2
+#define TOKEN_PUNCTUATOR    3
+
+#define is_digit(character) \
+    ((character) >= '0' && (character) <= '9')
+
+/*
+ * @docgen: structure
+ * @brief: a value which may not be known
+ * @name: ExpressionValue
+ *
+ * @field value: the value, if it is known
+ * @type: long
+ *
+ * @field known: whether the value is known
+ * @type: int
+ *
+ * @field is_unsigned: whether the value is unsigned, if it is known
+ * @type: int
+*/
+struct ExpressionValue {
+    long value;
+    int known;
+    int is_unsigned;
+};
+
+/*
+ * @docgen: structure
+ * @brief: a token of an expression
+ * @name: ExpressionToken
+ *
+ * @field type: the kind of token (TOKEN_*)
+ * @type: int
+ *
+ * @field text: the text of the token
+ * @type: const char *
+ *
+ * @field length: the length of the token
+ * @type: int
+ *
+ * @field value: the value of a number
+ * @type: long
+ *
+ * @field is_unsigned: whether the number is unsigned
+ * @type: int
+*/
+struct ExpressionToken {
+    int type;
+    const char *text;
+    int length;
+    long value;
+    int is_unsigned;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the state of parsing an expression
+ * @name: Expression
+ *
+ * @field text: the expression
+ * @type: const char *
+ *
+ * @field length: the length of the expression
+ * @type: int
+ *
+ * @field index: the index of the next token
+ * @type: int
+ *
+ * @field depth: how many macros deep the expression is
+ * @type: int
+ *
+ * @field nesting: how deep the parser is in the expression
+ * @type: int
+ *
+ * @field expansions: the macros expanded so far, shared by every level
+ * @type: int *
+ *
+ * @field failed: set when the expression could not be parsed
+ * @type: int
+ *
+ * @field defines: the definitions of the macros
+ * @type: const struct CSourceDefines *
+*/
+struct Expression {
+    const char *text;
+    int length;
+    int index;
+    int depth;
+    int nesting;
+    int *expansions;
+    int failed;
+    const struct CSourceDefines *defines;
+};
+
+/* Binary operators, from the loosest binding to the tightest */
+static const char *operators[] = {
+    "||", "&&", "|", "^", "&", "==", "!=", "<", ">", "<=", ">=", "<<", ">>",
+    "+", "-", "*", "/", "%", NULL
+};
+
+static const int precedences[] = {
+    1, 2, 3, 4, 5, 6, 6, 7, 7, 7, 7, 8, 8, 9, 9, 10, 10, 10
+};
+
+static struct ExpressionValue parse_conditional(struct Expression *expression);
+
+static struct ExpressionValue typed(long value, int is_unsigned) {
+    struct ExpressionValue result;
+
+    result.value = value;
+    result.known = 1;
+    result.is_unsigned = is_unsigned;
+
+    return result;
+}
+
+static struct ExpressionValue known(long value) {
+    return typed(value, 0);
+}
+
+static struct ExpressionValue unknown(void) {
+    struct ExpressionValue result;
+
+    result.value = 0;
+    result.known = 0;
+    result.is_unsigned = 0;
+
+    return result;
+}
+
+/*
+ * @docgen: function
+ * @brief: skip whitespace, continuations and comments
+ * @name: skip_blanks
+ *
+ * @param expression: the expression to skip in
+ * @type: struct Expression *
+*/
+static void skip_blanks(struct Expression *expression) {
+    const char *text = expression->text;
+
+    while(expression->index < expression->length) {
+        int index = expression->index;
+        int remaining = expression->length - index;
+
+        if(text[index] == ' ' || text[index] == '\t' || text[index] == '\r' ||
+           text[index] == '\n' || text[index] == '\f' || text[index] == '\v') {
+            expression->index++;
+        } else if(text[index] == '\\' && remaining > 1 &&
+                  (text[index + 1] == '\n' || text[index + 1] == '\r')) {
+            expression->index++;
+        } else if(remaining > 1 && text[index] == '/' && text[index + 1] == '*') {
+            const char *end = text + index + 2;
+
+            while(end + 1 < text + expression->length && (end[0] != '*' || end[1] != '/'))
+                end++;
+
+            expression->index = end + 2 - text;
+
+            if(expression->index > expression->length)
+                expression->index = expression->length;
+        } else if(remaining > 1 && text[index] == '/' && text[index + 1] == '/') {
+            expression->index = expression->length;
+        } else {
+            break;
+        }
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: read the value of a character constant
+ * @name: read_character
+ *
+ * @param expression: the expression, on the opening quote
+ * @type: struct Expression *
+ *
+ * @param token: the token to fill in
+ * @type: struct ExpressionToken *
+*/
+static void read_character(struct Expression *expression, struct ExpressionToken *token) {
+    const char *text = expression->text;
+    int index = expression->index + 1;
+    long value = 0;
+
+    if(index < expression->length && text[index] == '\\' && index + 1 < expression->length) {
+        index++;
+
+        switch(text[index]) {
+            case 'n': value = '\n'; index++; break;
+            case 't': value = '\t'; index++; break;
+            case 'r': value = '\r'; index++; break;
+            case 'a': value = '\a'; index++; break;
+            case 'b': value = '\b'; index++; break;
+            case 'f': value = '\f'; index++; break;
+            case 'v': value = '\v'; index++; break;
+            case 'x':
+                for(index++; index < expression->length; index++) {
+                    char digit = text[index];
+
+                    if(is_digit(digit))
+                        value = value * 16 + (digit - '0');
+                    else if(digit >= 'a' && digit <= 'f')
+                        value = value * 16 + (digit - 'a' + 10);
+                    else if(digit >= 'A' && digit <= 'F')
+                        value = value * 16 + (digit - 'A' + 10);
+                    else
+                        break;
+                }
+
+                break;
+            default:
+                if(text[index] < '0' || text[index] > '7') {
+                    value = (unsigned char) text[index++];
+
+                    break;
+                }
+
+                for(; index < expression->length && text[index] >= '0' && text[index] <= '7';
+                    index++)
+                    value = value * 8 + (text[index] - '0');
+        }
+    } else if(index < expression->length) {
+        value = (unsigned char) text[index++];
+    }
+
+    /* Only single character constants have a value we can be sure of */
+    if(index >= expression->length || text[index] != '\'')
+        expression->failed = 1;
+
+    token->type = TOKEN_NUMBER;
+    token->value = value;
+    expression->index = index + 1;
+}
+
+/*
+ * @docgen: function
+ * @brief: read the value of an integer constant
+ * @name: read_number
+ *
+ * @param expression: the expression, on the first digit
+ * @type: struct Expression *
+ *
+ * @param token: the token to fill in
+ * @type: struct ExpressionToken *
+*/
+static void read_number(struct Expression *expression, struct ExpressionToken *token) {
+    const char *text = expression->text;
+    int index = expression->index;
+    int base = 10;
+    unsigned long value = 0;
+
+    if(text[index] == '0' && index + 1 < expression->length &&
+       (text[index + 1] == 'x' || text[index + 1] == 'X')) {
+        base = 16;
+        index += 2;
+    } else if(text[index] == '0') {
+        base = 8;
+    }
+
+    for(; index < expression->length; index++) {
+        int digit = -1;
+        char character = text[index];
+
+        if(is_digit(character))
+            digit = character - '0';
+        else if(base == 16 && character >= 'a' && character <= 'f')
+            digit = character - 'a' + 10;
+        else if(base == 16 && character >= 'A' && character <= 'F')
+            digit = character - 'A' + 10;
+
+        if(digit == -1 || digit >= base)
+            break;
+
+        /* A constant too big for any integer type is an error */
+        if(value > (ULONG_MAX - digit) / base)
+            expression->failed = 1;
+
+        value = value * base + digit;
+    }
+
+    token->is_unsigned = 0;
+
+    while(index < expression->length && (text[index] == 'u' || text[index] == 'U' ||
+                                         text[index] == 'l' || text[index] == 'L')) {
+        if(text[index] == 'u' || text[index] == 'U')
+            token->is_unsigned = 1;
+
+        index++;
+    }
+
+    /* A hexadecimal or octal constant too big to be signed is unsigned, if
+     * a long is as wide as the preprocessor's integers. A decimal one is
+     * not a portable constant at all. */
+    if(value > (unsigned long) LONG_MAX && token->is_unsigned == 0) {
+        if(base == 10 || sizeof(long) * CHAR_BIT < 64)
+            expression->failed = 1;
+
+        token->is_unsigned = 1;
+    }
+
+    /* Anything else stuck to the number (like a fraction) is not an
+     * integer constant */
+    if(index < expression->length &&
+       (csource_is_identifier_character(text[index]) || text[index] == '.'))
+        expression->failed = 1;
+
+    token->type = TOKEN_NUMBER;
+    token->value = (long) value;
+    expression->index = index;
+}
+
+/*
+ * @docgen: function
+ * @brief: read the next token of an expression
+ * @name: next_token
+ *
+ * @param expression: the expression to read from
+ * @type: struct Expression *
+ *
+ * @return: the token, which is TOKEN_END at the end of the expression
+ * @type: struct ExpressionToken
+*/
+static struct ExpressionToken next_token(struct Expression *expression) {
+    int index = 0;
+    const char *text = expression->text;
+    struct ExpressionToken token;
+
+    skip_blanks(expression);
+    index = expression->index;
+
+    token.type = TOKEN_END;
+    token.text = text + index;
+    token.length = 0;
+    token.value = 0;
+    token.is_unsigned = 0;
+
+    if(index >= expression->length)
+        return token;
+
+    if(is_digit(text[index])) {
+        read_number(expression, &token);
+    } else if(text[index] == '\'') {
+        read_character(expression, &token);
+    } else if(csource_is_identifier_start(text[index])) {
+        token.type = TOKEN_IDENTIFIER;
+
+        while(expression->index < expression->length &&
+              csource_is_identifier_character(text[expression->index]))
+            expression->index++;
+    } else {
+        int operator = 0;
+
+        token.type = TOKEN_PUNCTUATOR;
+        expression->index++;
+
+        /* The two character operators are the ones with a second
+         * character that is also punctuation */
+        for(operator = 0; operators[operator] != NULL; operator++) {
+            if(strlen(operators[operator]) == 2 && index + 1 < expression->length &&
+               strncmp(operators[operator], text + index, 2) == 0) {
+                expression->index++;
+
+                break;
+            }
+        }
+
+        if(strchr("()!~-+*/%<>&^|?:,=", text[index]) == NULL)
+            expression->failed = 1;
+    }
+
+    token.length = expression->index - index;
+
+    return token;
+}
+
+/*
+ * @docgen: function
+ * @brief: look at the next token without reading it
+ * @name: peek_token
+ *
+ * @param expression: the expression to look in
+ * @type: struct Expression *
+ *
+ * @return: the next token
+ * @type: struct ExpressionToken
+*/
+static struct ExpressionToken peek_token(struct Expression *expression) {
+    int index = expression->index;
+    int failed = expression->failed;
+    struct ExpressionToken token = next_token(expression);
+
+    expression->index = index;
+    expression->failed = failed;
+
+    return token;
+}
+
+static int is_punctuator(struct ExpressionToken token, const char *punctuator) {
+    return token.type == TOKEN_PUNCTUATOR && token.length == (int) strlen(punctuator) &&
+           strncmp(token.text, punctuator, token.length) == 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: skip the arguments of a call to a macro
+ * @name: skip_arguments
+ *
+ * @param expression: the expression, before the opening parenthesis
+ * @type: struct Expression *
+*/
+static void skip_arguments(struct Expression *expression) {
+    int depth = 0;
+
+    if(is_punctuator(peek_token(expression), "(") == 0)
+        return;
+
+    do {
+        struct ExpressionToken token = next_token(expression);
+
+        if(token.type == TOKEN_END) {
+            expression->failed = 1;
+
+            return;
+        }
+
+        if(is_punctuator(token, "("))
+            depth++;
+        else if(is_punctuator(token, ")"))
+            depth--;
+    } while(depth > 0);
+}
+
+/*
+ * @docgen: function
+ * @brief: evaluate a macro used in an expression
+ * @name: expand_macro
+ *
+ * @param expression: the expression, after the name of the macro
+ * @type: struct Expression *
+ *
+ * @param name: the token of the name
+ * @type: struct ExpressionToken
+ *
+ * @return: the value of the macro
+ * @type: struct ExpressionValue
+*/
+static struct ExpressionValue expand_macro(struct Expression *expression,
+                                           struct ExpressionToken name) {
+    int index = csource_defines_lookup(expression->defines, name.text, name.length);
+    const struct CSourceDefine *define = NULL;
+    struct Expression body;
+    struct ExpressionValue value;
+
+    /* Nothing is known about it, or it takes arguments we do not expand */
+    if(index == -1 || expression->defines->contents[index].kind == CSOURCE_DEFINE_UNKNOWN ||
+       expression->defines->contents[index].kind == CSOURCE_DEFINE_FUNCTION) {
+        skip_arguments(expression);
+
+        return unknown();
+    }
+
+    define = expression->defines->contents + index;
+
+    /* An identifier that is not a macro is 0 */
+    if(define->kind == CSOURCE_DEFINE_UNDEFINE)
+        return known(0);
+
+    if(expression->depth >= CSOURCE_EXPRESSION_DEPTH ||
+       ++*expression->expansions > CSOURCE_EXPRESSION_EXPANSIONS)
+        return unknown();
+
+    body.text = define->body;
+    body.length = define->body_length;
+    body.index = 0;
+    body.depth = expression->depth + 1;
+    body.nesting = 0;
+    body.expansions = expression->expansions;
+    body.failed = 0;
+    body.defines = expression->defines;
+
+    value = parse_conditional(&body);
+
+    /* A body that is not a whole expression on its own would need real
+     * token pasting to get right */
+    if(body.failed == 1 || next_token(&body).type != TOKEN_END)
+        return unknown();
+
+    return value;
+}
+
+/*
+ * @docgen: function
+ * @brief: parse a primary or unary expression
+ * @name: parse_unary
+ *
+ * @param expression: the expression to parse
+ * @type: struct Expression *
+ *
+ * @return: the value of the expression
+ * @type: struct ExpressionValue
+*/
+static struct ExpressionValue parse_unary(struct Expression *expression) {
+    struct ExpressionValue value;
+    struct ExpressionToken token = next_token(expression);
+
+    /* Everything that nests comes back through here */
+    if(expression->nesting >= CSOURCE_EXPRESSION_NESTING) {
+        expression->failed = 1;
+
+        return unknown();
+    }
+
+    if(token.type == TOKEN_NUMBER)
+        return typed(token.value, token.is_unsigned);
+
+    if(token.type == TOKEN_IDENTIFIER) {
+        int parenthesized = 0;
+        struct ExpressionToken name;
+
+        if(token.length != 7 || strncmp(token.text, "defined", 7) != 0)
+            return expand_macro(expression, token);
+
+        if((parenthesized = is_punctuator(peek_token(expression), "(")) == 1)
+            next_token(expression);
+
+        if((name = next_token(expression)).type != TOKEN_IDENTIFIER) {
+            expression->failed = 1;
+
+            return unknown();
+        }
+
+        if(parenthesized == 1 && is_punctuator(next_token(expression), ")") == 0)
+            expression->failed = 1;
+
+        switch(csource_expression_defined(name.text, name.length, expression->defines)) {
+            case CSOURCE_EXPRESSION_TRUE: return known(1);
+            case CSOURCE_EXPRESSION_FALSE: return known(0);
+        }
+
+        return unknown();
+    }
+
+    if(is_punctuator(token, "(")) {
+        expression->nesting++;
+        value = parse_conditional(expression);
+        expression->nesting--;
+
+        if(is_punctuator(next_token(expression), ")") == 0)
+            expression->failed = 1;
+
+        return value;
+    }
+
+    if(token.type != TOKEN_PUNCTUATOR || token.length != 1 || strchr("!~-+", *token.text) == NULL) {
+        expression->failed = 1;
+
+        return unknown();
+    }
+
+    expression->nesting++;
+    value = parse_unary(expression);
+    expression->nesting--;
+
+    if(value.known == 0)
+        return value;
+
+    switch(*token.text) {
+        case '!': return known(!value.value);
+        case '~': return typed(~value.value, value.is_unsigned);
+        case '-': return typed((long) (0UL - (unsigned long) value.value), value.is_unsigned);
+    }
+
+    return value;
+}
+
+/*
+ * @docgen: function
+ * @brief: apply a binary operator to two values
+ * @name: apply
+ *
+ * @description
+ * @Apply an operator with the usual arithmetic conversions, so if either
+ * @side is unsigned, both are. Shifts have the type of their left side,
+ * @and comparisons and logical operators give a signed 0 or 1.
+ * @description
+ *
+ * @param operator: the operator
+ * @type: const char *
+ *
+ * @param left: the left operand
+ * @type: struct ExpressionValue
+ *
+ * @param right: the right operand
+ * @type: struct ExpressionValue
+ *
+ * @return: the result
+ * @type: struct ExpressionValue
+*/
+static struct ExpressionValue apply(const char *operator, struct ExpressionValue left,
+                                    struct ExpressionValue right) {
+    int is_unsigned = 0;
+    unsigned long a = (unsigned long) left.value;
+    unsigned long b = (unsigned long) right.value;
+
+    /* One side alone can decide a logical operator */
+    if(strcmp(operator, "&&") == 0) {
+        if((left.known && left.value == 0) || (right.known && right.value == 0))
+            return known(0);
+
+        return left.known && right.known ? known(1) : unknown();
+    }
+
+    if(strcmp(operator, "||") == 0) {
+        if((left.known && left.value != 0) || (right.known && right.value != 0))
+            return known(1);
+
+        return left.known && right.known ? known(0) : unknown();
+    }
+
+    if(left.known == 0 || right.known == 0)
+        return unknown();
+
+    if(strcmp(operator, "<<") == 0 || strcmp(operator, ">>") == 0) {
+        if(right.value < 0 || right.value >= (long) (sizeof(long) * CHAR_BIT))
+            return unknown();
+
+        if(operator[0] == '<')
+            return typed((long) (a << right.value), left.is_unsigned);
+
+        if(left.is_unsigned == 1)
+            return typed((long) (a >> right.value), 1);
+
+        return known(left.value >> right.value);
+    }
+
+    is_unsigned = left.is_unsigned || right.is_unsigned;
+
+    switch(operator[0]) {
+        case '*': return typed((long) (a * b), is_unsigned);
+        case '+': return typed((long) (a + b), is_unsigned);
+        case '-': return typed((long) (a - b), is_unsigned);
+        case '^': return typed((long) (a ^ b), is_unsigned);
+        case '|': return typed((long) (a | b), is_unsigned);
+        case '&': return typed((long) (a & b), is_unsigned);
+        case '=': return known(a == b);
+        case '!': return known(a != b);
+    }
+
+    if(strcmp(operator, "/") == 0 || strcmp(operator, "%") == 0) {
+        /* The preprocessor would stop here, so leave it to it */
+        if(b == 0 || (is_unsigned == 0 && right.value == -1 && left.value == LONG_MIN))
+            return unknown();
+
+        if(is_unsigned == 1)
+            return typed((long) (operator[0] == '/' ? a / b : a % b), 1);
+
+        return known(operator[0] == '/' ? left.value / right.value : left.value % right.value);
+    }
+
+    if(is_unsigned == 1) {
+        if(strcmp(operator, "<") == 0)
+            return known(a < b);
+
+        if(strcmp(operator, ">") == 0)
+            return known(a > b);
+
+        if(strcmp(operator, "<=") == 0)
+            return known(a <= b);
+
+        return known(a >= b);
+    }
+
+    if(strcmp(operator, "<") == 0)
+        return known(left.value < right.value);
+
+    if(strcmp(operator, ">") == 0)
+        return known(left.value > right.value);
+
+    if(strcmp(operator, "<=") == 0)
+        return known(left.value <= right.value);
+
+    return known(left.value >= right.value);
+}
+
+/*
+ * @docgen: function
+ * @brief: parse a chain of binary operators
+ * @name: parse_binary
+ *
+ * @param expression: the expression to parse
+ * @type: struct Expression *
+ *
+ * @param minimum: the loosest binding operator to take in
+ * @type: int
+ *
+ * @return: the value of the expression
+ * @type: struct ExpressionValue
+*/
+static struct ExpressionValue parse_binary(struct Expression *expression, int minimum) {
+    struct ExpressionValue left = parse_unary(expression);
+
+    while(expression->failed == 0) {
+        int index = 0;
+        struct ExpressionToken token = peek_token(expression);
+
+        if(token.type != TOKEN_PUNCTUATOR)
+            break;
+
+        for(index = 0; operators[index] != NULL; index++) {
+            if((int) strlen(operators[index]) == token.length &&
+               strncmp(operators[index], token.text, token.length) == 0)
+                break;
+        }
+
+        if(operators[index] == NULL || precedences[index] < minimum)
+            break;
+
+        next_token(expression);
+        left = apply(operators[index], left, parse_binary(expression, precedences[index] + 1));
+    }
+
+    return left;
+}
+
+/*
+ * @docgen: function
+ * @brief: parse a whole expression, including the ternary operator
+ * @name: parse_conditional
+ *
+ * @param expression: the expression to parse
+ * @type: struct Expression *
+ *
+ * @return: the value of the expression
+ * @type: struct ExpressionValue
+*/
+static struct ExpressionValue parse_conditional(struct Expression *expression) {
+    struct ExpressionValue condition = parse_binary(expression, 1);
+    struct ExpressionValue when_true;
+    struct ExpressionValue when_false;
+
+    if(expression->failed == 1 || is_punctuator(peek_token(expression), "?") == 0)
+        return condition;
+
+    next_token(expression);
+    expression->nesting++;
+    when_true = parse_conditional(expression);
+
+    if(is_punctuator(next_token(expression), ":") == 0) {
+        expression->failed = 1;
+
+        return unknown();
+    }
+
+    when_false = parse_conditional(expression);
+    expression->nesting--;
+
+    /* The result has the type of both sides together, so it is only known
+     * if both of them are, even the one that is not taken */
+    if(when_true.known == 0 || when_false.known == 0)
+        return unknown();
+
+    when_true.is_unsigned = when_false.is_unsigned = when_true.is_unsigned ||
+                                                     when_false.is_unsigned;
+
+    if(condition.known == 1)
+        return condition.value != 0 ? when_true : when_false;
+
+    /* Either way it goes, it is the same */
+    if(when_true.value == when_false.value)
+        return when_true;
+
+    return unknown();
+}
+
+int csource_expression_defined(const char *name, int length, const struct CSourceDefines *defines) {
+    int index = 0;
+
+    liberror_is_null(csource_expression_defined, name);
+    liberror_is_null(csource_expression_defined, defines);
+
+    if((index = csource_defines_lookup(defines, name, length)) == -1)
+        return CSOURCE_EXPRESSION_UNKNOWN;
+
+    switch(defines->contents[index].kind) {
+        case CSOURCE_DEFINE_OBJECT:
+        case CSOURCE_DEFINE_FUNCTION:
+            return CSOURCE_EXPRESSION_TRUE;
+        case CSOURCE_DEFINE_UNDEFINE:
+            return CSOURCE_EXPRESSION_FALSE;
+    }
+
+    return CSOURCE_EXPRESSION_UNKNOWN;
+}
+
+int csource_expression_evaluate(const char *text, int length, const struct CSourceDefines *defines) {
+    int expansions = 0;
+    struct Expression expression;
+    struct ExpressionValue value;
+
+    liberror_is_null(csource_expression_evaluate, text);
+    liberror_is_null(csource_expression_evaluate, defines);
+
+    expression.text = text;
+    expression.length = length;
+    expression.index = 0;
+    expression.depth = 0;
+    expression.nesting = 0;
+    expression.expansions = &expansions;
+    expression.failed = 0;
+    expression.defines = defines;
+
+    value = parse_conditional(&expression);
+
+    if(expression.failed == 1 || next_token(&expression).type != TOKEN_END)
+        return CSOURCE_EXPRESSION_UNKNOWN;
+
+    if(value.known == 0)
+        return CSOURCE_EXPRESSION_UNKNOWN;
+
+    return value.value != 0 ? CSOURCE_EXPRESSION_TRUE : CSOURCE_EXPRESSION_FALSE;
+}
@@ -0,0 +1,122 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_CSOURCE_FILTER_PRUNE_EXPRESSION_H
+#define CWARE_CSOURCE_FILTER_PRUNE_EXPRESSION_H
+
+/* Results of evaluating an expression */
+#define CSOURCE_EXPRESSION_UNKNOWN  -1
+#define CSOURCE_EXPRESSION_FALSE    0
+#define CSOURCE_EXPRESSION_TRUE     1
+
+/* How deep macros may expand into each other before giving up */
+#define CSOURCE_EXPRESSION_DEPTH    32
+
+/* How many macros one expression may expand in all, since each level of
+ * macros can use the level below it more than once */
+#define CSOURCE_EXPRESSION_EXPANSIONS   256
+
+/* How deep parentheses and unary operators may nest */
+#define CSOURCE_EXPRESSION_NESTING  256
+
+struct CSourceDefines;
+
+/*
+ * @docgen: function
+ * @brief: evaluate the expression of an #if or #elif
+ * @name: csource_expression_evaluate
+ *
+ * @description
+ * @Evaluate an integer constant expression the way the preprocessor would,
+ * @with defined() and object-like macros looked up in a table of
+ * @definitions. Any part of the expression that depends on a macro the
+ * @table knows nothing about is unknown, but an unknown side of && or ||
+ * @does not matter when the other side decides the result alone.
+ * @description
+ *
+ * @notes
+ * @Arithmetic is done in a long, with the u suffix, and hexadecimal or
+ * @octal constants too big to be signed, making a value unsigned as they
+ * @would in the preprocessor. A long is as wide as the integers of the
+ * @preprocessor where it is 64 bits; where it is narrower, constants that
+ * @only fit in wider integers make the result unknown, but arithmetic that
+ * @overflows a long still wraps. Function-like macros, and anything the expression cannot be parsed
+ * @past, make the result unknown rather than wrong. So does going past
+ * @any of the limits above, which keep hostile input from taking more
+ * @than linear time or running out of stack.
+ * @notes
+ *
+ * @error: text is NULL
+ * @error: defines is NULL
+ *
+ * @param text: the expression
+ * @type: const char *
+ *
+ * @param length: the length of the expression
+ * @type: int
+ *
+ * @param defines: the definitions of the macros
+ * @type: const struct CSourceDefines *
+ *
+ * @return: CSOURCE_EXPRESSION_TRUE, _FALSE, or _UNKNOWN
+ * @type: int
+*/
+int csource_expression_evaluate(const char *text, int length, const struct CSourceDefines *defines);
+
+/*
+ * @docgen: function
+ * @brief: determine whether a macro is defined
+ * @name: csource_expression_defined
+ *
+ * @error: name is NULL
+ * @error: defines is NULL
+ *
+ * @param name: the name of the macro
+ * @type: const char *
+ *
+ * @param length: the length of the name
+ * @type: int
+ *
+ * @param defines: the definitions of the macros
+ * @type: const struct CSourceDefines *
+ *
+ * @return: CSOURCE_EXPRESSION_TRUE, _FALSE, or _UNKNOWN
+ * @type: int
+*/
+int csource_expression_defined(const char *name, int length, const struct CSourceDefines *defines);
+
+#endif
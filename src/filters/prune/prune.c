@@ -0,0 +1,589 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file deals with pruning the conditional groups of a source file
+ * down to the code that a set of macros would compile. It is built on the
+ * directive pass of strip-directives: every run of code between two
+ * directives is written or dropped as a single span depending on the state
+ * of the group it is in, and every directive updates that state.
+ *
+ * A region of source is either dead (certainly not compiled), live
+ * (certainly compiled), or maybe (compiled depending on a macro we were
+ * not told about). Only the regions that are maybe keep their directives,
+ * and a #define seen in one of them makes its macro unknown from there on.
+*/
+
+#include <string.h>
+
+#include "../../csource.h"
+#include "../../common/common.h"
+#include "../../output/output.h"
+#include "../../extractors/defines/defines.h"
+#include "../directives/directives.h"
+
+#include "expression.h"
+#include "prune.h"
+
+/* Data structure properties */
+#define PRUNE_FRAME_TYPE    struct PruneFrame
+#define PRUNE_FRAME_HEAP    1
+#define PRUNE_FRAME_FREE(value)
+
+/*
+ * @docgen: structure
+ * @brief: a conditional group that has not been closed yet
+ * @name: PruneFrame
+ *
+ * @field parent: the state of the region the group is in
+ * @type: int
+ *
+ * @field state: the state of the current branch of the group
+ * @type: int
+ *
+ * @field taken: whether a branch of the group is known to be compiled
+ * @type: int
+ *
+ * @field kept: whether the directives of the group are being written
+ * @type: int
+*/
+struct PruneFrame {
+    int parent;
+    int state;
+    int taken;
+    int kept;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the conditional groups that have not been closed yet
+ * @name: PruneFrames
+ *
+ * @field length: the number of groups
+ * @type: int
+ *
+ * @field capacity: the capacity of the groups
+ * @type: int
+ *
+ * @field contents: the groups, from the outermost in
+ * @type: struct PruneFrame *
+*/
+struct PruneFrames {
+    int length;
+    int capacity;
+    struct PruneFrame *contents;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the state of pruning a file
+ * @name: Pruner
+ *
+ * @field setup: the setup of the module
+ * @type: struct ModuleSetup *
+ *
+ * @field defines: the macros given and those the file has defined so far
+ * @type: struct CSourceDefines *
+ *
+ * @field frames: the groups that have not been closed yet
+ * @type: struct PruneFrames *
+*/
+struct Pruner {
+    struct ModuleSetup *setup;
+    struct CSourceDefines *defines;
+    struct PruneFrames *frames;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the parts of a directive
+ * @name: PruneDirective
+ *
+ * @field start: the index the directive starts at
+ * @type: int
+ *
+ * @field end: the index the directive ends at
+ * @type: int
+ *
+ * @field line: the line the directive starts on
+ * @type: int
+ *
+ * @field keyword: the index of the name of the directive
+ * @type: int
+ *
+ * @field rest: the index after the name of the directive
+ * @type: int
+*/
+struct PruneDirective {
+    int start;
+    int end;
+    int line;
+    int keyword;
+    int rest;
+};
+
+static int skip_blanks(const char *buffer, int index, int end) {
+    while(index < end) {
+        if(buffer[index] == ' ' || buffer[index] == '\t' || buffer[index] == '\r' ||
+           buffer[index] == '\f' || buffer[index] == '\v' || buffer[index] == '\n') {
+            index++;
+        } else if(buffer[index] == '\\' && index + 1 < end &&
+                  (buffer[index + 1] == '\n' || buffer[index + 1] == '\r')) {
+            index++;
+        } else {
+            break;
+        }
+    }
+
+    return index;
+}
+
+static int is_keyword(const char *buffer, struct PruneDirective directive, const char *keyword) {
+    int length = strlen(keyword);
+
+    return directive.rest - directive.keyword == length &&
+           strncmp(buffer + directive.keyword, keyword, length) == 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: the state of the region the next line is in
+ * @name: current_state
+ *
+ * @param pruner: the pruner to get the state of
+ * @type: struct Pruner *
+ *
+ * @return: the state of the region (CSOURCE_PRUNE_*)
+ * @type: int
+*/
+static int current_state(struct Pruner *pruner) {
+    if(pruner->frames->length == 0)
+        return CSOURCE_PRUNE_LIVE;
+
+    return pruner->frames->contents[pruner->frames->length - 1].state;
+}
+
+/*
+ * @docgen: function
+ * @brief: write a directive, with its name replaced
+ * @name: write_directive
+ *
+ * @description
+ * @Write a directive up to its name, then a replacement for the name, then
+ * @the rest of the directive from an index. Writing it from the name with
+ * @no replacement writes the directive as it is.
+ * @description
+ *
+ * @param pruner: the pruner to write with
+ * @type: struct Pruner *
+ *
+ * @param directive: the directive to write
+ * @type: struct PruneDirective
+ *
+ * @param replacement: the name to write, or NULL
+ * @type: const char *
+ *
+ * @param from: the index to carry on from
+ * @type: int
+*/
+static void write_directive(struct Pruner *pruner, struct PruneDirective directive,
+                            const char *replacement, int from) {
+    struct CSourceOutput *output = pruner->setup->output;
+    const char *buffer = pruner->setup->input.buffer;
+    int end = directive.end;
+
+    csource_output_span(output, buffer + directive.start, directive.keyword - directive.start,
+                        directive.start, directive.line);
+
+    if(replacement != NULL)
+        csource_output_span(output, replacement, strlen(replacement), directive.keyword,
+                            directive.line);
+
+    /* The new line of the directive goes with it, if it has one */
+    if(end < pruner->setup->input.length) {
+        csource_output_span(output, buffer + from, end + 1 - from, from, directive.line);
+
+        return;
+    }
+
+    csource_output_span(output, buffer + from, end - from, from, directive.line);
+    csource_output_span(output, "\n", 1, end, directive.line);
+}
+
+/*
+ * @docgen: function
+ * @brief: evaluate the condition of a conditional directive
+ * @name: evaluate
+ *
+ * @param pruner: the pruner with the macros to evaluate with
+ * @type: struct Pruner *
+ *
+ * @param directive: the directive to evaluate
+ * @type: struct PruneDirective
+ *
+ * @return: CSOURCE_EXPRESSION_TRUE, _FALSE, or _UNKNOWN
+ * @type: int
+*/
+static int evaluate(struct Pruner *pruner, struct PruneDirective directive) {
+    int name = 0;
+    int result = 0;
+    const char *buffer = pruner->setup->input.buffer;
+
+    /* Each kind of #elif tests the same way as the #if it is named after */
+    if(buffer[directive.keyword] == 'e')
+        directive.keyword += 2;
+
+    if(is_keyword(buffer, directive, "if") == 1)
+        return csource_expression_evaluate(buffer + directive.rest, directive.end - directive.rest,
+                                           pruner->defines);
+
+    name = skip_blanks(buffer, directive.rest, directive.end);
+
+    if(name >= directive.end || csource_is_identifier_start(buffer[name]) == 0)
+        return CSOURCE_EXPRESSION_UNKNOWN;
+
+    for(directive.rest = name; directive.rest < directive.end; directive.rest++) {
+        if(csource_is_identifier_character(buffer[directive.rest]) == 0)
+            break;
+    }
+
+    result = csource_expression_defined(buffer + name, directive.rest - name, pruner->defines);
+
+    if(result != CSOURCE_EXPRESSION_UNKNOWN && buffer[directive.keyword + 2] == 'n')
+        return !result;
+
+    return result;
+}
+
+/*
+ * @docgen: function
+ * @brief: open a group with an #if, #ifdef or #ifndef
+ * @name: open_group
+ *
+ * @param pruner: the pruner to open the group in
+ * @type: struct Pruner *
+ *
+ * @param directive: the directive that opens the group
+ * @type: struct PruneDirective
+*/
+static void open_group(struct Pruner *pruner, struct PruneDirective directive) {
+    struct PruneFrame frame;
+
+    frame.parent = current_state(pruner);
+    frame.state = CSOURCE_PRUNE_DEAD;
+    frame.taken = 0;
+    frame.kept = 0;
+
+    if(frame.parent != CSOURCE_PRUNE_DEAD) {
+        switch(evaluate(pruner, directive)) {
+            case CSOURCE_EXPRESSION_TRUE:
+                frame.state = frame.parent;
+                frame.taken = 1;
+
+                break;
+            case CSOURCE_EXPRESSION_UNKNOWN:
+                frame.state = CSOURCE_PRUNE_MAYBE;
+                frame.kept = 1;
+                write_directive(pruner, directive, NULL, directive.keyword);
+
+                break;
+        }
+    }
+
+    carray_append(pruner->frames, frame, PRUNE_FRAME);
+}
+
+/*
+ * @docgen: function
+ * @brief: move to the next branch of a group with an #elif
+ * @name: next_branch
+ *
+ * @param pruner: the pruner with the group
+ * @type: struct Pruner *
+ *
+ * @param directive: the #elif, #elifdef or #elifndef
+ * @type: struct PruneDirective
+*/
+static void next_branch(struct Pruner *pruner, struct PruneDirective directive) {
+    struct PruneFrame *frame = pruner->frames->contents + pruner->frames->length - 1;
+    int result = 0;
+
+    if(frame->parent == CSOURCE_PRUNE_DEAD || frame->taken == 1) {
+        frame->state = CSOURCE_PRUNE_DEAD;
+
+        return;
+    }
+
+    result = evaluate(pruner, directive);
+
+    if(result == CSOURCE_EXPRESSION_FALSE) {
+        frame->state = CSOURCE_PRUNE_DEAD;
+
+        return;
+    }
+
+    if(result == CSOURCE_EXPRESSION_TRUE) {
+        frame->taken = 1;
+        frame->state = frame->parent;
+
+        /* Nothing after this branch is compiled, so it is all the else
+         * of the branches before it that could not be dropped */
+        if(frame->kept == 1) {
+            frame->state = CSOURCE_PRUNE_MAYBE;
+            write_directive(pruner, directive, "else", directive.end);
+        }
+
+        return;
+    }
+
+    frame->state = CSOURCE_PRUNE_MAYBE;
+
+    if(frame->kept == 1) {
+        write_directive(pruner, directive, NULL, directive.keyword);
+
+        return;
+    }
+
+    /* Every branch before this one was dropped, so this opens the group,
+     * and #elif, #elifdef and #elifndef are #if, #ifdef and #ifndef
+     * without their el */
+    frame->kept = 1;
+    write_directive(pruner, directive, NULL, directive.keyword + 2);
+}
+
+/*
+ * @docgen: function
+ * @brief: handle a directive
+ * @name: prune_directive
+ *
+ * @param visitor: the visitor of the pruner
+ * @type: struct CSourceDirectiveVisitor *
+ *
+ * @param start: the index the directive starts at
+ * @type: int
+ *
+ * @param end: the index the directive ends at
+ * @type: int
+ *
+ * @param line: the line the directive starts on
+ * @type: int
+*/
+static void prune_directive(struct CSourceDirectiveVisitor *visitor, int start, int end, int line) {
+    struct Pruner *pruner = visitor->data;
+    const char *buffer = pruner->setup->input.buffer;
+    struct PruneFrames *frames = pruner->frames;
+    struct PruneDirective directive;
+    struct CSourceDefine define;
+    int state = current_state(pruner);
+
+    directive.start = start;
+    directive.end = end;
+    directive.line = line;
+    directive.keyword = csource_directive_name(buffer, start, end, &directive.rest);
+    directive.rest += directive.keyword;
+
+    if(is_keyword(buffer, directive, "if") == 1 || is_keyword(buffer, directive, "ifdef") == 1 ||
+       is_keyword(buffer, directive, "ifndef") == 1) {
+        open_group(pruner, directive);
+
+        return;
+    }
+
+    /* Anything that closes a group we never saw open is left alone */
+    if(frames->length > 0 && (is_keyword(buffer, directive, "elif") == 1 ||
+                              is_keyword(buffer, directive, "elifdef") == 1 ||
+                              is_keyword(buffer, directive, "elifndef") == 1)) {
+        next_branch(pruner, directive);
+
+        return;
+    }
+
+    if(frames->length > 0 && is_keyword(buffer, directive, "else") == 1) {
+        struct PruneFrame *frame = frames->contents + frames->length - 1;
+
+        if(frame->parent == CSOURCE_PRUNE_DEAD || frame->taken == 1) {
+            frame->state = CSOURCE_PRUNE_DEAD;
+        } else if(frame->kept == 1) {
+            frame->state = CSOURCE_PRUNE_MAYBE;
+            write_directive(pruner, directive, NULL, directive.keyword);
+        } else {
+            frame->state = frame->parent;
+        }
+
+        return;
+    }
+
+    if(frames->length > 0 && is_keyword(buffer, directive, "endif") == 1) {
+        if(frames->contents[frames->length - 1].kept == 1)
+            write_directive(pruner, directive, NULL, directive.keyword);
+
+        frames->length--;
+
+        return;
+    }
+
+    if(state == CSOURCE_PRUNE_DEAD)
+        return;
+
+    /* A macro defined where we cannot tell if it is compiled could be
+     * anything after it */
+    if(csource_define_parse(buffer, start, end, &define) == 1) {
+        define.line = line;
+
+        if(state == CSOURCE_PRUNE_MAYBE)
+            define.kind = CSOURCE_DEFINE_UNKNOWN;
+
+        csource_defines_add(pruner->defines, define);
+    }
+
+    write_directive(pruner, directive, NULL, directive.keyword);
+}
+
+/*
+ * @docgen: function
+ * @brief: write a run of code if it is compiled
+ * @name: prune_code
+ *
+ * @param visitor: the visitor of the pruner
+ * @type: struct CSourceDirectiveVisitor *
+ *
+ * @param start: the index the run starts at
+ * @type: int
+ *
+ * @param end: the index the run ends at
+ * @type: int
+ *
+ * @param line: the line the run starts on
+ * @type: int
+*/
+static void prune_code(struct CSourceDirectiveVisitor *visitor, int start, int end, int line) {
+    const char *newline = NULL;
+    struct Pruner *pruner = visitor->data;
+    const char *buffer = pruner->setup->input.buffer;
+
+    if(current_state(pruner) == CSOURCE_PRUNE_DEAD)
+        return;
+
+    csource_output_span(pruner->setup->output, buffer + start, end - start, start, line);
+
+    if(end < pruner->setup->input.length || buffer[end - 1] == '\n')
+        return;
+
+    /* The new line is a span of its own, so it needs the line it is on */
+    while((newline = memchr(buffer + start, '\n', end - start)) != NULL) {
+        start = newline - buffer + 1;
+        line++;
+    }
+
+    csource_output_span(pruner->setup->output, "\n", 1, end, line);
+}
+
+/*
+ * @docgen: function
+ * @brief: add a macro of the command line to a table
+ * @name: add_macro
+ *
+ * @param visitor: the visitor with the table to add to
+ * @type: struct CSourceDirectiveVisitor *
+ *
+ * @param start: the index the directive starts at
+ * @type: int
+ *
+ * @param end: the index the directive ends at
+ * @type: int
+ *
+ * @param line: the line the directive starts on
+ * @type: int
+*/
+static void add_macro(struct CSourceDirectiveVisitor *visitor, int start, int end, int line) {
+    struct CSourceDefine define;
+    struct Pruner *pruner = visitor->data;
+
+    if(csource_define_parse(pruner->setup->input.buffer, start, end, &define) == 0)
+        return;
+
+    define.line = line;
+    csource_defines_add(pruner->defines, define);
+}
+
+struct CSourceDefines *csource_prune_macros(const char *text, int length) {
+    struct Pruner pruner;
+    struct ModuleSetup setup;
+    struct CSourceDirectiveVisitor visitor;
+
+    liberror_is_null(csource_prune_macros, text);
+
+    INIT_VARIABLE(setup);
+
+    setup.input.buffer = (char *) text;
+    setup.input.length = length;
+
+    pruner.setup = &setup;
+    pruner.defines = csource_defines_init();
+    pruner.frames = NULL;
+
+    visitor.code = NULL;
+    visitor.directive = add_macro;
+    visitor.data = &pruner;
+
+    csource_scan_directives(text, length, &visitor);
+
+    return pruner.defines;
+}
+
+void csource_filter_prune(struct ModuleSetup setup) {
+    int index = 0;
+    struct Pruner pruner;
+    struct CSourceDirectiveVisitor visitor;
+
+    pruner.setup = &setup;
+    pruner.defines = csource_defines_init();
+    pruner.frames = carray_init(pruner.frames, PRUNE_FRAME);
+
+    /* The file adds to the macros it was given, but only for itself */
+    for(index = 0; setup.macros != NULL && index < setup.macros->length; index++)
+        csource_defines_add(pruner.defines, setup.macros->contents[index]);
+
+    visitor.code = prune_code;
+    visitor.directive = prune_directive;
+    visitor.data = &pruner;
+
+    csource_scan_directives(setup.input.buffer, setup.input.length, &visitor);
+
+    carray_free(pruner.frames, PRUNE_FRAME);
+    csource_defines_free(pruner.defines);
+}
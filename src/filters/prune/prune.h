@@ -0,0 +1,99 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_CSOURCE_FILTER_PRUNE_H
+#define CWARE_CSOURCE_FILTER_PRUNE_H
+
+/* States of a region of source between two conditional directives */
+#define CSOURCE_PRUNE_DEAD      0
+#define CSOURCE_PRUNE_LIVE      1
+#define CSOURCE_PRUNE_MAYBE     2
+
+struct ModuleSetup;
+struct CSourceDefines;
+
+/*
+ * @docgen: function
+ * @brief: read the macros given on the command line
+ * @name: csource_prune_macros
+ *
+ * @description
+ * @Read every #define and #undef in a buffer into a new table. The -D and
+ * @-U options are written out as directives, so they are read exactly the
+ * @way the definitions in a file are. The table points into the buffer,
+ * @which must outlive it.
+ * @description
+ *
+ * @error: text is NULL
+ *
+ * @param text: the directives to read
+ * @type: const char *
+ *
+ * @param length: the length of the directives
+ * @type: int
+ *
+ * @return: a table of the macros
+ * @type: struct CSourceDefines *
+*/
+struct CSourceDefines *csource_prune_macros(const char *text, int length);
+
+/*
+ * @docgen: function
+ * @brief: remove the code a set of macros leaves out
+ * @name: csource_filter_prune
+ *
+ * @description
+ * @Write the source with every group of #if, #ifdef, #ifndef, #elif and
+ * @#else resolved against the macros of the setup and those the file
+ * @defines on its way. A group whose branch is known keeps only the code
+ * @of that branch, without its directives. A condition that depends on a
+ * @macro nothing is known about is left in place, along with its group,
+ * @so the output is still right whatever that macro turns out to be.
+ * @description
+ *
+ * @notes
+ * @An #elif that is known to be true after a kept branch becomes an
+ * @#else, and the first unknown #elif after dropped branches becomes an
+ * @#if. This is all done in the one pass csource_scan_directives makes.
+ * @notes
+ *
+ * @param setup: the setup of the module
+ * @type: struct ModuleSetup
+*/
+void csource_filter_prune(struct ModuleSetup setup);
+
+#endif
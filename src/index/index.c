@@ -0,0 +1,989 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file implements indexes of the symbols of a tree, which are laid
+ * out in index.h. Searching an index is nothing but arithmetic over its
+ * mapped contents. Making one again only reads the files that changed,
+ * and takes the postings of every other file from the last index.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../csource.h"
+#include "../common/common.h"
+#include "../ingest/ingest.h"
+#include "../output/output.h"
+#include "../table/table.h"
+#include "../extractors/symbols/symbols.h"
+
+#include "index.h"
+
+/* Data structure properties */
+#define INDEX_SYMBOL_TYPE   struct IndexSymbol
+#define INDEX_SYMBOL_HEAP   1
+#define INDEX_SYMBOL_FREE(value)
+
+/* The number of buckets the names start with, which is a power of two */
+#define INDEX_BUCKETS       1024
+
+/*
+ * @docgen: structure
+ * @brief: a symbol of a file that is being indexed
+ * @name: IndexSymbol
+ *
+ * @field name: the name of the symbol, in the file
+ * @type: const char *
+ *
+ * @field length: the length of the name
+ * @type: int
+ *
+ * @field line: the line the symbol is on
+ * @type: int
+ *
+ * @field kind: the kind of symbol (CSOURCE_SYMBOL_*)
+ * @type: int
+*/
+struct IndexSymbol {
+    const char *name;
+    int length;
+    int line;
+    int kind;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the symbols of a file that is being indexed
+ * @name: IndexSymbols
+ *
+ * @field length: the number of symbols
+ * @type: int
+ *
+ * @field capacity: the number of symbols there is room for
+ * @type: int
+ *
+ * @field contents: the symbols
+ * @type: struct IndexSymbol *
+*/
+struct IndexSymbols {
+    int length;
+    int capacity;
+    struct IndexSymbol *contents;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the state of indexing a file
+ * @name: IndexScan
+ *
+ * @field buffer: the file
+ * @type: const char *
+ *
+ * @field symbols: the symbols found so far
+ * @type: struct IndexSymbols *
+*/
+struct IndexScan {
+    const char *buffer;
+    struct IndexSymbols *symbols;
+};
+
+/*
+ * @docgen: structure
+ * @brief: a name of an index that is being made, to be put in order
+ * @name: IndexOrder
+ *
+ * @field text: the name
+ * @type: const char *
+ *
+ * @field name: the number of the name in the builder
+ * @type: int
+*/
+struct IndexOrder {
+    const char *text;
+    int name;
+};
+
+/*
+ * @docgen: function
+ * @brief: find an entry of the names of an index
+ * @name: name_entry
+ *
+ * @param index: the index
+ * @type: const struct CSourceIndex *
+ *
+ * @param name: the number of the name
+ * @type: unsigned long
+ *
+ * @return: the entry of the name
+ * @type: const char *
+*/
+static const char *name_entry(const struct CSourceIndex *index, unsigned long name) {
+    return index->table.entries + index->table.files * CSOURCE_INDEX_FILE_SIZE +
+           name * CSOURCE_INDEX_NAME_SIZE;
+}
+
+/*
+ * @docgen: function
+ * @brief: find an entry of the postings of an index
+ * @name: posting_entry
+ *
+ * @param index: the index
+ * @type: const struct CSourceIndex *
+ *
+ * @param posting: the number of the posting
+ * @type: unsigned long
+ *
+ * @return: the entry of the posting
+ * @type: const char *
+*/
+static const char *posting_entry(const struct CSourceIndex *index, unsigned long posting) {
+    return name_entry(index, index->names) + posting * CSOURCE_INDEX_POSTING_SIZE;
+}
+
+/*
+ * @docgen: function
+ * @brief: find a string of an index
+ * @name: index_string
+ *
+ * @description
+ * @Find a string of an index by its offset. The strings end with a NUL,
+ * @so an offset past them is the only way a string could be out of
+ * @bounds, and is taken as an empty string.
+ * @description
+ *
+ * @param index: the index
+ * @type: const struct CSourceIndex *
+ *
+ * @param offset: the offset of the string
+ * @type: unsigned long
+ *
+ * @return: the string
+ * @type: const char *
+*/
+static const char *index_string(const struct CSourceIndex *index, unsigned long offset) {
+    if(offset >= index->strings)
+        return "";
+
+    return posting_entry(index, index->postings) + offset;
+}
+
+/*
+ * @docgen: function
+ * @brief: find the postings of a name of an index
+ * @name: name_postings
+ *
+ * @param index: the index
+ * @type: const struct CSourceIndex *
+ *
+ * @param name: the number of the name
+ * @type: unsigned long
+ *
+ * @param count: where to put the number of postings
+ * @type: unsigned long *
+ *
+ * @return: the first posting, or 0 with a count of 0 if they are out of bounds
+ * @type: unsigned long
+*/
+static unsigned long name_postings(const struct CSourceIndex *index, unsigned long name,
+                                   unsigned long *count) {
+    const char *entry = name_entry(index, name);
+    unsigned long first = csource_read_unsigned(entry + 8, 4);
+
+    *count = csource_read_unsigned(entry + 12, 4);
+
+    if(first > index->postings || *count > index->postings - first) {
+        *count = 0;
+
+        return 0;
+    }
+
+    return first;
+}
+
+/*
+ * @docgen: function
+ * @brief: find a name of an index
+ * @name: find_name
+ *
+ * @param index: the index
+ * @type: const struct CSourceIndex *
+ *
+ * @param name: the name
+ * @type: const char *
+ *
+ * @return: the number of the name, or -1 if the index does not have it
+ * @type: long
+*/
+static long find_name(const struct CSourceIndex *index, const char *name) {
+    unsigned long low = 0;
+    unsigned long high = index->names;
+
+    while(low < high) {
+        unsigned long middle = low + (high - low) / 2;
+        int order = strcmp(name, index_string(index, csource_read_unsigned(name_entry(index, middle), 4)));
+
+        if(order == 0)
+            return (long) middle;
+
+        if(order < 0)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+
+    return -1;
+}
+
+/*
+ * @docgen: function
+ * @brief: write a place a name is found in
+ * @name: write_posting
+ *
+ * @param output: the record stream to write to
+ * @type: struct CSourceOutput *
+ *
+ * @param path: the file the name is found in
+ * @type: const char *
+ *
+ * @param name: the name
+ * @type: const char *
+ *
+ * @param line: the line the name is found on
+ * @type: int
+ *
+ * @param kind: the kind of symbol the name is there (CSOURCE_SYMBOL_*)
+ * @type: int
+*/
+static void write_posting(struct CSourceOutput *output, const char *path, const char *name,
+                          int line, int kind) {
+    char number[64 + 1];
+    const char *kind_name = csource_symbol_kind(kind);
+    struct CSourceRecord record;
+
+    if(output->format != CSOURCE_FORMAT_TEXT) {
+        INIT_VARIABLE(record);
+
+        record.kind = csource_symbol_record(kind);
+        record.line = line;
+        record.payload = name;
+        record.length = strlen(name);
+
+        output->path = path;
+        csource_output_record(output, record);
+
+        return;
+    }
+
+    sprintf(number, ":%i:", line);
+
+    csource_output_span(output, path, strlen(path), 0, line);
+    csource_output_span(output, number, strlen(number), 0, line);
+    csource_output_span(output, kind_name, strlen(kind_name), 0, line);
+    csource_output_span(output, "\n", 1, 0, line);
+}
+
+int csource_index_open(struct CSourceIndex *index, const char *path) {
+    FILE *file = NULL;
+    unsigned long length = 0;
+    const char *buffer = NULL;
+
+    liberror_is_null(csource_index_open, index);
+    liberror_is_null(csource_index_open, path);
+
+    INIT_VARIABLE(*index);
+
+    if((file = fopen(path, "rb")) == NULL)
+        return -1;
+
+    index->input = csource_ingest(file, &index->mapped);
+    buffer = index->input.buffer;
+    length = (unsigned long) index->input.length;
+
+    if(ferror(file) != 0 || length < CSOURCE_INDEX_HEADER_SIZE ||
+       memcmp(buffer, CSOURCE_INDEX_MAGIC, 8) != 0 ||
+       csource_read_unsigned(buffer + 8, 4) != CSOURCE_INDEX_VERSION) {
+        fclose(file);
+        csource_index_close(index);
+
+        return -1;
+    }
+
+    fclose(file);
+
+    index->table.files = csource_read_unsigned(buffer + 12, 4);
+    index->names = csource_read_unsigned(buffer + 16, 4);
+    index->postings = csource_read_unsigned(buffer + 20, 4);
+    index->strings = csource_read_unsigned(buffer + 24, 8);
+
+    /* Every count is checked against the length before it is multiplied,
+     * so that the sizes of the tables cannot overflow */
+    if(index->table.files > length / CSOURCE_INDEX_FILE_SIZE ||
+       index->names > length / CSOURCE_INDEX_NAME_SIZE ||
+       index->postings > length / CSOURCE_INDEX_POSTING_SIZE || index->strings > length ||
+       CSOURCE_INDEX_HEADER_SIZE + index->table.files * CSOURCE_INDEX_FILE_SIZE +
+       index->names * CSOURCE_INDEX_NAME_SIZE + index->postings * CSOURCE_INDEX_POSTING_SIZE +
+       index->strings != length || (index->strings > 0 && buffer[length - 1] != '\0')) {
+        csource_index_close(index);
+
+        return -1;
+    }
+
+    /* The paths are the first of the strings */
+    index->table.entries = buffer + CSOURCE_INDEX_HEADER_SIZE;
+    index->table.strings = posting_entry(index, index->postings);
+    index->table.length = index->strings;
+
+    return 0;
+}
+
+void csource_index_close(struct CSourceIndex *index) {
+    liberror_is_null(csource_index_close, index);
+
+    csource_ingest_free(&index->input, index->mapped);
+    INIT_VARIABLE(*index);
+}
+
+long csource_index_query(const struct CSourceIndex *index, const char *name,
+                         struct CSourceOutput *output) {
+    long found = 0;
+    long written = 0;
+    unsigned long count = 0;
+    unsigned long posting = 0;
+    const char *path = NULL;
+
+    liberror_is_null(csource_index_query, index);
+    liberror_is_null(csource_index_query, name);
+    liberror_is_null(csource_index_query, output);
+
+    if((found = find_name(index, name)) == -1)
+        return 0;
+
+    path = output->path;
+    posting = name_postings(index, (unsigned long) found, &count);
+
+    for(; count > 0; posting++, count--) {
+        const char *entry = posting_entry(index, posting);
+        unsigned long file = csource_read_unsigned(entry, 4);
+        unsigned long value = csource_read_unsigned(entry + 4, 4);
+
+        if(file >= index->table.files)
+            continue;
+
+        write_posting(output, csource_table_path(&index->table, file), name, (int) (value >> 2),
+                      (int) (value & 3));
+        written++;
+    }
+
+    output->path = path;
+
+    return written;
+}
+
+
+/*
+ * @docgen: function
+ * @brief: keep a symbol of a file that is being indexed
+ * @name: collect_symbol
+ *
+ * @param visitor: the visitor of the symbols
+ * @type: struct CSourceSymbolVisitor *
+ *
+ * @param start: the index the symbol starts at
+ * @type: int
+ *
+ * @param end: the index the symbol ends at
+ * @type: int
+ *
+ * @param line: the line the symbol is on
+ * @type: int
+ *
+ * @param kind: the kind of symbol
+ * @type: int
+*/
+static void collect_symbol(struct CSourceSymbolVisitor *visitor, int start, int end, int line,
+                           int kind) {
+    struct IndexSymbol symbol;
+    struct IndexScan *scan = visitor->data;
+
+    symbol.name = scan->buffer + start;
+    symbol.length = end - start;
+    symbol.line = line;
+    symbol.kind = kind;
+
+    carray_append(scan->symbols, symbol, INDEX_SYMBOL);
+}
+
+/*
+ * @docgen: function
+ * @brief: order symbols by their name, line and kind
+ * @name: compare_symbols
+ *
+ * @param first: the first symbol
+ * @type: const void *
+ *
+ * @param second: the second symbol
+ * @type: const void *
+ *
+ * @return: less than, equal to or greater than 0, like strcmp
+ * @type: int
+*/
+static int compare_symbols(const void *first, const void *second) {
+    const struct IndexSymbol *left = first;
+    const struct IndexSymbol *right = second;
+    int order = memcmp(left->name, right->name,
+                       left->length < right->length ? left->length : right->length);
+
+    if(order != 0)
+        return order;
+
+    if(left->length != right->length)
+        return (left->length > right->length) - (left->length < right->length);
+
+    if(left->line != right->line)
+        return (left->line > right->line) - (left->line < right->line);
+
+    return (left->kind > right->kind) - (left->kind < right->kind);
+}
+
+/*
+ * @docgen: function
+ * @brief: determine whether two symbols have the same name
+ * @name: same_name
+ *
+ * @param left: the first symbol
+ * @type: const struct IndexSymbol *
+ *
+ * @param right: the second symbol
+ * @type: const struct IndexSymbol *
+ *
+ * @return: 1 if the names are the same, 0 if they are not
+ * @type: int
+*/
+static int same_name(const struct IndexSymbol *left, const struct IndexSymbol *right) {
+    return left->length == right->length && memcmp(left->name, right->name, left->length) == 0;
+}
+
+void csource_index_file(struct ModuleSetup setup) {
+    int index = 0;
+    int kept = 0;
+    int groups = 0;
+    struct IndexScan scan;
+    struct CSourceSymbolVisitor visitor;
+    struct IndexSymbols *symbols = NULL;
+
+    symbols = carray_init(symbols, INDEX_SYMBOL);
+
+    scan.buffer = setup.input.buffer;
+    scan.symbols = symbols;
+    visitor.symbol = collect_symbol;
+    visitor.data = &scan;
+
+    csource_scan_symbols(setup.input.buffer, setup.input.length, &visitor);
+    qsort(symbols->contents, symbols->length, sizeof(*symbols->contents), compare_symbols);
+
+    /* A name used more than once on a line is only kept once */
+    for(index = 0; index < symbols->length; index++) {
+        struct IndexSymbol *symbol = symbols->contents + index;
+
+        if(kept > 0 && same_name(symbols->contents + kept - 1, symbol) == 1 &&
+           symbols->contents[kept - 1].line == symbol->line &&
+           symbols->contents[kept - 1].kind == symbol->kind)
+            continue;
+
+        if(kept == 0 || same_name(symbols->contents + kept - 1, symbol) == 0)
+            groups++;
+
+        symbols->contents[kept++] = *symbol;
+    }
+
+    symbols->length = kept;
+
+    csource_table_write_path(setup.output, setup.source);
+    csource_table_write_number(setup.output, groups);
+
+    for(index = 0; index < symbols->length;) {
+        int last = index;
+        struct IndexSymbol *symbol = symbols->contents + index;
+
+        while(last < symbols->length && same_name(symbol, symbols->contents + last) == 1)
+            last++;
+
+        csource_table_write_number(setup.output, symbol->length);
+        csource_output_span(setup.output, symbol->name, symbol->length, 0, 0);
+        csource_table_write_number(setup.output, last - index);
+
+        for(; index < last; index++) {
+            csource_table_write_number(setup.output,
+                                       ((unsigned long) symbols->contents[index].line << 2) |
+                                       (unsigned long) symbols->contents[index].kind);
+        }
+    }
+
+    carray_free(symbols, INDEX_SYMBOL);
+}
+
+/*
+ * @docgen: function
+ * @brief: double the buckets of the names of an index being made
+ * @name: grow_buckets
+ *
+ * @param builder: the builder
+ * @type: struct CSourceIndexBuilder *
+*/
+static void grow_buckets(struct CSourceIndexBuilder *builder) {
+    int index = 0;
+    int count = builder->bucket_count * 2;
+    int *buckets = csource_allocator.allocate(sizeof(int) * count);
+
+    for(index = 0; index < count; index++)
+        buckets[index] = -1;
+
+    for(index = 0; index < builder->names->length; index++) {
+        struct CSourceIndexName name = builder->names->contents[index];
+        unsigned long bucket = csource_hash_name(builder->strings + name.offset, name.length) & (count - 1);
+
+        while(buckets[bucket] != -1)
+            bucket = (bucket + 1) & (count - 1);
+
+        buckets[bucket] = index;
+    }
+
+    csource_allocator.release(builder->buckets);
+    builder->buckets = buckets;
+    builder->bucket_count = count;
+}
+
+/*
+ * @docgen: function
+ * @brief: find the number of a name of an index being made
+ * @name: intern_name
+ *
+ * @description
+ * @Find the number of a name, and give it the next one if it is new.
+ * @description
+ *
+ * @param builder: the builder
+ * @type: struct CSourceIndexBuilder *
+ *
+ * @param text: the name
+ * @type: const char *
+ *
+ * @param length: the length of the name
+ * @type: int
+ *
+ * @return: the number of the name
+ * @type: int
+*/
+static int intern_name(struct CSourceIndexBuilder *builder, const char *text, int length) {
+    struct CSourceIndexName name;
+    unsigned long mask = builder->bucket_count - 1;
+    unsigned long bucket = csource_hash_name(text, length) & mask;
+
+    for(; builder->buckets[bucket] != -1; bucket = (bucket + 1) & mask) {
+        struct CSourceIndexName *found = builder->names->contents + builder->buckets[bucket];
+
+        if(found->length == length && memcmp(builder->strings + found->offset, text, length) == 0)
+            return builder->buckets[bucket];
+    }
+
+    if(builder->strings_length + length + 1 > builder->strings_capacity) {
+        while(builder->strings_length + length + 1 > builder->strings_capacity)
+            builder->strings_capacity = builder->strings_capacity * 2 + 4096;
+
+        builder->strings = csource_allocator.reallocate(builder->strings,
+                                                        builder->strings_capacity);
+    }
+
+    memcpy(builder->strings + builder->strings_length, text, length);
+    builder->strings[builder->strings_length + length] = '\0';
+
+    name.offset = builder->strings_length;
+    name.length = length;
+    name.count = 0;
+    builder->strings_length += length + 1;
+    builder->buckets[bucket] = builder->names->length;
+
+    carray_append(builder->names, name, INDEX_NAME);
+
+    /* The buckets are kept at most half full */
+    if(builder->names->length * 2 > builder->bucket_count)
+        grow_buckets(builder);
+
+    return builder->names->length - 1;
+}
+
+/*
+ * @docgen: function
+ * @brief: add a posting to an index being made
+ * @name: add_posting
+ *
+ * @param builder: the builder
+ * @type: struct CSourceIndexBuilder *
+ *
+ * @param name: the number of the name
+ * @type: int
+ *
+ * @param file: the number of the file
+ * @type: int
+ *
+ * @param value: the line, shifted left by two, with the kind below it
+ * @type: unsigned long
+*/
+static void add_posting(struct CSourceIndexBuilder *builder, int name, int file,
+                        unsigned long value) {
+    struct CSourcePosting posting;
+
+    posting.name = name;
+    posting.file = file;
+    posting.line = (int) (value >> 2);
+    posting.kind = (int) (value & 3);
+
+    carray_append(builder->postings, posting, POSTING);
+    builder->names->contents[name].count++;
+}
+
+/*
+ * @docgen: function
+ * @brief: read the symbols of one file into an index being made
+ * @name: read_file
+ *
+ * @param table: the table of the builder
+ * @type: struct CSourceTable *
+ *
+ * @param stream: the stream to read from, after the path of the file
+ * @type: FILE *
+ *
+ * @param file: the number of the file
+ * @type: int
+ *
+ * @return: 0 if the symbols were read, or -1 if they were not
+ * @type: int
+*/
+static int read_file(struct CSourceTable *table, FILE *stream, int file) {
+    unsigned long groups = 0;
+    struct CSourceIndexBuilder *builder = (struct CSourceIndexBuilder *) table;
+
+    if(csource_read_number(stream, &groups) != 0)
+        return -1;
+
+    for(; groups > 0; groups--) {
+        int name = 0;
+        unsigned long count = 0;
+        unsigned long value = 0;
+        unsigned long length = 0;
+        const char *text = NULL;
+
+        if(csource_read_number(stream, &length) != 0 ||
+           (text = csource_table_read_text(table, stream, length)) == NULL)
+            return -1;
+
+        name = intern_name(builder, text, (int) length);
+
+        if(csource_read_number(stream, &count) != 0)
+            return -1;
+
+        for(; count > 0; count--) {
+            if(csource_read_number(stream, &value) != 0)
+                return -1;
+
+            add_posting(builder, name, file, value);
+        }
+    }
+
+    return 0;
+}
+
+struct CSourceTable *csource_index_builder_init(const char *path) {
+    int index = 0;
+    struct CSourceIndexBuilder *builder = NULL;
+
+    liberror_is_null(csource_index_builder_init, path);
+
+    builder = csource_allocator.allocate(sizeof(*builder));
+    INIT_VARIABLE(*builder);
+
+    /* An index that cannot be opened is made again from scratch */
+    if(csource_index_open(&builder->last, path) == 0)
+        csource_table_init(&builder->table, &builder->last.table);
+    else
+        csource_table_init(&builder->table, NULL);
+
+    builder->names = carray_init(builder->names, INDEX_NAME);
+    builder->postings = carray_init(builder->postings, POSTING);
+    builder->bucket_count = INDEX_BUCKETS;
+    builder->buckets = csource_allocator.allocate(sizeof(int) * INDEX_BUCKETS);
+
+    for(index = 0; index < INDEX_BUCKETS; index++)
+        builder->buckets[index] = -1;
+
+    return &builder->table;
+}
+
+int csource_index_read(struct CSourceTable *table, FILE *stream) {
+    liberror_is_null(csource_index_read, table);
+    liberror_is_null(csource_index_read, stream);
+
+    return csource_table_read(table, stream, read_file);
+}
+
+/*
+ * @docgen: function
+ * @brief: order names by their text
+ * @name: compare_names
+ *
+ * @param first: the first name
+ * @type: const void *
+ *
+ * @param second: the second name
+ * @type: const void *
+ *
+ * @return: less than, equal to or greater than 0, like strcmp
+ * @type: int
+*/
+static int compare_names(const void *first, const void *second) {
+    const struct IndexOrder *left = first;
+    const struct IndexOrder *right = second;
+
+    return strcmp(left->text, right->text);
+}
+
+/*
+ * @docgen: function
+ * @brief: order postings by their file, line and kind
+ * @name: compare_postings
+ *
+ * @param first: the first posting
+ * @type: const void *
+ *
+ * @param second: the second posting
+ * @type: const void *
+ *
+ * @return: less than, equal to or greater than 0, like strcmp
+ * @type: int
+*/
+static int compare_postings(const void *first, const void *second) {
+    const struct CSourcePosting *left = first;
+    const struct CSourcePosting *right = second;
+
+    if(left->file != right->file)
+        return (left->file > right->file) - (left->file < right->file);
+
+    if(left->line != right->line)
+        return (left->line > right->line) - (left->line < right->line);
+
+    return (left->kind > right->kind) - (left->kind < right->kind);
+}
+
+/*
+ * @docgen: function
+ * @brief: take the postings of the files that did not change
+ * @name: reuse_postings
+ *
+ * @description
+ * @Take the postings of every file of the last index which is still in
+ * @the tree, and did not change, in one pass over its postings.
+ * @description
+ *
+ * @param builder: the builder
+ * @type: struct CSourceIndexBuilder *
+*/
+static void reuse_postings(struct CSourceIndexBuilder *builder) {
+    unsigned long name = 0;
+    const struct CSourceIndex *last = &builder->last;
+
+    for(name = 0; name < last->names; name++) {
+        int interned = -1;
+        unsigned long count = 0;
+        unsigned long posting = name_postings(last, name, &count);
+
+        for(; count > 0; posting++, count--) {
+            const char *entry = posting_entry(last, posting);
+            int file = csource_table_reused(&builder->table, csource_read_unsigned(entry, 4));
+            const char *text = NULL;
+
+            if(file == -1)
+                continue;
+
+            /* Names only used by files that changed are left behind */
+            if(interned == -1) {
+                text = index_string(last, csource_read_unsigned(name_entry(last, name), 4));
+                interned = intern_name(builder, text, strlen(text));
+            }
+
+            add_posting(builder, interned, file, csource_read_unsigned(entry + 4, 4));
+        }
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: write the tables and strings of an index
+ * @name: write_tables
+ *
+ * @param builder: the builder
+ * @type: struct CSourceIndexBuilder *
+ *
+ * @param order: the names, in order
+ * @type: const struct IndexOrder *
+ *
+ * @param postings: the postings, in the order of the names
+ * @type: const struct CSourcePosting *
+ *
+ * @param stream: the stream to write to
+ * @type: FILE *
+*/
+static void write_tables(struct CSourceIndexBuilder *builder, const struct IndexOrder *order,
+                         const struct CSourcePosting *postings, FILE *stream) {
+    int index = 0;
+    unsigned long first = 0;
+    unsigned long paths = csource_table_paths(&builder->table);
+
+    fwrite(CSOURCE_INDEX_MAGIC, 1, 8, stream);
+    csource_write_unsigned(stream, CSOURCE_INDEX_VERSION, 4);
+    csource_write_unsigned(stream, builder->table.files->length, 4);
+    csource_write_unsigned(stream, builder->names->length, 4);
+    csource_write_unsigned(stream, builder->postings->length, 4);
+    csource_write_unsigned(stream, paths + builder->strings_length, 8);
+    csource_table_write_files(&builder->table, stream);
+
+    /* The names come after the paths in the strings */
+    for(index = 0; index < builder->names->length; index++) {
+        struct CSourceIndexName name = builder->names->contents[order[index].name];
+
+        csource_write_unsigned(stream, paths + name.offset, 4);
+        csource_write_unsigned(stream, name.length, 4);
+        csource_write_unsigned(stream, first, 4);
+        csource_write_unsigned(stream, name.count, 4);
+        first += name.count;
+    }
+
+    for(first = 0; first < (unsigned long) builder->postings->length; first++) {
+        csource_write_unsigned(stream, postings[first].file, 4);
+        csource_write_unsigned(stream, ((unsigned long) postings[first].line << 2) |
+                               (unsigned long) postings[first].kind, 4);
+    }
+
+    csource_table_write_paths(&builder->table, stream);
+    fwrite(builder->strings, 1, builder->strings_length, stream);
+}
+
+int csource_index_write(struct CSourceTable *table, const char *path) {
+    int index = 0;
+    int failed = 0;
+    long posting = 0;
+    int *ranks = NULL;
+    long *starts = NULL;
+    FILE *stream = NULL;
+    struct IndexOrder *order = NULL;
+    struct CSourcePosting *postings = NULL;
+    struct CSourceIndexBuilder *builder = (struct CSourceIndexBuilder *) table;
+    int names = 0;
+
+    liberror_is_null(csource_index_write, table);
+    liberror_is_null(csource_index_write, path);
+
+    if(table->reused != NULL)
+        reuse_postings(builder);
+
+    names = builder->names->length;
+    order = csource_allocator.allocate(sizeof(*order) * (names + 1));
+    ranks = csource_allocator.allocate(sizeof(*ranks) * (names + 1));
+    starts = csource_allocator.allocate(sizeof(*starts) * (names + 1));
+    postings = csource_allocator.allocate(sizeof(*postings) * (builder->postings->length + 1));
+
+    for(index = 0; index < names; index++) {
+        order[index].text = builder->strings + builder->names->contents[index].offset;
+        order[index].name = index;
+    }
+
+    qsort(order, names, sizeof(*order), compare_names);
+
+    /* The postings are put in the order of their names by counting, since
+     * the count of each name is known, and then each name is sorted */
+    for(index = 0, posting = 0; index < names; index++) {
+        ranks[order[index].name] = index;
+        starts[index] = posting;
+        posting += builder->names->contents[order[index].name].count;
+    }
+
+    for(posting = 0; posting < builder->postings->length; posting++) {
+        struct CSourcePosting value = builder->postings->contents[posting];
+
+        postings[starts[ranks[value.name]]++] = value;
+    }
+
+    for(index = 0, posting = 0; index < names; index++) {
+        long count = builder->names->contents[order[index].name].count;
+
+        qsort(postings + posting, count, sizeof(*postings), compare_postings);
+        posting += count;
+    }
+
+    if((stream = csource_table_create(path)) == NULL) {
+        failed = 1;
+    } else {
+        write_tables(builder, order, postings, stream);
+        failed = csource_table_replace(stream, path) == -1;
+    }
+
+    csource_allocator.release(order);
+    csource_allocator.release(ranks);
+    csource_allocator.release(starts);
+    csource_allocator.release(postings);
+
+    return failed == 1 ? -1 : 0;
+}
+
+void csource_index_builder_free(struct CSourceTable *table) {
+    struct CSourceIndexBuilder *builder = (struct CSourceIndexBuilder *) table;
+
+    liberror_is_null(csource_index_builder_free, table);
+
+    if(table->last != NULL)
+        csource_index_close(&builder->last);
+
+    csource_table_free(table);
+    carray_free(builder->names, INDEX_NAME);
+    carray_free(builder->postings, POSTING);
+
+    if(builder->strings != NULL)
+        csource_allocator.release(builder->strings);
+
+    csource_allocator.release(builder->buckets);
+    csource_allocator.release(builder);
+}
@@ -0,0 +1,440 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * An inverted index of the symbols of a tree, from each name to the
+ * files and lines it is defined, declared and used on. An index is made
+ * to be mapped into memory and searched where it is, without reading it
+ * into anything first. Every integer is little endian, and every table
+ * has entries of a fixed size, so an entry is found by its number alone:
+ *
+ *     header, 32 bytes
+ *         u8   magic[8], which is "csindex\n"
+ *         u32  version
+ *         u32  files
+ *         u32  names
+ *         u32  postings
+ *         u64  length of the strings
+ *
+ *     files, 24 bytes each, in the order of their paths
+ *         u32  offset of the path in the strings
+ *         u32  0
+ *         u64  size of the file, or all ones if it could not be indexed
+ *         u64  time the file was last modified
+ *
+ *     names, 16 bytes each, in the order of the names
+ *         u32  offset of the name in the strings
+ *         u32  length of the name
+ *         u32  first posting of the name
+ *         u32  number of postings of the name
+ *
+ *     postings, 8 bytes each, in the order of their files and lines
+ *         u32  file
+ *         u32  line, shifted left by two, with the kind of symbol below it
+ *
+ *     strings, which each end with a NUL
+ *
+ * The files are the table of table.h, which the trigram index has too,
+ * and which is what lets the index be made again from the last one.
+*/
+
+#ifndef CWARE_CSOURCE_INDEX_H
+#define CWARE_CSOURCE_INDEX_H
+
+#include <stdio.h>
+
+#include "../table/table.h"
+
+/* Data structure properties */
+#define INDEX_NAME_TYPE     struct CSourceIndexName
+#define INDEX_NAME_HEAP     1
+#define INDEX_NAME_FREE(value)
+
+#define POSTING_TYPE        struct CSourcePosting
+#define POSTING_HEAP        1
+#define POSTING_FREE(value)
+
+/* The format of an index. The version changes whenever the format does,
+ * and an index of any other version is made again from scratch. */
+#define CSOURCE_INDEX_MAGIC         "csindex\n"
+#define CSOURCE_INDEX_VERSION       1
+
+#define CSOURCE_INDEX_HEADER_SIZE   32
+#define CSOURCE_INDEX_FILE_SIZE     24
+#define CSOURCE_INDEX_NAME_SIZE     16
+#define CSOURCE_INDEX_POSTING_SIZE  8
+
+/* Where an index is made, if no other path is given */
+#define CSOURCE_INDEX_DEFAULT_PATH  "csource.index"
+
+struct ModuleSetup;
+struct CSourceOutput;
+
+/*
+ * @docgen: structure
+ * @brief: an index, mapped into memory
+ * @name: CSourceIndex
+ *
+ * @field input: the contents of the index
+ * @type: struct LibmatchCursor
+ *
+ * @field mapped: whether the contents are mapped
+ * @type: int
+ *
+ * @field table: the files
+ * @type: struct CSourceTableView
+ *
+ * @field names: the number of names
+ * @type: unsigned long
+ *
+ * @field postings: the number of postings
+ * @type: unsigned long
+ *
+ * @field strings: the number of bytes in the strings
+ * @type: unsigned long
+*/
+struct CSourceIndex {
+    struct LibmatchCursor input;
+    int mapped;
+    struct CSourceTableView table;
+    unsigned long names;
+    unsigned long postings;
+    unsigned long strings;
+};
+
+/*
+ * @docgen: structure
+ * @brief: a name of an index that is being made
+ * @name: CSourceIndexName
+ *
+ * @field offset: the offset of the name in the strings of the builder
+ * @type: long
+ *
+ * @field length: the length of the name
+ * @type: int
+ *
+ * @field count: the number of postings of the name
+ * @type: long
+*/
+struct CSourceIndexName {
+    long offset;
+    int length;
+    long count;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the names of an index that is being made
+ * @name: CSourceIndexNames
+ *
+ * @field length: the number of names
+ * @type: int
+ *
+ * @field capacity: the number of names there is room for
+ * @type: int
+ *
+ * @field contents: the names
+ * @type: struct CSourceIndexName *
+*/
+struct CSourceIndexNames {
+    int length;
+    int capacity;
+    struct CSourceIndexName *contents;
+};
+
+/*
+ * @docgen: structure
+ * @brief: a place a name is found in
+ * @name: CSourcePosting
+ *
+ * @field name: the name
+ * @type: int
+ *
+ * @field file: the file the name is found in
+ * @type: int
+ *
+ * @field line: the line the name is found on
+ * @type: int
+ *
+ * @field kind: the kind of symbol the name is there (CSOURCE_SYMBOL_*)
+ * @type: int
+*/
+struct CSourcePosting {
+    int name;
+    int file;
+    int line;
+    int kind;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the postings of an index that is being made
+ * @name: CSourcePostings
+ *
+ * @field length: the number of postings
+ * @type: int
+ *
+ * @field capacity: the number of postings there is room for
+ * @type: int
+ *
+ * @field contents: the postings
+ * @type: struct CSourcePosting *
+*/
+struct CSourcePostings {
+    int length;
+    int capacity;
+    struct CSourcePosting *contents;
+};
+
+/*
+ * @docgen: structure
+ * @brief: an index that is being made
+ * @name: CSourceIndexBuilder
+ *
+ * @field table: the files of the index, which must be the first field
+ * @type: struct CSourceTable
+ *
+ * @field last: the index made last time, if table.last is not NULL
+ * @type: struct CSourceIndex
+ *
+ * @field names: the names of the index, in the order they were found
+ * @type: struct CSourceIndexNames *
+ *
+ * @field postings: the postings of the index, in the order they were found
+ * @type: struct CSourcePostings *
+ *
+ * @field strings: the names, each ending with a NUL
+ * @type: char *
+ *
+ * @field strings_length: the number of bytes in the names
+ * @type: long
+ *
+ * @field strings_capacity: the number of bytes there is room for
+ * @type: long
+ *
+ * @field buckets: a hash table of the names, where -1 is an empty bucket
+ * @type: int *
+ *
+ * @field bucket_count: the number of buckets, which is a power of two
+ * @type: int
+*/
+struct CSourceIndexBuilder {
+    struct CSourceTable table;
+    struct CSourceIndex last;
+    struct CSourceIndexNames *names;
+    struct CSourcePostings *postings;
+    char *strings;
+    long strings_length;
+    long strings_capacity;
+    int *buckets;
+    int bucket_count;
+};
+
+/*
+ * @docgen: function
+ * @brief: open an index
+ * @name: csource_index_open
+ *
+ * @description
+ * @Map an index into memory, and check that it is whole, and of the
+ * @version of csource that is reading it.
+ * @description
+ *
+ * @error: index is NULL
+ * @error: path is NULL
+ *
+ * @param index: the index to open
+ * @type: struct CSourceIndex *
+ *
+ * @param path: the path of the index
+ * @type: const char *
+ *
+ * @return: 0 if the index could be opened, or -1 if it could not
+ * @type: int
+*/
+int csource_index_open(struct CSourceIndex *index, const char *path);
+
+/*
+ * @docgen: function
+ * @brief: close an index
+ * @name: csource_index_close
+ *
+ * @error: index is NULL
+ *
+ * @param index: the index to close
+ * @type: struct CSourceIndex *
+*/
+void csource_index_close(struct CSourceIndex *index);
+
+/*
+ * @docgen: function
+ * @brief: write every place a name is found in
+ * @name: csource_index_query
+ *
+ * @description
+ * @Write the postings of a name, by file and line. In the text format,
+ * @each one is written as the path, line and kind of symbol, split by
+ * @colons. Otherwise, each one is a definition, prototype or use record
+ * @of its file, with the name as its payload.
+ * @description
+ *
+ * @error: index is NULL
+ * @error: name is NULL
+ * @error: output is NULL
+ *
+ * @param index: the index to search
+ * @type: const struct CSourceIndex *
+ *
+ * @param name: the name to look for
+ * @type: const char *
+ *
+ * @param output: the record stream to write to
+ * @type: struct CSourceOutput *
+ *
+ * @return: the number of postings written
+ * @type: long
+*/
+long csource_index_query(const struct CSourceIndex *index, const char *name,
+                         struct CSourceOutput *output);
+
+/*
+ * @docgen: function
+ * @brief: write the symbols of a file for an index
+ * @name: csource_index_file
+ *
+ * @description
+ * @Write the symbols of a file the way csource_index_read reads them,
+ * @which is the path of the file, and then each name of the file with
+ * @its lines. Nothing else can make sense of them, so this is not one of
+ * @the commands. The text format must be used, since the symbols are
+ * @written as they are.
+ * @description
+ *
+ * @param setup: the setup of the module
+ * @type: struct ModuleSetup
+*/
+void csource_index_file(struct ModuleSetup setup);
+
+/*
+ * @docgen: function
+ * @brief: start making an index
+ * @name: csource_index_builder_init
+ *
+ * @description
+ * @Start making an index, from the one at its path if it can be opened.
+ * @Files are added to the table of the builder with csource_table_add_file,
+ * @which is the first field of the builder, and is what is returned, so
+ * @that every kind of index can be made the same way.
+ * @description
+ *
+ * @error: path is NULL
+ *
+ * @param path: the path of the index
+ * @type: const char *
+ *
+ * @return: the table of a new builder
+ * @type: struct CSourceTable *
+*/
+struct CSourceTable *csource_index_builder_init(const char *path);
+
+/*
+ * @docgen: function
+ * @brief: read the symbols of files into an index that is being made
+ * @name: csource_index_read
+ *
+ * @description
+ * @Read what csource_index_file wrote for each file that needed to be
+ * @read. A file which is not there, because it could not be read, is kept
+ * @out of the index until it can be.
+ * @description
+ *
+ * @error: table is NULL
+ * @error: stream is NULL
+ *
+ * @param table: the table of the builder to add the symbols to
+ * @type: struct CSourceTable *
+ *
+ * @param stream: the stream to read from
+ * @type: FILE *
+ *
+ * @return: 0 if the symbols could be read, or -1 if they are cut short
+ * @type: int
+*/
+int csource_index_read(struct CSourceTable *table, FILE *stream);
+
+/*
+ * @docgen: function
+ * @brief: write an index that is being made
+ * @name: csource_index_write
+ *
+ * @description
+ * @Take the postings of the files that did not change from the last
+ * @index, and write the index. It is written to a file next to the path
+ * @first, and then moved over it, so that a reader never sees half of it.
+ * @description
+ *
+ * @error: table is NULL
+ * @error: path is NULL
+ *
+ * @param table: the table of the builder to write
+ * @type: struct CSourceTable *
+ *
+ * @param path: the path to write the index to
+ * @type: const char *
+ *
+ * @return: 0 if the index was written, or -1 if it could not be
+ * @type: int
+*/
+int csource_index_write(struct CSourceTable *table, const char *path);
+
+/*
+ * @docgen: function
+ * @brief: release an index that is being made
+ * @name: csource_index_builder_free
+ *
+ * @description
+ * @Release a builder, and close the last index it was made from.
+ * @description
+ *
+ * @error: table is NULL
+ *
+ * @param table: the table of the builder to release
+ * @type: struct CSourceTable *
+*/
+void csource_index_builder_free(struct CSourceTable *table);
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file deals with reading source files in. Mapping a file is POSIX,
+ * not ANSI, so everywhere else a file is always read into a buffer.
+*/
+
+#if defined(__unix__) || defined(__CW_UNIXWARE__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200112L
+#define CSOURCE_INGEST_MMAP
+#endif
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(CSOURCE_INGEST_MMAP)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#include "../csource.h"
+
+#include "ingest.h"
+
+struct LibmatchCursor csource_ingest(FILE *file, int *mapped) {
+#if defined(CSOURCE_INGEST_MMAP)
+    void *mapping = NULL;
+    struct stat status;
+#endif
+    struct LibmatchCursor cursor;
+
+    liberror_is_null(csource_ingest, file);
+    liberror_is_null(csource_ingest, mapped);
+
+    INIT_VARIABLE(cursor);
+    *mapped = 0;
+
+#if defined(CSOURCE_INGEST_MMAP)
+    /* An empty file cannot be mapped, and a cursor cannot be longer than
+     * an int, so both are read the usual way */
+    if(fstat(fileno(file), &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0 &&
+       status.st_size <= INT_MAX) {
+        mapping = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+
+        if(mapping != MAP_FAILED) {
+            cursor.buffer = mapping;
+            cursor.length = status.st_size;
+            *mapped = 1;
+
+            return cursor;
+        }
+    }
+#endif
+
+    return libmatch_cursor_from_stream(file);
+}
+
+void csource_ingest_free(struct LibmatchCursor *cursor, int mapped) {
+    liberror_is_null(csource_ingest_free, cursor);
+
+#if defined(CSOURCE_INGEST_MMAP)
+    if(mapped == 1) {
+        munmap(cursor->buffer, cursor->length);
+
+        return;
+    }
+#endif
+
+    libmatch_cursor_free(cursor);
+}
@@ -0,0 +1,89 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_CSOURCE_INGEST_H
+#define CWARE_CSOURCE_INGEST_H
+
+#include <stdio.h>
+
+/*
+ * @docgen: function
+ * @brief: read a whole source file into a cursor
+ * @name: csource_ingest
+ *
+ * @description
+ * @Read a whole file into a cursor for a module to scan. A regular file is
+ * @mapped into memory where the system can, which saves copying it, and
+ * @anything else, like a pipe, is read into a buffer. A mapping can only
+ * @be read, since modules never write to their input.
+ * @description
+ *
+ * @notes
+ * @The buffer is not NUL terminated either way, and nothing past its
+ * @length may be read. A mapping ends on the last byte of the file.
+ * @notes
+ *
+ * @error: file is NULL
+ * @error: mapped is NULL
+ *
+ * @param file: the file to read
+ * @type: FILE *
+ *
+ * @param mapped: where to store whether the file was mapped
+ * @type: int *
+ *
+ * @return: a cursor over the contents of the file
+ * @type: struct LibmatchCursor
+*/
+struct LibmatchCursor csource_ingest(FILE *file, int *mapped);
+
+/*
+ * @docgen: function
+ * @brief: release a cursor from csource_ingest
+ * @name: csource_ingest_free
+ *
+ * @error: cursor is NULL
+ *
+ * @param cursor: the cursor to release
+ * @type: struct LibmatchCursor *
+ *
+ * @param mapped: whether the file was mapped
+ * @type: int
+*/
+void csource_ingest_free(struct LibmatchCursor *cursor, int mapped);
+
+#endif
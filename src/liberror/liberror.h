@@ -45,19 +45,35 @@
 
 #define CWARE_LIBERROR_VERSION  "1.0.0"
 
+/* Define LIBERROR_NO_ABORT to hand every error to liberror_handle_error,
+ * which the program defines and which must not return, rather than print
+ * it and abort. */
+#if defined(LIBERROR_NO_ABORT)
+void liberror_handle_error(void);
+
+#define _liberror_report(arguments)
+#define _liberror_abort() \
+    liberror_handle_error()
+#else
+#define _liberror_report(arguments) \
+    fprintf arguments
+#define _liberror_abort() \
+    abort()
+#endif
+
 #define liberror_abort() \
     fflush(stderr);      \
     fflush(stdout);      \
-    abort()
+    _liberror_abort()
 
 #define liberror_is_null(function_name, argument)                 \
 do {                                                              \
     if((argument) != NULL)                                        \
         break;                                                    \
                                                                   \
-    fprintf(stderr, "%s", #function_name ": argument '" #argument \
-            "' cannot be NULL\n");                                \
-    abort();                                                      \
+    _liberror_report((stderr, "%s", #function_name ": argument '" \
+                      #argument "' cannot be NULL\n"));           \
+    _liberror_abort();                                            \
 } while(0)
 
 #define liberror_in_range(function_name, argument, start, end)        \
@@ -65,9 +81,10 @@ do {                                                                  \
     if((argument) >= (start) && (argument) <= end)                    \
         break;                                                        \
                                                                       \
-    fprintf(stderr, "%s: argument '%s' (%i) out of range (%i, %i)\n", \
-            #function_name, #argument, (start), (end), argument);     \
-    abort();                                                          \
+    _liberror_report((stderr, "%s: argument '%s' (%i) out of range "  \
+                      "(%i, %i)\n", #function_name, #argument,        \
+                      (start), (end), argument));                     \
+    _liberror_abort();                                                \
 } while(0)
 
 #define liberror_buffer_is_full(function_name, argument, needed_size, length) \
@@ -75,10 +92,10 @@ do {                                                                          \
     if((needed_size) <= (length))                                             \
         break;                                                                \
                                                                               \
-    fprintf(stderr, "%s: argument '%s' (%s) produces truncated buffer at "    \
-            "runtime. maximum length is %i\n", #function_name, #argument,     \
-            argument, length);                                                \
-    abort();                                                                  \
+    _liberror_report((stderr, "%s: argument '%s' (%s) produces truncated "    \
+                      "buffer at runtime. maximum length is %i\n",            \
+                      #function_name, #argument, argument, length));          \
+    _liberror_abort();                                                        \
 } while(0)
 
 #define liberror_is_number(function_name, argument, format, value)    \
@@ -86,9 +103,10 @@ do {                                                                  \
     if((argument) != (value))                                         \
         break;                                                        \
                                                                       \
-    fprintf(stderr, "%s: argument '%s' cannot be value " format "\n", \
-            #function_name, #argument, value);                        \
-    abort();                                                          \
+    _liberror_report((stderr, "%s: argument '%s' cannot be value "    \
+                      format "\n", #function_name, #argument,         \
+                      value));                                        \
+    _liberror_abort();                                                \
 } while(0);
 
 #define liberror_failure(function_name, function)                           \
@@ -96,10 +114,10 @@ do {                                                                        \
     if((errno) == 0)                                                        \
         break;                                                              \
                                                                             \
-    fprintf(stderr, "%s: function '%s' failed with error code %i (%s) "     \
-            "(%s:%i)\n", #function_name, #function, errno, strerror(errno), \
-            __FILE__, __LINE__);                                            \
-    abort();                                                                \
+    _liberror_report((stderr, "%s: function '%s' failed with error code "   \
+                      "%i (%s) (%s:%i)\n", #function_name, #function,       \
+                      errno, strerror(errno), __FILE__, __LINE__));         \
+    _liberror_abort();                                                      \
 } while(0)
 
 #define liberror_is_negative(function_name, argument)         \
@@ -107,9 +125,10 @@ do {                                                          \
     if((argument) >= 0)                                       \
         break;                                                \
                                                               \
-    fprintf(stderr, "%s: argument '%s' cannot be negative\n", \
-            #function_name, #argument);                       \
-    abort();                                                  \
+    _liberror_report((stderr, "%s: argument '%s' cannot be "  \
+                      "negative\n", #function_name,           \
+                      #argument));                            \
+    _liberror_abort();                                        \
 } while(0)
 
 #define liberror_is_positive(function_name, argument)         \
@@ -117,14 +136,15 @@ do {                                                          \
     if((argument) <= 0)                                       \
         break;                                                \
                                                               \
-    fprintf(stderr, "%s: argument '%s' cannot be positive\n", \
-            #function_name, #argument);                       \
-    abort();                                                  \
+    _liberror_report((stderr, "%s: argument '%s' cannot be "  \
+                      "positive\n", #function_name,           \
+                      #argument));                            \
+    _liberror_abort();                                        \
 } while(0)
 
 #define liberror_unhandled(function_name) \
-    fprintf(stderr, "%s: unexpected error condition (errno %i: %s) "       \
-            "(%s:%i)\n", #function_name, errno, strerror(errno), __FILE__, \
-            __LINE__)
+    _liberror_report((stderr, "%s: unexpected error condition (errno "     \
+                      "%i: %s) (%s:%i)\n", #function_name, errno,          \
+                      strerror(errno), __FILE__, __LINE__))
 
 #endif
@@ -43,6 +43,12 @@
 
 #include "libmatch.h"
 
+struct LibmatchStatistics libmatch_statistics;
+
+void *(*libmatch_malloc_hook)(size_t size) = malloc;
+void *(*libmatch_realloc_hook)(void *pointer, size_t size) = realloc;
+void (*libmatch_free_hook)(void *pointer) = free;
+
 struct LibmatchCursor libmatch_cursor_init(char *buffer, int length) {
     struct LibmatchCursor new_cursor = {LIBMATCH_CURSOR_NULL};
 
@@ -55,24 +61,32 @@ struct LibmatchCursor libmatch_cursor_init(char *buffer, int length) {
 
 struct LibmatchCursor libmatch_cursor_from_stream(FILE *stream) {
     struct LibmatchCursor new_cursor = {LIBMATCH_CURSOR_NULL};
-    char *new_buffer = malloc(sizeof(char) * LIBMATCH_INITIAL_BUFFER_SIZE);
+    char *new_buffer = libmatch_malloc_hook(sizeof(char) * LIBMATCH_INITIAL_BUFFER_SIZE);
 
     int length = 0;
     int capacity = LIBMATCH_INITIAL_BUFFER_SIZE;
-    char character = -1;
+    size_t read = 0;
 
-    /* Keep reading the linitial size until an EOF is found. */
-    while((character = fgetc(stream)) != EOF) {
-        if(length == capacity) {
-            capacity += LIBMATCH_BUFFER_GROWTH;
-            new_buffer = realloc(new_buffer, sizeof(char) * capacity);
-        }
+    _libmatch_count(allocations, 1);
+    _libmatch_count(bytes_allocated, LIBMATCH_INITIAL_BUFFER_SIZE);
 
+    /* Read as much as fits until an EOF is found, doubling the buffer
+     * whenever it fills up so large files are not copied over and over. */
+    while((read = fread(new_buffer + length, 1, capacity - length, stream)) > 0) {
+        length += (int) read;
 
-        new_buffer[length] = character;
-        length++;
+        if(length < capacity)
+            continue;
+
+        capacity *= LIBMATCH_BUFFER_GROWTH;
+        new_buffer = libmatch_realloc_hook(new_buffer, sizeof(char) * capacity);
+
+        _libmatch_count(reallocations, 1);
+        _libmatch_count(bytes_allocated, capacity);
     }
 
+    _libmatch_count(bytes_read, length);
+
     new_cursor.buffer = new_buffer;
     new_cursor.length = length;
 
@@ -86,7 +100,7 @@ int libmatch_cursor_getch(struct LibmatchCursor *cursor) {
     if(cursor->cursor == cursor->length)
         return LIBMATCH_EOF;
 
-    character = cursor->buffer[cursor->cursor];
+    character = (unsigned char) cursor->buffer[cursor->cursor];
     cursor->cursor++;
 
     /* Handle coordinates */
@@ -151,5 +165,5 @@ void libmatch_cursor_disable_pushback(struct LibmatchCursor *cursor) {
 }
 
 void libmatch_cursor_free(struct LibmatchCursor *cursor) {
-    free(cursor->buffer);
+    libmatch_free_hook(cursor->buffer);
 }
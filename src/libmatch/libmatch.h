@@ -44,7 +44,9 @@
 #define LIBMATCH_EOF         -1
 
 #define LIBMATCH_INITIAL_BUFFER_SIZE    1024
-#define LIBMATCH_BUFFER_GROWTH          512
+/* Buffers grow by a factor rather than by a fixed amount, so reading
+ * something of any length stays linear. */
+#define LIBMATCH_BUFFER_GROWTH          2
 
 /* Character classes */
 #define LIBMATCH_LOWER      "abcdefghijklmnopqrstuvwxyz"
@@ -65,6 +67,38 @@
         libmatch_cursor_ungetch(cursor);    \
     }
 
+/* Instrumentation. Define LIBMATCH_NO_STATISTICS when building libmatch
+ * to compile the counters out entirely. */
+#if defined(LIBMATCH_NO_STATISTICS)
+#define _libmatch_count(counter, amount)
+#else
+#define _libmatch_count(counter, amount) \
+    (libmatch_statistics.counter += (unsigned long) (amount))
+#endif
+
+/*
+ * Counters of the work done by libmatch. These are only updated where
+ * memory is allocated, or a stream is consumed, so they are cheap enough
+ * to always be on.
+*/
+struct LibmatchStatistics {
+    unsigned long allocations;
+    unsigned long reallocations;
+    unsigned long bytes_allocated;
+    unsigned long bytes_read;
+};
+
+extern struct LibmatchStatistics libmatch_statistics;
+
+/*
+ * The allocator used by libmatch for every buffer it allocates, and for
+ * releasing them. These point at the standard allocator by default, and
+ * should only be replaced before libmatch has allocated anything.
+*/
+extern void *(*libmatch_malloc_hook)(size_t size);
+extern void *(*libmatch_realloc_hook)(void *pointer, size_t size);
+extern void (*libmatch_free_hook)(void *pointer);
+
 /*
  * A 'cursor' used to tell where the matching process is in a
  * stream.
@@ -247,22 +281,22 @@ int libmatch_next_line(struct LibmatchCursor *cursor);
  * cursor->buffer[cursor->cursor]
  *
  * Must evaluate to a double quote. If this is not the case, the
- * function will error. When parsing the string literal, the
+ * function fails. When parsing the string literal, the
  * sequence '\"' will be interpreted as a literal double quote in
  * the string. Otherwise, when a double quote is met, the string
  * will cease parsing.
  *
  * If the length is reached and the next immediate character is
- * not an unescaped double quote, an error will be raised. In a
- * situation where this behavior is not desirable, use a dynamic
- * buffer.
+ * not an unescaped double quote, or the string never ends, the
+ * function fails. In a situation where this behavior is not
+ * desirable, use a dynamic buffer.
  *
  * The final string will be NUL-terminated.
  *
  * @param cursor: the cursor to use
  * @param buffer: the buffer to write the literal into
  * @param length: the maximum length of the buffer.
- * @return: length of the string
+ * @return: length of the string, or -1 if it failed
 */
 int libmatch_read_literal(struct LibmatchCursor *cursor, char *buffer,
                           int length);
@@ -286,7 +320,7 @@ int libmatch_read_n(struct LibmatchCursor *cursor, char *buffer, int count);
  * final buffer must be released from memory.
  *
  * @param cursor: the cursor to use
- * @return: the new buffer
+ * @return: the new buffer, or NULL if it failed
 */
 char *libmatch_read_alloc_literal(struct LibmatchCursor *cursor);
 
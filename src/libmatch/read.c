@@ -52,12 +52,8 @@ int libmatch_read_literal(struct LibmatchCursor *cursor, char *buffer,
     int character = -1;
     int escaped = 0;
 
-    if(libmatch_cursor_getch(cursor) != '"') {
-        fprintf(stderr, "libmatch_read_literal: cursor not positioned on a "
-                "double quote (cursor=%i, string='%s')\n", cursor->cursor - 1,
-                cursor->buffer);
-        abort();
-    }
+    if(libmatch_cursor_getch(cursor) != '"')
+        return -1;
 
     while((character = libmatch_cursor_getch(cursor)) != EOF) {
         if(character == '"' && escaped == 0)
@@ -81,24 +77,14 @@ int libmatch_read_literal(struct LibmatchCursor *cursor, char *buffer,
 
     /* Cursor will be positioned after the LENGTH-th character, and so should
      * be positioned on a double quote in correct circumstances. */
-    if(written == length && cursor->buffer[cursor->cursor] != '"') {
-        fprintf(stderr, "libmatch_read_literal: no ending double quote found! "
-                "was the buffer too small? if so, consider using "
-                "libmatch_read_alloc_literal (cursor=%i, string='%s')\n",
-                cursor->cursor, cursor->buffer);
-        abort();
-    }
+    if(written == length && cursor->buffer[cursor->cursor] != '"')
+        return -1;
 
     /* Cursor will be positioned after the double quote since the length is not
      * met, leaving the occurrence of a double quote as the only condition that
      * can stop the loop (outside of an EOF) */
-    if(written < length && cursor->buffer[cursor->cursor - 1] != '"') {
-        fprintf(stderr, "libmatch_read_literal: no ending double quote found! "
-                "was the buffer too small? if so, consider using "
-                "libmatch_read_alloc_literal (cursor=%i, string='%s')\n",
-                cursor->cursor, cursor->buffer);
-        abort();
-    }
+    if(written < length && cursor->buffer[cursor->cursor - 1] != '"')
+        return -1;
 
     buffer[written] = '\0';
 
@@ -111,14 +97,15 @@ char *libmatch_read_alloc_literal(struct LibmatchCursor *cursor) {
     int escaped = 0;
     int buffer_cursor = 0;
     int capacity = LIBMATCH_INITIAL_BUFFER_SIZE;
-    char *buffer = malloc(sizeof(char) * (LIBMATCH_INITIAL_BUFFER_SIZE + 1));
+    char *buffer = NULL;
 
-    if(libmatch_cursor_getch(cursor) != '"') {
-        fprintf(stderr, "libmatch_read_alloc_literal: cursor not positioned on"
-                " a double quote (cursor=%i, string='%s')\n", cursor->cursor -
-                1, cursor->buffer);
-        abort();
-    }
+    if(libmatch_cursor_getch(cursor) != '"')
+        return NULL;
+
+    buffer = libmatch_malloc_hook(sizeof(char) * (LIBMATCH_INITIAL_BUFFER_SIZE + 1));
+
+    _libmatch_count(allocations, 1);
+    _libmatch_count(bytes_allocated, LIBMATCH_INITIAL_BUFFER_SIZE + 1);
 
     while((character = libmatch_cursor_getch(cursor)) != EOF) {
         if(character == '"' && escaped == 0)
@@ -138,16 +125,18 @@ char *libmatch_read_alloc_literal(struct LibmatchCursor *cursor) {
 
         /* Resize buffer */
         if(written == capacity) {
-            capacity += LIBMATCH_BUFFER_GROWTH;
-            buffer = realloc(buffer, sizeof(char) * capacity);
+            capacity *= LIBMATCH_BUFFER_GROWTH;
+            buffer = libmatch_realloc_hook(buffer, sizeof(char) * capacity);
+
+            _libmatch_count(reallocations, 1);
+            _libmatch_count(bytes_allocated, capacity);
         }
     }
 
     if(cursor->buffer[cursor->cursor - 1] != '"') {
-        fprintf(stderr, "libmatch_read_alloc_literal: no ending double quote "
-                "found! (cursor=%i, string='%s')\n",
-                cursor->cursor, cursor->buffer);
-        abort();
+        libmatch_free_hook(buffer);
+
+        return NULL;
     }
 
     buffer[buffer_cursor] = '\0';
@@ -209,7 +198,10 @@ char *libmatch_read_alloc_until(struct LibmatchCursor *cursor,
     int character = -1;
     int buffer_cursor = 0;
     int capacity = LIBMATCH_INITIAL_BUFFER_SIZE;
-    char *buffer = malloc(sizeof(char) * (LIBMATCH_INITIAL_BUFFER_SIZE + 1));
+    char *buffer = libmatch_malloc_hook(sizeof(char) * (LIBMATCH_INITIAL_BUFFER_SIZE + 1));
+
+    _libmatch_count(allocations, 1);
+    _libmatch_count(bytes_allocated, LIBMATCH_INITIAL_BUFFER_SIZE + 1);
 
     while((character = libmatch_cursor_getch(cursor)) != EOF) {
         if(strchr(characters, character) != NULL) {
@@ -223,8 +215,11 @@ char *libmatch_read_alloc_until(struct LibmatchCursor *cursor,
         written++;
 
         if(written == capacity) {
-            capacity += LIBMATCH_BUFFER_GROWTH;
-            buffer = realloc(buffer, sizeof(char) * capacity);
+            capacity *= LIBMATCH_BUFFER_GROWTH;
+            buffer = libmatch_realloc_hook(buffer, sizeof(char) * capacity);
+
+            _libmatch_count(reallocations, 1);
+            _libmatch_count(bytes_allocated, capacity);
         }
     }
 
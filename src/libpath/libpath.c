@@ -90,6 +90,10 @@
 #include "libpath.h"
 #include "lp_inter.h"
 
+void *(*libpath_malloc_hook)(size_t size) = malloc;
+void *(*libpath_realloc_hook)(void *pointer, size_t size) = realloc;
+void (*libpath_free_hook)(void *pointer) = free;
+
 int libpath_join_path(char *buffer, int length, ...) {
     int written = 0;
     va_list path_segment;
@@ -270,7 +274,7 @@ struct LibpathFiles libpath_glob(const char *path, const char *pattern) {
      * a stack structure but with a heap contents field. */
     globbed_files.length = 0;
     globbed_files.capacity = 5;
-    globbed_files.contents = malloc(sizeof(struct LibpathFile) * 5);
+    globbed_files.contents = libpath_malloc_hook(sizeof(struct LibpathFile) * 5);
 
     directory = opendir(path);
 
@@ -319,7 +323,7 @@ struct LibpathFiles libpath_glob(const char *path, const char *pattern) {
      * a stack structure but with a heap contents field. */
     globbed_files.length = 0;
     globbed_files.capacity = 5;
-    globbed_files.contents = malloc(sizeof(struct LibpathFile) * 5);
+    globbed_files.contents = libpath_malloc_hook(sizeof(struct LibpathFile) * 5);
 
     /* Build the path to the glob. */
     if(libpath_join_path(glob_path, LIBPATH_GLOB_PATH_LENGTH, path, "*.*",
@@ -391,7 +395,7 @@ struct LibpathFiles libpath_glob(const char *path, const char *pattern) {
      * a stack structure but with a heap contents field. */
     globbed_files.length = 0;
     globbed_files.capacity = 5;
-    globbed_files.contents = malloc(sizeof(struct LibpathFile) * 5);
+    globbed_files.contents = libpath_malloc_hook(sizeof(struct LibpathFile) * 5);
 
     /* Build the path to the glob. */
     if(libpath_join_path(glob_path, LIBPATH_GLOB_PATH_LENGTH, path, "*.*",
@@ -443,5 +447,5 @@ struct LibpathFiles libpath_glob(const char *path, const char *pattern) {
 #endif
 
 void libpath_glob_free(struct LibpathFiles files) {
-    free(files.contents);
+    libpath_free_hook(files.contents);
 }
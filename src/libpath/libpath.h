@@ -63,6 +63,15 @@
 
 #define CWARE_LIBCWPATH_VERSION  "1.0.2"
 
+#include <stddef.h>
+
+/* The allocator used by libpath for everything it allocates. These point at
+ * the standard allocator by default, and should only be replaced before
+ * libpath has allocated anything. */
+extern void *(*libpath_malloc_hook)(size_t size);
+extern void *(*libpath_realloc_hook)(void *pointer, size_t size);
+extern void (*libpath_free_hook)(void *pointer);
+
 /* Limits */
 #define LIBPATH_GLOB_PATH_LENGTH    256 + 1
 
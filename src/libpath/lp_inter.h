@@ -42,6 +42,11 @@
 #ifndef CWARE_LIBCWPATH_INTERNAL_H
 #define CWARE_LIBCWPATH_INTERNAL_H
 
+/* Route the allocations of carray through the libpath allocator */
+#define CARRAY_MALLOC(size)             libpath_malloc_hook((size))
+#define CARRAY_REALLOC(pointer, size)   libpath_realloc_hook((pointer), (size))
+#define CARRAY_FREE(pointer)            libpath_free_hook((pointer))
+
 /* Internal inclusions-- feel free to modify these as long as they
  * point to the same library */
 #include "carray/carray.h"
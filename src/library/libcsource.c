@@ -0,0 +1,377 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file implements libcsource, and the table of commands which the
+ * command line program shares with it. Nothing here keeps any state of
+ * its own outside of a context, and the library is built without the
+ * allocation counters of --stats, so that threads never share anything
+ * they write to.
+*/
+
+#include <string.h>
+#include <setjmp.h>
+
+#include "../csource.h"
+#include "../common/common.h"
+
+#include "../extractors/include/include.h"
+#include "../extractors/docgen/docgen.h"
+#include "../extractors/conditionals/conditionals.h"
+#include "../extractors/counts/counts.h"
+#include "../extractors/defines/defines.h"
+#include "../extractors/functions/functions.h"
+#include "../extractors/grep/grep.h"
+#include "../extractors/prototypes/prototypes.h"
+#include "../extractors/symbols/symbols.h"
+#include "../extractors/tags/tags.h"
+#include "../extractors/types/types.h"
+#include "../extractors/globals/globals.h"
+
+#include "../filters/comments/comments.h"
+#include "../filters/directives/directives.h"
+#include "../filters/prune/prune.h"
+
+#include "libcsource.h"
+
+static const struct CSourceModule modules[] = {
+    {"include", csource_write_inclusions, NULL, 1, 0},
+    {"functions", csource_extract_functions, NULL, 1, 0},
+    {"strip-comments", csource_filter_comments, NULL, 1, 0},
+    {"strip-directives", csource_filter_directives, NULL, 1, 0},
+    {"docgen", csource_extract_docgen, NULL, 1, 0},
+    {"defines", csource_extract_defines, NULL, 1, 0},
+    {"prune", csource_filter_prune, NULL, 1, 0},
+    {"conditionals", csource_extract_conditionals, NULL, 1, 0},
+    {"stats", csource_extract_counts, csource_counts_write, 1, 0},
+    {"prototypes", csource_extract_prototypes, NULL, 0, 0},
+    {"grep", csource_extract_grep, NULL, 0, 1},
+    {"symbols", csource_extract_symbols, NULL, 1, 0},
+    {"tags", csource_extract_tags, NULL, 0, 0},
+    {"types", csource_extract_types, NULL, 1, 0},
+    {"globals", csource_extract_globals, NULL, 1, 0},
+    {NULL, NULL, NULL, 0, 0}
+};
+
+/* The descriptions of each error, indexed by error. */
+static const char *error_messages[] = {
+    "success", "invalid argument", "unknown command", "unknown format",
+    "the sink could not take the output", "a NUL byte, so the buffer is not text",
+    "an internal error stopped the command"
+};
+
+#if defined(LIBERROR_NO_ABORT)
+
+/* Where an error returns to, which is set by guard. Every thread needs
+ * its own, wherever the compiler has a way to give it one. */
+#if defined(__GNUC__)
+static __thread jmp_buf *recover = NULL;
+#else
+static jmp_buf *recover = NULL;
+#endif
+
+void liberror_handle_error(void) {
+    longjmp(*recover, 1);
+}
+
+#endif
+
+/*
+ * @docgen: function
+ * @brief: call a function, and return rather than end the process on an error
+ * @name: guard
+ *
+ * @description
+ * @Call a function with an argument. In the library, an error that would
+ * @otherwise print and end the process returns to here instead, leaving
+ * @what the function had allocated behind.
+ * @description
+ *
+ * @param function: the function to call
+ * @type: void (*)(void *)
+ *
+ * @param argument: the argument to call it with
+ * @type: void *
+ *
+ * @return: CSOURCE_SUCCESS, or CSOURCE_ERROR_INTERNAL on an error
+ * @type: int
+*/
+static int guard(void (*function)(void *argument), void *argument) {
+#if defined(LIBERROR_NO_ABORT)
+    jmp_buf point;
+
+    recover = &point;
+
+    if(setjmp(point) != 0) {
+        recover = NULL;
+
+        return CSOURCE_ERROR_INTERNAL;
+    }
+
+    function(argument);
+    recover = NULL;
+#else
+    function(argument);
+#endif
+
+    return CSOURCE_SUCCESS;
+}
+
+/*
+ * @docgen: structure
+ * @brief: a command to run on a buffer, and how it went
+ * @name: CSourceCommand
+ *
+ * @field context: the context to run the command with
+ * @type: struct CSourceContext *
+ *
+ * @field module: the module of the command
+ * @type: const struct CSourceModule *
+ *
+ * @field path: the path to attribute the records to
+ * @type: const char *
+ *
+ * @field buffer: the source file
+ * @type: const char *
+ *
+ * @field length: the length of the source file
+ * @type: int
+ *
+ * @field sink: the sink to give the records to
+ * @type: struct CSourceSink *
+ *
+ * @field directives: the directives to set the macros of the context from
+ * @type: const char *
+ *
+ * @field error: CSOURCE_SUCCESS, or the error the command ended with
+ * @type: int
+*/
+struct CSourceCommand {
+    struct CSourceContext *context;
+    const struct CSourceModule *module;
+    const char *path;
+    const char *buffer;
+    int length;
+    struct CSourceSink *sink;
+    const char *directives;
+    int error;
+};
+
+const struct CSourceModule *csource_find_module(const char *name) {
+    int index = 0;
+
+    if(name == NULL)
+        return NULL;
+
+    for(index = 0; modules[index].name != NULL; index++) {
+        if(strcmp(modules[index].name, name) == 0)
+            return modules + index;
+    }
+
+    return NULL;
+}
+
+struct CSourceContext csource_context_init(void) {
+    struct CSourceContext context;
+
+    INIT_VARIABLE(context);
+
+    context.format = CSOURCE_FORMAT_TEXT;
+
+    return context;
+}
+
+/*
+ * @docgen: function
+ * @brief: set the macros of a context from directives
+ * @name: set_macros
+ *
+ * @param argument: the struct CSourceCommand with the context and directives
+ * @type: void *
+*/
+static void set_macros(void *argument) {
+    struct CSourceCommand *command = argument;
+
+    if(command->context->macros != NULL)
+        csource_defines_free(command->context->macros);
+
+    /* The old macros are gone even if the new ones fail */
+    command->context->macros = NULL;
+    command->context->macros = csource_prune_macros(command->directives, command->length);
+}
+
+/*
+ * @docgen: function
+ * @brief: run a command on a buffer, giving its records to a sink
+ * @name: run_command
+ *
+ * @param argument: the struct CSourceCommand to run
+ * @type: void *
+*/
+static void run_command(void *argument) {
+    struct ModuleSetup setup;
+    struct CSourceOutput output;
+    struct CSourceCommand *command = argument;
+    struct CSourceContext *context = command->context;
+
+    INIT_VARIABLE(setup);
+
+    output = csource_output_init_sink(command->sink, context->format, command->path);
+    output.statistics = &context->statistics;
+
+    /* No module writes to its input, so the buffer is used as it is */
+    setup.input = libmatch_cursor_init((char *) command->buffer, command->length);
+    setup.source = command->path;
+    setup.command = command->module->name;
+    setup.lookup = context->lookup;
+    setup.line = context->line;
+    setup.statics = context->statics;
+    setup.identifiers = context->identifiers;
+    setup.scope = context->scope;
+    setup.tags = context->tags;
+    setup.macros = context->macros;
+    setup.statistics = &context->statistics;
+    setup.output = &output;
+
+    command->module->run(setup);
+    csource_output_flush(&output);
+
+    if(output.error != 0)
+        command->error = CSOURCE_ERROR_SINK;
+
+    csource_output_free(&output);
+}
+
+/*
+ * @docgen: function
+ * @brief: release the macros of a context
+ * @name: free_macros
+ *
+ * @param argument: the context
+ * @type: void *
+*/
+static void free_macros(void *argument) {
+    struct CSourceContext *context = argument;
+
+    csource_defines_free(context->macros);
+}
+
+int csource_context_macros(struct CSourceContext *context, const char *directives, int length) {
+    struct CSourceCommand command;
+
+    if(context == NULL || directives == NULL || length < 0)
+        return CSOURCE_ERROR_ARGUMENT;
+
+    INIT_VARIABLE(command);
+
+    command.context = context;
+    command.directives = directives;
+    command.length = length;
+
+    return guard(set_macros, &command);
+}
+
+int csource_context_run(struct CSourceContext *context, const char *command, const char *path,
+                        const char *buffer, int length, struct CSourceSink *sink) {
+    int index = 0;
+    int error = CSOURCE_SUCCESS;
+    struct CSourceCommand run;
+    const struct CSourceModule *module = NULL;
+
+    /* Everything the modules would stop the process over is checked
+     * here instead */
+    if(context == NULL || buffer == NULL || length < 0 || sink == NULL || sink->write == NULL)
+        return CSOURCE_ERROR_ARGUMENT;
+
+    if(context->scope < CSOURCE_SCOPE_ANY || context->scope > CSOURCE_SCOPE_TOP)
+        return CSOURCE_ERROR_ARGUMENT;
+
+    if(context->tags != CSOURCE_TAGS_CTAGS && context->tags != CSOURCE_TAGS_ETAGS)
+        return CSOURCE_ERROR_ARGUMENT;
+
+    for(index = 0; context->identifiers != NULL && context->identifiers[index] != NULL; index++) {
+        if(csource_is_identifier(context->identifiers[index]) == 0)
+            return CSOURCE_ERROR_ARGUMENT;
+    }
+
+    if((module = csource_find_module(command)) == NULL)
+        return CSOURCE_ERROR_COMMAND;
+
+    if(context->format != CSOURCE_FORMAT_TEXT && context->format != CSOURCE_FORMAT_JSONL &&
+       context->format != CSOURCE_FORMAT_BINARY)
+        return CSOURCE_ERROR_FORMAT;
+
+    /* The scanners take a NUL byte as the end of a line or a string, so
+     * what they made of a buffer with one in it would be wrong */
+    if(length > 0 && memchr(buffer, '\0', length) != NULL)
+        return CSOURCE_ERROR_BINARY;
+
+    if(path == NULL)
+        path = "-";
+
+    INIT_VARIABLE(run);
+
+    run.context = context;
+    run.module = module;
+    run.path = path;
+    run.buffer = buffer;
+    run.length = length;
+    run.sink = sink;
+
+    if((error = guard(run_command, &run)) == CSOURCE_SUCCESS)
+        error = run.error;
+
+    context->statistics.files++;
+    context->statistics.bytes_in += length;
+
+    return error;
+}
+
+void csource_context_free(struct CSourceContext *context) {
+    if(context == NULL || context->macros == NULL)
+        return;
+
+    guard(free_macros, context);
+    context->macros = NULL;
+}
+
+const char *csource_error_message(int error) {
+    if(error < CSOURCE_SUCCESS || error > CSOURCE_ERROR_INTERNAL)
+        return "unknown error";
+
+    return error_messages[error];
+}
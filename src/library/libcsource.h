@@ -0,0 +1,259 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * The interface of libcsource, which runs the commands of csource on
+ * buffers in memory, for programs that would rather link csource than
+ * run it once for every file.
+*/
+
+#ifndef CWARE_CSOURCE_LIBCSOURCE_H
+#define CWARE_CSOURCE_LIBCSOURCE_H
+
+#include <stdio.h>
+
+#include "../output/output.h"
+#include "../statistics/statistics.h"
+#include "../extractors/grep/grep.h"
+#include "../extractors/tags/tags.h"
+
+/* Errors of libcsource */
+#define CSOURCE_SUCCESS         0
+#define CSOURCE_ERROR_ARGUMENT  1
+#define CSOURCE_ERROR_COMMAND   2
+#define CSOURCE_ERROR_FORMAT    3
+#define CSOURCE_ERROR_SINK      4
+#define CSOURCE_ERROR_BINARY    5
+#define CSOURCE_ERROR_INTERNAL  6
+
+struct ModuleSetup;
+struct CSourceDefines;
+
+/*
+ * @docgen: structure
+ * @brief: a command of csource, and the module that performs it
+ * @name: CSourceModule
+ *
+ * @field name: the name of the command
+ * @type: const char *
+ *
+ * @field run: the module that performs the command
+ * @type: void (*)(struct ModuleSetup)
+ *
+ * @field report: writes totals over every file after the records, or NULL
+ * @type: void (*)(struct CSourceOutput *, struct CSourceStatistics)
+ *
+ * @field shared: whether files with the same contents have the same records
+ * @type: int
+ *
+ * @field paths: whether the text it writes has the path of the file in it
+ * @type: int
+*/
+struct CSourceModule {
+    const char *name;
+    void (*run)(struct ModuleSetup setup);
+    void (*report)(struct CSourceOutput *output, struct CSourceStatistics statistics);
+    int shared;
+    int paths;
+};
+
+/*
+ * @docgen: structure
+ * @brief: everything commands are run with, besides their input
+ * @name: CSourceContext
+ *
+ * @description
+ * @The options of a run, and the totals of every run made with it. A
+ * @context is only ever used by one thread at a time, but any number of
+ * @threads can each run commands with their own context at once.
+ * @description
+ *
+ * @field format: the format to write records in (CSOURCE_FORMAT_*)
+ * @type: int
+ *
+ * @field lookup: the name to look up, or NULL
+ * @type: const char *
+ *
+ * @field line: the line to look up, or 0
+ * @type: int
+ *
+ * @field statics: whether static functions are wanted too
+ * @type: int
+ *
+ * @field identifiers: the identifiers grep looks for, ending with NULL
+ * @type: const char **
+ *
+ * @field scope: where grep looks for them (CSOURCE_SCOPE_*)
+ * @type: int
+ *
+ * @field tags: the format tags writes tags in (CSOURCE_TAGS_*)
+ * @type: int
+ *
+ * @field macros: the macros set with csource_context_macros, or NULL
+ * @type: struct CSourceDefines *
+ *
+ * @field statistics: the totals of every run, like the counts of stats
+ * @type: struct CSourceStatistics
+*/
+struct CSourceContext {
+    int format;
+    const char *lookup;
+    int line;
+    int statics;
+    const char **identifiers;
+    int scope;
+    int tags;
+    struct CSourceDefines *macros;
+    struct CSourceStatistics statistics;
+};
+
+/*
+ * @docgen: function
+ * @brief: find the module of a command
+ * @name: csource_find_module
+ *
+ * @param name: the name of the command
+ * @type: const char *
+ *
+ * @return: the module, or NULL if there is no such command
+ * @type: const struct CSourceModule *
+*/
+const struct CSourceModule *csource_find_module(const char *name);
+
+/*
+ * @docgen: function
+ * @brief: initialize a new context
+ * @name: csource_context_init
+ *
+ * @description
+ * @Make a context that writes text, has no options set, and has no
+ * @totals yet.
+ * @description
+ *
+ * @return: a new context
+ * @type: struct CSourceContext
+*/
+struct CSourceContext csource_context_init(void);
+
+/*
+ * @docgen: function
+ * @brief: set the macros of a context
+ * @name: csource_context_macros
+ *
+ * @description
+ * @Set the macros prune resolves conditionals against, from #define and
+ * @#undef directives, the way -D and -U set them on the command line.
+ * @Any macros set before are replaced.
+ * @description
+ *
+ * @param context: the context to set the macros of
+ * @type: struct CSourceContext *
+ *
+ * @param directives: the directives defining the macros
+ * @type: const char *
+ *
+ * @param length: the length of the directives
+ * @type: int
+ *
+ * @return: CSOURCE_SUCCESS, CSOURCE_ERROR_ARGUMENT, or CSOURCE_ERROR_INTERNAL
+ * @type: int
+*/
+int csource_context_macros(struct CSourceContext *context, const char *directives, int length);
+
+/*
+ * @docgen: function
+ * @brief: run a command on a buffer
+ * @name: csource_context_run
+ *
+ * @description
+ * @Run a command on a source file in memory, and give its records to a
+ * @sink. The buffer belongs to the caller, and is only read. The path
+ * @is only what the records are attributed to, and can be NULL. Nothing
+ * @is ever printed, and the process is never ended, whatever the input.
+ * @A buffer with a NUL byte in it is refused, like the command line
+ * @refuses a file with one. An internal error ends the command with
+ * @CSOURCE_ERROR_INTERNAL, and whatever it had allocated is not released.
+ * @description
+ *
+ * @param context: the context to run the command with
+ * @type: struct CSourceContext *
+ *
+ * @param command: the name of the command
+ * @type: const char *
+ *
+ * @param path: the path to attribute the records to, or NULL
+ * @type: const char *
+ *
+ * @param buffer: the source file
+ * @type: const char *
+ *
+ * @param length: the length of the source file
+ * @type: int
+ *
+ * @param sink: the sink to give the records to
+ * @type: struct CSourceSink *
+ *
+ * @return: CSOURCE_SUCCESS, or one of CSOURCE_ERROR_*
+ * @type: int
+*/
+int csource_context_run(struct CSourceContext *context, const char *command, const char *path,
+                        const char *buffer, int length, struct CSourceSink *sink);
+
+/*
+ * @docgen: function
+ * @brief: release a context from memory
+ * @name: csource_context_free
+ *
+ * @param context: the context to release
+ * @type: struct CSourceContext *
+*/
+void csource_context_free(struct CSourceContext *context);
+
+/*
+ * @docgen: function
+ * @brief: describe an error of libcsource
+ * @name: csource_error_message
+ *
+ * @param error: the error
+ * @type: int
+ *
+ * @return: a description of the error
+ * @type: const char *
+*/
+const char *csource_error_message(int error);
+
+#endif
@@ -41,12 +41,222 @@
 
 #include "csource.h"
 
-#include "extractors/include/include.h"
-#include "extractors/functions/functions.h"
+#include "common/common.h"
+#include "compdb/compdb.h"
+#include "extractors/defines/defines.h"
+#include "extractors/grep/grep.h"
+#include "extractors/tags/tags.h"
+#include "filters/prune/prune.h"
 
-#include "filters/comments/comments.h"
-#include "filters/directives/directives.h"
+#include "index/index.h"
+#include "ingest/ingest.h"
+#include "library/libcsource.h"
+#include "output/output.h"
+#include "search/search.h"
+#include "statistics/statistics.h"
+#include "table/table.h"
+#include "tree/tree.h"
 
+/* The help message is split into lines so that no single string
+ * literal is longer than ANSI C guarantees. */
+static const char *help_message[] = {
+    "csource COMMAND SOURCE [ --help | -h ] [ --format FORMAT ]",
+    "                       [ --stats FORMAT ] [ --jobs N ] [ --lookup NAME ]",
+    "                       [ --line N ] [ --static ] [ --keep-going ]",
+    "                       [ --scope SCOPE ] [ -D NAME[=VALUE] ]... [ -U NAME ]...",
+    "                       [ --compdb FILE ]",
+    "csource grep IDENTIFIER... SOURCE [ OPTIONS ]",
+    "csource index build DIRECTORY [ --index FILE ] [ OPTIONS ]",
+    "csource index query NAME [ --index FILE ] [ OPTIONS ]",
+    "csource search build DIRECTORY [ --index FILE ] [ OPTIONS ]",
+    "csource search query PATTERN [ --index FILE ] [ --code ] [ --regex ]",
+    "csource tags SOURCE [ --output FILE | -o FILE ] [ --etags ] [ OPTIONS ]",
+    "Extract code from a C source file or tree",
+    "",
+    "Arguments",
+    "    command            the type of token to extract",
+    "    source             the file or directory to use",
+    "",
+    "Commands",
+    "    include            local and system inclusions",
+    "    functions          function prototypes",
+    "    strip-comments     the source without its comments",
+    "    strip-directives   the source without its preprocessor directives",
+    "    docgen             docgen documentation blocks",
+    "    defines            macro definitions",
+    "    prune              the source without the code -D and -U leave out",
+    "    conditionals       conditional branches, and an index of their lines",
+    "    stats              code, comment, blank and directive lines, functions",
+    "                       and inclusions, with the totals as JSON",
+    "    prototypes         a header declaring the functions a file defines",
+    "    grep               the lines that use identifiers in their code",
+    "    symbols            identifiers, as definitions, prototypes and uses",
+    "    index              build an index of the symbols of a tree, or find",
+    "                       where a name is defined and used in one",
+    "    search             build a trigram index of a tree, or find the lines",
+    "                       a string or regular expression is on with one",
+    "    tags               a sorted ctags file of the functions, macros, types",
+    "                       and variables a file or tree defines",
+    "    types              structures, unions, enumerations and typedefs,",
+    "                       with their lines and members",
+    "    globals            variables at file scope, with their storage class,",
+    "                       whether they are arrays, and whether initialized",
+    "",
+    "Options",
+    "    --help, -h         display this message",
+    "    --format FORMAT    output format (text, jsonl, binary)",
+    "    --stats FORMAT     report statistics to stderr (text, json)",
+    "    --jobs N           files to work on at once in a directory",
+    "    --lookup NAME      only the definitions of a macro (defines)",
+    "    --line N           only the branches a line is in (conditionals)",
+    "    --static           static functions too, declared static (prototypes)",
+    "    --keep-going       skip the files that fail, and go on with the rest",
+    "    --scope SCOPE      only uses in function bodies or outside of them",
+    "                       (function, top) (grep)",
+    "    --index FILE       the index to build or query (csource.index,",
+    "                       csource.trigrams) (index, search)",
+    "    --code             only matches in code, not comments (search)",
+    "    --regex            the pattern is a POSIX extended regular expression",
+    "                       (search)",
+    "    --output, -o FILE  the file to write tags to, not stdout (tags)",
+    "    --etags            write an etags file, for Emacs, rather than ctags",
+    "                       (tags)",
+    "    --compdb FILE      only the files under the source that a",
+    "                       compile_commands.json lists, each with its own",
+    "                       -I, -D and -U",
+    "    -D NAME[=VALUE]    define a macro, as 1 without a value (prune)",
+    "    -U NAME            undefine a macro (prune)",
+    NULL
+};
+
+/* The index command reads the files of a tree with a module of its own,
+ * which is not one of the commands, since nothing else reads its output */
+static const struct CSourceModule index_module = {"index", csource_index_file, NULL, 0, 0};
+
+/* The search command has one module to read the trigrams of files, and
+ * another to search the files the trigrams are found in */
+static const struct CSourceModule search_build_module = {"search", csource_search_file, NULL, 0, 0};
+static const struct CSourceModule search_module = {"search", csource_search_lines, NULL, 0, 1};
+
+/*
+ * @docgen: structure
+ * @brief: everything needed to run a command on a file
+ * @name: CSourceRun
+ *
+ * @field module: the module to run
+ * @type: const struct CSourceModule *
+ *
+ * @field format: the format to write records in
+ * @type: int
+ *
+ * @field lookup: the name to look up, or NULL
+ * @type: const char *
+ *
+ * @field line: the line to look up, or 0
+ * @type: int
+ *
+ * @field statics: whether static functions are wanted too
+ * @type: int
+ *
+ * @field keep_going: whether to go on with the other files after one fails
+ * @type: int
+ *
+ * @field paths: whether each line of text starts with the path of its file
+ * @type: int
+ *
+ * @field identifiers: the identifiers to look for, ending with NULL, or NULL
+ * @type: const char **
+ *
+ * @field scope: where to look for them
+ * @type: int
+ *
+ * @field search: how to search for the lookup
+ * @type: int
+ *
+ * @field tags: the format to write tags in
+ * @type: int
+ *
+ * @field macros: the macros given with -D and -U
+ * @type: const struct CSourceDefines *
+ *
+ * @field directives: the -D and -U options, written as directives
+ * @type: const char *
+ *
+ * @field includes: the directories to find inclusions in, or NULL
+ * @type: const char **
+ *
+ * @field statistics: the statistics to measure the run in, or NULL
+ * @type: struct CSourceStatistics *
+ *
+ * @field groups: what is kept for each group of files of the tree, or NULL
+ * @type: struct CSourceShared *
+ *
+ * @field shared: what is kept for the group of the file, or NULL
+ * @type: struct CSourceShared *
+*/
+struct CSourceRun {
+    const struct CSourceModule *module;
+    int format;
+    const char *lookup;
+    int line;
+    int statics;
+    int keep_going;
+    int paths;
+    const char **identifiers;
+    int scope;
+    int search;
+    int tags;
+    const struct CSourceDefines *macros;
+    const char *directives;
+    const char **includes;
+    struct CSourceStatistics *statistics;
+    struct CSourceShared *groups;
+    struct CSourceShared *shared;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the records of a group of files that may have the same contents
+ * @name: CSourceShared
+ *
+ * @description
+ * @The contents and records of the first file of a group a process runs
+ * @the command on, kept for the other files of the group to write as their
+ * @own if they are copies of it. Every file of a group goes to the same
+ * @worker, so a group is only scanned again by the worker that takes over
+ * @from one that crashed.
+ * @description
+ *
+ * @field kept: whether anything has been kept yet
+ * @type: int
+ *
+ * @field contents: the contents of the file the records are of
+ * @type: char *
+ *
+ * @field size: the size of the contents
+ * @type: int
+ *
+ * @field records: the records, in the form csource_output_replay takes
+ * @type: char *
+ *
+ * @field length: the length of the records
+ * @type: long
+ *
+ * @field capacity: the capacity of the records
+ * @type: long
+ *
+ * @field statistics: what the module added to the statistics of the run
+ * @type: struct CSourceStatistics
+*/
+struct CSourceShared {
+    int kept;
+    char *contents;
+    int size;
+    char *records;
+    long length;
+    long capacity;
+    struct CSourceStatistics statistics;
+};
 
 struct ArgparseParser setup_arguments(int argc, char **argv) {
     struct ArgparseParser parser = argparse_init("csource", argc, argv);
@@ -54,13 +264,34 @@ struct ArgparseParser setup_arguments(int argc, char **argv) {
     /* Setup arguments */
     argparse_add_argument(&parser, "command");
     argparse_add_argument(&parser, "source");
+    argparse_variable_arguments(parser);
 
     /* Options */
     argparse_add_option(&parser, "--help", "-h", 0);
+    argparse_add_option(&parser, "--format", NULL, 1);
+    argparse_add_option(&parser, "--stats", NULL, 1);
+    argparse_add_option(&parser, "--jobs", NULL, 1);
+    argparse_add_option(&parser, "--lookup", NULL, 1);
+    argparse_add_option(&parser, "--line", NULL, 1);
+    argparse_add_option(&parser, "--static", NULL, 0);
+    argparse_add_option(&parser, "--keep-going", NULL, 0);
+    argparse_add_option(&parser, "--scope", NULL, 1);
+    argparse_add_option(&parser, "--index", NULL, 1);
+    argparse_add_option(&parser, "--code", NULL, 0);
+    argparse_add_option(&parser, "--regex", NULL, 0);
+    argparse_add_option(&parser, "--output", "-o", 1);
+    argparse_add_option(&parser, "--etags", NULL, 0);
+    argparse_add_option(&parser, "--compdb", NULL, 1);
+    argparse_add_repeatable_option(&parser, "-D", NULL);
+    argparse_add_repeatable_option(&parser, "-U", NULL);
 
     /* Display a help message */
     if(argparse_option_exists(parser, "--help") != 0 || argparse_option_exists(parser, "-h") != 0) {
-        fprintf(HELP_MESSAGE_STREAM, "%s", HELP_MESSAGE);
+        int index = 0;
+
+        for(index = 0; help_message[index] != NULL; index++)
+            fprintf(HELP_MESSAGE_STREAM, "%s\n", help_message[index]);
+
         exit(EXIT_FAILURE);
     }
 
@@ -69,51 +300,1444 @@ struct ArgparseParser setup_arguments(int argc, char **argv) {
     return parser;
 }
 
-int main(int argc, char **argv) {
+/*
+ * @docgen: function
+ * @brief: split the macro options from their macros
+ * @name: split_macros
+ *
+ * @description
+ * @Make a copy of argv where -DNAME and -UNAME are given as two arguments,
+ * @-D NAME and -U NAME, which is how the parser takes a repeatable option.
+ * @Both ways of writing them can then be used, like with a compiler.
+ * @description
+ *
+ * @param argc: the number of arguments
+ * @type: int
+ *
+ * @param argv: the arguments
+ * @type: char **
+ *
+ * @param split: the number of arguments in the copy
+ * @type: int *
+ *
+ * @return: the copy of argv, which points into argv
+ * @type: char **
+*/
+static char **split_macros(int argc, char **argv, int *split) {
+    int index = 0;
+    char **arguments = csource_allocator.allocate(sizeof(char *) * (argc * 2 + 1));
+
+    *split = 0;
+
+    for(index = 0; index < argc; index++) {
+        const char *argument = argv[index];
+
+        if(index > 0 && argument[0] == '-' && (argument[1] == 'D' || argument[1] == 'U') &&
+           argument[2] != '\0') {
+            arguments[(*split)++] = argument[1] == 'D' ? "-D" : "-U";
+            arguments[(*split)++] = argv[index] + 2;
+
+            continue;
+        }
+
+        arguments[(*split)++] = argv[index];
+    }
+
+    arguments[*split] = NULL;
+
+    return arguments;
+}
+
+/*
+ * @docgen: function
+ * @brief: find the identifiers given to grep, and its source
+ * @name: split_identifiers
+ *
+ * @description
+ * @Everything grep is given between its name and its source is an
+ * @identifier to look for, so the source of grep is its last argument,
+ * @rather than its second. Other than index, which is given what to do
+ * @and what to do it to, no other command takes more than two.
+ * @description
+ *
+ * @param parser: the parser with the arguments
+ * @type: struct ArgparseParser
+ *
+ * @param command: the name of the command
+ * @type: const char *
+ *
+ * @param source: the second argument, which becomes the last for grep
+ * @type: const char **
+ *
+ * @return: the identifiers, ending with NULL, or NULL for other commands
+ * @type: const char **
+*/
+static const char **split_identifiers(struct ArgparseParser parser, const char *command,
+                                      const char **source) {
+    int length = 0;
+    const char **identifiers = NULL;
+    int count = argparse_count_arguments(parser);
+    int index = argparse_argument_variable_start(parser);
+
+    if(strcmp(command, "grep") != 0) {
+        if(count == 2 || (count == 3 && (strcmp(command, "index") == 0 ||
+                                         strcmp(command, "search") == 0)))
+            return NULL;
+
+        fprintf(ERROR_MESSAGE_STREAM, "csource: expected 2 argument(s), got %i\n", count);
+        fprintf(ERROR_MESSAGE_STREAM, "Try 'csource --help' for more information.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if(count < 3) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: grep expects identifiers before its source\n");
+        fprintf(ERROR_MESSAGE_STREAM, "Try 'csource --help' for more information.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Every argument but the command and the source, and a NULL */
+    identifiers = csource_allocator.allocate(sizeof(char *) * count);
+    identifiers[length++] = *source;
+
+    for(; index != ARGPARSE_NOT_FOUND; index = argparse_argument_variable_next(parser, index))
+        identifiers[length++] = parser.argv[index];
+
+    *source = identifiers[--length];
+    identifiers[length] = NULL;
+
+    for(index = 0; identifiers[index] != NULL; index++) {
+        if(csource_is_identifier(identifiers[index]) == 1)
+            continue;
+
+        fprintf(ERROR_MESSAGE_STREAM, "csource: '%s' is not an identifier\n", identifiers[index]);
+        exit(EXIT_INVALID_NAME);
+    }
+
+    return identifiers;
+}
+
+/*
+ * @docgen: function
+ * @brief: write the -D and -U options as directives
+ * @name: write_macros
+ *
+ * @description
+ * @Write a #define for every -D and an #undef for every -U, in the order
+ * @they were given, so a later option wins over an earlier one.
+ * @description
+ *
+ * @param parser: the parser with the options
+ * @type: struct ArgparseParser
+ *
+ * @param directives: the string to write the directives to
+ * @type: struct CString *
+*/
+static void write_macros(struct ArgparseParser parser, struct CString *directives) {
+    int define = argparse_repeatable_option_start(parser, "-D");
+    int undefine = argparse_repeatable_option_start(parser, "-U");
+
+    while(define != ARGPARSE_NOT_FOUND || undefine != ARGPARSE_NOT_FOUND) {
+        const char *macro = NULL;
+        const char *value = NULL;
+        struct CString whole;
+        struct CString name;
+
+        if(define == ARGPARSE_NOT_FOUND || (undefine != ARGPARSE_NOT_FOUND && undefine < define)) {
+            cstring_concats(directives, "#undef ");
+            cstring_concats(directives, parser.argv[undefine]);
+            cstring_concats(directives, "\n");
+            undefine = argparse_repeatable_option_next(parser, "-U", undefine);
+
+            continue;
+        }
+
+        macro = parser.argv[define];
+        define = argparse_repeatable_option_next(parser, "-D", define);
+        cstring_concats(directives, "#define ");
+
+        /* A macro without a value is 1, the same as with a compiler */
+        if((value = strchr(macro, '=')) == NULL) {
+            cstring_concats(directives, macro);
+            cstring_concats(directives, " 1\n");
+
+            continue;
+        }
+
+        /* The slice is a view into the whole macro, so only it is freed */
+        whole = cstring_init(macro);
+        name = cstring_slice(whole, 0, value - macro);
+
+        cstring_concat(directives, name);
+        cstring_concats(directives, " ");
+        cstring_concats(directives, value + 1);
+        cstring_concats(directives, "\n");
+
+        cstring_free(whole);
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: count the lines in a buffer
+ * @name: count_lines
+ *
+ * @description
+ * @Count the lines in a buffer. A final line without a new line
+ * @still counts as a line.
+ * @description
+ *
+ * @param buffer: the buffer to count the lines of
+ * @type: const char *
+ *
+ * @param length: the length of the buffer
+ * @type: int
+ *
+ * @return: the number of lines in the buffer
+ * @type: unsigned long
+*/
+static unsigned long count_lines(const char *buffer, int length) {
+    unsigned long lines = 0;
+    const char *cursor = buffer;
+    const char *end = buffer + length;
+
+    while(cursor < end) {
+        const char *newline = memchr(cursor, '\n', end - cursor);
+
+        lines++;
+
+        if(newline == NULL)
+            break;
+
+        cursor = newline + 1;
+    }
+
+    return lines;
+}
+
+/*
+ * @docgen: function
+ * @brief: report a file that failed
+ * @name: write_error
+ *
+ * @description
+ * @Report why a file failed on stderr, and as an error record in the
+ * @stream too, unless the records are text, which has nowhere to put one
+ * @without it being taken for the output of the command.
+ * @description
+ *
+ * @param path: the file that failed
+ * @type: const char *
+ *
+ * @param line: the line the file failed on, or 0 for the whole file
+ * @type: int
+ *
+ * @param reason: why the file failed
+ * @type: const char *
+ *
+ * @param stream: the stream to write the records of the file to
+ * @type: FILE *
+ *
+ * @param run: the run the file failed in
+ * @type: struct CSourceRun *
+*/
+static void write_error(const char *path, int line, const char *reason, FILE *stream,
+                        struct CSourceRun *run) {
+    struct CSourceRecord record;
+    struct CSourceOutput output;
+
+    if(line > 0)
+        fprintf(ERROR_MESSAGE_STREAM, "csource: %s:%i: %s\n", path, line, reason);
+    else
+        fprintf(ERROR_MESSAGE_STREAM, "csource: %s: %s\n", path, reason);
+
+    if(run->statistics != NULL)
+        run->statistics->failed++;
+
+    if(run->format == CSOURCE_FORMAT_TEXT)
+        return;
+
+    INIT_VARIABLE(record);
+
+    record.kind = CSOURCE_RECORD_ERROR;
+    record.line = line;
+    record.payload = reason;
+    record.length = strlen(reason);
+
+    output = csource_output_init(stream, run->format, path);
+    csource_output_record(&output, record);
+    csource_output_flush(&output);
+    csource_output_free(&output);
+}
+
+/*
+ * @docgen: function
+ * @brief: report a file a worker crashed on
+ * @name: write_crash
+ *
+ * @param path: the file the worker crashed on
+ * @type: const char *
+ *
+ * @param reason: why the file failed
+ * @type: const char *
+ *
+ * @param stream: the stream to write the records of the file to
+ * @type: FILE *
+ *
+ * @param data: the run the file failed in
+ * @type: void *
+*/
+static void write_crash(const char *path, const char *reason, FILE *stream, void *data) {
+    write_error(path, 0, reason, stream, data);
+}
+
+/*
+ * @docgen: function
+ * @brief: determine whether a file can be given to a module
+ * @name: check_input
+ *
+ * @description
+ * @Check that a file was read whole, and that it is text. The scanners
+ * @take a NUL byte as the end of a line or a string, so whatever they
+ * @made of a file with one in it would be wrong.
+ * @description
+ *
+ * @param path: the file that was read
+ * @type: const char *
+ *
+ * @param file: the stream the file was read from
+ * @type: FILE *
+ *
+ * @param input: the contents of the file
+ * @type: struct LibmatchCursor
+ *
+ * @param stream: the stream to write the records of the file to
+ * @type: FILE *
+ *
+ * @param run: the run the file is in
+ * @type: struct CSourceRun *
+ *
+ * @return: 0 if the file can be used, or the exit status to fail with
+ * @type: int
+*/
+static int check_input(const char *path, FILE *file, struct LibmatchCursor input, FILE *stream,
+                       struct CSourceRun *run) {
+    const char *nul = NULL;
+
+    if(ferror(file) != 0) {
+        write_error(path, 0, "could not read the file", stream, run);
+
+        return EXIT_UNKNOWN_FILE;
+    }
+
+    if(input.length > 0 && (nul = memchr(input.buffer, '\0', input.length)) != NULL) {
+        write_error(path, (int) count_lines(input.buffer, nul - input.buffer + 1),
+                    "a NUL byte, so the file is not text", stream, run);
+
+        return EXIT_BINARY_FILE;
+    }
+
+    return 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: keep the records a file writes
+ * @name: keep_records
+ *
+ * @param sink: the sink, whose data is the struct CSourceShared to keep them in
+ * @type: struct CSourceSink *
+ *
+ * @param bytes: the records
+ * @type: const char *
+ *
+ * @param length: the length of the records
+ * @type: int
+ *
+ * @return: 0, since the records can always be kept
+ * @type: int
+*/
+static int keep_records(struct CSourceSink *sink, const char *bytes, int length) {
+    struct CSourceShared *shared = sink->data;
+
+    if(shared->length + length > shared->capacity) {
+        while(shared->length + length > shared->capacity)
+            shared->capacity *= 2;
+
+        shared->records = csource_allocator.reallocate(shared->records, shared->capacity);
+    }
+
+    memcpy(shared->records + shared->length, bytes, length);
+    shared->length += length;
+
+    return 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: run the module of a command on a file that was read
+ * @name: run_module
+ *
+ * @description
+ * @Run the module of a command on the contents of a file, and write its
+ * @records to a stream. If the file is in a group, and nothing has been
+ * @kept for the group yet, the contents of the file, its records and what
+ * @it added to the statistics are kept for the other files of the group,
+ * @and its records are written from what was kept.
+ * @description
+ *
+ * @param setup: the setup of the module, without an output
+ * @type: struct ModuleSetup
+ *
+ * @param stream: the stream to write the records to
+ * @type: FILE *
+ *
+ * @param run: the run to perform
+ * @type: struct CSourceRun *
+*/
+static void run_module(struct ModuleSetup setup, FILE *stream, struct CSourceRun *run) {
+    struct CSourceSink sink;
+    struct CSourceOutput output;
+    struct CSourcePhase start;
+    struct CSourcePhase emit;
+    struct CSourceStatistics unused;
+    struct CSourceShared *shared = run->shared;
+    struct CSourceStatistics *statistics = run->statistics;
+
+    INIT_VARIABLE(unused);
+
+    /* Time is always measured somewhere, even if it is not reported */
+    if(statistics == NULL)
+        statistics = &unused;
+
+    /* Records that are kept have no path, and are in the binary format
+     * unless they are text. They are counted once they are written. */
+    if(shared != NULL) {
+        INIT_VARIABLE(shared->statistics);
+
+        sink.write = keep_records;
+        sink.data = shared;
+        shared->capacity = CSOURCE_OUTPUT_BUFFER_SIZE;
+        shared->records = csource_allocator.allocate(shared->capacity);
+
+        if(run->format == CSOURCE_FORMAT_TEXT)
+            output = csource_output_init_sink(&sink, CSOURCE_FORMAT_TEXT, "");
+        else
+            output = csource_output_init_sink(&sink, CSOURCE_FORMAT_BINARY, "");
+
+        if(run->statistics != NULL)
+            setup.statistics = &shared->statistics;
+    } else {
+        output = csource_output_init(stream, run->format, setup.source);
+        output.paths = run->paths;
+        output.statistics = run->statistics;
+    }
+
+    setup.output = &output;
+
+    start = csource_phase_now();
+    emit = statistics->emit;
+
+    run->module->run(setup);
+
+    /* Scanning is whatever the module spent not writing output */
+    csource_phase_add(&statistics->scan, start);
+    statistics->scan.wall -= statistics->emit.wall - emit.wall;
+    statistics->scan.cpu -= statistics->emit.cpu - emit.cpu;
+
+    csource_output_flush(&output);
+    csource_output_free(&output);
+
+    if(shared == NULL)
+        return;
+
+    shared->kept = 1;
+    shared->size = setup.input.length;
+    shared->contents = csource_allocator.allocate(setup.input.length + 1);
+    memcpy(shared->contents, setup.input.buffer, setup.input.length);
+
+    if(run->statistics != NULL)
+        csource_statistics_merge(run->statistics, shared->statistics);
+}
+
+/*
+ * @docgen: function
+ * @brief: write the records kept for the group of a file
+ * @name: replay_records
+ *
+ * @param path: the file to write the records as the records of
+ * @type: const char *
+ *
+ * @param stream: the stream to write the records to
+ * @type: FILE *
+ *
+ * @param run: the run to perform
+ * @type: struct CSourceRun *
+*/
+static void replay_records(const char *path, FILE *stream, struct CSourceRun *run) {
+    struct CSourceOutput output;
+
+    output = csource_output_init(stream, run->format, path);
+    output.paths = run->paths;
+    output.statistics = run->statistics;
+
+    csource_output_replay(&output, run->shared->records, run->shared->length);
+
+    csource_output_flush(&output);
+    csource_output_free(&output);
+}
+
+/*
+ * @docgen: function
+ * @brief: run a command on a single file
+ * @name: run_file
+ *
+ * @description
+ * @Read a whole file, run the module of a command on it, and write its
+ * @records to a stream. A path of - reads from stdin. This is the task
+ * @run on every file when the source is a directory. A file which cannot
+ * @be read, or is not text, is reported and left alone. A file with the
+ * @same contents as the one kept for its group is not scanned, and writes
+ * @the records kept for the group as its own.
+ * @description
+ *
+ * @param path: the file to run the command on
+ * @type: const char *
+ *
+ * @param stream: the stream to write the records to
+ * @type: FILE *
+ *
+ * @param data: the run to perform
+ * @type: void *
+ *
+ * @return: 0 if the file was processed, or the exit status to fail with
+ * @type: int
+*/
+static int run_file(const char *path, FILE *stream, void *data) {
+    int status = 0;
+    int mapped = 0;
+    FILE *file = NULL;
     struct ModuleSetup setup;
-    struct ArgparseParser parser = setup_arguments(argc, argv);
+    struct CSourcePhase start;
+    struct CSourceStatistics unused;
+    struct CSourceRun *run = data;
+    struct CSourceShared *shared = run->shared;
+    struct CSourceStatistics *statistics = run->statistics;
 
     INIT_VARIABLE(setup);
+    INIT_VARIABLE(unused);
+
+    /* Time is always measured somewhere, even if it is not reported */
+    if(statistics == NULL)
+        statistics = &unused;
+
+    if(strcmp(path, "-") == 0)
+        file = stdin;
+    else if((file = fopen(path, "rb")) == NULL) {
+        write_error(path, 0, "could not open the file", stream, run);
+
+        return EXIT_UNKNOWN_FILE;
+    }
+
+    setup.source = path;
+    setup.command = run->module->name;
+    setup.lookup = run->lookup;
+    setup.line = run->line;
+    setup.statics = run->statics;
+    setup.identifiers = run->identifiers;
+    setup.scope = run->scope;
+    setup.search = run->search;
+    setup.tags = run->tags;
+    setup.macros = run->macros;
+    setup.includes = run->includes;
+    setup.statistics = run->statistics;
+
+    /* Read the whole source before any module runs, so the time spent
+     * reading is kept apart from the time spent scanning. */
+    start = csource_phase_now();
+    setup.input = csource_ingest(file, &mapped);
+    csource_phase_add(&statistics->ingest, start);
+
+    if((status = check_input(path, file, setup.input, stream, run)) != 0) {
+        csource_ingest_free(&setup.input, mapped);
+
+        if(file != stdin)
+            fclose(file);
+
+        return status;
+    }
+
+    if(shared == NULL) {
+        run_module(setup, stream, run);
+    } else if(shared->kept == 0) {
+        run_module(setup, stream, run);
+        replay_records(path, stream, run);
+
+    /* A file of the group that is not a copy of the kept one after all is
+     * run on its own */
+    } else if(shared->size != setup.input.length ||
+              memcmp(shared->contents, setup.input.buffer, setup.input.length) != 0) {
+        struct CSourceRun own = *run;
+
+        own.shared = NULL;
+        run_module(setup, stream, &own);
+    } else {
+        if(run->statistics != NULL)
+            csource_statistics_merge(run->statistics, shared->statistics);
+
+        replay_records(path, stream, run);
+    }
+
+    if(run->statistics != NULL) {
+        statistics->files++;
+        statistics->bytes_in += setup.input.length;
+        statistics->lines += count_lines(setup.input.buffer, setup.input.length);
+    }
+
+    csource_ingest_free(&setup.input, mapped);
+
+    if(file != stdin)
+        fclose(file);
+
+    return 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: run a command on a file of a tree
+ * @name: run_task
+ *
+ * @description
+ * @Run a command on a file of a tree. A file that is a unit of a
+ * @compilation database is run with its own -D and -U flags, before those
+ * @given to csource so that they win, and with its own directories to find
+ * @inclusions in. A file in a group shares what is kept for the group.
+ * @description
+ *
+ * @param file: the file to run the command on
+ * @type: const struct CSourceTreeFile *
+ *
+ * @param stream: the stream to write the records to
+ * @type: FILE *
+ *
+ * @param data: the run to perform
+ * @type: void *
+ *
+ * @return: 0 if the file was processed, or the exit status to fail with
+ * @type: int
+*/
+static int run_task(const struct CSourceTreeFile *file, FILE *stream, void *data) {
+    int status = 0;
+    struct CString directives;
+    struct CSourceDefines *macros = NULL;
+    struct CSourceRun task_run = *(struct CSourceRun *) data;
+    const struct CSourceUnit *unit = file->data;
+
+    if(file->group > 0 && task_run.groups != NULL)
+        task_run.shared = task_run.groups + file->group - 1;
+
+    if(unit == NULL)
+        return run_file(file->path.contents, stream, &task_run);
+
+    directives = cstring_init("");
+    csource_compdb_directives(unit, &directives);
+    cstring_concats(&directives, task_run.directives);
+
+    task_run.macros = macros = csource_prune_macros(directives.contents, directives.length);
+    task_run.includes = csource_compdb_includes(unit);
+
+    status = run_file(file->path.contents, stream, &task_run);
+
+    csource_defines_free(macros);
+    csource_allocator.release((void *) task_run.includes);
+    cstring_free(directives);
+
+    return status;
+}
+
+/*
+ * @docgen: structure
+ * @brief: a command that builds an index of a tree, and queries it
+ * @name: CSourceIndexCommand
+ *
+ * @field name: the name of the command
+ * @type: const char *
+ *
+ * @field query: what a query is given, for the usage
+ * @type: const char *
+ *
+ * @field path: where the index is made, if no other path is given
+ * @type: const char *
+ *
+ * @field kept: what the index keeps of each file, for the errors
+ * @type: const char *
+ *
+ * @field module: the module the workers read each file with
+ * @type: const struct CSourceModule *
+ *
+ * @field init: starts a builder from the index at a path
+ * @type: struct CSourceTable *(*)(const char *)
+ *
+ * @field read: reads what the workers wrote into a builder
+ * @type: int (*)(struct CSourceTable *, FILE *)
+ *
+ * @field write: writes a builder to a path
+ * @type: int (*)(struct CSourceTable *, const char *)
+ *
+ * @field free: releases a builder
+ * @type: void (*)(struct CSourceTable *)
+ *
+ * @field run: runs a query of the index at a path
+ * @type: int (*)(const char *, const char *, int, struct CSourceRun *)
+*/
+struct CSourceIndexCommand {
+    const char *name;
+    const char *query;
+    const char *path;
+    const char *kept;
+    const struct CSourceModule *module;
+    struct CSourceTable *(*init)(const char *path);
+    int (*read)(struct CSourceTable *table, FILE *stream);
+    int (*write)(struct CSourceTable *table, const char *path);
+    void (*free)(struct CSourceTable *table);
+    int (*run)(const char *path, const char *target, int jobs, struct CSourceRun *run);
+};
+
+/*
+ * @docgen: function
+ * @brief: build the index of a tree
+ * @name: build_index
+ *
+ * @description
+ * @Build an index of a tree, reading only the files which changed since
+ * @the index was last built. The files are read the same way as for any
+ * @other command, by workers, which write what the index keeps of them to
+ * @a temporary file to be put in the index once they are all done.
+ * @Without --keep-going, a file that fails leaves the index as it was.
+ * @description
+ *
+ * @param command: the command of the index
+ * @type: const struct CSourceIndexCommand *
+ *
+ * @param root: the directory to index
+ * @type: const char *
+ *
+ * @param path: the path of the index
+ * @type: const char *
+ *
+ * @param jobs: the most workers to run at once
+ * @type: int
+ *
+ * @param run: the run to read the files with
+ * @type: struct CSourceRun *
+ *
+ * @return: 0 if the index was built, or the exit status to fail with
+ * @type: int
+*/
+static int build_index(const struct CSourceIndexCommand *command, const char *root,
+                       const char *path, int jobs, struct CSourceRun *run) {
+    int index = 0;
+    int status = 0;
+    FILE *kept = NULL;
+    struct CSourceTreeRun tree_run;
+    struct CSourceTable *table = command->init(path);
+    struct CSourceTree *tree = csource_tree_init(root);
+    struct CSourceTree *changed = carray_init(changed, TREE_FILE);
+
+    /* What the workers write is read back by the index as it is, so
+     * nothing else, like an error record, can be written with it */
+    run->module = command->module;
+    run->format = CSOURCE_FORMAT_TEXT;
 
-    setup.command = argparse_get_argument(parser, "command");
-    setup.source = argparse_get_argument(parser, "source");
-    setup.file = NULL;
+    for(index = 0; index < tree->length; index++) {
+        struct CSourceTreeFile file = tree->contents[index];
+
+        if(csource_table_add_file(table, file.path.contents, file.size, file.modified) == 0)
+            continue;
+
+        file.path = cstring_init(file.path.contents);
+        carray_append(changed, file, TREE_FILE);
+    }
+
+    if(csource_table_unchanged(table) == 1) {
+        command->free(table);
+        csource_tree_free(changed);
+        csource_tree_free(tree);
+
+        return 0;
+    }
+
+    if((kept = tmpfile()) == NULL) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: could not create a temporary file\n");
+        status = EXIT_INTERNAL_ERROR;
+    } else {
+        tree_run.jobs = jobs;
+        tree_run.keep_going = run->keep_going;
+        tree_run.task = run_task;
+        tree_run.error = write_crash;
+        tree_run.data = run;
+        tree_run.statistics = run->statistics;
+
+        status = csource_tree_run(changed, tree_run, kept);
+        rewind(kept);
+
+        /* The files that failed are left out, and counted in the summary */
+        if(run->keep_going == 1)
+            status = 0;
+    }
+
+    if(status == 0 && command->read(table, kept) == -1) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: could not read the %s of the files\n",
+                command->kept);
+        status = EXIT_INTERNAL_ERROR;
+    }
+
+    if(status == 0 && command->write(table, path) == -1) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: could not write the index '%s'\n", path);
+        status = EXIT_INVALID_INDEX;
+    }
+
+    if(kept != NULL)
+        fclose(kept);
+
+    command->free(table);
+    csource_tree_free(changed);
+    csource_tree_free(tree);
+
+    return status;
+}
+
+/*
+ * @docgen: function
+ * @brief: write where a name is found from the index of symbols
+ * @name: query_symbols
+ *
+ * @description
+ * @Write where a name is defined, declared and used from the index. A
+ * @query maps the index and searches it where it is, so it takes no
+ * @longer for a large tree than a small one.
+ * @description
+ *
+ * @param path: the path of the index
+ * @type: const char *
+ *
+ * @param target: the name to look for
+ * @type: const char *
+ *
+ * @param jobs: the most workers to run at once, which is not used
+ * @type: int
+ *
+ * @param run: the run to write the places with
+ * @type: struct CSourceRun *
+ *
+ * @return: 0 if the query succeeded, or the exit status to fail with
+ * @type: int
+*/
+static int query_symbols(const char *path, const char *target, int jobs,
+                         struct CSourceRun *run) {
+    struct CSourceIndex index;
+    struct CSourceOutput output;
+
+    if(csource_is_identifier(target) == 0) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: '%s' is not an identifier\n", target);
+        exit(EXIT_INVALID_NAME);
+    }
+
+    if(csource_index_open(&index, path) == -1) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: could not open the index '%s'\n", path);
+        exit(EXIT_INVALID_INDEX);
+    }
+
+    output = csource_output_init(stdout, run->format, path);
+    csource_index_query(&index, target, &output);
+    csource_output_flush(&output);
+    csource_output_free(&output);
+    csource_index_close(&index);
+
+    return 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: write the lines a pattern is on from the trigram index
+ * @name: query_trigrams
+ *
+ * @description
+ * @Write the lines a pattern is on. Only the files which have every
+ * @trigram of the pattern are read, and they are read by workers like the
+ * @files of any tree, so a file which changed since the index was built
+ * @is searched as it is now.
+ * @description
+ *
+ * @param path: the path of the index
+ * @type: const char *
+ *
+ * @param target: the pattern to look for
+ * @type: const char *
+ *
+ * @param jobs: the most workers to run at once
+ * @type: int
+ *
+ * @param run: the run to read the files with
+ * @type: struct CSourceRun *
+ *
+ * @return: 0 if the query succeeded, or the exit status to fail with
+ * @type: int
+*/
+static int query_trigrams(const char *path, const char *target, int jobs,
+                          struct CSourceRun *run) {
+    int index = 0;
+    int count = 0;
+    int status = 0;
+    int *files = NULL;
+    struct CSourceSearch search;
+    struct CSourceTreeRun tree_run;
+    struct CSourceTree *candidates = NULL;
+    struct CSourceSearchLiterals *literals = NULL;
+
+    if(csource_search_check(target, run->search) == -1) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: '%s' is not a valid pattern\n", target);
+        exit(EXIT_INVALID_PATTERN);
+    }
+
+    if(csource_search_open(&search, path) == -1) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: could not open the index '%s'\n", path);
+        exit(EXIT_INVALID_INDEX);
+    }
+
+    literals = csource_search_literals(target, run->search);
+    files = csource_search_candidates(&search, literals, run->search & CSOURCE_SEARCH_CODE,
+                                      &count);
+    candidates = carray_init(candidates, TREE_FILE);
+
+    for(index = 0; index < count; index++) {
+        struct CSourceTreeFile file;
+
+        INIT_VARIABLE(file);
+        file.path = cstring_init(csource_table_path(&search.table, files[index]));
+        carray_append(candidates, file, TREE_FILE);
+    }
+
+    /* The files are searched as they are now, by the search module */
+    run->module = &search_module;
+    run->lookup = target;
+
+    tree_run.jobs = jobs;
+    tree_run.keep_going = 1;
+    tree_run.task = run_task;
+    tree_run.error = write_crash;
+    tree_run.data = run;
+    tree_run.statistics = run->statistics;
+
+    status = csource_tree_run(candidates, tree_run, stdout);
+
+    csource_allocator.release(files);
+    carray_free(literals, SEARCH_LITERAL);
+    csource_tree_free(candidates);
+    csource_search_close(&search);
+
+    return status;
+}
+
+/* The commands that build an index of a tree, and query it */
+static const struct CSourceIndexCommand index_command = {
+    "index", "NAME", CSOURCE_INDEX_DEFAULT_PATH, "symbols", &index_module,
+    csource_index_builder_init, csource_index_read, csource_index_write,
+    csource_index_builder_free, query_symbols
+};
+
+static const struct CSourceIndexCommand search_command = {
+    "search", "PATTERN", CSOURCE_SEARCH_DEFAULT_PATH, "trigrams", &search_build_module,
+    csource_search_builder_init, csource_search_read, csource_search_write,
+    csource_search_builder_free, query_trigrams
+};
+
+/*
+ * @docgen: function
+ * @brief: run a command that builds an index, or queries it
+ * @name: run_index
+ *
+ * @description
+ * @Build the index of a directory, or query it, for the index and search
+ * @commands, which differ in nothing else but their index and query.
+ * @description
+ *
+ * @param parser: the parser with the arguments
+ * @type: struct ArgparseParser
+ *
+ * @param command: the command to run
+ * @type: const struct CSourceIndexCommand *
+ *
+ * @param action: what to do, which is build or query
+ * @type: const char *
+ *
+ * @param jobs: the most workers to run at once
+ * @type: int
+ *
+ * @param run: the run to read the files with
+ * @type: struct CSourceRun *
+ *
+ * @return: 0 if the command succeeded, or the exit status to fail with
+ * @type: int
+*/
+static int run_index(struct ArgparseParser parser, const struct CSourceIndexCommand *command,
+                     const char *action, int jobs, struct CSourceRun *run) {
+    const char *target = NULL;
+    const char *path = command->path;
+
+    if(argparse_count_arguments(parser) != 3) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: %s expects build DIRECTORY or query %s\n",
+                command->name, command->query);
+        fprintf(ERROR_MESSAGE_STREAM, "Try 'csource --help' for more information.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    target = parser.argv[argparse_argument_variable_start(parser)];
+
+    if(argparse_option_exists(parser, "--index") != 0)
+        path = argparse_get_option_parameter(parser, "--index", 0);
+
+    if(strcmp(action, "build") == 0) {
+        if(csource_tree_is_directory(target) == 0) {
+            fprintf(ERROR_MESSAGE_STREAM, "csource: could not find directory '%s'\n", target);
+            exit(EXIT_UNKNOWN_FILE);
+        }
+
+        return build_index(command, target, path, jobs, run);
+    }
+
+    if(strcmp(action, "query") != 0) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: unknown %s command '%s'\n", command->name,
+                action);
+        exit(EXIT_UNKNOWN_MODULE);
+    }
+
+    return command->run(path, target, jobs, run);
+}
+
+/*
+ * @docgen: function
+ * @brief: run the tags command
+ * @name: run_tags
+ *
+ * @description
+ * @Write the tags of a file or tree. The files are read by workers like
+ * @for any other command, and each writes the tags of a file in order of
+ * @their names, so a ctags file is only a merge of the runs the workers
+ * @wrote. An etags file is written as the workers write it. With --output,
+ * @the tags are written next to the path first, and then moved over it,
+ * @unless a file fails without --keep-going.
+ * @description
+ *
+ * @param source: the file or directory to write the tags of
+ * @type: const char *
+ *
+ * @param path: the file to write the tags to, or NULL for stdout
+ * @type: const char *
+ *
+ * @param jobs: the most workers to run at once
+ * @type: int
+ *
+ * @param run: the run to read the files with
+ * @type: struct CSourceRun *
+ *
+ * @return: 0 if the tags were written, or the exit status to fail with
+ * @type: int
+*/
+static int run_tags(const char *source, const char *path, int jobs, struct CSourceRun *run) {
+    int mapped = 0;
+    int status = 0;
+    FILE *lines = NULL;
+    FILE *stream = stdout;
+    struct LibmatchCursor input;
+    struct CSourceTreeRun tree_run;
+    struct CSourceTree *tree = NULL;
+    struct CString temporary = cstring_init("");
+
+    if(strcmp(source, "-") != 0 && csource_tree_is_directory(source) == 1) {
+        tree = csource_tree_init(source);
+    } else {
+        struct CSourceTreeFile file;
+
+        INIT_VARIABLE(file);
+        file.path = cstring_init(source);
+        tree = carray_init(tree, TREE_FILE);
+        carray_append(tree, file, TREE_FILE);
+    }
+
+    if(path != NULL && strcmp(path, "-") != 0) {
+        cstring_concats(&temporary, path);
+        cstring_concats(&temporary, ".tmp");
+
+        if((stream = fopen(temporary.contents, "wb")) == NULL) {
+            fprintf(ERROR_MESSAGE_STREAM, "csource: could not write the tags '%s'\n", path);
+            csource_tree_free(tree);
+            cstring_free(temporary);
+
+            return EXIT_UNKNOWN_FILE;
+        }
+    }
+
+    /* Only a ctags file needs its lines sorted before it is written */
+    if(run->tags == CSOURCE_TAGS_ETAGS)
+        lines = stream;
+    else if((lines = tmpfile()) == NULL)
+        status = EXIT_INTERNAL_ERROR;
+
+    if(lines != NULL) {
+        tree_run.jobs = jobs;
+        tree_run.keep_going = run->keep_going;
+        tree_run.task = run_task;
+        tree_run.error = write_crash;
+        tree_run.data = run;
+        tree_run.statistics = run->statistics;
+
+        status = csource_tree_run(tree, tree_run, lines);
+    } else {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: could not create a temporary file\n");
+    }
+
+    if(lines != NULL && lines != stream) {
+        if(status == 0 || run->keep_going == 1) {
+            rewind(lines);
+            input = csource_ingest(lines, &mapped);
+            csource_tags_write(stream, input.buffer, input.length);
+            csource_ingest_free(&input, mapped);
+        }
+
+        fclose(lines);
+    }
+
+    if(stream != stdout) {
+        int failed = ferror(stream) != 0;
+
+        failed = fclose(stream) != 0 || failed;
+
+        /* The tags are only replaced by ones that are whole */
+        if(failed == 1 || (status != 0 && run->keep_going == 0) ||
+           rename(temporary.contents, path) != 0) {
+            remove(temporary.contents);
+
+            if(status == 0) {
+                fprintf(ERROR_MESSAGE_STREAM, "csource: could not write the tags '%s'\n", path);
+                status = EXIT_UNKNOWN_FILE;
+            }
+        }
+    }
+
+    csource_tree_free(tree);
+    cstring_free(temporary);
+
+    return status;
+}
+
+/*
+ * @docgen: function
+ * @brief: run a command on the units of a compilation database
+ * @name: run_compdb
+ *
+ * @description
+ * @Run a command on every translation unit a compilation database lists
+ * @under the source, in the order it lists them, by workers like for a
+ * @directory. Each unit is run with its own flags. A database that cannot
+ * @be read, or that has no unit under the source, ends csource.
+ * @description
+ *
+ * @param source: the file or directory to run the units under
+ * @type: const char *
+ *
+ * @param path: the compilation database
+ * @type: const char *
+ *
+ * @param jobs: the most files to work on at once
+ * @type: int
+ *
+ * @param run: the run to perform
+ * @type: struct CSourceRun *
+ *
+ * @return: 0 if every unit was processed, or the exit status to fail with
+ * @type: int
+*/
+static int run_compdb(const char *source, const char *path, int jobs, struct CSourceRun *run) {
+    int line = 0;
+    int index = 0;
+    int status = 0;
+    FILE *stream = NULL;
+    struct CSourceTreeRun tree_run;
+    struct CSourceUnits *units = NULL;
+    struct CSourceTree *tree = NULL;
+
+    if((stream = fopen(path, "rb")) == NULL) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: could not open the compilation database '%s'\n",
+                path);
+        exit(EXIT_UNKNOWN_FILE);
+    }
+
+    units = csource_compdb_read(stream, source, &line);
+    fclose(stream);
+
+    if(units == NULL) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: malformed compilation database '%s' on line %i\n",
+                path, line);
+        exit(EXIT_INVALID_COMPDB);
+    }
+
+    /* A file the database does not compile would otherwise be skipped
+     * without a word */
+    if(units->length == 0) {
+        fprintf(ERROR_MESSAGE_STREAM,
+                "csource: the compilation database '%s' has no unit %s '%s'\n", path,
+                csource_tree_is_directory(source) == 1 ? "under" : "for", source);
+        exit(EXIT_UNKNOWN_UNIT);
+    }
+
+    tree = carray_init(tree, TREE_FILE);
+
+    for(index = 0; index < units->length; index++) {
+        struct CSourceTreeFile file;
+
+        INIT_VARIABLE(file);
+        file.path = cstring_init(units->contents[index].path);
+        file.data = units->contents + index;
+        carray_append(tree, file, TREE_FILE);
+    }
+
+    tree_run.jobs = jobs;
+    tree_run.keep_going = run->keep_going;
+    tree_run.task = run_task;
+    tree_run.error = write_crash;
+    tree_run.data = run;
+    tree_run.statistics = run->statistics;
+
+    /* The text of every unit is told apart by its path, like for a directory */
+    run->paths = run->module->paths == 0;
+
+    status = csource_tree_run(tree, tree_run, stdout);
+
+    csource_tree_free(tree);
+    csource_compdb_free(units);
+
+    return status;
+}
+
+int main(int argc, char **argv) {
+    int status = 0;
+    int split = 0;
+    int stats_format = -1;
+    int jobs = csource_tree_jobs();
+    const char *source = NULL;
+    const char *command = NULL;
+    struct CSourceRun run;
+    struct CSourceStatistics statistics;
+    struct CSourceDefines *macros = NULL;
+    struct CString directives = cstring_init("");
+    char **arguments = split_macros(argc, argv, &split);
+    struct ArgparseParser parser = setup_arguments(split, arguments);
+
+    INIT_VARIABLE(run);
+    INIT_VARIABLE(statistics);
+
+    command = argparse_get_argument(parser, "command");
+    source = argparse_get_argument(parser, "source");
+    run.format = CSOURCE_FORMAT_TEXT;
+
+    /* The index is not a command of a single file, but its files are
+     * read like one */
+    if(strcmp(command, "index") == 0)
+        run.module = &index_module;
+    else if(strcmp(command, "search") == 0)
+        run.module = &search_module;
+    else if((run.module = csource_find_module(command)) == NULL) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: unknown module '%s'\n", command);
+        exit(EXIT_UNKNOWN_MODULE);
+    }
+
+    run.identifiers = split_identifiers(parser, command, &source);
+
+    if(argparse_option_exists(parser, "--format") != 0) {
+        const char *name = argparse_get_option_parameter(parser, "--format", 0);
+
+        if((run.format = csource_output_format(name)) == -1) {
+            fprintf(ERROR_MESSAGE_STREAM, "csource: unknown format '%s'\n", name);
+            exit(EXIT_UNKNOWN_FORMAT);
+        }
+    }
+
+    if(argparse_option_exists(parser, "--stats") != 0) {
+        const char *name = argparse_get_option_parameter(parser, "--stats", 0);
+
+        if(strcmp(name, "text") == 0) {
+            stats_format = CSOURCE_STATISTICS_TEXT;
+        } else if(strcmp(name, "json") == 0) {
+            stats_format = CSOURCE_STATISTICS_JSON;
+        } else {
+            fprintf(ERROR_MESSAGE_STREAM, "csource: unknown statistics format '%s'\n", name);
+            exit(EXIT_UNKNOWN_STATS);
+        }
+
+        /* Only measure anything when it will be reported */
+        run.statistics = &statistics;
+    }
+
+    /* Totals are gathered in the statistics, since that is what the
+     * workers of a tree send back */
+    if(run.module->report != NULL)
+        run.statistics = &statistics;
+
+    if(argparse_option_exists(parser, "--jobs") != 0) {
+        if((jobs = atoi(argparse_get_option_parameter(parser, "--jobs", 0))) <= 0) {
+            fprintf(ERROR_MESSAGE_STREAM, "csource: jobs must be a positive number\n");
+            exit(EXIT_INVALID_JOBS);
+        }
+    }
+
+    if(argparse_option_exists(parser, "--lookup") != 0)
+        run.lookup = argparse_get_option_parameter(parser, "--lookup", 0);
+
+    if(argparse_option_exists(parser, "--line") != 0) {
+        if((run.line = atoi(argparse_get_option_parameter(parser, "--line", 0))) <= 0) {
+            fprintf(ERROR_MESSAGE_STREAM, "csource: line must be a positive number\n");
+            exit(EXIT_INVALID_LINE);
+        }
+    }
+
+    if(argparse_option_exists(parser, "--static") != 0)
+        run.statics = 1;
+
+    if(argparse_option_exists(parser, "--code") != 0)
+        run.search |= CSOURCE_SEARCH_CODE;
+
+    if(argparse_option_exists(parser, "--regex") != 0)
+        run.search |= CSOURCE_SEARCH_REGEX;
+
+    if(argparse_option_exists(parser, "--etags") != 0)
+        run.tags = CSOURCE_TAGS_ETAGS;
+
+    if(argparse_option_exists(parser, "--scope") != 0) {
+        const char *name = argparse_get_option_parameter(parser, "--scope", 0);
+
+        if((run.scope = csource_grep_scope(name)) == -1) {
+            fprintf(ERROR_MESSAGE_STREAM, "csource: unknown scope '%s'\n", name);
+            exit(EXIT_UNKNOWN_SCOPE);
+        }
+    }
+
+    /* Failures are counted in the statistics, for the summary */
+    if(argparse_option_exists(parser, "--keep-going") != 0) {
+        run.keep_going = 1;
+        run.statistics = &statistics;
+    }
+
+    write_macros(parser, &directives);
+    run.macros = macros = csource_prune_macros(directives.contents, directives.length);
+    run.directives = directives.contents;
 
     /* The source file must exist before we go any further. Do not
-     * attempt to find a file named '-', since that means stdin. */
-    if(strcmp(setup.source, "-") != 0 && libpath_exists(setup.source) == 0) {
-        fprintf(ERROR_MESSAGE_STREAM, "csource: could not find file '%s'\n", setup.source);
+     * attempt to find a file named '-', since that means stdin. The
+     * second argument of index and search is what to do, rather than
+     * a file. */
+    if(run.module != &index_module && run.module != &search_module &&
+       strcmp(source, "-") != 0 && libpath_exists(source) == 0) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: could not find file '%s'\n", source);
         exit(EXIT_UNKNOWN_FILE);
     }
 
-    if(strcmp(setup.source, "-") == 0)
-        setup.file = stdin;
-    else
-        setup.file = fopen(setup.source, "r");
-
-    /* Extract local and system inclusions */
-    if(strcmp(setup.command, "include") == 0) {
-        int i = 0;
-        struct CSourceInclusions *inclusions = csource_extract_inclusions(setup);                
-
-        /* Display resources */
-        for(i = 0; i < carray_length(inclusions); i++)
-            printf("%i\t\t%s\n", inclusions->contents[i].line, inclusions->contents[i].path.contents);
-
-        carray_free(inclusions, INCLUSION);
-    } else if(strcmp(setup.command, "functions") == 0) {
-        csource_extract_functions(setup);
-    } else if(strcmp(setup.command, "strip-comments") == 0) {
-        csource_filter_comments(setup);
-    } else if(strcmp(setup.command, "strip-directives") == 0) {
-        csource_filter_directives(setup);
+    if(run.module == &index_module) {
+        status = run_index(parser, &index_command, source, jobs, &run);
+    } else if(run.module == &search_module) {
+        status = run_index(parser, &search_command, source, jobs, &run);
+
+    /* The tags of every file are written as one file, in order */
+    } else if(strcmp(command, "tags") == 0 && run.format == CSOURCE_FORMAT_TEXT) {
+        const char *path = NULL;
+
+        if(argparse_option_exists(parser, "--output") != 0)
+            path = argparse_get_option_parameter(parser, "--output", 0);
+        else if(argparse_option_exists(parser, "-o") != 0)
+            path = argparse_get_option_parameter(parser, "-o", 0);
+
+        status = run_tags(source, path, jobs, &run);
+
+    /* A compilation database runs the command over the units it lists */
+    } else if(argparse_option_exists(parser, "--compdb") != 0) {
+        status = run_compdb(source, argparse_get_option_parameter(parser, "--compdb", 0), jobs,
+                            &run);
+
+    /* A directory runs the command over every source file under it */
+    } else if(strcmp(source, "-") != 0 && csource_tree_is_directory(source) == 1) {
+        int index = 0;
+        int groups = 0;
+        struct CSourceTree *tree = csource_tree_init(source);
+        struct CSourceTreeRun tree_run;
+
+        /* Files with the same contents, like copies of a vendored header,
+         * are read once, unless the path is in their records */
+        if(run.module->shared == 1 && (groups = csource_tree_group(tree)) > 0) {
+            run.groups = csource_allocator.allocate(sizeof(*run.groups) * groups);
+            memset(run.groups, 0, sizeof(*run.groups) * groups);
+        }
+
+        tree_run.jobs = jobs;
+        tree_run.keep_going = run.keep_going;
+        tree_run.task = run_task;
+        tree_run.error = write_crash;
+        tree_run.data = &run;
+        tree_run.statistics = run.statistics;
+
+        /* The lines of text of each file start with its path, unless the
+         * module already writes it */
+        run.paths = run.module->paths == 0;
+
+        status = csource_tree_run(tree, tree_run, stdout);
+        csource_tree_free(tree);
+
+        for(index = 0; index < groups; index++) {
+            if(run.groups[index].kept == 0)
+                continue;
+
+            csource_allocator.release(run.groups[index].contents);
+            csource_allocator.release(run.groups[index].records);
+        }
+
+        if(run.groups != NULL)
+            csource_allocator.release(run.groups);
     } else {
-        fprintf(ERROR_MESSAGE_STREAM, "csource: unknown module '%s\n", setup.command);
-        exit(EXIT_UNKNOWN_MODULE);
+        status = run_file(source, stdout, &run);
+    }
+
+    /* The totals are attributed to the source, since they are of all of it */
+    if(run.module->report != NULL) {
+        struct CSourceOutput output = csource_output_init(stdout, run.format, source);
+
+        run.module->report(&output, statistics);
+        csource_output_flush(&output);
+        csource_output_free(&output);
+    }
+
+    fflush(stdout);
+
+    if(stats_format != -1) {
+        csource_statistics_collect(&statistics);
+        csource_statistics_write(ERROR_MESSAGE_STREAM, statistics, stats_format);
+    }
+
+    if(run.keep_going == 1) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: %lu of %lu files failed\n", statistics.failed,
+                statistics.files + statistics.failed);
+
+        if(statistics.failed > 0)
+            status = EXIT_SKIPPED_FILES;
     }
 
     argparse_free(parser);
-    fclose(setup.file);
+    csource_defines_free(macros);
+    cstring_free(directives);
+    csource_allocator.release(arguments);
+
+    if(run.identifiers != NULL)
+        csource_allocator.release((void *) run.identifiers);
+
+    if(status != 0)
+        return status;
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,480 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file deals with writing the results of a module in one of the
+ * supported formats. Every module produces a stream of records, which
+ * carry the path, line, byte offset, kind and payload of whatever was
+ * found. Filters produce 'code' records for the text that survived.
+ *
+ * The text format is the traditional human readable output. The JSON
+ * Lines format writes one JSON object per record. The binary format is
+ * a sequence of length-prefixed records, where every integer is little
+ * endian:
+ *
+ *     u32  size of the rest of the record
+ *     u8   kind
+ *     u32  line
+ *     u64  byte offset
+ *     u32  path length, followed by the path
+ *     u32  payload length, followed by the payload
+ *
+ * Records are written as soon as they are produced, so they can be
+ * consumed while a module is still running.
+*/
+
+#include <string.h>
+
+#include "../csource.h"
+#include "../common/common.h"
+
+#include "output.h"
+#include "../statistics/statistics.h"
+
+/* The names of each record kind, indexed by kind. */
+static const char *record_kinds[] = {
+    "code", "include", "function", "docgen", "define", "conditional", "interval",
+    "counts", "prototype", "error", "match", "definition", "use", "tag", "type",
+    "global", "totals"
+};
+
+/*
+ * @docgen: function
+ * @brief: write the buffer of a record stream to its stream
+ * @name: write_buffer
+ *
+ * @description
+ * @Write everything in the buffer to the underlying stream or sink. This
+ * @is the only place output leaves the record stream, so it is also where
+ * @the time spent emitting is measured.
+ * @description
+ *
+ * @param output: the record stream to write the buffer of
+ * @type: struct CSourceOutput *
+*/
+static void write_buffer(struct CSourceOutput *output) {
+    struct CSourcePhase start;
+
+    if(output->length == 0)
+        return;
+
+    if(output->statistics != NULL)
+        start = csource_phase_now();
+
+    /* Whatever follows output that was lost is useless, so nothing
+     * more is written once some is */
+    if(output->error == 0 && output->stream != NULL)
+        output->error = fwrite(output->buffer, 1, output->length, output->stream) !=
+                        (size_t) output->length;
+    else if(output->error == 0)
+        output->error = output->sink->write(output->sink, output->buffer, output->length) != 0;
+
+    if(output->statistics != NULL) {
+        csource_phase_add(&output->statistics->emit, start);
+        output->statistics->bytes_out += output->length;
+    }
+
+    output->length = 0;
+}
+
+/*
+ * @docgen: function
+ * @brief: write bytes to a record stream
+ * @name: write_bytes
+ *
+ * @param output: the record stream to write to
+ * @type: struct CSourceOutput *
+ *
+ * @param bytes: the bytes to write
+ * @type: const char *
+ *
+ * @param length: the number of bytes to write
+ * @type: int
+*/
+static void write_bytes(struct CSourceOutput *output, const char *bytes, int length) {
+    while(length > 0) {
+        int chunk = CSOURCE_OUTPUT_BUFFER_SIZE - output->length;
+
+        if(chunk > length)
+            chunk = length;
+
+        memcpy(output->buffer + output->length, bytes, chunk);
+        output->length += chunk;
+        bytes += chunk;
+        length -= chunk;
+
+        if(output->length == CSOURCE_OUTPUT_BUFFER_SIZE)
+            write_buffer(output);
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: write text to a record stream
+ * @name: write_text
+ *
+ * @description
+ * @Write text to a record stream in the text format, starting each of its
+ * @lines with the path and a colon if the stream asks for paths, so the
+ * @lines of the files of a tree can be told apart.
+ * @description
+ *
+ * @param output: the record stream to write to
+ * @type: struct CSourceOutput *
+ *
+ * @param text: the text to write
+ * @type: const char *
+ *
+ * @param length: the length of the text
+ * @type: int
+*/
+static void write_text(struct CSourceOutput *output, const char *text, int length) {
+    if(output->paths == 0) {
+        write_bytes(output, text, length);
+
+        return;
+    }
+
+    while(length > 0) {
+        int line = length;
+        const char *newline = memchr(text, '\n', length);
+
+        if(newline != NULL)
+            line = newline - text + 1;
+
+        if(output->started == 0) {
+            write_bytes(output, output->path, strlen(output->path));
+            write_bytes(output, ":", 1);
+        }
+
+        write_bytes(output, text, line);
+        output->started = newline == NULL;
+        text += line;
+        length -= line;
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: write an unsigned integer as little endian bytes
+ * @name: write_unsigned
+ *
+ * @description
+ * @Write the low bytes of a value to a stream, least significant byte
+ * @first, as csource_encode_unsigned turns them into bytes.
+ * @description
+ *
+ * @param output: the record stream to write to
+ * @type: struct CSourceOutput *
+ *
+ * @param value: the value to write
+ * @type: unsigned long
+ *
+ * @param bytes: the number of bytes to write
+ * @type: int
+*/
+static void write_unsigned(struct CSourceOutput *output, unsigned long value, int bytes) {
+    char encoded[8];
+
+    csource_encode_unsigned(encoded, value, bytes);
+    write_bytes(output, encoded, bytes);
+}
+
+/*
+ * @docgen: function
+ * @brief: write a string as the contents of a json string
+ * @name: write_json_string
+ *
+ * @description
+ * @Write a string surrounded by double quotes, escaping any quotes,
+ * @backslashes and control characters. Bytes above 0x7F are written
+ * @as they are.
+ * @description
+ *
+ * @param output: the record stream to write to
+ * @type: struct CSourceOutput *
+ *
+ * @param string: the string to write
+ * @type: const char *
+ *
+ * @param length: the length of the string
+ * @type: int
+*/
+static void write_json_string(struct CSourceOutput *output, const char *string, int length) {
+    int index = 0;
+    int start = 0;
+
+    write_bytes(output, "\"", 1);
+
+    /* Write runs of characters that do not need escaping in one go */
+    for(index = 0; index < length; index++) {
+        char escape[6 + 1];
+        int character = (unsigned char) string[index];
+
+        if(character >= 0x20 && character != '"' && character != '\\')
+            continue;
+
+        write_bytes(output, string + start, index - start);
+        start = index + 1;
+
+        switch(character) {
+            case '"':  write_bytes(output, "\\\"", 2); break;
+            case '\\': write_bytes(output, "\\\\", 2); break;
+            case '\n': write_bytes(output, "\\n", 2); break;
+            case '\r': write_bytes(output, "\\r", 2); break;
+            case '\t': write_bytes(output, "\\t", 2); break;
+            default:
+                sprintf(escape, "\\u%04x", character);
+                write_bytes(output, escape, 6);
+
+                break;
+        }
+    }
+
+    write_bytes(output, string + start, index - start);
+    write_bytes(output, "\"", 1);
+}
+
+struct CSourceOutput csource_output_init(FILE *stream, int format, const char *path) {
+    struct CSourceOutput output;
+
+    liberror_is_null(csource_output_init, stream);
+    liberror_is_null(csource_output_init, path);
+
+    INIT_VARIABLE(output);
+
+    output.format = format;
+    output.stream = stream;
+    output.path = path;
+    output.span.kind = CSOURCE_RECORD_CODE;
+    output.buffer = csource_allocator.allocate(CSOURCE_OUTPUT_BUFFER_SIZE);
+
+    return output;
+}
+
+struct CSourceOutput csource_output_init_sink(struct CSourceSink *sink, int format,
+                                              const char *path) {
+    struct CSourceOutput output;
+
+    liberror_is_null(csource_output_init_sink, sink);
+    liberror_is_null(csource_output_init_sink, sink->write);
+    liberror_is_null(csource_output_init_sink, path);
+
+    INIT_VARIABLE(output);
+
+    output.format = format;
+    output.sink = sink;
+    output.path = path;
+    output.span.kind = CSOURCE_RECORD_CODE;
+    output.buffer = csource_allocator.allocate(CSOURCE_OUTPUT_BUFFER_SIZE);
+
+    return output;
+}
+
+void csource_output_free(struct CSourceOutput *output) {
+    liberror_is_null(csource_output_free, output);
+
+    csource_allocator.release(output->buffer);
+}
+
+/*
+ * @docgen: function
+ * @brief: write a single record in the format of a record stream
+ * @name: write_record
+ *
+ * @param output: the record stream to write to
+ * @type: struct CSourceOutput *
+ *
+ * @param record: the record to write
+ * @type: struct CSourceRecord
+*/
+static void write_record(struct CSourceOutput *output, struct CSourceRecord record) {
+    int path_length = 0;
+    char number[64 + 1];
+
+    switch(output->format) {
+        case CSOURCE_FORMAT_TEXT:
+            sprintf(number, "%i\t\t", record.line);
+            write_text(output, number, strlen(number));
+            write_text(output, record.payload, record.length);
+            write_text(output, "\n", 1);
+
+            break;
+
+        case CSOURCE_FORMAT_JSONL:
+            write_bytes(output, "{\"path\":", 8);
+            write_json_string(output, output->path, strlen(output->path));
+            sprintf(number, ",\"line\":%i,\"offset\":%li,\"kind\":\"", record.line, record.offset);
+            write_bytes(output, number, strlen(number));
+            write_bytes(output, record_kinds[record.kind], strlen(record_kinds[record.kind]));
+            write_bytes(output, "\",\"payload\":", 12);
+            write_json_string(output, record.payload, record.length);
+            write_bytes(output, "}\n", 2);
+
+            break;
+
+        case CSOURCE_FORMAT_BINARY:
+            path_length = strlen(output->path);
+
+            write_unsigned(output, 1 + 4 + 8 + 4 + path_length + 4 + record.length, 4);
+            write_unsigned(output, record.kind, 1);
+            write_unsigned(output, record.line, 4);
+            write_unsigned(output, record.offset, 8);
+            write_unsigned(output, path_length, 4);
+            write_bytes(output, output->path, path_length);
+            write_unsigned(output, record.length, 4);
+            write_bytes(output, record.payload, record.length);
+
+            break;
+    }
+}
+
+/*
+ * @docgen: function
+ * @brief: write the pending span of a record stream as a code record
+ * @name: write_span
+ *
+ * @param output: the record stream to write the pending span of
+ * @type: struct CSourceOutput *
+*/
+static void write_span(struct CSourceOutput *output) {
+    if(output->span.length == 0)
+        return;
+
+    write_record(output, output->span);
+    output->span.length = 0;
+}
+
+void csource_output_record(struct CSourceOutput *output, struct CSourceRecord record) {
+    liberror_is_null(csource_output_record, output);
+
+    /* Write the pending span first, so records stay in order */
+    write_span(output);
+    write_record(output, record);
+}
+
+void csource_output_span(struct CSourceOutput *output, const char *text, int length,
+                         long offset, int line) {
+    liberror_is_null(csource_output_span, output);
+    liberror_is_null(csource_output_span, text);
+
+    if(length == 0)
+        return;
+
+    /* Spans are just the text itself in the text format */
+    if(output->format == CSOURCE_FORMAT_TEXT) {
+        write_text(output, text, length);
+
+        return;
+    }
+
+    /* Extend the pending span if this span continues it */
+    if(output->span.length > 0 && output->span.payload + output->span.length == text &&
+       output->span.offset + output->span.length == offset) {
+        output->span.length += length;
+
+        return;
+    }
+
+    write_span(output);
+
+    output->span.payload = text;
+    output->span.length = length;
+    output->span.offset = offset;
+    output->span.line = line;
+}
+
+void csource_output_flush(struct CSourceOutput *output) {
+    liberror_is_null(csource_output_flush, output);
+
+    write_span(output);
+
+    write_buffer(output);
+
+    if(output->stream != NULL)
+        fflush(output->stream);
+}
+
+void csource_output_replay(struct CSourceOutput *output, const char *records, long length) {
+    const char *cursor = records;
+    const char *end = records + length;
+
+    liberror_is_null(csource_output_replay, output);
+    liberror_is_null(csource_output_replay, records);
+
+    if(output->format == CSOURCE_FORMAT_TEXT) {
+        write_text(output, records, (int) length);
+
+        return;
+    }
+
+    /* Each record is its size, kind, line, offset, path, and payload, with
+     * the path and the payload after their lengths, as write_record writes
+     * it. The path is whatever this stream was given. */
+    while(cursor < end) {
+        struct CSourceRecord record;
+        unsigned long size = csource_read_unsigned(cursor, 4);
+        const char *path = cursor + 4 + 1 + 4 + 8;
+        const char *payload = path + 4 + csource_read_unsigned(path, 4);
+
+        INIT_VARIABLE(record);
+
+        record.kind = (int) csource_read_unsigned(cursor + 4, 1);
+        record.line = (int) csource_read_unsigned(cursor + 4 + 1, 4);
+        record.offset = (long) csource_read_unsigned(cursor + 4 + 1 + 4, 8);
+        record.length = (int) csource_read_unsigned(payload, 4);
+        record.payload = payload + 4;
+
+        csource_output_record(output, record);
+        cursor += 4 + size;
+    }
+}
+
+int csource_output_format(const char *name) {
+    liberror_is_null(csource_output_format, name);
+
+    if(strcmp(name, "text") == 0)
+        return CSOURCE_FORMAT_TEXT;
+
+    if(strcmp(name, "jsonl") == 0)
+        return CSOURCE_FORMAT_JSONL;
+
+    if(strcmp(name, "binary") == 0)
+        return CSOURCE_FORMAT_BINARY;
+
+    return -1;
+}
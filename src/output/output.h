@@ -0,0 +1,355 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_CSOURCE_OUTPUT_H
+#define CWARE_CSOURCE_OUTPUT_H
+
+#include <stdio.h>
+
+/* Size of the buffer that output is collected in before it is
+ * written to the stream. */
+#define CSOURCE_OUTPUT_BUFFER_SIZE  65536
+
+/* Output formats */
+#define CSOURCE_FORMAT_TEXT     0
+#define CSOURCE_FORMAT_JSONL    1
+#define CSOURCE_FORMAT_BINARY   2
+
+/* Record kinds. These values are written as-is in the binary format,
+ * so existing values must never be renumbered. */
+#define CSOURCE_RECORD_CODE         0
+#define CSOURCE_RECORD_INCLUDE      1
+#define CSOURCE_RECORD_FUNCTION     2
+#define CSOURCE_RECORD_DOCGEN       3
+#define CSOURCE_RECORD_DEFINE       4
+#define CSOURCE_RECORD_CONDITIONAL  5
+#define CSOURCE_RECORD_INTERVAL     6
+#define CSOURCE_RECORD_COUNTS       7
+#define CSOURCE_RECORD_PROTOTYPE    8
+#define CSOURCE_RECORD_ERROR        9
+#define CSOURCE_RECORD_MATCH        10
+#define CSOURCE_RECORD_DEFINITION   11
+#define CSOURCE_RECORD_USE          12
+#define CSOURCE_RECORD_TAG          13
+#define CSOURCE_RECORD_TYPE         14
+#define CSOURCE_RECORD_GLOBAL       15
+#define CSOURCE_RECORD_TOTALS       16
+
+/*
+ * @docgen: structure
+ * @brief: a single unit of output produced by a module
+ * @name: CSourceRecord
+ *
+ * @field kind: the kind of record (CSOURCE_RECORD_*)
+ * @type: int
+ *
+ * @field line: the line the record starts on, starting from 1
+ * @type: int
+ *
+ * @field offset: the byte offset the record starts at, starting from 0
+ * @type: long
+ *
+ * @field payload: the contents of the record (not NUL terminated)
+ * @type: const char *
+ *
+ * @field length: the length of the payload
+ * @type: int
+*/
+struct CSourceRecord {
+    int kind;
+    int line;
+    long offset;
+    const char *payload;
+    int length;
+};
+
+/*
+ * @docgen: structure
+ * @brief: somewhere other than a FILE to write output to
+ * @name: CSourceSink
+ *
+ * @field write: takes bytes of output, and returns 0 if it could take them
+ * @type: int (*)(struct CSourceSink *, const char *, int)
+ *
+ * @field data: whatever the callback needs
+ * @type: void *
+*/
+struct CSourceSink {
+    int (*write)(struct CSourceSink *sink, const char *bytes, int length);
+    void *data;
+};
+
+/*
+ * @docgen: structure
+ * @brief: a stream of records in a given format
+ * @name: CSourceOutput
+ *
+ * @field format: the format to write records in (CSOURCE_FORMAT_*)
+ * @type: int
+ *
+ * @field stream: the stream to write to, or NULL to write to the sink
+ * @type: FILE *
+ *
+ * @field sink: the sink to write to, if there is no stream
+ * @type: struct CSourceSink *
+ *
+ * @field error: whether the stream or sink failed to take some output
+ * @type: int
+ *
+ * @field path: the path of the file the records come from
+ * @type: const char *
+ *
+ * @field paths: whether each line of text starts with the path, for trees
+ * @type: int
+ *
+ * @field started: whether a line of text was started and not yet ended
+ * @type: int
+ *
+ * @field span: the pending span of code that has not been written yet
+ * @type: struct CSourceRecord
+ *
+ * @field buffer: output that has not been written to the stream yet
+ * @type: char *
+ *
+ * @field length: the length of the buffer
+ * @type: int
+ *
+ * @field statistics: the statistics to count output in, or NULL
+ * @type: struct CSourceStatistics *
+*/
+struct CSourceOutput {
+    int format;
+    FILE *stream;
+    struct CSourceSink *sink;
+    int error;
+    const char *path;
+    int paths;
+    int started;
+    struct CSourceRecord span;
+
+    char *buffer;
+    int length;
+    struct CSourceStatistics *statistics;
+};
+
+struct CSourceStatistics;
+
+/*
+ * @docgen: function
+ * @brief: initialize a new record stream
+ * @name: csource_output_init
+ *
+ * @param stream: the stream to write records to
+ * @type: FILE *
+ *
+ * @param format: the format to write the records in
+ * @type: int
+ *
+ * @param path: the path to attribute the records to
+ * @type: const char *
+ *
+ * @return: a new record stream
+ * @type: struct CSourceOutput
+*/
+struct CSourceOutput csource_output_init(FILE *stream, int format, const char *path);
+
+/*
+ * @docgen: function
+ * @brief: initialize a new record stream that writes to a sink
+ * @name: csource_output_init_sink
+ *
+ * @description
+ * @Initialize a record stream like csource_output_init, but give its
+ * @output to a sink instead of a FILE. Once the sink fails to take some
+ * @output, the error of the stream is set, and nothing more is given
+ * @to the sink.
+ * @description
+ *
+ * @param sink: the sink to write records to
+ * @type: struct CSourceSink *
+ *
+ * @param format: the format to write the records in
+ * @type: int
+ *
+ * @param path: the path to attribute the records to
+ * @type: const char *
+ *
+ * @return: a new record stream
+ * @type: struct CSourceOutput
+*/
+struct CSourceOutput csource_output_init_sink(struct CSourceSink *sink, int format,
+                                              const char *path);
+
+/*
+ * @docgen: function
+ * @brief: release a record stream from memory
+ * @name: csource_output_free
+ *
+ * @description
+ * @Release the buffer of a record stream. The stream should be flushed
+ * @beforehand, as anything that has not been written is discarded. The
+ * @underlying FILE is not closed.
+ * @description
+ *
+ * @error: output is NULL
+ *
+ * @param output: the record stream to release
+ * @type: struct CSourceOutput *
+*/
+void csource_output_free(struct CSourceOutput *output);
+
+/*
+ * @docgen: function
+ * @brief: write a record to a record stream
+ * @name: csource_output_record
+ *
+ * @description
+ * @Write a single record to the stream. In the text format, records are
+ * @written as their line, two tabs, and the payload. Any pending span of
+ * @code is written before the record.
+ * @description
+ *
+ * @error: output is NULL
+ *
+ * @param output: the stream to write to
+ * @type: struct CSourceOutput *
+ *
+ * @param record: the record to write
+ * @type: struct CSourceRecord
+*/
+void csource_output_record(struct CSourceOutput *output, struct CSourceRecord record);
+
+/*
+ * @docgen: function
+ * @brief: write a span of surviving code to a record stream
+ * @name: csource_output_span
+ *
+ * @description
+ * @Write a span of text that survived a filter. In the text format, the
+ * @span is written as-is. In the other formats, spans which are adjacent in
+ * @the source are joined together, and written as one code record once a
+ * @gap is found, or the stream is flushed.
+ * @description
+ *
+ * @notes
+ * @The text of a pending span is not copied, so it must stay alive until
+ * @the stream is flushed.
+ * @notes
+ *
+ * @error: output is NULL
+ * @error: text is NULL
+ *
+ * @param output: the stream to write to
+ * @type: struct CSourceOutput *
+ *
+ * @param text: the start of the span
+ * @type: const char *
+ *
+ * @param length: the length of the span
+ * @type: int
+ *
+ * @param offset: the byte offset of the span in the source
+ * @type: long
+ *
+ * @param line: the line the span starts on, starting from 1
+ * @type: int
+*/
+void csource_output_span(struct CSourceOutput *output, const char *text, int length,
+                         long offset, int line);
+
+/*
+ * @docgen: function
+ * @brief: write everything pending in a record stream
+ * @name: csource_output_flush
+ *
+ * @description
+ * @Write any pending span of code, and everything in the buffer of the
+ * @record stream to the underlying stream.
+ * @description
+ *
+ * @error: output is NULL
+ *
+ * @param output: the stream to flush
+ * @type: struct CSourceOutput *
+*/
+void csource_output_flush(struct CSourceOutput *output);
+
+/*
+ * @docgen: function
+ * @brief: write records that were kept from another record stream
+ * @name: csource_output_replay
+ *
+ * @description
+ * @Write the records another record stream wrote to a sink, as if they had
+ * @been written to this one, so the records of one file can be given to
+ * @another with the same contents. The records of a text stream are kept
+ * @as text, which has no paths in it, and are written as they are, with
+ * @the path of this one before each line if it asks for paths. The
+ * @records of any other stream are kept in the binary format with an empty
+ * @path, and are written again in the format and with the path of this one.
+ * @description
+ *
+ * @error: output is NULL
+ * @error: records is NULL
+ *
+ * @param output: the stream to write to
+ * @type: struct CSourceOutput *
+ *
+ * @param records: the records that were kept
+ * @type: const char *
+ *
+ * @param length: the length of the records
+ * @type: long
+*/
+void csource_output_replay(struct CSourceOutput *output, const char *records, long length);
+
+/*
+ * @docgen: function
+ * @brief: get the format from its name
+ * @name: csource_output_format
+ *
+ * @error: name is NULL
+ *
+ * @param name: the name of the format (text, jsonl, or binary)
+ * @type: const char *
+ *
+ * @return: the format, or -1 if the name is not a known format
+ * @type: int
+*/
+int csource_output_format(const char *name);
+
+#endif
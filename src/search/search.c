@@ -0,0 +1,1283 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file implements trigram indexes, which are laid out in search.h,
+ * and the search of the files they find. The files are read the same way
+ * as for the index of symbols, and so is an index made again.
+*/
+
+/* Regular expressions are POSIX, not ANSI */
+#if defined(__unix__) || defined(__CW_UNIXWARE__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200112L
+#define CSOURCE_SEARCH_POSIX
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(CSOURCE_SEARCH_POSIX)
+#include <sys/types.h>
+#include <regex.h>
+#endif
+
+#include "../csource.h"
+#include "../common/common.h"
+#include "../ingest/ingest.h"
+#include "../output/output.h"
+#include "../table/table.h"
+#include "../filters/blank/blank.h"
+
+#include "search.h"
+
+/* The number of buckets the trigrams start with, which is a power of two */
+#define SEARCH_BUCKETS      4096
+
+/* A slot of a set of keys with no key in it, which is not a key */
+#define SEARCH_EMPTY        0xFFFFFFFFUL
+
+/*
+ * @docgen: structure
+ * @brief: the keys of the trigrams of a file
+ * @name: SearchSet
+ *
+ * @field slots: a hash table of the keys
+ * @type: unsigned long *
+ *
+ * @field capacity: the number of slots, which is a power of two
+ * @type: int
+ *
+ * @field keys: the keys, in the order they were found
+ * @type: unsigned long *
+ *
+ * @field length: the number of keys
+ * @type: int
+*/
+struct SearchSet {
+    unsigned long *slots;
+    int capacity;
+    unsigned long *keys;
+    int length;
+};
+
+/*
+ * @docgen: structure
+ * @brief: a trigram of an index that is being made, to be put in order
+ * @name: SearchOrder
+ *
+ * @field key: the key of the trigram
+ * @type: unsigned long
+ *
+ * @field trigram: the number of the trigram in the builder
+ * @type: int
+*/
+struct SearchOrder {
+    unsigned long key;
+    int trigram;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the files of a trigram of an index, to be intersected
+ * @name: SearchList
+ *
+ * @field key: the key of the trigram
+ * @type: unsigned long
+ *
+ * @field entry: the entry of the trigram, or NULL if the index does not have it
+ * @type: const char *
+ *
+ * @field count: the number of files the trigram is in
+ * @type: unsigned long
+*/
+struct SearchList {
+    unsigned long key;
+    const char *entry;
+    unsigned long count;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the state of a search through a file
+ * @name: SearchLines
+ *
+ * @field setup: the setup of the module
+ * @type: struct ModuleSetup *
+ *
+ * @field line: the line the search has counted up to
+ * @type: int
+ *
+ * @field line_start: the offset that line starts at
+ * @type: int
+ *
+ * @field counted: the offset the lines have been counted up to
+ * @type: int
+ *
+ * @field written: the last line that was written, or 0
+ * @type: int
+*/
+struct SearchLines {
+    struct ModuleSetup *setup;
+    int line;
+    int line_start;
+    int counted;
+    int written;
+};
+
+/*
+ * @docgen: function
+ * @brief: find an entry of the trigrams of an index
+ * @name: trigram_entry
+ *
+ * @param search: the index
+ * @type: const struct CSourceSearch *
+ *
+ * @param trigram: the number of the trigram
+ * @type: unsigned long
+ *
+ * @return: the entry of the trigram
+ * @type: const char *
+*/
+static const char *trigram_entry(const struct CSourceSearch *search, unsigned long trigram) {
+    return search->table.entries + search->table.files * CSOURCE_SEARCH_FILE_SIZE +
+           trigram * CSOURCE_SEARCH_TRIGRAM_SIZE;
+}
+
+/*
+ * @docgen: function
+ * @brief: find the postings of an index
+ * @name: postings_start
+ *
+ * @param search: the index
+ * @type: const struct CSourceSearch *
+ *
+ * @return: the first byte of the postings
+ * @type: const char *
+*/
+static const char *postings_start(const struct CSourceSearch *search) {
+    return trigram_entry(search, search->trigrams);
+}
+
+/*
+ * @docgen: function
+ * @brief: find a trigram of an index by its key
+ * @name: find_trigram
+ *
+ * @param search: the index
+ * @type: const struct CSourceSearch *
+ *
+ * @param key: the key of the trigram
+ * @type: unsigned long
+ *
+ * @return: the entry of the trigram, or NULL if the index does not have it
+ * @type: const char *
+*/
+static const char *find_trigram(const struct CSourceSearch *search, unsigned long key) {
+    unsigned long low = 0;
+    unsigned long high = search->trigrams;
+
+    while(low < high) {
+        unsigned long middle = low + (high - low) / 2;
+        const char *entry = trigram_entry(search, middle);
+        unsigned long found = csource_read_unsigned(entry, 4);
+
+        if(found == key)
+            return entry;
+
+        if(key < found)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+
+    return NULL;
+}
+
+/*
+ * @docgen: function
+ * @brief: read the files of a trigram of an index
+ * @name: read_postings
+ *
+ * @description
+ * @Read the files of a trigram into an array. Whatever is out of the
+ * @bounds of the index, or of the files, ends the files early.
+ * @description
+ *
+ * @param search: the index
+ * @type: const struct CSourceSearch *
+ *
+ * @param entry: the entry of the trigram
+ * @type: const char *
+ *
+ * @param files: where to put the files, with room for the count of the trigram
+ * @type: int *
+ *
+ * @return: the number of files read
+ * @type: int
+*/
+static int read_postings(const struct CSourceSearch *search, const char *entry, int *files) {
+    int length = 0;
+    long file = -1;
+    unsigned long count = csource_read_unsigned(entry + 4, 4);
+    unsigned long offset = csource_read_unsigned(entry + 8, 8);
+    const char *postings = postings_start(search);
+
+    while(count-- > 0 && offset < search->postings) {
+        int shift = 0;
+        unsigned long delta = 0;
+
+        while(offset < search->postings && shift < 32) {
+            unsigned char byte = (unsigned char) postings[offset++];
+
+            delta |= (unsigned long) (byte & 0x7F) << shift;
+            shift += 7;
+
+            if((byte & 0x80) == 0)
+                break;
+        }
+
+        file += (long) delta + 1;
+
+        if(file < 0 || (unsigned long) file >= search->table.files)
+            break;
+
+        files[length++] = (int) file;
+    }
+
+    return length;
+}
+
+/*
+ * @docgen: function
+ * @brief: order the files of trigrams by how many there are
+ * @name: compare_lists
+ *
+ * @param first: the first list
+ * @type: const void *
+ *
+ * @param second: the second list
+ * @type: const void *
+ *
+ * @return: less than, equal to or greater than 0, like strcmp
+ * @type: int
+*/
+static int compare_lists(const void *first, const void *second) {
+    const struct SearchList *left = first;
+    const struct SearchList *right = second;
+
+    return (left->count > right->count) - (left->count < right->count);
+}
+
+/*
+ * @docgen: function
+ * @brief: order integers
+ * @name: compare_integers
+ *
+ * @param first: the first integer
+ * @type: const void *
+ *
+ * @param second: the second integer
+ * @type: const void *
+ *
+ * @return: less than, equal to or greater than 0, like strcmp
+ * @type: int
+*/
+static int compare_integers(const void *first, const void *second) {
+    int left = *(const int *) first;
+    int right = *(const int *) second;
+
+    return (left > right) - (left < right);
+}
+
+int csource_search_open(struct CSourceSearch *search, const char *path) {
+    FILE *file = NULL;
+    unsigned long length = 0;
+    const char *buffer = NULL;
+
+    liberror_is_null(csource_search_open, search);
+    liberror_is_null(csource_search_open, path);
+
+    INIT_VARIABLE(*search);
+
+    if((file = fopen(path, "rb")) == NULL)
+        return -1;
+
+    search->input = csource_ingest(file, &search->mapped);
+    buffer = search->input.buffer;
+    length = (unsigned long) search->input.length;
+
+    if(ferror(file) != 0 || length < CSOURCE_SEARCH_HEADER_SIZE ||
+       memcmp(buffer, CSOURCE_SEARCH_MAGIC, 8) != 0 ||
+       csource_read_unsigned(buffer + 8, 4) != CSOURCE_SEARCH_VERSION) {
+        fclose(file);
+        csource_search_close(search);
+
+        return -1;
+    }
+
+    fclose(file);
+
+    search->table.files = csource_read_unsigned(buffer + 12, 4);
+    search->trigrams = csource_read_unsigned(buffer + 16, 4);
+    search->postings = csource_read_unsigned(buffer + 24, 8);
+    search->strings = csource_read_unsigned(buffer + 32, 8);
+
+    /* Every count is checked against the length before it is multiplied,
+     * so that the sizes of the tables cannot overflow */
+    if(search->table.files > length / CSOURCE_SEARCH_FILE_SIZE ||
+       search->trigrams > length / CSOURCE_SEARCH_TRIGRAM_SIZE || search->postings > length ||
+       search->strings > length ||
+       CSOURCE_SEARCH_HEADER_SIZE + search->table.files * CSOURCE_SEARCH_FILE_SIZE +
+       search->trigrams * CSOURCE_SEARCH_TRIGRAM_SIZE + search->postings + search->strings !=
+       length || (search->strings > 0 && buffer[length - 1] != '\0')) {
+        csource_search_close(search);
+
+        return -1;
+    }
+
+    /* The strings are nothing but the paths */
+    search->table.entries = buffer + CSOURCE_SEARCH_HEADER_SIZE;
+    search->table.strings = postings_start(search) + search->postings;
+    search->table.length = search->strings;
+
+    return 0;
+}
+
+void csource_search_close(struct CSourceSearch *search) {
+    liberror_is_null(csource_search_close, search);
+
+    csource_ingest_free(&search->input, search->mapped);
+    INIT_VARIABLE(*search);
+}
+
+int csource_search_check(const char *pattern, int search) {
+#if defined(CSOURCE_SEARCH_POSIX)
+    regex_t expression;
+#endif
+
+    liberror_is_null(csource_search_check, pattern);
+
+    if(pattern[0] == '\0')
+        return -1;
+
+    if((search & CSOURCE_SEARCH_REGEX) == 0)
+        return 0;
+
+#if defined(CSOURCE_SEARCH_POSIX)
+    if(regcomp(&expression, pattern, REG_EXTENDED | REG_NEWLINE | REG_NOSUB) != 0)
+        return -1;
+
+    regfree(&expression);
+
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+/*
+ * @docgen: function
+ * @brief: keep a string every match has in it, if it has any trigrams
+ * @name: add_literal
+ *
+ * @param literals: the strings to add to
+ * @type: struct CSourceSearchLiterals *
+ *
+ * @param literal: the string, which is reset afterwards
+ * @type: struct CString *
+*/
+static void add_literal(struct CSourceSearchLiterals *literals, struct CString *literal) {
+    if(literal->length >= 3) {
+        carray_append(literals, cstring_init(literal->contents), SEARCH_LITERAL);
+    }
+
+    cstring_reset(literal);
+}
+
+/*
+ * @docgen: function
+ * @brief: skip past the end of a group or bracket of a regular expression
+ * @name: skip_nested
+ *
+ * @param pattern: the regular expression
+ * @type: const char *
+ *
+ * @param index: the index of the ( or [ that starts it
+ * @type: int
+ *
+ * @return: the index just after the end
+ * @type: int
+*/
+static int skip_nested(const char *pattern, int index) {
+    int depth = 0;
+
+    if(pattern[index] == '[') {
+        index++;
+
+        /* A ] right after the [, or after [^, is one of the characters */
+        if(pattern[index] == '^')
+            index++;
+
+        if(pattern[index] == ']')
+            index++;
+
+        while(pattern[index] != '\0' && pattern[index] != ']')
+            index++;
+
+        return pattern[index] == '\0' ? index : index + 1;
+    }
+
+    for(; pattern[index] != '\0'; index++) {
+        if(pattern[index] == '\\' && pattern[index + 1] != '\0')
+            index++;
+        else if(pattern[index] == '[')
+            index = skip_nested(pattern, index) - 1;
+        else if(pattern[index] == '(')
+            depth++;
+        else if(pattern[index] == ')' && --depth == 0)
+            return index + 1;
+    }
+
+    return index;
+}
+
+struct CSourceSearchLiterals *csource_search_literals(const char *pattern, int search) {
+    int index = 0;
+    struct CString literal;
+    struct CSourceSearchLiterals *literals = NULL;
+
+    liberror_is_null(csource_search_literals, pattern);
+
+    literals = carray_init(literals, SEARCH_LITERAL);
+    literal = cstring_init("");
+
+    if((search & CSOURCE_SEARCH_REGEX) == 0) {
+        cstring_concats(&literal, pattern);
+        add_literal(literals, &literal);
+        cstring_free(literal);
+
+        return literals;
+    }
+
+    /* Neither side of an alternative has to match */
+    if(strchr(pattern, '|') != NULL) {
+        cstring_free(literal);
+
+        return literals;
+    }
+
+    while(pattern[index] != '\0') {
+        char character[2];
+
+        switch(pattern[index]) {
+            case '*': case '?': case '{':
+                /* Whatever was repeated may not be there at all */
+                if(literal.length > 0)
+                    literal.contents[--literal.length] = '\0';
+
+                add_literal(literals, &literal);
+
+                if(pattern[index] == '{') {
+                    while(pattern[index] != '\0' && pattern[index] != '}')
+                        index++;
+                }
+
+                if(pattern[index] != '\0')
+                    index++;
+
+                continue;
+
+            case '(': case '[':
+                add_literal(literals, &literal);
+                index = skip_nested(pattern, index);
+
+                continue;
+
+            case '+': case '.': case '^': case '$':
+                add_literal(literals, &literal);
+                index++;
+
+                continue;
+
+            case '\\':
+                /* Only escaped punctuation is a plain character */
+                if(pattern[index + 1] == '\0' || strchr(LIBMATCH_ALPHANUM, pattern[index + 1])) {
+                    add_literal(literals, &literal);
+                    index += pattern[index + 1] == '\0' ? 1 : 2;
+
+                    continue;
+                }
+
+                index++;
+                break;
+        }
+
+        /* A character followed by a repetition is taken off above */
+        character[0] = pattern[index++];
+        character[1] = '\0';
+        cstring_concats(&literal, character);
+    }
+
+    add_literal(literals, &literal);
+    cstring_free(literal);
+
+    return literals;
+}
+
+int *csource_search_candidates(const struct CSourceSearch *search,
+                               const struct CSourceSearchLiterals *literals, int variant,
+                               int *count) {
+    int index = 0;
+    int length = 0;
+    int *files = NULL;
+    int *next = NULL;
+    struct SearchList *lists = NULL;
+
+    liberror_is_null(csource_search_candidates, search);
+    liberror_is_null(csource_search_candidates, literals);
+    liberror_is_null(csource_search_candidates, count);
+
+    for(index = 0; index < literals->length; index++)
+        length += literals->contents[index].length - 2;
+
+    lists = csource_allocator.allocate(sizeof(*lists) * (length + 1));
+    length = 0;
+
+    for(index = 0; index < literals->length; index++) {
+        int offset = 0;
+        const unsigned char *text = (const unsigned char *) literals->contents[index].contents;
+
+        for(offset = 0; offset + 2 < literals->contents[index].length; offset++) {
+            struct SearchList list;
+
+            list.key = ((unsigned long) variant << 24) | ((unsigned long) text[offset] << 16) |
+                       ((unsigned long) text[offset + 1] << 8) | text[offset + 2];
+            list.entry = find_trigram(search, list.key);
+            list.count = list.entry == NULL ? 0 : csource_read_unsigned(list.entry + 4, 4);
+
+            if(list.count > search->table.files)
+                list.count = search->table.files;
+
+            lists[length++] = list;
+        }
+    }
+
+    files = csource_allocator.allocate(sizeof(*files) * (search->table.files + 1));
+    *count = 0;
+
+    /* With nothing to look for, every file that was indexed could match */
+    if(length == 0) {
+        unsigned long file = 0;
+
+        for(file = 0; file < search->table.files; file++) {
+            const char *entry = search->table.entries + file * CSOURCE_SEARCH_FILE_SIZE;
+
+            if((long) csource_read_unsigned(entry + 8, 8) != CSOURCE_TABLE_FAILED)
+                files[(*count)++] = (int) file;
+        }
+
+        csource_allocator.release(lists);
+
+        return files;
+    }
+
+    /* The rarest trigram is read first, since no file can be added after */
+    qsort(lists, length, sizeof(*lists), compare_lists);
+
+    if(lists[0].entry != NULL)
+        *count = read_postings(search, lists[0].entry, files);
+
+    next = csource_allocator.allocate(sizeof(*next) * (search->table.files + 1));
+
+    for(index = 1; index < length && *count > 0; index++) {
+        int kept = 0;
+        int left = 0;
+        int right = 0;
+        int found = 0;
+
+        if(lists[index].key == lists[index - 1].key)
+            continue;
+
+        found = lists[index].entry == NULL ? 0 : read_postings(search, lists[index].entry, next);
+
+        while(left < *count && right < found) {
+            if(files[left] < next[right]) {
+                left++;
+            } else if(files[left] > next[right]) {
+                right++;
+            } else {
+                files[kept++] = files[left];
+                left++;
+                right++;
+            }
+        }
+
+        *count = kept;
+    }
+
+    csource_allocator.release(next);
+    csource_allocator.release(lists);
+
+    return files;
+}
+
+/*
+ * @docgen: function
+ * @brief: write a line that matches
+ * @name: write_line
+ *
+ * @param search: the search the match was found in
+ * @type: struct SearchLines *
+ *
+ * @param offset: the offset of the match
+ * @type: int
+ *
+ * @return: the offset the next line starts at
+ * @type: int
+*/
+static int write_line(struct SearchLines *search, int offset) {
+    int end = 0;
+    int next = 0;
+    char number[64 + 1];
+    const char *newline = NULL;
+    struct CSourceRecord record;
+    const char *buffer = search->setup->input.buffer;
+    int length = search->setup->input.length;
+
+    /* Matches are found in order, so lines are counted from the last one */
+    while((newline = memchr(buffer + search->counted, '\n', offset - search->counted)) != NULL) {
+        search->line++;
+        search->line_start = newline - buffer + 1;
+        search->counted = search->line_start;
+    }
+
+    search->counted = offset;
+
+    if((newline = memchr(buffer + offset, '\n', length - offset)) == NULL)
+        end = next = length;
+    else
+        next = (end = newline - buffer) + 1;
+
+    /* A line is only written once, however many matches are on it */
+    if(search->line == search->written)
+        return next;
+
+    search->written = search->line;
+
+    if(end > search->line_start && buffer[end - 1] == '\r')
+        end--;
+
+    if(search->setup->output->format != CSOURCE_FORMAT_TEXT) {
+        INIT_VARIABLE(record);
+
+        record.kind = CSOURCE_RECORD_MATCH;
+        record.line = search->line;
+        record.offset = offset;
+        record.payload = buffer + search->line_start;
+        record.length = end - search->line_start;
+
+        csource_output_record(search->setup->output, record);
+
+        return next;
+    }
+
+    sprintf(number, ":%i:", search->line);
+
+    csource_output_span(search->setup->output, search->setup->source,
+                        strlen(search->setup->source), offset, search->line);
+    csource_output_span(search->setup->output, number, strlen(number), offset, search->line);
+    csource_output_span(search->setup->output, buffer + search->line_start,
+                        end - search->line_start, offset, search->line);
+    csource_output_span(search->setup->output, "\n", 1, offset, search->line);
+
+    return next;
+}
+
+/*
+ * @docgen: function
+ * @brief: write the lines a plain string is on
+ * @name: search_string
+ *
+ * @param search: the search
+ * @type: struct SearchLines *
+ *
+ * @param text: the text to search
+ * @type: const char *
+ *
+ * @param length: the length of the text
+ * @type: int
+*/
+static void search_string(struct SearchLines *search, const char *text, int length) {
+    const char *pattern = search->setup->lookup;
+    int size = strlen(pattern);
+    const char *cursor = text;
+    const char *end = text + length;
+
+    while(end - cursor >= size &&
+          (cursor = memchr(cursor, pattern[0], (end - cursor) - size + 1)) != NULL) {
+        if(memcmp(cursor, pattern, size) != 0) {
+            cursor++;
+
+            continue;
+        }
+
+        cursor = text + write_line(search, cursor - text);
+    }
+}
+
+#if defined(CSOURCE_SEARCH_POSIX)
+/*
+ * @docgen: function
+ * @brief: write the lines a regular expression matches on
+ * @name: search_expression
+ *
+ * @param search: the search
+ * @type: struct SearchLines *
+ *
+ * @param text: the text to search, which ends with a NUL
+ * @type: const char *
+ *
+ * @param length: the length of the text
+ * @type: int
+*/
+static void search_expression(struct SearchLines *search, const char *text, int length) {
+    int offset = 0;
+    regex_t expression;
+    regmatch_t match;
+
+    if(regcomp(&expression, search->setup->lookup, REG_EXTENDED | REG_NEWLINE) != 0)
+        return;
+
+    /* Each search starts at the start of a line, since the one that
+     * matched is written whole */
+    while(offset < length && regexec(&expression, text + offset, 1, &match, 0) == 0)
+        offset = write_line(search, offset + (int) match.rm_so);
+
+    regfree(&expression);
+}
+#endif
+
+void csource_search_lines(struct ModuleSetup setup) {
+    char *text = NULL;
+    struct SearchLines search;
+
+    if(setup.lookup == NULL || setup.lookup[0] == '\0')
+        return;
+
+    INIT_VARIABLE(search);
+
+    search.setup = &setup;
+    search.line = 1;
+
+    text = csource_allocator.allocate(setup.input.length + 1);
+    memcpy(text, setup.input.buffer, setup.input.length);
+    text[setup.input.length] = '\0';
+
+    if((setup.search & CSOURCE_SEARCH_CODE) != 0)
+        csource_blank_only_comments(text, setup.input.length);
+
+    if((setup.search & CSOURCE_SEARCH_REGEX) == 0)
+        search_string(&search, text, setup.input.length);
+#if defined(CSOURCE_SEARCH_POSIX)
+    else
+        search_expression(&search, text, setup.input.length);
+#endif
+
+    csource_allocator.release(text);
+}
+
+/*
+ * @docgen: function
+ * @brief: find the slot of a key in a set of keys
+ * @name: set_slot
+ *
+ * @param slots: the slots of the set
+ * @type: const unsigned long *
+ *
+ * @param capacity: the number of slots
+ * @type: int
+ *
+ * @param key: the key
+ * @type: unsigned long
+ *
+ * @return: the slot the key is in, or would be put in
+ * @type: int
+*/
+static int set_slot(const unsigned long *slots, int capacity, unsigned long key) {
+    unsigned long mask = (unsigned long) capacity - 1;
+    unsigned long slot = ((key * 2654435761UL) & 0xFFFFFFFFUL) >> 7;
+
+    for(slot &= mask; slots[slot] != SEARCH_EMPTY && slots[slot] != key; slot = (slot + 1) & mask)
+        continue;
+
+    return (int) slot;
+}
+
+/*
+ * @docgen: function
+ * @brief: add the trigrams of a text to a set of keys
+ * @name: add_trigrams
+ *
+ * @param set: the set of keys
+ * @type: struct SearchSet *
+ *
+ * @param text: the text
+ * @type: const char *
+ *
+ * @param length: the length of the text
+ * @type: int
+ *
+ * @param variant: the variant the text is (CSOURCE_SEARCH_RAW, CSOURCE_SEARCH_CODE)
+ * @type: int
+*/
+static void add_trigrams(struct SearchSet *set, const char *text, int length, int variant) {
+    int index = 0;
+    unsigned long key = 0;
+    const unsigned char *bytes = (const unsigned char *) text;
+
+    for(index = 0; index < length; index++) {
+        int slot = 0;
+
+        key = ((key << 8) | bytes[index]) & 0xFFFFFF;
+
+        if(index < 2)
+            continue;
+
+        slot = set_slot(set->slots, set->capacity, key | ((unsigned long) variant << 24));
+
+        if(set->slots[slot] != SEARCH_EMPTY)
+            continue;
+
+        set->slots[slot] = key | ((unsigned long) variant << 24);
+        set->keys[set->length++] = set->slots[slot];
+
+        /* The slots are kept at most half full */
+        if(set->length * 2 > set->capacity) {
+            int grown = 0;
+
+            csource_allocator.release(set->slots);
+            set->capacity *= 2;
+            set->slots = csource_allocator.allocate(sizeof(*set->slots) * set->capacity);
+            set->keys = csource_allocator.reallocate(set->keys,
+                                                     sizeof(*set->keys) * (set->capacity / 2 + 1));
+
+            for(grown = 0; grown < set->capacity; grown++)
+                set->slots[grown] = SEARCH_EMPTY;
+
+            for(grown = 0; grown < set->length; grown++)
+                set->slots[set_slot(set->slots, set->capacity, set->keys[grown])] = set->keys[grown];
+        }
+    }
+}
+
+void csource_search_file(struct ModuleSetup setup) {
+    int index = 0;
+    char *code = NULL;
+    struct SearchSet set;
+
+    set.capacity = 1024;
+    set.length = 0;
+    set.slots = csource_allocator.allocate(sizeof(*set.slots) * set.capacity);
+    set.keys = csource_allocator.allocate(sizeof(*set.keys) * (set.capacity / 2 + 1));
+
+    for(index = 0; index < set.capacity; index++)
+        set.slots[index] = SEARCH_EMPTY;
+
+    add_trigrams(&set, setup.input.buffer, setup.input.length, CSOURCE_SEARCH_RAW);
+
+    code = csource_allocator.allocate(setup.input.length + 1);
+    memcpy(code, setup.input.buffer, setup.input.length);
+    csource_blank_only_comments(code, setup.input.length);
+    add_trigrams(&set, code, setup.input.length, CSOURCE_SEARCH_CODE);
+    csource_allocator.release(code);
+
+    csource_table_write_path(setup.output, setup.source);
+    csource_table_write_number(setup.output, set.length);
+
+    for(index = 0; index < set.length; index++)
+        csource_table_write_number(setup.output, set.keys[index]);
+
+    csource_allocator.release(set.slots);
+    csource_allocator.release(set.keys);
+}
+
+/*
+ * @docgen: function
+ * @brief: double the buckets of the trigrams of an index being made
+ * @name: grow_buckets
+ *
+ * @param builder: the builder
+ * @type: struct CSourceSearchBuilder *
+*/
+static void grow_buckets(struct CSourceSearchBuilder *builder) {
+    int index = 0;
+    int count = builder->bucket_count * 2;
+    unsigned long mask = (unsigned long) count - 1;
+    int *buckets = csource_allocator.allocate(sizeof(int) * count);
+
+    for(index = 0; index < count; index++)
+        buckets[index] = -1;
+
+    for(index = 0; index < builder->trigrams->length; index++) {
+        unsigned long key = builder->trigrams->contents[index].key;
+        unsigned long bucket = (((key * 2654435761UL) & 0xFFFFFFFFUL) >> 7) & mask;
+
+        while(buckets[bucket] != -1)
+            bucket = (bucket + 1) & mask;
+
+        buckets[bucket] = index;
+    }
+
+    csource_allocator.release(builder->buckets);
+    builder->buckets = buckets;
+    builder->bucket_count = count;
+}
+
+/*
+ * @docgen: function
+ * @brief: add a file to the files of a trigram of an index being made
+ * @name: add_posting
+ *
+ * @param builder: the builder
+ * @type: struct CSourceSearchBuilder *
+ *
+ * @param key: the key of the trigram
+ * @type: unsigned long
+ *
+ * @param file: the number of the file
+ * @type: int
+*/
+static void add_posting(struct CSourceSearchBuilder *builder, unsigned long key, int file) {
+    struct CSourceSearchTrigram *trigram = NULL;
+    unsigned long mask = (unsigned long) builder->bucket_count - 1;
+    unsigned long bucket = (((key * 2654435761UL) & 0xFFFFFFFFUL) >> 7) & mask;
+
+    for(; builder->buckets[bucket] != -1; bucket = (bucket + 1) & mask) {
+        if(builder->trigrams->contents[builder->buckets[bucket]].key == key)
+            break;
+    }
+
+    if(builder->buckets[bucket] == -1) {
+        struct CSourceSearchTrigram created;
+
+        created.key = key;
+        created.length = 0;
+        created.capacity = 4;
+        created.sorted = 1;
+        created.files = csource_allocator.allocate(sizeof(int) * created.capacity);
+
+        builder->buckets[bucket] = builder->trigrams->length;
+        carray_append(builder->trigrams, created, SEARCH_TRIGRAM);
+
+        trigram = builder->trigrams->contents + builder->trigrams->length - 1;
+
+        /* The buckets are kept at most half full */
+        if(builder->trigrams->length * 2 > builder->bucket_count)
+            grow_buckets(builder);
+    } else {
+        trigram = builder->trigrams->contents + builder->buckets[bucket];
+    }
+
+    if(trigram->length == trigram->capacity) {
+        trigram->capacity *= 2;
+        trigram->files = csource_allocator.reallocate(trigram->files,
+                                                      sizeof(int) * trigram->capacity);
+    }
+
+    if(trigram->length > 0 && trigram->files[trigram->length - 1] > file)
+        trigram->sorted = 0;
+
+    trigram->files[trigram->length++] = file;
+}
+
+/*
+ * @docgen: function
+ * @brief: read the trigrams of one file into an index being made
+ * @name: read_file
+ *
+ * @param table: the table of the builder
+ * @type: struct CSourceTable *
+ *
+ * @param stream: the stream to read from, after the path of the file
+ * @type: FILE *
+ *
+ * @param file: the number of the file
+ * @type: int
+ *
+ * @return: 0 if the trigrams were read, or -1 if they were not
+ * @type: int
+*/
+static int read_file(struct CSourceTable *table, FILE *stream, int file) {
+    unsigned long count = 0;
+    unsigned long key = 0;
+    struct CSourceSearchBuilder *builder = (struct CSourceSearchBuilder *) table;
+
+    if(csource_read_number(stream, &count) != 0)
+        return -1;
+
+    for(; count > 0; count--) {
+        if(csource_read_number(stream, &key) != 0)
+            return -1;
+
+        add_posting(builder, key, file);
+    }
+
+    return 0;
+}
+
+struct CSourceTable *csource_search_builder_init(const char *path) {
+    int index = 0;
+    struct CSourceSearchBuilder *builder = NULL;
+
+    liberror_is_null(csource_search_builder_init, path);
+
+    builder = csource_allocator.allocate(sizeof(*builder));
+    INIT_VARIABLE(*builder);
+
+    /* An index that cannot be opened is made again from scratch */
+    if(csource_search_open(&builder->last, path) == 0)
+        csource_table_init(&builder->table, &builder->last.table);
+    else
+        csource_table_init(&builder->table, NULL);
+
+    builder->trigrams = carray_init(builder->trigrams, SEARCH_TRIGRAM);
+    builder->bucket_count = SEARCH_BUCKETS;
+    builder->buckets = csource_allocator.allocate(sizeof(int) * SEARCH_BUCKETS);
+
+    for(index = 0; index < SEARCH_BUCKETS; index++)
+        builder->buckets[index] = -1;
+
+    return &builder->table;
+}
+
+int csource_search_read(struct CSourceTable *table, FILE *stream) {
+    liberror_is_null(csource_search_read, table);
+    liberror_is_null(csource_search_read, stream);
+
+    return csource_table_read(table, stream, read_file);
+}
+
+/*
+ * @docgen: function
+ * @brief: take the files of the trigrams that did not change
+ * @name: reuse_postings
+ *
+ * @param builder: the builder
+ * @type: struct CSourceSearchBuilder *
+*/
+static void reuse_postings(struct CSourceSearchBuilder *builder) {
+    unsigned long trigram = 0;
+    const struct CSourceSearch *last = &builder->last;
+    int *files = csource_allocator.allocate(sizeof(int) * (last->table.files + 1));
+
+    for(trigram = 0; trigram < last->trigrams; trigram++) {
+        int index = 0;
+        const char *entry = trigram_entry(last, trigram);
+        int count = read_postings(last, entry, files);
+
+        for(index = 0; index < count; index++) {
+            int file = csource_table_reused(&builder->table, files[index]);
+
+            if(file != -1)
+                add_posting(builder, csource_read_unsigned(entry, 4), file);
+        }
+    }
+
+    csource_allocator.release(files);
+}
+
+/*
+ * @docgen: function
+ * @brief: order trigrams by their keys
+ * @name: compare_keys
+ *
+ * @param first: the first trigram
+ * @type: const void *
+ *
+ * @param second: the second trigram
+ * @type: const void *
+ *
+ * @return: less than, equal to or greater than 0, like strcmp
+ * @type: int
+*/
+static int compare_keys(const void *first, const void *second) {
+    const struct SearchOrder *left = first;
+    const struct SearchOrder *right = second;
+
+    return (left->key > right->key) - (left->key < right->key);
+}
+
+/*
+ * @docgen: function
+ * @brief: encode the files of a trigram
+ * @name: encode_postings
+ *
+ * @param trigram: the trigram
+ * @type: struct CSourceSearchTrigram *
+ *
+ * @param postings: the postings to add to, which are grown to fit
+ * @type: struct CString *
+ *
+ * @return: the number of files encoded
+ * @type: int
+*/
+static int encode_postings(struct CSourceSearchTrigram *trigram, struct CString *postings) {
+    int index = 0;
+    int count = 0;
+    long last = -1;
+
+    if(trigram->sorted == 0)
+        qsort(trigram->files, trigram->length, sizeof(int), compare_integers);
+
+    for(index = 0; index < trigram->length; index++) {
+        char bytes[8];
+        int length = 0;
+        unsigned long delta = 0;
+
+        if(trigram->files[index] == last)
+            continue;
+
+        delta = (unsigned long) (trigram->files[index] - last - 1);
+        last = trigram->files[index];
+
+        do {
+            bytes[length++] = (char) ((delta & 0x7F) | (delta > 0x7F ? 0x80 : 0));
+            delta >>= 7;
+        } while(delta > 0);
+
+        /* The bytes can be 0, so they are added without concatenation */
+        while(postings->length + length + 1 > postings->capacity) {
+            postings->capacity = postings->capacity * 2 + 4096;
+            postings->contents = csource_allocator.reallocate(postings->contents,
+                                                              postings->capacity);
+        }
+
+        memcpy(postings->contents + postings->length, bytes, length);
+        postings->length += length;
+        count++;
+    }
+
+    return count;
+}
+
+int csource_search_write(struct CSourceTable *table, const char *path) {
+    int index = 0;
+    int failed = 0;
+    FILE *stream = NULL;
+    unsigned long *offsets = NULL;
+    int *counts = NULL;
+    struct SearchOrder *order = NULL;
+    struct CString postings;
+    struct CSourceSearchBuilder *builder = (struct CSourceSearchBuilder *) table;
+    int trigrams = 0;
+
+    liberror_is_null(csource_search_write, table);
+    liberror_is_null(csource_search_write, path);
+
+    if(table->reused != NULL)
+        reuse_postings(builder);
+
+    trigrams = builder->trigrams->length;
+    order = csource_allocator.allocate(sizeof(*order) * (trigrams + 1));
+    offsets = csource_allocator.allocate(sizeof(*offsets) * (trigrams + 1));
+    counts = csource_allocator.allocate(sizeof(*counts) * (trigrams + 1));
+
+    for(index = 0; index < trigrams; index++) {
+        order[index].key = builder->trigrams->contents[index].key;
+        order[index].trigram = index;
+    }
+
+    qsort(order, trigrams, sizeof(*order), compare_keys);
+
+    postings.length = 0;
+    postings.capacity = 0;
+    postings.contents = NULL;
+
+    for(index = 0; index < trigrams; index++) {
+        offsets[index] = postings.length;
+        counts[index] = encode_postings(builder->trigrams->contents + order[index].trigram,
+                                        &postings);
+    }
+
+    if((stream = csource_table_create(path)) == NULL) {
+        failed = 1;
+    } else {
+        fwrite(CSOURCE_SEARCH_MAGIC, 1, 8, stream);
+        csource_write_unsigned(stream, CSOURCE_SEARCH_VERSION, 4);
+        csource_write_unsigned(stream, table->files->length, 4);
+        csource_write_unsigned(stream, trigrams, 4);
+        csource_write_unsigned(stream, 0, 4);
+        csource_write_unsigned(stream, postings.length, 8);
+        csource_write_unsigned(stream, csource_table_paths(table), 8);
+        csource_table_write_files(table, stream);
+
+        for(index = 0; index < trigrams; index++) {
+            csource_write_unsigned(stream, order[index].key, 4);
+            csource_write_unsigned(stream, counts[index], 4);
+            csource_write_unsigned(stream, offsets[index], 8);
+        }
+
+        if(postings.length > 0)
+            fwrite(postings.contents, 1, postings.length, stream);
+
+        csource_table_write_paths(table, stream);
+        failed = csource_table_replace(stream, path) == -1;
+    }
+
+    if(postings.contents != NULL)
+        csource_allocator.release(postings.contents);
+
+    csource_allocator.release(order);
+    csource_allocator.release(offsets);
+    csource_allocator.release(counts);
+
+    return failed == 1 ? -1 : 0;
+}
+
+void csource_search_builder_free(struct CSourceTable *table) {
+    struct CSourceSearchBuilder *builder = (struct CSourceSearchBuilder *) table;
+
+    liberror_is_null(csource_search_builder_free, table);
+
+    if(table->last != NULL)
+        csource_search_close(&builder->last);
+
+    csource_table_free(table);
+    carray_free(builder->trigrams, SEARCH_TRIGRAM);
+    csource_allocator.release(builder->buckets);
+    csource_allocator.release(builder);
+}
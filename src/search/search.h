@@ -0,0 +1,482 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * A trigram index of a tree, for finding the files a string could be in
+ * without reading every file. Each run of three bytes of a file is one of
+ * its trigrams, and the index keeps the files each trigram is in. A file
+ * can only have a string in it if it has every trigram of the string, so
+ * the files that do are the only ones that are read to check. Trigrams
+ * are kept of each file as it is, and of its code, with the comments
+ * blanked, so that a search of code alone never matches a comment.
+ *
+ * Like the index of symbols, every integer is little endian, and it is
+ * searched where it is mapped:
+ *
+ *     header, 40 bytes
+ *         u8   magic[8], which is "cstrigr\n"
+ *         u32  version
+ *         u32  files
+ *         u32  trigrams
+ *         u32  0
+ *         u64  length of the postings
+ *         u64  length of the strings
+ *
+ *     files, 24 bytes each, in the order of their paths
+ *         u32  offset of the path in the strings
+ *         u32  0
+ *         u64  size of the file, or all ones if it could not be indexed
+ *         u64  time the file was last modified
+ *
+ *     trigrams, 16 bytes each, in the order of their keys
+ *         u32  key, which is the variant, shifted left by 24, and the three
+ *              bytes of the trigram, the first of them the most significant
+ *         u32  number of files the trigram is in
+ *         u64  offset of the files in the postings
+ *
+ *     postings, which are the files of each trigram, in order, as the
+ *     difference from the last file, or from -1 for the first file, in
+ *     seven bit groups, least significant first, where every group but
+ *     the last has its eighth bit set
+ *
+ *     strings, which each end with a NUL
+ *
+ * The files are the table of table.h, the same as those of the index of
+ * symbols, and the strings only have their paths.
+*/
+
+#ifndef CWARE_CSOURCE_SEARCH_H
+#define CWARE_CSOURCE_SEARCH_H
+
+#include <stdio.h>
+
+#include "../table/table.h"
+
+/* Data structure properties */
+#define SEARCH_TRIGRAM_TYPE     struct CSourceSearchTrigram
+#define SEARCH_TRIGRAM_HEAP     1
+#define SEARCH_TRIGRAM_FREE(value) csource_allocator.release((value).files)
+
+#define SEARCH_LITERAL_TYPE     struct CString
+#define SEARCH_LITERAL_HEAP     1
+#define SEARCH_LITERAL_FREE(value) cstring_free(value)
+
+/* The format of a trigram index. The version changes whenever the format
+ * does, and an index of any other version is made again from scratch. */
+#define CSOURCE_SEARCH_MAGIC            "cstrigr\n"
+#define CSOURCE_SEARCH_VERSION          1
+
+#define CSOURCE_SEARCH_HEADER_SIZE      40
+#define CSOURCE_SEARCH_FILE_SIZE        24
+#define CSOURCE_SEARCH_TRIGRAM_SIZE     16
+
+/* Where a trigram index is made, if no other path is given */
+#define CSOURCE_SEARCH_DEFAULT_PATH     "csource.trigrams"
+
+/* The variants of a file trigrams are kept of */
+#define CSOURCE_SEARCH_RAW      0
+#define CSOURCE_SEARCH_CODE     1
+
+/* How to search, which can be combined */
+#define CSOURCE_SEARCH_REGEX    2
+
+struct ModuleSetup;
+
+/*
+ * @docgen: structure
+ * @brief: a trigram index, mapped into memory
+ * @name: CSourceSearch
+ *
+ * @field input: the contents of the index
+ * @type: struct LibmatchCursor
+ *
+ * @field mapped: whether the contents are mapped
+ * @type: int
+ *
+ * @field table: the files
+ * @type: struct CSourceTableView
+ *
+ * @field trigrams: the number of trigrams
+ * @type: unsigned long
+ *
+ * @field postings: the number of bytes in the postings
+ * @type: unsigned long
+ *
+ * @field strings: the number of bytes in the strings
+ * @type: unsigned long
+*/
+struct CSourceSearch {
+    struct LibmatchCursor input;
+    int mapped;
+    struct CSourceTableView table;
+    unsigned long trigrams;
+    unsigned long postings;
+    unsigned long strings;
+};
+
+/*
+ * @docgen: structure
+ * @brief: a trigram of an index that is being made
+ * @name: CSourceSearchTrigram
+ *
+ * @field key: the key of the trigram
+ * @type: unsigned long
+ *
+ * @field length: the number of files the trigram is in
+ * @type: int
+ *
+ * @field capacity: the number of files there is room for
+ * @type: int
+ *
+ * @field sorted: whether the files are in order
+ * @type: int
+ *
+ * @field files: the files the trigram is in
+ * @type: int *
+*/
+struct CSourceSearchTrigram {
+    unsigned long key;
+    int length;
+    int capacity;
+    int sorted;
+    int *files;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the trigrams of an index that is being made
+ * @name: CSourceSearchTrigrams
+ *
+ * @field length: the number of trigrams
+ * @type: int
+ *
+ * @field capacity: the number of trigrams there is room for
+ * @type: int
+ *
+ * @field contents: the trigrams
+ * @type: struct CSourceSearchTrigram *
+*/
+struct CSourceSearchTrigrams {
+    int length;
+    int capacity;
+    struct CSourceSearchTrigram *contents;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the strings a search must find, every one of them, in a file
+ * @name: CSourceSearchLiterals
+ *
+ * @field length: the number of strings
+ * @type: int
+ *
+ * @field capacity: the number of strings there is room for
+ * @type: int
+ *
+ * @field contents: the strings
+ * @type: struct CString *
+*/
+struct CSourceSearchLiterals {
+    int length;
+    int capacity;
+    struct CString *contents;
+};
+
+/*
+ * @docgen: structure
+ * @brief: a trigram index that is being made
+ * @name: CSourceSearchBuilder
+ *
+ * @field table: the files of the index, which must be the first field
+ * @type: struct CSourceTable
+ *
+ * @field last: the index made last time, if table.last is not NULL
+ * @type: struct CSourceSearch
+ *
+ * @field trigrams: the trigrams of the index, in the order they were found
+ * @type: struct CSourceSearchTrigrams *
+ *
+ * @field buckets: a hash table of the trigrams, where -1 is an empty bucket
+ * @type: int *
+ *
+ * @field bucket_count: the number of buckets, which is a power of two
+ * @type: int
+*/
+struct CSourceSearchBuilder {
+    struct CSourceTable table;
+    struct CSourceSearch last;
+    struct CSourceSearchTrigrams *trigrams;
+    int *buckets;
+    int bucket_count;
+};
+
+/*
+ * @docgen: function
+ * @brief: open a trigram index
+ * @name: csource_search_open
+ *
+ * @description
+ * @Map a trigram index into memory, and check that it is whole, and of
+ * @the version of csource that is reading it.
+ * @description
+ *
+ * @error: search is NULL
+ * @error: path is NULL
+ *
+ * @param search: the index to open
+ * @type: struct CSourceSearch *
+ *
+ * @param path: the path of the index
+ * @type: const char *
+ *
+ * @return: 0 if the index could be opened, or -1 if it could not
+ * @type: int
+*/
+int csource_search_open(struct CSourceSearch *search, const char *path);
+
+/*
+ * @docgen: function
+ * @brief: close a trigram index
+ * @name: csource_search_close
+ *
+ * @error: search is NULL
+ *
+ * @param search: the index to close
+ * @type: struct CSourceSearch *
+*/
+void csource_search_close(struct CSourceSearch *search);
+
+/*
+ * @docgen: function
+ * @brief: determine whether a pattern can be searched for
+ * @name: csource_search_check
+ *
+ * @error: pattern is NULL
+ *
+ * @param pattern: the pattern
+ * @type: const char *
+ *
+ * @param search: how to search (CSOURCE_SEARCH_*)
+ * @type: int
+ *
+ * @return: 0 if the pattern can be searched for, or -1 if it cannot
+ * @type: int
+*/
+int csource_search_check(const char *pattern, int search);
+
+/*
+ * @docgen: function
+ * @brief: find the strings every match of a pattern has in it
+ * @name: csource_search_literals
+ *
+ * @description
+ * @Find the strings that are in every match of a pattern. A plain string
+ * @is the only one of its own. Of a regular expression, only the runs of
+ * @plain characters outside of groups and brackets are taken, without
+ * @any character a repetition could leave out, and an expression with an
+ * @alternative has none, since neither side has to match. A string with
+ * @fewer than three characters has no trigrams, and is left out.
+ * @description
+ *
+ * @error: pattern is NULL
+ *
+ * @param pattern: the pattern
+ * @type: const char *
+ *
+ * @param search: how to search (CSOURCE_SEARCH_*)
+ * @type: int
+ *
+ * @return: the strings, which may be none
+ * @type: struct CSourceSearchLiterals *
+*/
+struct CSourceSearchLiterals *csource_search_literals(const char *pattern, int search);
+
+/*
+ * @docgen: function
+ * @brief: find the files that could have a match in them
+ * @name: csource_search_candidates
+ *
+ * @description
+ * @Find the files of an index with every trigram of the literals of a
+ * @search. If there are no trigrams to look for, every file that was
+ * @indexed could have a match.
+ * @description
+ *
+ * @error: search is NULL
+ * @error: literals is NULL
+ * @error: count is NULL
+ *
+ * @param search: the index
+ * @type: const struct CSourceSearch *
+ *
+ * @param literals: the strings every match has in it
+ * @type: const struct CSourceSearchLiterals *
+ *
+ * @param variant: the variant to search (CSOURCE_SEARCH_RAW, CSOURCE_SEARCH_CODE)
+ * @type: int
+ *
+ * @param count: where to put the number of files
+ * @type: int *
+ *
+ * @return: the files, in order, which are released with csource_allocator
+ * @type: int *
+*/
+int *csource_search_candidates(const struct CSourceSearch *search,
+                               const struct CSourceSearchLiterals *literals, int variant,
+                               int *count);
+
+/*
+ * @docgen: function
+ * @brief: write the lines of a file that match a pattern
+ * @name: csource_search_lines
+ *
+ * @description
+ * @Write every line of a file that has the lookup of the setup in it,
+ * @as a plain string, or as a POSIX extended regular expression with
+ * @CSOURCE_SEARCH_REGEX. With CSOURCE_SEARCH_CODE, the comments of the
+ * @file are blanked first, so only its code is searched. Lines are written
+ * @like grep writes them, after the path of the file, or as match records.
+ * @description
+ *
+ * @param setup: the setup of the module
+ * @type: struct ModuleSetup
+*/
+void csource_search_lines(struct ModuleSetup setup);
+
+/*
+ * @docgen: function
+ * @brief: write the trigrams of a file for a trigram index
+ * @name: csource_search_file
+ *
+ * @description
+ * @Write the trigrams of a file, and of its code, the way
+ * @csource_search_read reads them, which is the path of the file, and
+ * @then each key. Like csource_index_file, this is not one of the
+ * @commands, and the text format must be used.
+ * @description
+ *
+ * @param setup: the setup of the module
+ * @type: struct ModuleSetup
+*/
+void csource_search_file(struct ModuleSetup setup);
+
+/*
+ * @docgen: function
+ * @brief: start making a trigram index
+ * @name: csource_search_builder_init
+ *
+ * @description
+ * @Start making a trigram index, from the one at its path if it can be
+ * @opened, the same way as csource_index_builder_init.
+ * @description
+ *
+ * @error: path is NULL
+ *
+ * @param path: the path of the index
+ * @type: const char *
+ *
+ * @return: the table of a new builder
+ * @type: struct CSourceTable *
+*/
+struct CSourceTable *csource_search_builder_init(const char *path);
+
+/*
+ * @docgen: function
+ * @brief: read the trigrams of files into an index that is being made
+ * @name: csource_search_read
+ *
+ * @description
+ * @Read what csource_search_file wrote for each file that needed to be
+ * @read. A file which is not there is kept out of the index until it can
+ * @be read.
+ * @description
+ *
+ * @error: table is NULL
+ * @error: stream is NULL
+ *
+ * @param table: the table of the builder to add the trigrams to
+ * @type: struct CSourceTable *
+ *
+ * @param stream: the stream to read from
+ * @type: FILE *
+ *
+ * @return: 0 if the trigrams could be read, or -1 if they are cut short
+ * @type: int
+*/
+int csource_search_read(struct CSourceTable *table, FILE *stream);
+
+/*
+ * @docgen: function
+ * @brief: write a trigram index that is being made
+ * @name: csource_search_write
+ *
+ * @description
+ * @Take the files of each trigram that did not change from the last
+ * @index, and write the index, first next to the path, and then over it.
+ * @description
+ *
+ * @error: table is NULL
+ * @error: path is NULL
+ *
+ * @param table: the table of the builder to write
+ * @type: struct CSourceTable *
+ *
+ * @param path: the path to write the index to
+ * @type: const char *
+ *
+ * @return: 0 if the index was written, or -1 if it could not be
+ * @type: int
+*/
+int csource_search_write(struct CSourceTable *table, const char *path);
+
+/*
+ * @docgen: function
+ * @brief: release a trigram index that is being made
+ * @name: csource_search_builder_free
+ *
+ * @description
+ * @Release a builder, and close the last index it was made from.
+ * @description
+ *
+ * @error: table is NULL
+ *
+ * @param table: the table of the builder to release
+ * @type: struct CSourceTable *
+*/
+void csource_search_builder_free(struct CSourceTable *table);
+
+#endif
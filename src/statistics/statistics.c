@@ -0,0 +1,202 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file deals with measuring a run of csource for --stats. Time is
+ * measured per phase by main and the output, while the allocation
+ * counters are kept by the libraries themselves and only collected
+ * once the run is over.
+*/
+
+#include <time.h>
+#include <string.h>
+
+/* Inclusions for the wall clock and resource usage */
+#if defined(__unix__) || defined(__CW_UNIXWARE__) || defined(__APPLE__)
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+#include "../csource.h"
+
+#include "statistics.h"
+
+struct CSourcePhase csource_phase_now(void) {
+    struct CSourcePhase now;
+
+#if defined(__unix__) || defined(__CW_UNIXWARE__) || defined(__APPLE__)
+    struct timeval time_of_day;
+
+    gettimeofday(&time_of_day, NULL);
+    now.wall = (double) time_of_day.tv_sec + (double) time_of_day.tv_usec / 1e6;
+#else
+    now.wall = (double) time(NULL);
+#endif
+
+    now.cpu = (double) clock() / CLOCKS_PER_SEC;
+
+    return now;
+}
+
+void csource_phase_add(struct CSourcePhase *phase, struct CSourcePhase start) {
+    struct CSourcePhase now = csource_phase_now();
+
+    liberror_is_null(csource_phase_add, phase);
+
+    phase->wall += now.wall - start.wall;
+    phase->cpu += now.cpu - start.cpu;
+}
+
+void csource_statistics_collect(struct CSourceStatistics *statistics) {
+#if defined(__unix__) || defined(__CW_UNIXWARE__) || defined(__APPLE__)
+    long peak_rss = 0;
+    struct rusage usage;
+#endif
+
+    liberror_is_null(csource_statistics_collect, statistics);
+
+    statistics->allocations += libmatch_statistics.allocations + cstring_statistics.allocations +
+                               csource_allocator_statistics.allocations;
+    statistics->reallocations += libmatch_statistics.reallocations +
+                                 cstring_statistics.reallocations +
+                                 csource_allocator_statistics.reallocations;
+    statistics->bytes_allocated += libmatch_statistics.bytes_allocated +
+                                   cstring_statistics.bytes_allocated +
+                                   csource_allocator_statistics.bytes_allocated;
+
+#if defined(__unix__) || defined(__CW_UNIXWARE__) || defined(__APPLE__)
+    if(getrusage(RUSAGE_SELF, &usage) == 0)
+        peak_rss = usage.ru_maxrss;
+
+/* Darwin reports the peak in bytes rather than kilobytes */
+#if defined(__APPLE__)
+    peak_rss /= 1024;
+#endif
+
+    if(peak_rss > statistics->peak_rss)
+        statistics->peak_rss = peak_rss;
+#endif
+}
+
+void csource_statistics_reset(void) {
+    INIT_VARIABLE(libmatch_statistics);
+    INIT_VARIABLE(cstring_statistics);
+    INIT_VARIABLE(csource_allocator_statistics);
+}
+
+void csource_statistics_merge(struct CSourceStatistics *statistics, struct CSourceStatistics other) {
+    liberror_is_null(csource_statistics_merge, statistics);
+
+    statistics->ingest.wall += other.ingest.wall;
+    statistics->ingest.cpu += other.ingest.cpu;
+    statistics->scan.wall += other.scan.wall;
+    statistics->scan.cpu += other.scan.cpu;
+    statistics->emit.wall += other.emit.wall;
+    statistics->emit.cpu += other.emit.cpu;
+
+    statistics->bytes_in += other.bytes_in;
+    statistics->bytes_out += other.bytes_out;
+    statistics->files += other.files;
+    statistics->failed += other.failed;
+    statistics->lines += other.lines;
+
+    statistics->allocations += other.allocations;
+    statistics->reallocations += other.reallocations;
+    statistics->bytes_allocated += other.bytes_allocated;
+
+    if(other.peak_rss > statistics->peak_rss)
+        statistics->peak_rss = other.peak_rss;
+
+    statistics->counts.code += other.counts.code;
+    statistics->counts.comment += other.counts.comment;
+    statistics->counts.blank += other.counts.blank;
+    statistics->counts.directive += other.counts.directive;
+    statistics->counts.functions += other.counts.functions;
+    statistics->counts.includes += other.counts.includes;
+}
+
+/*
+ * @docgen: function
+ * @brief: write the time of a phase in a human readable form
+ * @name: write_phase
+ *
+ * @param stream: the stream to write to
+ * @type: FILE *
+ *
+ * @param name: the name of the phase
+ * @type: const char *
+ *
+ * @param phase: the phase to write
+ * @type: struct CSourcePhase
+*/
+static void write_phase(FILE *stream, const char *name, struct CSourcePhase phase) {
+    fprintf(stream, "%-16s %12.6f s wall %12.6f s cpu\n", name, phase.wall, phase.cpu);
+}
+
+void csource_statistics_write(FILE *stream, struct CSourceStatistics statistics, int format) {
+    liberror_is_null(csource_statistics_write, stream);
+
+    if(format == CSOURCE_STATISTICS_JSON) {
+        fprintf(stream, "{\"ingest\":{\"wall\":%.6f,\"cpu\":%.6f},", statistics.ingest.wall,
+                statistics.ingest.cpu);
+        fprintf(stream, "\"scan\":{\"wall\":%.6f,\"cpu\":%.6f},", statistics.scan.wall,
+                statistics.scan.cpu);
+        fprintf(stream, "\"emit\":{\"wall\":%.6f,\"cpu\":%.6f},", statistics.emit.wall,
+                statistics.emit.cpu);
+        fprintf(stream, "\"bytes_in\":%lu,\"bytes_out\":%lu,\"files\":%lu,\"failed\":%lu,",
+                statistics.bytes_in, statistics.bytes_out, statistics.files, statistics.failed);
+        fprintf(stream, "\"lines\":%lu,", statistics.lines);
+        fprintf(stream, "\"allocations\":%lu,\"reallocations\":%lu,\"bytes_allocated\":%lu,",
+                statistics.allocations, statistics.reallocations, statistics.bytes_allocated);
+        fprintf(stream, "\"peak_rss_kb\":%li}\n", statistics.peak_rss);
+
+        return;
+    }
+
+    write_phase(stream, "ingest", statistics.ingest);
+    write_phase(stream, "scan", statistics.scan);
+    write_phase(stream, "emit", statistics.emit);
+    fprintf(stream, "%-16s %12lu\n", "bytes in", statistics.bytes_in);
+    fprintf(stream, "%-16s %12lu\n", "bytes out", statistics.bytes_out);
+    fprintf(stream, "%-16s %12lu\n", "files", statistics.files);
+    fprintf(stream, "%-16s %12lu\n", "failed", statistics.failed);
+    fprintf(stream, "%-16s %12lu\n", "lines", statistics.lines);
+    fprintf(stream, "%-16s %12lu\n", "allocations", statistics.allocations);
+    fprintf(stream, "%-16s %12lu\n", "reallocations", statistics.reallocations);
+    fprintf(stream, "%-16s %12lu\n", "bytes allocated", statistics.bytes_allocated);
+    fprintf(stream, "%-16s %12li KB\n", "peak rss", statistics.peak_rss);
+}
@@ -0,0 +1,260 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_CSOURCE_STATISTICS_H
+#define CWARE_CSOURCE_STATISTICS_H
+
+#include <stdio.h>
+
+/* Statistics formats */
+#define CSOURCE_STATISTICS_TEXT 0
+#define CSOURCE_STATISTICS_JSON 1
+
+/*
+ * @docgen: structure
+ * @brief: the time spent in a phase of a run
+ * @name: CSourcePhase
+ *
+ * @field wall: wall clock time in seconds
+ * @type: double
+ *
+ * @field cpu: processor time in seconds
+ * @type: double
+*/
+struct CSourcePhase {
+    double wall;
+    double cpu;
+};
+
+/*
+ * @docgen: structure
+ * @brief: what the source files of a run are made of
+ * @name: CSourceCounts
+ *
+ * @description
+ * @Every line is exactly one of code, comment, blank or directive. A line
+ * @with code and a comment on it is code, and a line a directive is
+ * @continued onto is a directive.
+ * @description
+ *
+ * @field code: lines with code on them
+ * @type: unsigned long
+ *
+ * @field comment: lines with nothing but comments on them
+ * @type: unsigned long
+ *
+ * @field blank: lines with nothing but whitespace on them
+ * @type: unsigned long
+ *
+ * @field directive: lines of preprocessor directives
+ * @type: unsigned long
+ *
+ * @field functions: function definitions
+ * @type: unsigned long
+ *
+ * @field includes: inclusions
+ * @type: unsigned long
+*/
+struct CSourceCounts {
+    unsigned long code;
+    unsigned long comment;
+    unsigned long blank;
+    unsigned long directive;
+    unsigned long functions;
+    unsigned long includes;
+};
+
+/*
+ * @docgen: structure
+ * @brief: measurements of a run of csource
+ * @name: CSourceStatistics
+ *
+ * @field ingest: time spent reading input
+ * @type: struct CSourcePhase
+ *
+ * @field scan: time spent inside of the modules, without writing output
+ * @type: struct CSourcePhase
+ *
+ * @field emit: time spent writing output
+ * @type: struct CSourcePhase
+ *
+ * @field bytes_in: the number of bytes read
+ * @type: unsigned long
+ *
+ * @field bytes_out: the number of bytes written
+ * @type: unsigned long
+ *
+ * @field files: the number of files processed
+ * @type: unsigned long
+ *
+ * @field failed: the number of files that failed, and were not processed
+ * @type: unsigned long
+ *
+ * @field lines: the number of lines processed
+ * @type: unsigned long
+ *
+ * @field allocations: the number of allocations made by csource and its libraries
+ * @type: unsigned long
+ *
+ * @field reallocations: the number of reallocations made by csource and its libraries
+ * @type: unsigned long
+ *
+ * @field bytes_allocated: the number of bytes requested by csource and its libraries
+ * @type: unsigned long
+ *
+ * @field peak_rss: the peak resident set size in kilobytes, or 0 if unknown
+ * @type: long
+ *
+ * @field counts: what the source files are made of, if it was counted
+ * @type: struct CSourceCounts
+*/
+struct CSourceStatistics {
+    struct CSourcePhase ingest;
+    struct CSourcePhase scan;
+    struct CSourcePhase emit;
+
+    unsigned long bytes_in;
+    unsigned long bytes_out;
+    unsigned long files;
+    unsigned long failed;
+    unsigned long lines;
+
+    unsigned long allocations;
+    unsigned long reallocations;
+    unsigned long bytes_allocated;
+    long peak_rss;
+
+    struct CSourceCounts counts;
+};
+
+/*
+ * @docgen: function
+ * @brief: get the current time of both clocks
+ * @name: csource_phase_now
+ *
+ * @return: the current wall clock and processor time
+ * @type: struct CSourcePhase
+*/
+struct CSourcePhase csource_phase_now(void);
+
+/*
+ * @docgen: function
+ * @brief: add the time since a starting point to a phase
+ * @name: csource_phase_add
+ *
+ * @error: phase is NULL
+ *
+ * @param phase: the phase to add to
+ * @type: struct CSourcePhase *
+ *
+ * @param start: the time returned by csource_phase_now at the start
+ * @type: struct CSourcePhase
+*/
+void csource_phase_add(struct CSourcePhase *phase, struct CSourcePhase start);
+
+/*
+ * @docgen: function
+ * @brief: collect the counters of the libraries
+ * @name: csource_statistics_collect
+ *
+ * @description
+ * @Add the allocation counters from libmatch, cstring, and the allocator
+ * @of csource to the statistics, and raise the peak resident set size to
+ * @that of the process if it is higher. This should be called once the
+ * @run is over.
+ * @description
+ *
+ * @error: statistics is NULL
+ *
+ * @param statistics: the statistics to fill in
+ * @type: struct CSourceStatistics *
+*/
+void csource_statistics_collect(struct CSourceStatistics *statistics);
+
+/*
+ * @docgen: function
+ * @brief: reset the counters of the libraries
+ * @name: csource_statistics_reset
+ *
+ * @description
+ * @Zero the allocation counters of libmatch, cstring, and the allocator of
+ * @csource. A worker process calls this when it starts, so what its parent
+ * @allocated before it was started is not counted twice.
+ * @description
+*/
+void csource_statistics_reset(void);
+
+/*
+ * @docgen: function
+ * @brief: add the statistics of one run to another
+ * @name: csource_statistics_merge
+ *
+ * @description
+ * @Add the times and counters of a run to the statistics of another. The
+ * @peak resident set size is the higher of the two, since the runs are in
+ * @separate processes.
+ * @description
+ *
+ * @error: statistics is NULL
+ *
+ * @param statistics: the statistics to add to
+ * @type: struct CSourceStatistics *
+ *
+ * @param other: the statistics to add
+ * @type: struct CSourceStatistics
+*/
+void csource_statistics_merge(struct CSourceStatistics *statistics, struct CSourceStatistics other);
+
+/*
+ * @docgen: function
+ * @brief: write statistics in a human or machine readable form
+ * @name: csource_statistics_write
+ *
+ * @error: stream is NULL
+ *
+ * @param stream: the stream to write to
+ * @type: FILE *
+ *
+ * @param statistics: the statistics to write
+ * @type: struct CSourceStatistics
+ *
+ * @param format: CSOURCE_STATISTICS_TEXT or CSOURCE_STATISTICS_JSON
+ * @type: int
+*/
+void csource_statistics_write(FILE *stream, struct CSourceStatistics statistics, int format);
+
+#endif
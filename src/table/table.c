@@ -0,0 +1,403 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file implements the table of files that the index of symbols and
+ * the trigram index share, which is laid out in table.h, and the rest of
+ * making either of them again from the last one.
+*/
+
+#include <limits.h>
+#include <string.h>
+
+#include "../csource.h"
+#include "../common/common.h"
+#include "../output/output.h"
+
+#include "table.h"
+
+/*
+ * @docgen: function
+ * @brief: find an entry of the files of an index
+ * @name: file_entry
+ *
+ * @param view: the files of the index
+ * @type: const struct CSourceTableView *
+ *
+ * @param file: the number of the file
+ * @type: unsigned long
+ *
+ * @return: the entry of the file
+ * @type: const char *
+*/
+static const char *file_entry(const struct CSourceTableView *view, unsigned long file) {
+    return view->entries + file * CSOURCE_TABLE_FILE_SIZE;
+}
+
+/*
+ * @docgen: function
+ * @brief: find a file of an index that is being made by its path
+ * @name: find_builder_file
+ *
+ * @param table: the table
+ * @type: const struct CSourceTable *
+ *
+ * @param path: the path of the file
+ * @type: const char *
+ *
+ * @return: the number of the file, or -1 if the table does not have it
+ * @type: int
+*/
+static int find_builder_file(const struct CSourceTable *table, const char *path) {
+    int low = 0;
+    int high = table->files->length;
+
+    while(low < high) {
+        int middle = low + (high - low) / 2;
+        int order = strcmp(path, table->files->contents[middle].path.contents);
+
+        if(order == 0)
+            return middle;
+
+        if(order < 0)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+
+    return -1;
+}
+
+/*
+ * @docgen: function
+ * @brief: make the path a new index is written to before it is moved
+ * @name: temporary_path
+ *
+ * @param path: the path of the index
+ * @type: const char *
+ *
+ * @return: the path to write the new index to
+ * @type: struct CString
+*/
+static struct CString temporary_path(const char *path) {
+    struct CString temporary = cstring_init(path);
+
+    cstring_concats(&temporary, ".tmp");
+
+    return temporary;
+}
+
+const char *csource_table_path(const struct CSourceTableView *view, unsigned long file) {
+    unsigned long offset = 0;
+
+    liberror_is_null(csource_table_path, view);
+
+    offset = csource_read_unsigned(file_entry(view, file), 4);
+
+    /* The strings end with a NUL, so only the offset needs checking */
+    if(offset >= view->length)
+        return "";
+
+    return view->strings + offset;
+}
+
+long csource_table_find(const struct CSourceTableView *view, const char *path) {
+    unsigned long low = 0;
+    unsigned long high = 0;
+
+    liberror_is_null(csource_table_find, view);
+    liberror_is_null(csource_table_find, path);
+
+    high = view->files;
+
+    while(low < high) {
+        unsigned long middle = low + (high - low) / 2;
+        int order = strcmp(path, csource_table_path(view, middle));
+
+        if(order == 0)
+            return (long) middle;
+
+        if(order < 0)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+
+    return -1;
+}
+
+void csource_table_init(struct CSourceTable *table, const struct CSourceTableView *last) {
+    unsigned long index = 0;
+
+    liberror_is_null(csource_table_init, table);
+
+    INIT_VARIABLE(*table);
+
+    table->files = carray_init(table->files, TABLE_FILE);
+    table->last = last;
+
+    if(last == NULL || last->files == 0)
+        return;
+
+    table->reused = csource_allocator.allocate(sizeof(int) * last->files);
+
+    for(index = 0; index < last->files; index++)
+        table->reused[index] = -1;
+}
+
+int csource_table_add_file(struct CSourceTable *table, const char *path, long size,
+                           long modified) {
+    long found = 0;
+    struct CSourceTableFile file;
+
+    liberror_is_null(csource_table_add_file, table);
+    liberror_is_null(csource_table_add_file, path);
+
+    file.path = cstring_init(path);
+    file.size = size;
+    file.modified = modified;
+    file.pending = 1;
+
+    if(table->reused != NULL && (found = csource_table_find(table->last, path)) != -1) {
+        const char *entry = file_entry(table->last, (unsigned long) found);
+
+        if((long) csource_read_unsigned(entry + 8, 8) == size && size != CSOURCE_TABLE_FAILED &&
+           (long) csource_read_unsigned(entry + 16, 8) == modified) {
+            table->reused[found] = table->files->length;
+            file.pending = 0;
+        }
+    }
+
+    carray_append(table->files, file, TABLE_FILE);
+
+    return file.pending;
+}
+
+int csource_table_unchanged(const struct CSourceTable *table) {
+    int index = 0;
+
+    liberror_is_null(csource_table_unchanged, table);
+
+    if(table->last == NULL || (unsigned long) table->files->length != table->last->files)
+        return 0;
+
+    for(index = 0; index < table->files->length; index++) {
+        if(table->files->contents[index].pending == 1)
+            return 0;
+    }
+
+    return 1;
+}
+
+int csource_table_reused(const struct CSourceTable *table, unsigned long file) {
+    liberror_is_null(csource_table_reused, table);
+
+    if(table->reused == NULL || file >= table->last->files)
+        return -1;
+
+    return table->reused[file];
+}
+
+const char *csource_table_read_text(struct CSourceTable *table, FILE *stream,
+                                    unsigned long length) {
+    liberror_is_null(csource_table_read_text, table);
+    liberror_is_null(csource_table_read_text, stream);
+
+    if(length > INT_MAX)
+        return NULL;
+
+    if(length + 1 > table->capacity) {
+        table->capacity = length + 1;
+        table->text = csource_allocator.reallocate(table->text, table->capacity);
+    }
+
+    if(fread(table->text, 1, length, stream) != length)
+        return NULL;
+
+    table->text[length] = '\0';
+
+    return table->text;
+}
+
+int csource_table_read(struct CSourceTable *table, FILE *stream,
+                       int (*read_file)(struct CSourceTable *table, FILE *stream, int file)) {
+    int file = 0;
+    int index = 0;
+    int status = 0;
+    unsigned long length = 0;
+    const char *path = NULL;
+
+    liberror_is_null(csource_table_read, table);
+    liberror_is_null(csource_table_read, stream);
+    liberror_is_null(csource_table_read, read_file);
+
+    while((status = csource_read_number(stream, &length)) == 0) {
+        if((path = csource_table_read_text(table, stream, length)) == NULL) {
+            status = -1;
+            break;
+        }
+
+        /* Each file that needed to be read is only there once */
+        if((file = find_builder_file(table, path)) == -1 ||
+           table->files->contents[file].pending == 0) {
+            status = -1;
+            break;
+        }
+
+        table->files->contents[file].pending = 0;
+
+        if((status = read_file(table, stream, file)) == -1)
+            break;
+    }
+
+    /* A file that is not there could not be read, and is kept out of the
+     * index by a size no file has, so that it is read again next time */
+    for(index = 0; index < table->files->length; index++) {
+        if(table->files->contents[index].pending == 0)
+            continue;
+
+        table->files->contents[index].size = CSOURCE_TABLE_FAILED;
+        table->files->contents[index].pending = 0;
+    }
+
+    return status == -1 ? -1 : 0;
+}
+
+void csource_table_write_number(struct CSourceOutput *output, unsigned long value) {
+    char bytes[4];
+
+    liberror_is_null(csource_table_write_number, output);
+
+    csource_encode_unsigned(bytes, value, 4);
+    csource_output_span(output, bytes, 4, 0, 0);
+}
+
+void csource_table_write_path(struct CSourceOutput *output, const char *path) {
+    liberror_is_null(csource_table_write_path, output);
+    liberror_is_null(csource_table_write_path, path);
+
+    csource_table_write_number(output, strlen(path));
+    csource_output_span(output, path, strlen(path), 0, 0);
+}
+
+unsigned long csource_table_paths(const struct CSourceTable *table) {
+    int index = 0;
+    unsigned long paths = 0;
+
+    liberror_is_null(csource_table_paths, table);
+
+    for(index = 0; index < table->files->length; index++)
+        paths += table->files->contents[index].path.length + 1;
+
+    return paths;
+}
+
+void csource_table_write_files(const struct CSourceTable *table, FILE *stream) {
+    int index = 0;
+    unsigned long paths = 0;
+
+    liberror_is_null(csource_table_write_files, table);
+    liberror_is_null(csource_table_write_files, stream);
+
+    for(index = 0; index < table->files->length; index++) {
+        struct CSourceTableFile file = table->files->contents[index];
+
+        csource_write_unsigned(stream, paths, 4);
+        csource_write_unsigned(stream, 0, 4);
+        csource_write_unsigned(stream, (unsigned long) file.size, 8);
+        csource_write_unsigned(stream, (unsigned long) file.modified, 8);
+        paths += file.path.length + 1;
+    }
+}
+
+void csource_table_write_paths(const struct CSourceTable *table, FILE *stream) {
+    int index = 0;
+
+    liberror_is_null(csource_table_write_paths, table);
+    liberror_is_null(csource_table_write_paths, stream);
+
+    for(index = 0; index < table->files->length; index++)
+        fwrite(table->files->contents[index].path.contents, 1,
+               table->files->contents[index].path.length + 1, stream);
+}
+
+FILE *csource_table_create(const char *path) {
+    FILE *stream = NULL;
+    struct CString temporary;
+
+    liberror_is_null(csource_table_create, path);
+
+    temporary = temporary_path(path);
+    stream = fopen(temporary.contents, "wb");
+    cstring_free(temporary);
+
+    return stream;
+}
+
+int csource_table_replace(FILE *stream, const char *path) {
+    int failed = 0;
+    struct CString temporary;
+
+    liberror_is_null(csource_table_replace, stream);
+    liberror_is_null(csource_table_replace, path);
+
+    temporary = temporary_path(path);
+    failed = ferror(stream) != 0;
+    failed = fclose(stream) != 0 || failed;
+
+    /* The index is only replaced once the new one is whole */
+    if(failed == 1 || rename(temporary.contents, path) != 0) {
+        remove(temporary.contents);
+        failed = 1;
+    }
+
+    cstring_free(temporary);
+
+    return failed == 1 ? -1 : 0;
+}
+
+void csource_table_free(struct CSourceTable *table) {
+    liberror_is_null(csource_table_free, table);
+
+    carray_free(table->files, TABLE_FILE);
+
+    if(table->reused != NULL)
+        csource_allocator.release(table->reused);
+
+    if(table->text != NULL)
+        csource_allocator.release(table->text);
+}
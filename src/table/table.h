@@ -0,0 +1,504 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * The table of files that the index of symbols and the trigram index
+ * share, and the rest of what making either of them again without
+ * reading every file takes. Both kinds of index lay their files out the
+ * same way, 24 bytes each, in the order of their paths:
+ *
+ *     u32  offset of the path in the strings
+ *     u32  0
+ *     u64  size of the file, or all ones if it could not be indexed
+ *     u64  time the file was last modified
+ *
+ * Files are compared by their size and the time they were modified, so
+ * that only the ones which changed since an index was made are read
+ * again when it is made again. The workers that read them write the
+ * path of each file, and then whatever the kind of index keeps of it.
+*/
+
+#ifndef CWARE_CSOURCE_TABLE_H
+#define CWARE_CSOURCE_TABLE_H
+
+#include <stdio.h>
+
+/* Data structure properties */
+#define TABLE_FILE_TYPE     struct CSourceTableFile
+#define TABLE_FILE_HEAP     1
+#define TABLE_FILE_FREE(value) cstring_free((value).path)
+
+/* The size of an entry of the files of an index */
+#define CSOURCE_TABLE_FILE_SIZE 24
+
+/* The size of a file that could not be indexed, which no file has */
+#define CSOURCE_TABLE_FAILED    -1L
+
+struct CSourceOutput;
+
+/*
+ * @docgen: structure
+ * @brief: the files of an index, mapped into memory
+ * @name: CSourceTableView
+ *
+ * @field entries: the first entry of the files
+ * @type: const char *
+ *
+ * @field files: the number of files
+ * @type: unsigned long
+ *
+ * @field strings: the strings the paths are in
+ * @type: const char *
+ *
+ * @field length: the number of bytes in the strings
+ * @type: unsigned long
+*/
+struct CSourceTableView {
+    const char *entries;
+    unsigned long files;
+    const char *strings;
+    unsigned long length;
+};
+
+/*
+ * @docgen: structure
+ * @brief: a file of an index that is being made
+ * @name: CSourceTableFile
+ *
+ * @field path: the path of the file
+ * @type: struct CString
+ *
+ * @field size: the size of the file, or -1 if it could not be indexed
+ * @type: long
+ *
+ * @field modified: the time the file was last modified
+ * @type: long
+ *
+ * @field pending: whether what is kept of the file is still to come
+ * @type: int
+*/
+struct CSourceTableFile {
+    struct CString path;
+    long size;
+    long modified;
+    int pending;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the files of an index that is being made
+ * @name: CSourceTableFiles
+ *
+ * @field length: the number of files
+ * @type: int
+ *
+ * @field capacity: the number of files there is room for
+ * @type: int
+ *
+ * @field contents: the files
+ * @type: struct CSourceTableFile *
+*/
+struct CSourceTableFiles {
+    int length;
+    int capacity;
+    struct CSourceTableFile *contents;
+};
+
+/*
+ * @docgen: structure
+ * @brief: the files of an index that is being made, and of the last one
+ * @name: CSourceTable
+ *
+ * @description
+ * @The files of an index that is being made. Each kind of index keeps
+ * @this as the first field of its builder, so that the builder can be
+ * @handled as its table by whatever does not need to know the kind.
+ * @description
+ *
+ * @field files: the files of the index, in the order of their paths
+ * @type: struct CSourceTableFiles *
+ *
+ * @field last: the files of the index made last time, or NULL
+ * @type: const struct CSourceTableView *
+ *
+ * @field reused: the file each file of the last index is now, or -1
+ * @type: int *
+ *
+ * @field text: a buffer to read the strings of the workers into
+ * @type: char *
+ *
+ * @field capacity: the size of the buffer
+ * @type: unsigned long
+*/
+struct CSourceTable {
+    struct CSourceTableFiles *files;
+    const struct CSourceTableView *last;
+    int *reused;
+    char *text;
+    unsigned long capacity;
+};
+
+/*
+ * @docgen: function
+ * @brief: find the path of a file of an index
+ * @name: csource_table_path
+ *
+ * @description
+ * @Find the path of a file by its number. The strings end with a NUL, so
+ * @an offset past them is the only way a path could be out of bounds, and
+ * @is taken as an empty path.
+ * @description
+ *
+ * @error: view is NULL
+ *
+ * @param view: the files of the index
+ * @type: const struct CSourceTableView *
+ *
+ * @param file: the number of the file
+ * @type: unsigned long
+ *
+ * @return: the path of the file
+ * @type: const char *
+*/
+const char *csource_table_path(const struct CSourceTableView *view, unsigned long file);
+
+/*
+ * @docgen: function
+ * @brief: find a file of an index by its path
+ * @name: csource_table_find
+ *
+ * @error: view is NULL
+ * @error: path is NULL
+ *
+ * @param view: the files of the index
+ * @type: const struct CSourceTableView *
+ *
+ * @param path: the path of the file
+ * @type: const char *
+ *
+ * @return: the number of the file, or -1 if the index does not have it
+ * @type: long
+*/
+long csource_table_find(const struct CSourceTableView *view, const char *path);
+
+/*
+ * @docgen: function
+ * @brief: start the files of an index that is being made
+ * @name: csource_table_init
+ *
+ * @error: table is NULL
+ *
+ * @param table: the table to start
+ * @type: struct CSourceTable *
+ *
+ * @param last: the files of the index made last time, or NULL
+ * @type: const struct CSourceTableView *
+*/
+void csource_table_init(struct CSourceTable *table, const struct CSourceTableView *last);
+
+/*
+ * @docgen: function
+ * @brief: add a file to an index that is being made
+ * @name: csource_table_add_file
+ *
+ * @description
+ * @Add a file to an index. If the last index has the file, with the same
+ * @size and time of modification, what it keeps of the file is taken from
+ * @there, and the file does not need to be read. Files must be added in
+ * @the order of their paths, as they are in a tree.
+ * @description
+ *
+ * @error: table is NULL
+ * @error: path is NULL
+ *
+ * @param table: the table to add the file to
+ * @type: struct CSourceTable *
+ *
+ * @param path: the path of the file
+ * @type: const char *
+ *
+ * @param size: the size of the file
+ * @type: long
+ *
+ * @param modified: the time the file was last modified
+ * @type: long
+ *
+ * @return: 1 if the file needs to be read, or 0 if it does not
+ * @type: int
+*/
+int csource_table_add_file(struct CSourceTable *table, const char *path, long size,
+                           long modified);
+
+/*
+ * @docgen: function
+ * @brief: determine whether the files are those of the last index
+ * @name: csource_table_unchanged
+ *
+ * @error: table is NULL
+ *
+ * @param table: the table
+ * @type: const struct CSourceTable *
+ *
+ * @return: 1 if every file is in the last index as it is, and it has no others
+ * @type: int
+*/
+int csource_table_unchanged(const struct CSourceTable *table);
+
+/*
+ * @docgen: function
+ * @brief: find what a file of the last index is now
+ * @name: csource_table_reused
+ *
+ * @error: table is NULL
+ *
+ * @param table: the table
+ * @type: const struct CSourceTable *
+ *
+ * @param file: the number of the file in the last index
+ * @type: unsigned long
+ *
+ * @return: the number of the file now, or -1 if it is gone, or changed
+ * @type: int
+*/
+int csource_table_reused(const struct CSourceTable *table, unsigned long file);
+
+/*
+ * @docgen: function
+ * @brief: read a string the workers wrote
+ * @name: csource_table_read_text
+ *
+ * @description
+ * @Read a string into the buffer of the table, which is grown to fit, and
+ * @end it with a NUL. The string is only there until the next one is read.
+ * @description
+ *
+ * @error: table is NULL
+ * @error: stream is NULL
+ *
+ * @param table: the table whose buffer to read into
+ * @type: struct CSourceTable *
+ *
+ * @param stream: the stream to read from
+ * @type: FILE *
+ *
+ * @param length: the length of the string
+ * @type: unsigned long
+ *
+ * @return: the string, or NULL if it was cut short
+ * @type: const char *
+*/
+const char *csource_table_read_text(struct CSourceTable *table, FILE *stream,
+                                    unsigned long length);
+
+/*
+ * @docgen: function
+ * @brief: read what the workers wrote of each file
+ * @name: csource_table_read
+ *
+ * @description
+ * @Read the path of each file the workers wrote, and have the kind of
+ * @index read the rest. Each file that needed to be read is only there
+ * @once. A file which is not there, because it could not be read, is kept
+ * @out of the index by a size no file has, so that it is read again the
+ * @next time the index is made.
+ * @description
+ *
+ * @error: table is NULL
+ * @error: stream is NULL
+ * @error: read_file is NULL
+ *
+ * @param table: the table
+ * @type: struct CSourceTable *
+ *
+ * @param stream: the stream to read from
+ * @type: FILE *
+ *
+ * @param read_file: reads the rest of a file, returning 0, or -1 if it could not
+ * @type: int (*)(struct CSourceTable *, FILE *, int)
+ *
+ * @return: 0 if everything was read, or -1 if it was not
+ * @type: int
+*/
+int csource_table_read(struct CSourceTable *table, FILE *stream,
+                       int (*read_file)(struct CSourceTable *table, FILE *stream, int file));
+
+/*
+ * @docgen: function
+ * @brief: write a 32 bit little endian unsigned integer for the workers
+ * @name: csource_table_write_number
+ *
+ * @error: output is NULL
+ *
+ * @param output: the record stream to write to
+ * @type: struct CSourceOutput *
+ *
+ * @param value: the integer
+ * @type: unsigned long
+*/
+void csource_table_write_number(struct CSourceOutput *output, unsigned long value);
+
+/*
+ * @docgen: function
+ * @brief: write the path of a file for the workers
+ * @name: csource_table_write_path
+ *
+ * @description
+ * @Write the path of a file the way csource_table_read reads it, which
+ * @is what a worker writes of a file before anything else.
+ * @description
+ *
+ * @error: output is NULL
+ * @error: path is NULL
+ *
+ * @param output: the record stream to write to
+ * @type: struct CSourceOutput *
+ *
+ * @param path: the path
+ * @type: const char *
+*/
+void csource_table_write_path(struct CSourceOutput *output, const char *path);
+
+/*
+ * @docgen: function
+ * @brief: count the bytes of the paths of an index that is being made
+ * @name: csource_table_paths
+ *
+ * @error: table is NULL
+ *
+ * @param table: the table
+ * @type: const struct CSourceTable *
+ *
+ * @return: the number of bytes the paths take in the strings
+ * @type: unsigned long
+*/
+unsigned long csource_table_paths(const struct CSourceTable *table);
+
+/*
+ * @docgen: function
+ * @brief: write the files of an index
+ * @name: csource_table_write_files
+ *
+ * @description
+ * @Write the entries of the files, with the offsets of the paths counted
+ * @from the first path. The paths are written by csource_table_write_paths.
+ * @description
+ *
+ * @error: table is NULL
+ * @error: stream is NULL
+ *
+ * @param table: the table
+ * @type: const struct CSourceTable *
+ *
+ * @param stream: the stream to write to
+ * @type: FILE *
+*/
+void csource_table_write_files(const struct CSourceTable *table, FILE *stream);
+
+/*
+ * @docgen: function
+ * @brief: write the paths of the files of an index
+ * @name: csource_table_write_paths
+ *
+ * @error: table is NULL
+ * @error: stream is NULL
+ *
+ * @param table: the table
+ * @type: const struct CSourceTable *
+ *
+ * @param stream: the stream to write to
+ * @type: FILE *
+*/
+void csource_table_write_paths(const struct CSourceTable *table, FILE *stream);
+
+/*
+ * @docgen: function
+ * @brief: open the file a new index is written to
+ * @name: csource_table_create
+ *
+ * @description
+ * @Open a file next to the path of an index to write a new one to, which
+ * @csource_table_replace then moves over it, so that a reader never sees
+ * @half of an index.
+ * @description
+ *
+ * @error: path is NULL
+ *
+ * @param path: the path of the index
+ * @type: const char *
+ *
+ * @return: the stream to write the index to, or NULL if it could not be opened
+ * @type: FILE *
+*/
+FILE *csource_table_create(const char *path);
+
+/*
+ * @docgen: function
+ * @brief: replace an index with the one that was written
+ * @name: csource_table_replace
+ *
+ * @description
+ * @Close the stream of a new index, and move it over the index, unless it
+ * @could not be written whole, in which case it is removed instead.
+ * @description
+ *
+ * @error: stream is NULL
+ * @error: path is NULL
+ *
+ * @param stream: the stream returned by csource_table_create
+ * @type: FILE *
+ *
+ * @param path: the path of the index
+ * @type: const char *
+ *
+ * @return: 0 if the index was replaced, or -1 if it was not
+ * @type: int
+*/
+int csource_table_replace(FILE *stream, const char *path);
+
+/*
+ * @docgen: function
+ * @brief: release the files of an index that is being made
+ * @name: csource_table_free
+ *
+ * @error: table is NULL
+ *
+ * @param table: the table to release
+ * @type: struct CSourceTable *
+*/
+void csource_table_free(struct CSourceTable *table);
+
+#endif
@@ -0,0 +1,1022 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file deals with finding the source files in a tree, and running
+ * a command over them in parallel. See tree.h for how the work is split.
+*/
+
+/* Processes and directories are POSIX, not ANSI */
+#if defined(__unix__) || defined(__CW_UNIXWARE__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200112L
+#define CSOURCE_TREE_POSIX
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(CSOURCE_TREE_POSIX)
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/types.h>
+#endif
+
+#include "../csource.h"
+
+#include "tree.h"
+#include "../statistics/statistics.h"
+
+/* Size of the chunks worker output is copied to the stream in */
+#define TREE_COPY_SIZE  65536
+
+/* Size of the start and end of a file that are hashed to find its copies */
+#define TREE_SAMPLE_SIZE    512
+
+/* Data structure properties */
+#define TREE_CONTENTS_TYPE  struct TreeContents
+#define TREE_CONTENTS_HEAP  1
+#define TREE_CONTENTS_FREE(value)
+
+/*
+ * @docgen: structure
+ * @brief: what is known of the contents of a file of a tree
+ * @name: TreeContents
+ *
+ * @field index: the index of the file in the tree
+ * @type: int
+ *
+ * @field size: the size of the file in bytes
+ * @type: long
+ *
+ * @field hash: the hash of the start and end of the file, or 0 if it is not read
+ * @type: unsigned long
+*/
+struct TreeContents {
+    int index;
+    long size;
+    unsigned long hash;
+};
+
+/*
+ * @docgen: structure
+ * @brief: an array of what is known of the contents of files
+ * @name: TreeContentsArray
+ *
+ * @field length: the number of files
+ * @type: int
+ *
+ * @field capacity: the capacity of the array
+ * @type: int
+ *
+ * @field contents: the files
+ * @type: struct TreeContents *
+*/
+struct TreeContentsArray {
+    int length;
+    int capacity;
+    struct TreeContents *contents;
+};
+
+/*
+ * @docgen: function
+ * @brief: determine if a file name is a C source file or header
+ * @name: is_source
+ *
+ * @param name: the name of the file
+ * @type: const char *
+ *
+ * @return: 1 if it is a source file or header, 0 if it is not
+ * @type: int
+*/
+static int is_source(const char *name) {
+    int length = strlen(name);
+
+    if(length < 3 || name[length - 2] != '.')
+        return 0;
+
+    return name[length - 1] == 'c' || name[length - 1] == 'h';
+}
+
+static int compare_files(const void *a, const void *b) {
+    const struct CSourceTreeFile *file_a = a;
+    const struct CSourceTreeFile *file_b = b;
+
+    return strcmp(file_a->path.contents, file_b->path.contents);
+}
+
+#if defined(CSOURCE_TREE_POSIX)
+/*
+ * @docgen: function
+ * @brief: add the source files under a directory to a tree
+ * @name: walk_directory
+ *
+ * @param tree: the tree to add the files to
+ * @type: struct CSourceTree *
+ *
+ * @param path: the directory to walk
+ * @type: const char *
+*/
+static void walk_directory(struct CSourceTree *tree, const char *path) {
+    DIR *directory = NULL;
+    struct dirent *entry = NULL;
+
+    if((directory = opendir(path)) == NULL) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: could not open directory '%s'\n", path);
+
+        return;
+    }
+
+    while((entry = readdir(directory)) != NULL) {
+        struct stat status;
+        struct CString child;
+
+        /* Hidden files, along with . and .. */
+        if(entry->d_name[0] == '.')
+            continue;
+
+        child = cstring_init(path);
+
+        if(child.length > 0 && child.contents[child.length - 1] != '/')
+            cstring_concats(&child, "/");
+
+        cstring_concats(&child, entry->d_name);
+
+        /* Links are not followed into directories, so a cycle of them
+         * cannot make the walk go on forever */
+        if(lstat(child.contents, &status) == -1) {
+            cstring_free(child);
+
+            continue;
+        }
+
+        if(S_ISLNK(status.st_mode) != 0 && stat(child.contents, &status) == 0 &&
+           S_ISDIR(status.st_mode) != 0) {
+            cstring_free(child);
+
+            continue;
+        }
+
+        if(S_ISDIR(status.st_mode) != 0) {
+            walk_directory(tree, child.contents);
+            cstring_free(child);
+
+            continue;
+        }
+
+        if(S_ISREG(status.st_mode) != 0 && is_source(entry->d_name) == 1) {
+            struct CSourceTreeFile file;
+
+            file.path = child;
+            file.size = (long) status.st_size;
+            file.modified = (long) status.st_mtime;
+            file.data = NULL;
+            file.group = 0;
+            carray_append(tree, file, TREE_FILE);
+
+            continue;
+        }
+
+        cstring_free(child);
+    }
+
+    closedir(directory);
+}
+#endif
+
+int csource_tree_is_directory(const char *path) {
+#if defined(CSOURCE_TREE_POSIX)
+    struct stat status;
+#endif
+
+    liberror_is_null(csource_tree_is_directory, path);
+
+#if defined(CSOURCE_TREE_POSIX)
+    if(stat(path, &status) == 0 && S_ISDIR(status.st_mode) != 0)
+        return 1;
+#endif
+
+    return 0;
+}
+
+struct CSourceTree *csource_tree_init(const char *root) {
+    struct CSourceTree *tree = carray_init(tree, TREE_FILE);
+
+    liberror_is_null(csource_tree_init, root);
+
+#if defined(CSOURCE_TREE_POSIX)
+    walk_directory(tree, root);
+#endif
+
+    /* Directories are read in whatever order the file system keeps
+     * them, so sort the files to make the output reproducible */
+    qsort(tree->contents, tree->length, sizeof(*tree->contents), compare_files);
+
+    return tree;
+}
+
+void csource_tree_free(struct CSourceTree *tree) {
+    liberror_is_null(csource_tree_free, tree);
+
+    carray_free(tree, TREE_FILE);
+}
+
+static int compare_contents(const void *a, const void *b) {
+    const struct TreeContents *contents_a = a;
+    const struct TreeContents *contents_b = b;
+
+    if(contents_a->size != contents_b->size)
+        return contents_a->size < contents_b->size ? -1 : 1;
+
+    if(contents_a->hash != contents_b->hash)
+        return contents_a->hash < contents_b->hash ? -1 : 1;
+
+    return contents_a->index - contents_b->index;
+}
+
+/*
+ * @docgen: function
+ * @brief: hash the start and end of a file
+ * @name: hash_file
+ *
+ * @description
+ * @Hash the first and last TREE_SAMPLE_SIZE bytes of a file with 32 bit
+ * @FNV-1a. Copies of a file are found by their size and this hash without
+ * @reading them whole, which would cost as much as running most commands.
+ * @description
+ *
+ * @param path: the file to hash
+ * @type: const char *
+ *
+ * @param size: the size of the file
+ * @type: long
+ *
+ * @return: the hash of the file, or 0 if it could not be read
+ * @type: unsigned long
+*/
+static unsigned long hash_file(const char *path, long size) {
+    int part = 0;
+    FILE *file = NULL;
+    unsigned long hash = 2166136261UL;
+    char buffer[TREE_SAMPLE_SIZE];
+
+    if((file = fopen(path, "rb")) == NULL)
+        return 0;
+
+    for(part = 0; part < 2; part++) {
+        size_t index = 0;
+        size_t length = 0;
+
+        /* A file small enough to be read whole is read in the first part */
+        if(part == 1 && size <= TREE_SAMPLE_SIZE)
+            break;
+
+        if(part == 1 && size > TREE_SAMPLE_SIZE * 2)
+            fseek(file, -TREE_SAMPLE_SIZE, SEEK_END);
+
+        length = fread(buffer, 1, sizeof(buffer), file);
+
+        for(index = 0; index < length; index++) {
+            hash ^= (unsigned char) buffer[index];
+            hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+        }
+    }
+
+    if(ferror(file) != 0)
+        hash = 0;
+
+    fclose(file);
+
+    return hash;
+}
+
+int csource_tree_group(struct CSourceTree *tree) {
+    int first = 0;
+    int last = 0;
+    int index = 0;
+    int groups = 0;
+    struct TreeContentsArray *contents = NULL;
+
+    liberror_is_null(csource_tree_group, tree);
+
+    contents = carray_init(contents, TREE_CONTENTS);
+
+    for(index = 0; index < tree->length; index++) {
+        struct TreeContents file;
+
+        file.index = index;
+        file.size = tree->contents[index].size;
+        file.hash = 0;
+        tree->contents[index].group = 0;
+
+        carray_append(contents, file, TREE_CONTENTS);
+    }
+
+    /* Files can only be the same if their sizes are, so only the files
+     * which share their size with another are read */
+    qsort(contents->contents, contents->length, sizeof(*contents->contents), compare_contents);
+
+    for(first = 0; first < contents->length; first = last) {
+        for(last = first + 1; last < contents->length; last++) {
+            if(contents->contents[last].size != contents->contents[first].size)
+                break;
+        }
+
+        if(last - first == 1)
+            continue;
+
+        for(index = first; index < last; index++) {
+            struct CSourceTreeFile *file = tree->contents + contents->contents[index].index;
+
+            contents->contents[index].hash = hash_file(file->path.contents, file->size);
+        }
+    }
+
+    qsort(contents->contents, contents->length, sizeof(*contents->contents), compare_contents);
+
+    for(first = 0; first < contents->length; first = last) {
+        for(last = first + 1; last < contents->length; last++) {
+            if(contents->contents[last].size != contents->contents[first].size ||
+               contents->contents[last].hash != contents->contents[first].hash)
+                break;
+        }
+
+        if(last - first == 1 || contents->contents[first].hash == 0)
+            continue;
+
+        groups++;
+
+        for(index = first; index < last; index++)
+            tree->contents[contents->contents[index].index].group = groups;
+    }
+
+    carray_free(contents, TREE_CONTENTS);
+
+    return groups;
+}
+
+int csource_tree_jobs(void) {
+#if defined(CSOURCE_TREE_POSIX) && defined(_SC_NPROCESSORS_ONLN)
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if(processors > 0)
+        return (int) processors;
+#endif
+
+    return 1;
+}
+/*
+ * @docgen: structure
+ * @brief: how far a worker got through its files
+ * @name: TreeProgress
+ *
+ * @description
+ * @What a worker leaves behind before each file it starts, so that if it
+ * @crashes on one, the file is known, and whatever came before it is
+ * @still of use. In its file, the progress is followed by the offset the
+ * @output of each file of the worker starts at, so that the output of the
+ * @workers can be put back in the order of the tree.
+ * @description
+ *
+ * @field index: the file the worker is on, or the end of its files
+ * @type: int
+ *
+ * @field offset: how much output the worker had written before the file
+ * @type: long
+ *
+ * @field statistics: the statistics of the files before the file
+ * @type: struct CSourceStatistics
+*/
+struct TreeProgress {
+    int index;
+    long offset;
+    struct CSourceStatistics statistics;
+};
+
+/*
+ * @docgen: function
+ * @brief: record how far a worker got
+ * @name: mark_progress
+ *
+ * @param progress: the file to record the progress in, or NULL
+ * @type: FILE *
+ *
+ * @param index: the file the worker is on
+ * @type: int
+ *
+ * @param first: the first file of the worker
+ * @type: int
+ *
+ * @param stream: the stream the worker writes its records to
+ * @type: FILE *
+ *
+ * @param statistics: the statistics of the worker, or NULL
+ * @type: struct CSourceStatistics *
+*/
+static void mark_progress(FILE *progress, int index, int first, FILE *stream,
+                          struct CSourceStatistics *statistics) {
+    struct TreeProgress mark;
+
+    if(progress == NULL)
+        return;
+
+    INIT_VARIABLE(mark);
+
+    mark.index = index;
+    mark.offset = ftell(stream);
+
+    if(statistics != NULL)
+        mark.statistics = *statistics;
+
+    rewind(progress);
+    fwrite(&mark, sizeof(mark), 1, progress);
+
+    /* The output of the file starts where that of the last one ended */
+    fseek(progress, (long) (sizeof(mark) + sizeof(mark.offset) * (index - first)), SEEK_SET);
+    fwrite(&mark.offset, sizeof(mark.offset), 1, progress);
+    fflush(progress);
+}
+
+/*
+ * @docgen: function
+ * @brief: run a task over a range of the files of a tree
+ * @name: run_range
+ *
+ * @param tree: the tree to run over
+ * @type: struct CSourceTree *
+ *
+ * @param order: the files to run over, by their place, or NULL for the tree as it is
+ * @type: const int *
+ *
+ * @param first: the place of the first file
+ * @type: int
+ *
+ * @param last: the place after the last file
+ * @type: int
+ *
+ * @param run: how to run the task
+ * @type: struct CSourceTreeRun *
+ *
+ * @param stream: the stream to write to
+ * @type: FILE *
+ *
+ * @param progress: the file to record the progress in, or NULL
+ * @type: FILE *
+ *
+ * @param reached: where to put the place after the last file that was run, or NULL
+ * @type: int *
+ *
+ * @return: 0 if every file succeeded, or the exit status of the first that did not
+ * @type: int
+*/
+static int run_range(struct CSourceTree *tree, const int *order, int first, int last,
+                     struct CSourceTreeRun *run, FILE *stream, FILE *progress, int *reached) {
+    int index = 0;
+    int failure = 0;
+
+    for(index = first; index < last; index++) {
+        int status = 0;
+        int file = order == NULL ? index : order[index];
+
+        mark_progress(progress, index, first, stream, run->statistics);
+
+        if((status = run->task(tree->contents + file, stream, run->data)) == 0)
+            continue;
+
+        if(failure == 0)
+            failure = status;
+
+        if(run->keep_going == 0) {
+            index++;
+            break;
+        }
+    }
+
+    if(reached != NULL)
+        *reached = index;
+
+    return failure;
+}
+
+#if defined(CSOURCE_TREE_POSIX)
+/*
+ * @docgen: structure
+ * @brief: files of a tree that must be given to the same worker
+ * @name: TreeUnit
+ *
+ * @field id: the number of the unit, in the order of the tree
+ * @type: int
+ *
+ * @field size: the size of one of the files, which is what running them costs
+ * @type: long
+*/
+struct TreeUnit {
+    int id;
+    long size;
+};
+
+/*
+ * @docgen: structure
+ * @brief: where the output of a file of a tree is
+ * @name: TreeSlice
+ *
+ * @field output: the file the output is in, or NULL if the file has none
+ * @type: FILE *
+ *
+ * @field start: the offset the output starts at
+ * @type: long
+ *
+ * @field end: the offset after the output
+ * @type: long
+*/
+struct TreeSlice {
+    FILE *output;
+    long start;
+    long end;
+};
+
+static int compare_units(const void *a, const void *b) {
+    const struct TreeUnit *unit_a = a;
+    const struct TreeUnit *unit_b = b;
+
+    if(unit_a->size != unit_b->size)
+        return unit_a->size > unit_b->size ? -1 : 1;
+
+    return unit_a->id - unit_b->id;
+}
+
+/*
+ * @docgen: function
+ * @brief: give the files of a tree to workers
+ * @name: schedule_files
+ *
+ * @description
+ * @Give the files of a tree to workers, so that each has about the same
+ * @number of bytes to read. The files of a group all go to the same
+ * @worker, so that the copies of a file reuse its work rather than being
+ * @scanned again by another worker. A group costs about as much as one of
+ * @its files, since the others are only compared to it. The groups and
+ * @the other files are given out from the largest down, each to the worker
+ * @with the fewest bytes so far, and then each worker runs its files in
+ * @the order of the tree.
+ * @description
+ *
+ * @param tree: the tree to give out
+ * @type: struct CSourceTree *
+ *
+ * @param jobs: the number of workers, which is lowered if there are fewer groups and files
+ * @type: int *
+ *
+ * @param firsts: where to put the place of the first file of each worker, and the end
+ * @type: int *
+ *
+ * @return: the files, by their place, which the workers have in order
+ * @type: int *
+*/
+static int *schedule_files(struct CSourceTree *tree, int *jobs, int *firsts) {
+    int index = 0;
+    int units = 0;
+    int groups = 0;
+    int *order = csource_allocator.allocate(sizeof(int) * (tree->length + 1));
+    int *unit_of = csource_allocator.allocate(sizeof(int) * (tree->length + 1));
+    int *workers = csource_allocator.allocate(sizeof(int) * (tree->length + 1));
+    struct TreeUnit *list = csource_allocator.allocate(sizeof(*list) * (tree->length + 1));
+    double *loads = NULL;
+    int *group_unit = NULL;
+
+    for(index = 0; index < tree->length; index++) {
+        if(tree->contents[index].group > groups)
+            groups = tree->contents[index].group;
+    }
+
+    group_unit = csource_allocator.allocate(sizeof(int) * (groups + 1));
+
+    for(index = 0; index <= groups; index++)
+        group_unit[index] = -1;
+
+    for(index = 0; index < tree->length; index++) {
+        int group = tree->contents[index].group;
+
+        if(group > 0 && group_unit[group] != -1) {
+            unit_of[index] = group_unit[group];
+            continue;
+        }
+
+        if(group > 0)
+            group_unit[group] = units;
+
+        list[units].id = units;
+        list[units].size = tree->contents[index].size;
+        unit_of[index] = units++;
+    }
+
+    if(*jobs > units)
+        *jobs = units;
+
+    qsort(list, units, sizeof(*list), compare_units);
+    loads = csource_allocator.allocate(sizeof(double) * (*jobs + 1));
+
+    for(index = 0; index < *jobs; index++) {
+        loads[index] = 0;
+        firsts[index] = 0;
+    }
+
+    /* A tie goes to the worker with the fewest units, so that every
+     * worker gets at least one */
+    for(index = 0; index < units; index++) {
+        int worker = 0;
+        int best = 0;
+
+        for(worker = 1; worker < *jobs; worker++) {
+            if(loads[worker] < loads[best] ||
+               (loads[worker] == loads[best] && firsts[worker] < firsts[best]))
+                best = worker;
+        }
+
+        loads[best] += (double) list[index].size;
+        firsts[best]++;
+        workers[list[index].id] = best;
+    }
+
+    for(index = 0; index < *jobs; index++)
+        firsts[index] = 0;
+
+    for(index = 0; index < tree->length; index++)
+        firsts[workers[unit_of[index]]]++;
+
+    for(index = 1; index < *jobs; index++)
+        firsts[index] += firsts[index - 1];
+
+    /* Going back over the tree leaves the files of each worker in order,
+     * and the count of each worker at where its files start */
+    for(index = tree->length - 1; index >= 0; index--)
+        order[--firsts[workers[unit_of[index]]]] = index;
+
+    firsts[*jobs] = tree->length;
+
+    csource_allocator.release(unit_of);
+    csource_allocator.release(workers);
+    csource_allocator.release(list);
+    csource_allocator.release(loads);
+    csource_allocator.release(group_unit);
+
+    return order;
+}
+
+/*
+ * @docgen: function
+ * @brief: copy part of one stream to another
+ * @name: copy_stream
+ *
+ * @param from: the stream to copy from
+ * @type: FILE *
+ *
+ * @param to: the stream to copy to
+ * @type: FILE *
+ *
+ * @param start: where in the stream to start copying
+ * @type: long
+ *
+ * @param length: how much of the stream to copy
+ * @type: long
+*/
+static void copy_stream(FILE *from, FILE *to, long start, long length) {
+    static char buffer[TREE_COPY_SIZE];
+
+    /* The output of the files of a worker is mostly copied in order */
+    if(ftell(from) != start)
+        fseek(from, start, SEEK_SET);
+
+    while(length > 0) {
+        size_t chunk = sizeof(buffer);
+
+        if((long) chunk > length)
+            chunk = (size_t) length;
+
+        if((chunk = fread(buffer, 1, chunk, from)) == 0)
+            break;
+
+        fwrite(buffer, 1, chunk, to);
+        length -= (long) chunk;
+    }
+}
+
+/*
+ * @docgen: structure
+ * @brief: a worker process, and where its results go
+ * @name: TreeWorker
+ *
+ * @field process: the process of the worker
+ * @type: pid_t
+ *
+ * @field first: the place of the first file of the worker
+ * @type: int
+ *
+ * @field last: the place after the last file of the worker
+ * @type: int
+ *
+ * @field output: the file the worker writes its records to
+ * @type: FILE *
+ *
+ * @field progress: the file the worker records its progress in
+ * @type: FILE *
+*/
+struct TreeWorker {
+    pid_t process;
+    int first;
+    int last;
+    FILE *output;
+    FILE *progress;
+};
+
+/*
+ * @docgen: function
+ * @brief: start a worker on a range of the files of a tree
+ * @name: start_worker
+ *
+ * @param worker: the worker to start
+ * @type: struct TreeWorker *
+ *
+ * @param tree: the tree to run over
+ * @type: struct CSourceTree *
+ *
+ * @param order: the files of the tree, by their place
+ * @type: const int *
+ *
+ * @param first: the place of the first file
+ * @type: int
+ *
+ * @param last: the place after the last file
+ * @type: int
+ *
+ * @param run: how to run the task
+ * @type: struct CSourceTreeRun *
+*/
+static void start_worker(struct TreeWorker *worker, struct CSourceTree *tree, const int *order,
+                         int first, int last, struct CSourceTreeRun *run) {
+    int failure = 0;
+    int reached = 0;
+
+    worker->first = first;
+    worker->last = last;
+
+    /* Nothing buffered may be written twice by the children */
+    fflush(NULL);
+
+    if((worker->output = tmpfile()) == NULL || (worker->progress = tmpfile()) == NULL ||
+       (worker->process = fork()) == -1) {
+        fprintf(ERROR_MESSAGE_STREAM, "csource: could not start a worker\n");
+        exit(EXIT_INTERNAL_ERROR);
+    }
+
+    if(worker->process != 0)
+        return;
+
+    /* The statistics of a worker are only of its own files, since they
+     * are merged into the ones it was started with */
+    csource_statistics_reset();
+
+    if(run->statistics != NULL)
+        INIT_VARIABLE(*run->statistics);
+
+    failure = run_range(tree, order, first, last, run, worker->output, worker->progress,
+                        &reached);
+    fflush(worker->output);
+
+    if(run->statistics != NULL)
+        csource_statistics_collect(run->statistics);
+
+    mark_progress(worker->progress, reached, first, worker->output, run->statistics);
+    exit(failure);
+}
+
+/*
+ * @docgen: function
+ * @brief: wait for a worker, and find where the output of its files is
+ * @name: finish_worker
+ *
+ * @description
+ * @Wait for a worker to finish, and find the output of each file it ran.
+ * @If the worker crashed, the output of the files before the one it
+ * @crashed on is moved to the spill, the file is given to the error of the
+ * @run there, and when the run keeps going, the worker is started again
+ * @after it.
+ * @description
+ *
+ * @param worker: the worker to finish
+ * @type: struct TreeWorker *
+ *
+ * @param tree: the tree the worker runs over
+ * @type: struct CSourceTree *
+ *
+ * @param order: the files of the tree, by their place
+ * @type: const int *
+ *
+ * @param slices: where the output of each file of the tree is
+ * @type: struct TreeSlice *
+ *
+ * @param spill: the file the output of crashed workers is moved to, or NULL until one crashes
+ * @type: FILE **
+ *
+ * @param run: how the task is run
+ * @type: struct CSourceTreeRun *
+ *
+ * @return: 0 if every file succeeded, or the exit status of one that did not
+ * @type: int
+*/
+static int finish_worker(struct TreeWorker *worker, struct CSourceTree *tree, const int *order,
+                         struct TreeSlice *slices, FILE **spill, struct CSourceTreeRun *run) {
+    int failure = 0;
+
+    while(1) {
+        int index = 0;
+        int status = 0;
+        long spilled = 0;
+        long *starts = NULL;
+        struct TreeProgress mark;
+
+        INIT_VARIABLE(mark);
+        mark.index = worker->first;
+
+        waitpid(worker->process, &status, 0);
+
+        rewind(worker->progress);
+
+        if(fread(&mark, sizeof(mark), 1, worker->progress) != 1)
+            mark.index = worker->first;
+
+        starts = csource_allocator.allocate(sizeof(long) * (mark.index - worker->first + 1));
+
+        if(fread(starts, sizeof(long), mark.index - worker->first, worker->progress) !=
+           (size_t) (mark.index - worker->first))
+            mark.index = worker->first;
+
+        /* The output of each file ends where that of the next one starts */
+        for(index = worker->first; index < mark.index; index++) {
+            struct TreeSlice *slice = slices + order[index];
+
+            slice->output = worker->output;
+            slice->start = starts[index - worker->first];
+            slice->end = index + 1 < mark.index ? starts[index + 1 - worker->first] : mark.offset;
+        }
+
+        csource_allocator.release(starts);
+        fclose(worker->progress);
+
+        if(run->statistics != NULL)
+            csource_statistics_merge(run->statistics, mark.statistics);
+
+        /* The output is copied once every worker is done */
+        if(WIFEXITED(status) != 0) {
+            if(failure == 0)
+                failure = WEXITSTATUS(status);
+
+            return failure;
+        }
+
+        if(failure == 0)
+            failure = EXIT_INTERNAL_ERROR;
+
+        if(*spill == NULL && (*spill = tmpfile()) == NULL) {
+            fprintf(ERROR_MESSAGE_STREAM, "csource: could not create a temporary file\n");
+            exit(EXIT_INTERNAL_ERROR);
+        }
+
+        /* A new worker takes over the files after the crash with an output
+         * of its own, so what came before the crash is moved out */
+        fseek(*spill, 0, SEEK_END);
+        spilled = ftell(*spill);
+        copy_stream(worker->output, *spill, 0, mark.offset);
+        fclose(worker->output);
+        worker->output = NULL;
+
+        for(index = worker->first; index < mark.index; index++) {
+            slices[order[index]].output = *spill;
+            slices[order[index]].start += spilled;
+            slices[order[index]].end += spilled;
+        }
+
+        /* A worker which crashed before it started cannot be blamed on
+         * any file */
+        if(mark.index >= worker->last)
+            return failure;
+
+        slices[order[mark.index]].output = *spill;
+        slices[order[mark.index]].start = ftell(*spill);
+        run->error(tree->contents[order[mark.index]].path.contents,
+                   "the command crashed on this file", *spill, run->data);
+        slices[order[mark.index]].end = ftell(*spill);
+
+        if(run->keep_going == 0 || mark.index + 1 >= worker->last)
+            return failure;
+
+        start_worker(worker, tree, order, mark.index + 1, worker->last, run);
+    }
+}
+#endif
+
+int csource_tree_run(struct CSourceTree *tree, struct CSourceTreeRun run, FILE *stream) {
+#if defined(CSOURCE_TREE_POSIX)
+    int index = 0;
+    int failure = 0;
+    int *order = NULL;
+    int *firsts = NULL;
+    FILE *spill = NULL;
+    struct TreeSlice *slices = NULL;
+    struct TreeWorker *workers = NULL;
+#endif
+
+    liberror_is_null(csource_tree_run, tree);
+    liberror_is_null(csource_tree_run, run.task);
+    liberror_is_null(csource_tree_run, run.error);
+    liberror_is_null(csource_tree_run, stream);
+
+    if(run.jobs > tree->length)
+        run.jobs = tree->length;
+
+#if defined(CSOURCE_TREE_POSIX)
+    if(run.jobs > 1 || (run.jobs == 1 && run.keep_going == 1)) {
+        firsts = csource_allocator.allocate(sizeof(int) * (run.jobs + 1));
+        order = schedule_files(tree, &run.jobs, firsts);
+        workers = csource_allocator.allocate(sizeof(*workers) * run.jobs);
+        slices = csource_allocator.allocate(sizeof(*slices) * (tree->length + 1));
+
+        for(index = 0; index < tree->length; index++)
+            slices[index].output = NULL;
+
+        for(index = 0; index < run.jobs; index++)
+            start_worker(workers + index, tree, order, firsts[index], firsts[index + 1], &run);
+
+        for(index = 0; index < run.jobs; index++) {
+            int status = finish_worker(workers + index, tree, order, slices, &spill, &run);
+
+            if(failure == 0)
+                failure = status;
+        }
+
+        /* What was written to the spill is read back from it */
+        if(spill != NULL)
+            fflush(spill);
+
+        /* The output of the files is put back in the order of the tree */
+        for(index = 0; index < tree->length; index++) {
+            struct TreeSlice slice = slices[index];
+
+            if(slice.output != NULL)
+                copy_stream(slice.output, stream, slice.start, slice.end - slice.start);
+        }
+
+        for(index = 0; index < run.jobs; index++) {
+            if(workers[index].output != NULL)
+                fclose(workers[index].output);
+        }
+
+        if(spill != NULL)
+            fclose(spill);
+
+        csource_allocator.release(order);
+        csource_allocator.release(firsts);
+        csource_allocator.release(slices);
+        csource_allocator.release(workers);
+
+        return failure;
+    }
+#endif
+
+    return run_range(tree, NULL, 0, tree->length, &run, stream, NULL, NULL);
+}
@@ -0,0 +1,303 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Running a command over a whole tree of source files. The tree is walked
+ * once up front, and then split between worker processes by size, with
+ * every file of a group going to the same worker. Every worker writes its
+ * records to a file of its own, and the records of each file are copied
+ * to the output in the order of the tree once the workers are done, so the
+ * output is the same no matter how many workers there are.
+*/
+
+#ifndef CWARE_CSOURCE_TREE_H
+#define CWARE_CSOURCE_TREE_H
+
+#include <stdio.h>
+
+/* Data structure properties */
+#define TREE_FILE_TYPE  struct CSourceTreeFile
+#define TREE_FILE_HEAP  1
+#define TREE_FILE_FREE(value) cstring_free((value).path)
+
+struct CSourceStatistics;
+
+/*
+ * @docgen: structure
+ * @brief: a source file in a tree
+ * @name: CSourceTreeFile
+ *
+ * @field path: the path of the file
+ * @type: struct CString
+ *
+ * @field size: the size of the file in bytes
+ * @type: long
+ *
+ * @field modified: the time the file was last modified
+ * @type: long
+ *
+ * @field data: whatever the task needs to know of this file alone, or NULL
+ * @type: const void *
+ *
+ * @field group: the files that may have the same contents as this one, or 0 if none
+ * @type: int
+*/
+struct CSourceTreeFile {
+    struct CString path;
+    long size;
+    long modified;
+    const void *data;
+    int group;
+};
+
+/*
+ * @docgen: structure
+ * @brief: every source file in a tree, sorted by path
+ * @name: CSourceTree
+ *
+ * @field length: the number of files
+ * @type: int
+ *
+ * @field capacity: the capacity of the array
+ * @type: int
+ *
+ * @field contents: the files
+ * @type: struct CSourceTreeFile *
+*/
+struct CSourceTree {
+    int length;
+    int capacity;
+    struct CSourceTreeFile *contents;
+};
+
+/*
+ * @docgen: function
+ * @brief: what to do with each file of a tree
+ * @name: CSourceTreeTask
+ *
+ * @param file: the file
+ * @type: const struct CSourceTreeFile *
+ *
+ * @param stream: the stream to write the records of the file to
+ * @type: FILE *
+ *
+ * @param data: the data of the run
+ * @type: void *
+ *
+ * @return: 0 if the file was processed, or an exit status if it failed
+ * @type: int
+*/
+typedef int (*CSourceTreeTask)(const struct CSourceTreeFile *file, FILE *stream, void *data);
+
+/*
+ * @docgen: function
+ * @brief: what to do with a file a task crashed on
+ * @name: CSourceTreeError
+ *
+ * @param path: the path of the file
+ * @type: const char *
+ *
+ * @param reason: why the file failed
+ * @type: const char *
+ *
+ * @param stream: the stream to write the records of the file to
+ * @type: FILE *
+ *
+ * @param data: the data of the run
+ * @type: void *
+*/
+typedef void (*CSourceTreeError)(const char *path, const char *reason, FILE *stream, void *data);
+
+/*
+ * @docgen: structure
+ * @brief: how to run a task over a tree
+ * @name: CSourceTreeRun
+ *
+ * @field jobs: the most workers to run at once
+ * @type: int
+ *
+ * @field keep_going: whether to go on to the next file after one fails
+ * @type: int
+ *
+ * @field task: the task to run on each file
+ * @type: CSourceTreeTask
+ *
+ * @field error: called with each file a worker crashed on
+ * @type: CSourceTreeError
+ *
+ * @field data: passed to the task and the error
+ * @type: void *
+ *
+ * @field statistics: the statistics to merge into, or NULL
+ * @type: struct CSourceStatistics *
+*/
+struct CSourceTreeRun {
+    int jobs;
+    int keep_going;
+    CSourceTreeTask task;
+    CSourceTreeError error;
+    void *data;
+    struct CSourceStatistics *statistics;
+};
+
+/*
+ * @docgen: function
+ * @brief: determine if a path is a directory
+ * @name: csource_tree_is_directory
+ *
+ * @error: path is NULL
+ *
+ * @param path: the path to check
+ * @type: const char *
+ *
+ * @return: 1 if the path is a directory, 0 if it is not
+ * @type: int
+*/
+int csource_tree_is_directory(const char *path);
+
+/*
+ * @docgen: function
+ * @brief: find every source file in a tree
+ * @name: csource_tree_init
+ *
+ * @description
+ * @Walk a directory and everything under it for C source files and
+ * @headers. Hidden files and directories are skipped, and so are links to
+ * @directories, so a tree with a cycle in it is still walked once.
+ * @description
+ *
+ * @error: root is NULL
+ *
+ * @param root: the directory to walk
+ * @type: const char *
+ *
+ * @return: the source files in the tree
+ * @type: struct CSourceTree *
+*/
+struct CSourceTree *csource_tree_init(const char *root);
+
+/*
+ * @docgen: function
+ * @brief: release a tree from memory
+ * @name: csource_tree_free
+ *
+ * @error: tree is NULL
+ *
+ * @param tree: the tree to release
+ * @type: struct CSourceTree *
+*/
+void csource_tree_free(struct CSourceTree *tree);
+
+/*
+ * @docgen: function
+ * @brief: group the files of a tree that may have the same contents
+ * @name: csource_tree_group
+ *
+ * @description
+ * @Find the files of a tree which may be copies of another, and give each
+ * @set of them a group of its own, from 1 up, so that a task can do the
+ * @work of a set once. Files are put together if they are the same size,
+ * @and the start and end of them are the same, so a task must still check
+ * @that a file is the same as the one whose work it would reuse. Only files
+ * @which share their size with another are read. The other files, and any
+ * @that cannot be read, are left in group 0.
+ * @description
+ *
+ * @error: tree is NULL
+ *
+ * @param tree: the tree to group the files of
+ * @type: struct CSourceTree *
+ *
+ * @return: the number of groups
+ * @type: int
+*/
+int csource_tree_group(struct CSourceTree *tree);
+
+/*
+ * @docgen: function
+ * @brief: the number of workers to use by default
+ * @name: csource_tree_jobs
+ *
+ * @return: the number of processors online, or 1 if it is not known
+ * @type: int
+*/
+int csource_tree_jobs(void);
+
+/*
+ * @docgen: function
+ * @brief: run a task over every file of a tree
+ * @name: csource_tree_run
+ *
+ * @description
+ * @Run a task over every file of a tree with up to the given number of
+ * @worker processes, and write what the tasks wrote to the stream in the
+ * @order of the files. If statistics are given, the statistics each worker
+ * @collects are merged into them.
+ * @
+ * @A worker stops at the first file that fails, unless the run keeps
+ * @going. A worker that crashes has its file given to the error of the
+ * @run, and when the run keeps going, a new worker takes over the files
+ * @after it. Everything written for the files before it is kept.
+ * @description
+ *
+ * @notes
+ * @With one job, or on systems without processes, the tasks run in this
+ * @process, and write directly to the stream. A run that keeps going always
+ * @uses workers where there are processes, so that a crash only costs the
+ * @file it happened on.
+ * @notes
+ *
+ * @error: tree is NULL
+ * @error: run.task is NULL
+ * @error: run.error is NULL
+ * @error: stream is NULL
+ *
+ * @param tree: the tree to run over
+ * @type: struct CSourceTree *
+ *
+ * @param run: how to run the task
+ * @type: struct CSourceTreeRun
+ *
+ * @param stream: the stream to write to
+ * @type: FILE *
+ *
+ * @return: 0 if every file succeeded, or the exit status of one that did not
+ * @type: int
+*/
+int csource_tree_run(struct CSourceTree *tree, struct CSourceTreeRun run, FILE *stream);
+
+#endif